@@ -5,11 +5,10 @@ import Foundation
 final class AppFileLogger {
     static let shared = AppFileLogger()
 
-    private let queue = DispatchQueue(label: "AppFileLogger.queue")
     // Prefer the sandbox container so this works under the App Sandbox.
     // Example:
     // ~/Library/Containers/personal.Kenwood-control/Data/Library/Logs/kenwood-control.log
-    private let url: URL = {
+    private static let url: URL = {
         // Prefer a user-accessible location when permitted by entitlements.
         // We enable Downloads read/write so VoiceOver users can inspect logs without Console.app.
         if let downloads = FileManager.default.urls(for: .downloadsDirectory, in: .userDomainMask).first {
@@ -22,68 +21,58 @@ final class AppFileLogger {
         return home.appendingPathComponent("Library/Logs/kenwood-control.log")
     }()
     private let maxBytes: Int = 5 * 1024 * 1024
-    private let keepTailBytes: Int = 1 * 1024 * 1024
+    private let path: String
 
-    private init() {}
+    /// Records go into kc_log's ring on the calling thread and its writer thread appends them to
+    /// the open file, so logging costs a copy rather than an open/write/close per line.
+    /// `defaults write <bundle id> binary_log -bool YES` writes binary records to a .kclog file
+    /// instead: smaller, for long sessions; `kc-log decode` turns them back into text.
+    private init() {
+        let binary = UserDefaults.standard.bool(forKey: "binary_log")
+        let url = Self.url
+        path = binary ? url.deletingPathExtension().appendingPathExtension("kclog").path : url.path
+        try? FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true)
+        var config = kc_log_config()
+        config.binary = binary ? 1 : 0
+        config.maxBytes = maxBytes
+        config.keep = 1
+        let result = path.withCString { cPath -> Int32 in
+            config.path = cPath
+            return kc_log_open(&config)
+        }
+        if result != 0 {
+            // Logging must never break app behavior, but we still want a breadcrumb in unified logs.
+            AppLogger.error("File log open failed: \(String(cString: strerror(errno))) path=\(path)")
+        }
+    }
 
     func log(_ message: String) {
-        queue.async {
-            self.rotateIfNeeded()
-            self.appendLine(message)
-        }
+        var message = message
+        message.withUTF8 { kc_log_text(KC_LOG_INFO, $0.baseAddress, $0.count) }
     }
 
+    /// Returns once the line is in the file.
     func logSync(_ message: String) {
-        queue.sync {
-            self.rotateIfNeeded()
-            self.appendLine(message)
-        }
+        log(message)
+        kc_log_flush()
     }
 
-    func logLaunchHeader() {
-        let version = Bundle.main.object(forInfoDictionaryKey: "CFBundleShortVersionString") as? String ?? "?"
-        let build = Bundle.main.object(forInfoDictionaryKey: "CFBundleVersion") as? String ?? "?"
-        logSync("=== Launch \(Self.timestamp()) v\(version) (\(build)) pid=\(ProcessInfo.processInfo.processIdentifier) ===")
-        logSync("Log path: \(url.path)")
+    /// A received CAT frame, without its ';', logged from its bytes.
+    func logReceivedFrame(_ frame: UnsafeRawBufferPointer) {
+        kc_log_write(KC_LOG_INFO, KC_LOG_FMT_CAT_RX, nil, 0, frame.baseAddress, frame.count)
     }
 
-    private func appendLine(_ message: String) {
-        let line = "[\(Self.timestamp())] \(message)\n"
-        guard let data = line.data(using: .utf8) else { return }
-
-        do {
-            // Ensure directory exists.
-            let dir = url.deletingLastPathComponent()
-            try FileManager.default.createDirectory(at: dir, withIntermediateDirectories: true)
-            if !FileManager.default.fileExists(atPath: url.path) {
-                FileManager.default.createFile(atPath: url.path, contents: nil)
-            }
-            let handle = try FileHandle(forWritingTo: url)
-            try handle.seekToEnd()
-            try handle.write(contentsOf: data)
-            try handle.close()
-        } catch {
-            // Logging must never break app behavior, but we still want a breadcrumb in unified logs.
-            AppLogger.error("File log write failed: \(error.localizedDescription) path=\(url.path)")
-        }
+    /// A bandscope or audio-scope frame: its command and its length only.
+    func logScopeFrame(_ command: UnsafeRawBufferPointer, length: Int) {
+        var chars = UInt64(length)
+        kc_log_write(KC_LOG_INFO, KC_LOG_FMT_CAT_SCOPE, &chars, 1, command.baseAddress, command.count)
     }
 
-    private func rotateIfNeeded() {
-        do {
-            let attrs = try FileManager.default.attributesOfItem(atPath: url.path)
-            let size = (attrs[.size] as? NSNumber)?.intValue ?? 0
-            guard size > maxBytes else { return }
-
-            let handle = try FileHandle(forReadingFrom: url)
-            defer { try? handle.close() }
-
-            let tail = try handle.readToEnd() ?? Data()
-            let trimmed = tail.suffix(keepTailBytes)
-            try trimmed.write(to: url, options: .atomic)
-            appendLine("=== log rotated (kept last \(keepTailBytes) bytes) ===")
-        } catch {
-            // Ignore.
-        }
+    func logLaunchHeader() {
+        let version = Bundle.main.object(forInfoDictionaryKey: "CFBundleShortVersionString") as? String ?? "?"
+        let build = Bundle.main.object(forInfoDictionaryKey: "CFBundleVersion") as? String ?? "?"
+        logSync("=== Launch \(Self.timestamp()) v\(version) (\(build)) pid=\(ProcessInfo.processInfo.processIdentifier) ===")
+        logSync("Log path: \(path)")
     }
 
     private static func timestamp() -> String {
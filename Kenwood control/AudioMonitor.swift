@@ -44,11 +44,19 @@ final class AudioMonitor {
     private var isRunning = false
     private var dryFrame: [Float]
     private var wetFrame: [Float]
+    // Backlog path: when the process timer runs late, up to `maxBatchFrames` queued frames
+    // go to the processor in one call (EMNR batches its FFTs across them).
+    // Blocks are preallocated per frame count (index = frames) so the backlog path doesn't allocate.
+    private let maxBatchFrames = 8
+    private var dryBlocks: [[Float]]
+    private var wetBlocks: [[Float]]
 
     init(processor: any NoiseReductionProcessor) {
         self.processor = processor
         self.dryFrame = Array(repeating: 0, count: frameSize)
         self.wetFrame = Array(repeating: 0, count: frameSize)
+        self.dryBlocks = (0...maxBatchFrames).map { Array(repeating: 0, count: $0 * frameSize) }
+        self.wetBlocks = (0...maxBatchFrames).map { Array(repeating: 0, count: $0 * frameSize) }
     }
 
     func start(inputDeviceID: AudioDeviceID, outputDeviceID: AudioDeviceID) throws {
@@ -248,6 +256,8 @@ final class AudioMonitor {
         guard let inputUnit else { return noErr }
         let frames = Int(inNumberFrames)
         if frames <= 0 { return noErr }
+        kc_rt_guard_enter()
+        defer { kc_rt_guard_leave() }
         if frames > inputScratch.count {
             // Avoid allocating in realtime callback.
             return noErr
@@ -294,6 +304,8 @@ final class AudioMonitor {
         guard let first = buffers.first else { return noErr }
         guard first.mNumberChannels == channels else { return noErr }
         guard let outPtr = first.mData?.assumingMemoryBound(to: Float.self) else { return noErr }
+        kc_rt_guard_enter()
+        defer { kc_rt_guard_leave() }
 
         let got = outFifo.read(into: outPtr, count: frames)
         if got < frames {
@@ -327,6 +339,36 @@ final class AudioMonitor {
 
     private func drainAndProcess() {
         guard isRunning else { return }
+        kc_rt_guard_enter()
+        defer { kc_rt_guard_leave() }
+
+        while rawFifo.availableToRead() >= 2 * frameSize {
+            let frames = min(rawFifo.availableToRead() / frameSize, maxBatchFrames)
+            let n = frames * frameSize
+            let readCount = dryBlocks[frames].withUnsafeMutableBufferPointer { ptr in
+                rawFifo.read(into: ptr.baseAddress!, count: n)
+            }
+            if readCount < n { break }
+
+            dryBlocks[frames].withUnsafeBufferPointer { dry in
+                wetBlocks[frames].withUnsafeMutableBufferPointer { wet in
+                    wet.baseAddress!.update(from: dry.baseAddress!, count: n)
+                }
+            }
+            processor.processFrames48kMonoInPlace(&wetBlocks[frames], frameSize: frameSize)
+
+            let mix = wetDry
+            if mix < 1 {
+                let inv = 1 - mix
+                for i in 0..<n {
+                    wetBlocks[frames][i] = dryBlocks[frames][i] * inv + wetBlocks[frames][i] * mix
+                }
+            }
+
+            _ = wetBlocks[frames].withUnsafeBufferPointer { ptr in
+                outFifo.write(from: ptr.baseAddress!, count: n)
+            }
+        }
 
         while rawFifo.availableToRead() >= frameSize {
             let readCount = dryFrame.withUnsafeMutableBufferPointer { ptr in
@@ -334,7 +376,13 @@ final class AudioMonitor {
             }
             if readCount < frameSize { break }
 
-            wetFrame = dryFrame
+            // Element copy, not `wetFrame = dryFrame`: sharing the storage would make the
+            // in-place call below copy (allocate) the array on every frame.
+            dryFrame.withUnsafeBufferPointer { dry in
+                wetFrame.withUnsafeMutableBufferPointer { wet in
+                    wet.baseAddress!.update(from: dry.baseAddress!, count: frameSize)
+                }
+            }
             processor.processFrame48kMonoInPlace(&wetFrame)
 
             let mix = wetDry
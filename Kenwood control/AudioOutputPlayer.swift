@@ -66,11 +66,15 @@ final class AudioOutputPlayer {
         fifo.clear()
     }
 
-    func enqueue48kMono(_ samples: [Float]) {
-        samples.withUnsafeBufferPointer { ptr in
-            guard let base = ptr.baseAddress else { return }
-            _ = fifo.write(from: base, count: samples.count)
+    /// Copies `samples` into the output FIFO; whatever doesn't fit is dropped. Doesn't allocate.
+    func enqueue48kMono(_ samples: UnsafeBufferPointer<Float>) {
+        guard let base = samples.baseAddress else { return }
+        let start = kc_stats_begin()
+        let written = fifo.write(from: base, count: samples.count)
+        if written < samples.count {
+            kc_stats_count(KC_STATS_FIFO_DROPS, UInt64(samples.count - written))
         }
+        kc_stats_end(KC_STATS_FIFO_WRITE, start)
     }
 
     private func makeOutputUnit(deviceID: AudioDeviceID) throws -> AudioUnit {
@@ -153,8 +157,14 @@ final class AudioOutputPlayer {
         guard first.mNumberChannels == channels else { return noErr }
         guard let outPtr = first.mData?.assumingMemoryBound(to: Float.self) else { return noErr }
 
+        kc_rt_guard_enter()
+        defer { kc_rt_guard_leave() }
+        let start = kc_stats_begin()
+        defer { kc_stats_end(KC_STATS_OUTPUT_PULL, start) }
+
         let got = fifo.read(into: outPtr, count: frames)
         if got < frames {
+            kc_stats_count(KC_STATS_UNDERRUNS, 1)
             outPtr.advanced(by: got).initialize(repeating: 0, count: frames - got)
         }
         if gain != 1 {
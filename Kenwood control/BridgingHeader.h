@@ -9,4 +9,19 @@
 #include "WDSPWrapper.h"
 #endif
 
+#include "Native/kc_audio_stats.h"
+#include "Native/kc_rt_guard.h"
+#include "Native/kc_jitter.h"
+#include "Native/kc_plc.h"
+#include "Native/kc_pcm.h"
+#include "Native/kc_udp_rx.h"
+#include "Native/kc_tx.h"
+#include "Native/kc_capture.h"
+#include "Native/kc_log.h"
+#include "Native/kc_cat_codec.h"
+#include "Native/kc_cat_framer.h"
+#include "Native/kc_cat_sched.h"
+#include "Native/kc_rig_state.h"
+#include "Native/kc_rigctl.h"
+
 #endif /* BridgingHeader_h */
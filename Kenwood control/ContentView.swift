@@ -978,6 +978,24 @@ private struct AudioSectionView: View {
                     .accessibilityLabel("Noise reduction backend selector")
                     .accessibilityValue(radio.noiseReductionBackend)
 
+                    if radio.nrGovernorLevel != NoiseReductionGovernor.Level.full.label || radio.nrDeadlineMisses > 0 {
+                        Text("NR load: \(radio.nrGovernorLevel)   Late frames: \(radio.nrDeadlineMisses)")
+                            .font(.system(.body, design: .monospaced))
+                            .accessibilityLabel("Noise reduction load level \(radio.nrGovernorLevel), \(radio.nrDeadlineMisses) late frames")
+                    }
+
+                    if let timing = radio.audioTimingSummary {
+                        Text("Audio timing: \(timing)")
+                            .font(.system(.body, design: .monospaced))
+                            .accessibilityLabel("Audio timing, last second: \(timing)")
+                    }
+
+                    if let floor = radio.noiseFloorDB, let snr = radio.estimatedSNRDB {
+                        Text("Noise floor: \(floor) dB   SNR: \(snr) dB")
+                            .font(.system(.body, design: .monospaced))
+                            .accessibilityLabel("Noise floor \(floor) dB, signal to noise \(snr) dB")
+                    }
+
                 }
 
                 Divider()
@@ -1042,6 +1060,29 @@ private struct AudioSectionView: View {
                                 .font(.system(.body, design: .monospaced))
                         }
                     }
+
+                    if let jitter = radio.lanJitterSummary {
+                        Text(jitter)
+                            .font(.system(.body, design: .monospaced))
+                            .accessibilityLabel("Jitter buffer: \(jitter)")
+                    }
+                }
+
+                Divider()
+
+                VStack(alignment: .leading, spacing: 10) {
+                    Text("Logging and Digital-Mode Software")
+                        .font(.headline)
+
+                    Toggle("rigctld server (Hamlib NET rigctl)", isOn: Binding(
+                        get: { radio.rigctlServerEnabled },
+                        set: { radio.setRigctlServerEnabled($0) }
+                    ))
+                    .accessibilityValue(radio.rigctlServerEnabled ? "On" : "Off")
+
+                    Text(radio.rigctlServerStatus)
+                        .font(.system(.body, design: .monospaced))
+                        .accessibilityLabel("rigctld server: \(radio.rigctlServerStatus)")
                 }
             }
             .frame(maxWidth: .infinity, alignment: .leading)
@@ -877,11 +877,12 @@ final class FT8ViewModel: ObservableObject {
         putASCII("data")
         putU32(UInt32(dataBytes))
 
-        for s in samples {
-            let clamped = max(-1.0, min(1.0, Double(s)))
-            let v = Int16(clamped * 32767.0)
-            var le = v.littleEndian
-            data.append(UnsafeBufferPointer(start: &le, count: 1))
+        let pcmStart = data.count
+        data.count += dataBytes
+        samples.withUnsafeBufferPointer { src in
+            data.withUnsafeMutableBytes { raw in
+                kc_pcm_f32_to_s16le(src.baseAddress, raw.baseAddress! + pcmStart, numSamples, 32767.0, nil)
+            }
         }
 
         try data.write(to: path, options: .atomic)
@@ -1,6 +1,18 @@
 import Foundation
 
 enum KenwoodCAT {
+    /// Formats a command from Native/kc_cat_spec.h (kc_cat_encode) into a stack buffer.
+    /// Callers clamp first; a value that still doesn't fit its field gives "".
+    private static func encode(_ cmd: kc_cat_cmd, _ values: Int...) -> String {
+        withUnsafeTemporaryAllocation(of: Int64.self, capacity: values.count) { fields in
+            for (i, v) in values.enumerated() { fields[i] = Int64(v) }
+            return withUnsafeTemporaryAllocation(of: CChar.self, capacity: 32) { buf in
+                let n = kc_cat_encode(buf.baseAddress, buf.count, cmd, fields.baseAddress, Int32(values.count), nil, 0)
+                return String(decoding: UnsafeRawBufferPointer(start: buf.baseAddress, count: n), as: UTF8.self)
+            }
+        }
+    }
+
     enum AutoInformationMode: Int {
         case off = 0
         /// AI ON (not backed up on radio power-off).
@@ -15,18 +27,18 @@ enum KenwoodCAT {
 
     static func setVFOAFrequencyHz(_ hz: Int) -> String {
         let clamped = max(0, min(hz, 999_999_999))
-        return String(format: "FA%011d;", clamped)
+        return encode(KC_CAT_FA, clamped)
     }
 
     static func getVFOBFrequency() -> String { "FB;" }
 
     static func setVFOBFrequencyHz(_ hz: Int) -> String {
         let clamped = max(0, min(hz, 999_999_999))
-        return String(format: "FB%011d;", clamped)
+        return encode(KC_CAT_FB, clamped)
     }
 
     static func setAutoInformation(_ mode: AutoInformationMode) -> String {
-        "AI\(mode.rawValue);"
+        encode(KC_CAT_AI, mode.rawValue)
     }
 
     // MARK: - KNS VoIP Levels (requires administrator login for setting)
@@ -36,12 +48,12 @@ enum KenwoodCAT {
 
     static func setVoipInputLevel(_ level: Int) -> String {
         let clamped = max(0, min(level, 100))
-        return String(format: "##KN30%03d;", clamped)
+        return encode(KC_CAT_KN3, 0, clamped)
     }
 
     static func setVoipOutputLevel(_ level: Int) -> String {
         let clamped = max(0, min(level, 100))
-        return String(format: "##KN31%03d;", clamped)
+        return encode(KC_CAT_KN3, 1, clamped)
     }
 
     // MARK: - AF Gain (Audio / Speaker Level)
@@ -50,7 +62,7 @@ enum KenwoodCAT {
 
     static func setAFGain(_ value: Int) -> String {
         let clamped = max(0, min(value, 255))
-        return String(format: "AG%03d;", clamped)
+        return encode(KC_CAT_AG, clamped)
     }
 
     // MARK: - Operating Mode (OM)
@@ -83,12 +95,12 @@ enum KenwoodCAT {
     }
 
     static func getOperatingMode(_ area: FrequencyDisplayArea = .left) -> String {
-        "OM\(area.rawValue);"
+        encode(KC_CAT_OM, area.rawValue)
     }
 
     static func setOperatingMode(_ mode: OperatingMode) -> String {
         // Kenwood notes P1 is ignored for setting; provide a placeholder.
-        "OM0\(mode.rawValue);"
+        encode(KC_CAT_OM, 0, mode.rawValue)
     }
 
     // MARK: - Mode / Data Mode (MD)
@@ -96,14 +108,14 @@ enum KenwoodCAT {
     // TS-890 reports "MDx" in Auto Information. We use this as the primary way to enter/exit "USB-DATA".
     // Exact mapping is radio-specific; we treat values as opaque and restore what we observed.
     static func getModeMD() -> String { "MD;" }
-    static func setModeMD(_ value: Int) -> String { "MD\(value);" }
+    static func setModeMD(_ value: Int) -> String { encode(KC_CAT_MD, value) }
 
     // MARK: - Data Mode (DA)
     //
     // The TS-890 command set supports "data mode" selection separate from base mode on many Kenwood rigs.
     // If the radio rejects these commands, it will respond with `?;` and the app will continue.
     static func getDataMode() -> String { "DA;" }
-    static func setDataMode(enabled: Bool) -> String { "DA\(enabled ? 1 : 0);" }
+    static func setDataMode(enabled: Bool) -> String { encode(KC_CAT_DA, enabled ? 1 : 0) }
 
     // MARK: - Noise Reduction / Notch
 
@@ -122,10 +134,10 @@ enum KenwoodCAT {
     }
 
     static func getNoiseReduction() -> String { "NR;" }
-    static func setNoiseReduction(_ mode: NoiseReductionMode) -> String { "NR\(mode.rawValue);" }
+    static func setNoiseReduction(_ mode: NoiseReductionMode) -> String { encode(KC_CAT_NR, mode.rawValue) }
 
     static func getNotch() -> String { "NT;" }
-    static func setNotch(enabled: Bool) -> String { "NT\(enabled ? 1 : 0);" }
+    static func setNotch(enabled: Bool) -> String { encode(KC_CAT_NT, enabled ? 1 : 0) }
 
     // MARK: - Squelch / Meter
 
@@ -133,7 +145,7 @@ enum KenwoodCAT {
 
     static func setSquelchLevel(_ level: Int) -> String {
         let clamped = max(0, min(level, 255))
-        return String(format: "SQ%03d;", clamped)
+        return encode(KC_CAT_SQ, clamped)
     }
 
     static func getSMeter() -> String { "SM;" }
@@ -145,7 +157,7 @@ enum KenwoodCAT {
     static func setRFGain(_ value: Int) -> String {
         // TS-890S PC Control command reference guide: 000..255
         let clamped = max(0, min(value, 255))
-        return String(format: "RG%03d;", clamped)
+        return encode(KC_CAT_RG, clamped)
     }
 
     // MARK: - PTT (TX/RX)
@@ -170,18 +182,18 @@ enum KenwoodCAT {
     }
 
     static func getReceiverVFO() -> String { "FR;" }
-    static func setReceiverVFO(_ vfo: VFO) -> String { "FR\(vfo.rawValue);" }
+    static func setReceiverVFO(_ vfo: VFO) -> String { encode(KC_CAT_FR, vfo.rawValue) }
 
     static func getTransmitterVFO() -> String { "FT;" }
-    static func setTransmitterVFO(_ vfo: VFO) -> String { "FT\(vfo.rawValue);" }
+    static func setTransmitterVFO(_ vfo: VFO) -> String { encode(KC_CAT_FT, vfo.rawValue) }
 
     // MARK: - RIT / XIT
 
     static func ritGetState() -> String { "RT;" }
-    static func ritSetEnabled(_ enabled: Bool) -> String { "RT\(enabled ? 1 : 0);" }
+    static func ritSetEnabled(_ enabled: Bool) -> String { encode(KC_CAT_RT, enabled ? 1 : 0) }
 
     static func xitGetState() -> String { "XT;" }
-    static func xitSetEnabled(_ enabled: Bool) -> String { "XT\(enabled ? 1 : 0);" }
+    static func xitSetEnabled(_ enabled: Bool) -> String { encode(KC_CAT_XT, enabled ? 1 : 0) }
 
     static func ritXitClearOffset() -> String { "RC;" }
     static func ritXitGetOffset() -> String { "RF;" }
@@ -192,11 +204,7 @@ enum KenwoodCAT {
     static func ritXitSetOffsetHz(_ hz: Int) -> String {
         // RU is positive; RD is negative. P1 is 5 digits (0..9999).
         let absHz = max(0, min(abs(hz), 9_999))
-        if hz >= 0 {
-            return String(format: "RU%05d;", absHz)
-        } else {
-            return String(format: "RD%05d;", absHz)
-        }
+        return encode(hz >= 0 ? KC_CAT_RU : KC_CAT_RD, absHz)
     }
 
     // MARK: - RX Filter Low/High Cut and Shift
@@ -204,13 +212,13 @@ enum KenwoodCAT {
     static func getReceiveFilterLowCutSettingID() -> String { "SL0;" }
     static func setReceiveFilterLowCutSettingID(_ id: Int) -> String {
         let clamped = max(0, min(id, 99))
-        return String(format: "SL0%02d;", clamped)
+        return encode(KC_CAT_SL, 0, clamped)
     }
 
     static func getReceiveFilterHighCutSettingID() -> String { "SH0;" }
     static func setReceiveFilterHighCutSettingID(_ id: Int) -> String {
         let clamped = max(0, min(id, 999))
-        return String(format: "SH0%03d;", clamped)
+        return encode(KC_CAT_SH, 0, clamped)
     }
 
     static func getReceiveFilterShift() -> String { "IS;" }
@@ -218,8 +226,7 @@ enum KenwoodCAT {
     static func setReceiveFilterShiftHz(_ hz: Int) -> String {
         // IS expects sign (+/-/space) and 4 digits. Radio clamps to legal ranges by mode.
         let clamped = max(-9_999, min(hz, 9_999))
-        let sign = clamped < 0 ? "-" : "+"
-        return String(format: "IS%@%04d;", sign, abs(clamped))
+        return encode(KC_CAT_IS, clamped)
     }
 
     // MARK: - TX Power
@@ -228,7 +235,7 @@ enum KenwoodCAT {
     static func setOutputPowerWatts(_ watts: Int) -> String {
         // HF/50: 5..100. (AM limits differ, but the radio will clamp/reject.)
         let clamped = max(5, min(watts, 100))
-        return String(format: "PC%03d;", clamped)
+        return encode(KC_CAT_PC, clamped)
     }
 
     // MARK: - Antenna Tuner (ATU)
@@ -238,23 +245,23 @@ enum KenwoodCAT {
     static func setAntennaTuner(txEnabled: Bool) -> String {
         // Per PC Command guide notes: P1 is invalid for setting; enter 1.
         // P3: 0 stop tuning, 1 start tuning.
-        return "AC1\(txEnabled ? 1 : 0)0;"
+        return encode(KC_CAT_AC, 1, txEnabled ? 1 : 0, 0)
     }
 
-    static func startAntennaTuning() -> String { "AC111;" }
-    static func stopAntennaTuning(txEnabled: Bool) -> String { "AC1\(txEnabled ? 1 : 0)0;" }
+    static func startAntennaTuning() -> String { encode(KC_CAT_AC, 1, 1, 1) }
+    static func stopAntennaTuning(txEnabled: Bool) -> String { encode(KC_CAT_AC, 1, txEnabled ? 1 : 0, 0) }
 
     // MARK: - Split Offset Setting (kHz)
 
     static func getSplitOffsetSettingState() -> String { "SP;" }
-    static func startSplitOffsetSetting() -> String { "SP1;" }
-    static func cancelSplitOffsetSetting() -> String { "SP2;" }
+    static func startSplitOffsetSetting() -> String { encode(KC_CAT_SP, 1) }
+    static func cancelSplitOffsetSetting() -> String { encode(KC_CAT_SP, 2) }
 
     static func setSplitOffset(plus: Bool, khz: Int) -> String {
         let amount = max(1, min(khz, 9))
         let dir = plus ? 0 : 1
         // Setting 2: SP0 P2 P3;
-        return "SP0\(dir)\(amount);"
+        return encode(KC_CAT_SP0, dir, amount)
     }
 
     // MARK: - Memory Channels
@@ -270,12 +277,12 @@ enum KenwoodCAT {
 
     static func setMemoryChannelNumber(_ channel: Int) -> String {
         let clamped = max(0, min(channel, 119))
-        return String(format: "MN%03d;", clamped)
+        return encode(KC_CAT_MN, clamped)
     }
 
     static func getMemoryChannelConfiguration(_ channel: Int) -> String {
         let clamped = max(0, min(channel, 119))
-        return String(format: "MA0%03d;", clamped)
+        return encode(KC_CAT_MA0, clamped)
     }
 
     static func setMemoryChannelDirectWriteFrequencyHz(_ hz: Int, mode: OperatingMode, fmNarrow: Bool) -> String {
@@ -283,7 +290,7 @@ enum KenwoodCAT {
         // Format: MA1 + P1(11 digits Hz) + P2(mode) + P3(FM narrow) + ;
         let clamped = max(0, min(hz, 99_999_999_999))
         let narrow = fmNarrow ? 1 : 0
-        return String(format: "MA1%011d%01d%01d;", clamped, mode.rawValue, narrow)
+        return encode(KC_CAT_MA1, clamped, mode.rawValue, narrow)
     }
 
     static func setMemoryChannelName(_ channel: Int, name: String) -> String {
@@ -306,19 +313,18 @@ enum KenwoodCAT {
     //   RX EQ: 060 = Low gain, 061 = Mid gain, 062 = High gain  (-20…+10 dB)
 
     static func getMenuValue(_ menuNumber: Int) -> String {
-        String(format: "EX%03d;", menuNumber)
+        encode(KC_CAT_EX, menuNumber)
     }
 
     /// Set a plain-integer menu value (e.g. NB level 0-10, TX bandwidth, etc.)
     static func setMenuValue(_ menuNumber: Int, value: Int) -> String {
-        String(format: "EX%03d%d;", menuNumber, value)
+        encode(KC_CAT_EX, menuNumber, value)
     }
 
     /// Set a signed dB EQ gain (−20…+10). Uses explicit +/- sign per TS-890S protocol.
     static func setEQGain(_ menuNumber: Int, dB: Int) -> String {
         let clamped = max(-20, min(dB, 10))
-        let sign = clamped >= 0 ? "+" : "-"
-        return String(format: "EX%03d%@%02d;", menuNumber, sign, abs(clamped))
+        return encode(KC_CAT_EX_SIGNED, menuNumber, clamped)
     }
 
     // MARK: - TX EQ convenience (menu 030–032)
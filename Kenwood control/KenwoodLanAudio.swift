@@ -63,8 +63,10 @@ final class KenwoodLanAudioReceiver {
     var onLog: ((String) -> Void)?
     var onError: ((String) -> Void)?
 
-    // Output is always 48 kHz mono float.
-    var onAudio48kMono: (([Float]) -> Void)?
+    // Output is always 48 kHz mono float. The buffer is the receiver's own scratch and is only
+    // valid during the call; the callback runs inside a real-time section (kc_rt_guard) and
+    // must not allocate.
+    var onAudio48kMono: ((UnsafeBufferPointer<Float>) -> Void)?
     // Per-packet diagnostics (seq/ssrc/payload bytes).
     var onPacket: ((UInt16, UInt32, Int) -> Void)?
 
@@ -76,14 +78,48 @@ final class KenwoodLanAudioReceiver {
     private var expectedHostPort: UInt16 = 60001
     private var destAddr: sockaddr_in?
 
-    // TX (microphone) state. TS-Control captures show PC->radio UDP comes from port 60001 with RTP PT=96,
-    // timestamp=0, and SSRC="890\0".
-    private var txSeq: UInt16 = 0
+    // TX (microphone). TS-Control captures show PC->radio UDP comes from port 60001 with RTP PT=96,
+    // timestamp=0, and SSRC="890\0". kc_tx builds those packets and paces them from its own thread;
+    // it is created with the socket in start() and destroyed in stop().
     private let txSSRC: UInt32 = 0x38393000 // "890\0"
-    private var txPacketCount: Int = 0
+    private var micTx: OpaquePointer?
 
     private var pendingSample: Float?
-    private var lastSeq: UInt16?
+
+    // Packets are reordered and paced by the jitter buffer, then played out from `playoutTimer`
+    // (and after each socket drain) on `queue`. 640 bytes = one 20 ms PCM16 packet at 16 kHz.
+    private static let payloadBytes = 640
+    private let jitter: OpaquePointer? = kc_jitter_create(Int32(KenwoodLanAudioReceiver.payloadBytes),
+                                                          20_000_000, 2, 15)
+    private let jitterFrame = UnsafeMutableBufferPointer<UInt8>.allocate(capacity: KenwoodLanAudioReceiver.payloadBytes)
+    private var playoutTimer: DispatchSourceTimer?
+
+    // Batched socket reads with kernel arrival times (kc_udp_rx). Created per socket in start(),
+    // used and destroyed on `queue`.
+    private static let rxSlabPackets: Int32 = 32
+    private static let rxPacketBytes: Int32 = 2048
+    private var udpRx: OpaquePointer?
+
+    // Missing packets are concealed at 16 kHz, before the upsampler, so concealment and real
+    // audio share its interpolation state.
+    private static let samplesPerPacket16k = 320
+    private let plc: OpaquePointer? = kc_plc_create(16000, Int32(KenwoodLanAudioReceiver.samplesPerPacket16k))
+
+    // Receive-path buffers, allocated once so drain() never allocates.
+    // 960 = one 20 ms packet at 48 kHz: the held sample plus 319 interpolated triplets.
+    private static let samplesPerPacket48k = 960
+    private let frame16k = UnsafeMutableBufferPointer<Float>.allocate(capacity: KenwoodLanAudioReceiver.samplesPerPacket16k)
+    private let out48k = UnsafeMutableBufferPointer<Float>.allocate(capacity: KenwoodLanAudioReceiver.samplesPerPacket48k)
+
+    deinit {
+        playoutTimer?.cancel()
+        kc_udp_rx_destroy(udpRx)
+        kc_jitter_destroy(jitter)
+        kc_plc_destroy(plc)
+        jitterFrame.deallocate()
+        frame16k.deallocate()
+        out48k.deallocate()
+    }
 
     func start(host: String, port: UInt16 = 60001) throws {
         stop()
@@ -94,8 +130,6 @@ final class KenwoodLanAudioReceiver {
         }
         expectedHostAddr = addr
         expectedHostPort = port
-        txSeq = UInt16.random(in: 0...UInt16.max)
-        txPacketCount = 0
         destAddr = {
             var sin = sockaddr_in()
             sin.sin_len = UInt8(MemoryLayout<sockaddr_in>.size)
@@ -136,6 +170,14 @@ final class KenwoodLanAudioReceiver {
             throw ReceiverError.nonBlockingFailed("fcntl(F_SETFL) failed: \(String(cString: strerror(errno)))")
         }
 
+        // Room for a few hundred ms of packets if the queue is held up, so a stall shows up as
+        // late packets rather than kernel drops.
+        var rcvbuf: Int32 = 256 * 1024
+        _ = setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, socklen_t(MemoryLayout<Int32>.size))
+        guard let rx = kc_udp_rx_create(fd, Self.rxSlabPackets, Self.rxPacketBytes) else {
+            throw ReceiverError.socketFailed("UDP receiver setup failed: \(String(cString: strerror(errno)))")
+        }
+
         let source = DispatchSource.makeReadSource(fileDescriptor: fd, queue: queue)
         source.setEventHandler { [weak self] in
             self?.drain()
@@ -146,10 +188,33 @@ final class KenwoodLanAudioReceiver {
             self.fd = -1
         }
         readSource = source
-        source.resume()
 
-        pendingSample = nil
-        lastSeq = nil
+        queue.sync {
+            udpRx = rx
+            pendingSample = nil
+            if let jitter { kc_jitter_reset(jitter) }
+            if let plc { kc_plc_reset(plc) }
+        }
+        // 5 ms is a quarter packet: playout lands within a few ms of each frame's due time.
+        let timer = DispatchSource.makeTimerSource(flags: .strict, queue: queue)
+        timer.schedule(deadline: .now(), repeating: .milliseconds(5), leeway: .milliseconds(1))
+        timer.setEventHandler { [weak self] in
+            kc_rt_guard_enter()
+            defer { kc_rt_guard_leave() }
+            self?.playOut(now: DispatchTime.now().uptimeNanoseconds)
+        }
+        playoutTimer = timer
+
+        // Bound TX latency at 6 queued frames (120 ms), as the old send queue did.
+        var txDest = destAddr!
+        micTx = withUnsafePointer(to: &txDest) { ptr in
+            ptr.withMemoryRebound(to: sockaddr.self, capacity: 1) { sa in
+                kc_tx_create(fd, sa, socklen_t(MemoryLayout<sockaddr_in>.size), UInt16.random(in: 0...UInt16.max), 6)
+            }
+        }
+
+        source.resume()
+        timer.resume()
         onLog?("LAN audio receiver started on UDP \(port) for host \(host)")
         // Some implementations only start sending audio after they observe inbound UDP from the client.
         // Send a small "probe" datagram from our bound socket so the radio can learn/confirm our endpoint.
@@ -157,9 +222,14 @@ final class KenwoodLanAudioReceiver {
     }
 
     func stop() {
-        // Cancel the dispatch source first so no more read events fire.
+        // The TX thread sends on `fd`, so it goes first.
+        kc_tx_destroy(micTx)
+        micTx = nil
+        // Cancel the dispatch sources first so no more read or playout events fire.
         readSource?.cancel()
         readSource = nil
+        playoutTimer?.cancel()
+        playoutTimer = nil
         // Close the file descriptor synchronously so the OS releases the port
         // immediately, before the dispatch source's async cancel handler runs.
         // The cancel handler already guards with `if self.fd >= 0`, so it will
@@ -170,158 +240,188 @@ final class KenwoodLanAudioReceiver {
         }
         expectedHostAddr = nil
         destAddr = nil
-        pendingSample = nil
-        lastSeq = nil
+        queue.sync {
+            kc_udp_rx_destroy(udpRx)
+            udpRx = nil
+            pendingSample = nil
+            if let jitter { kc_jitter_reset(jitter) }
+            if let plc { kc_plc_reset(plc) }
+        }
     }
 
-    /// Send one 20 ms microphone frame (16 kHz mono PCM16, 320 samples) to the radio.
-    /// Uses the same bound socket as the receiver, so the source port is 60001.
-    func sendMicFramePCM16(_ samples: UnsafePointer<Int16>, count: Int) {
-        guard count == 320 else { return }
-        guard fd >= 0, var destAddr else { return }
-
-        var packet = [UInt8](repeating: 0, count: 12 + 640)
-        packet[0] = 0x80 // V=2
-        packet[1] = 0x60 // PT=96
-        packet[2] = UInt8((txSeq >> 8) & 0xFF)
-        packet[3] = UInt8(txSeq & 0xFF)
-        // timestamp stays 0 in observed TS-Control traffic
-        packet[8] = UInt8((txSSRC >> 24) & 0xFF)
-        packet[9] = UInt8((txSSRC >> 16) & 0xFF)
-        packet[10] = UInt8((txSSRC >> 8) & 0xFF)
-        packet[11] = UInt8(txSSRC & 0xFF)
-
-        for i in 0..<320 {
-            let v = UInt16(bitPattern: samples[i])
-            packet[12 + i * 2] = UInt8(v & 0xFF)
-            packet[12 + i * 2 + 1] = UInt8((v >> 8) & 0xFF)
-        }
+    /// Jitter buffer depth and packet counters. Safe from any thread.
+    func jitterStats() -> kc_jitter_stats {
+        var stats = kc_jitter_stats()
+        if let jitter { kc_jitter_read_stats(jitter, &stats) }
+        return stats
+    }
 
-        let sent: Int = packet.withUnsafeBytes { raw in
-            let base = raw.baseAddress!.assumingMemoryBound(to: UInt8.self)
-            return withUnsafePointer(to: &destAddr) { ptr in
-                ptr.withMemoryRebound(to: sockaddr.self, capacity: 1) { sa in
-                    sendto(fd, base, raw.count, 0, sa, socklen_t(MemoryLayout<sockaddr_in>.size))
-                }
-            }
+    /// Socket-level counters: batching, truncated datagrams and kernel drops. Safe from any thread
+    /// while running; zeros when stopped.
+    func socketStats() -> kc_udp_rx_stats {
+        var stats = kc_udp_rx_stats()
+        queue.sync {
+            if let udpRx { kc_udp_rx_read_stats(udpRx, &stats) }
         }
-        if sent < 0 {
-            onError?("Mic send failed: \(String(cString: strerror(errno)))")
-        }
-        txPacketCount += 1
-        if txPacketCount == 1 {
-            onLog?("LAN mic: first frame sent seq=\(txSeq)")
+        return stats
+    }
+
+    // MARK: Mic TX
+
+    /// Starts or stops the paced sender thread. Frames queued while it is stopped are kept.
+    func startMicTx() {
+        guard let micTx else { return }
+        if kc_tx_start(micTx) != 0 {
+            onError?("Mic TX thread could not be started")
         }
-        txSeq &+= 1
+    }
+
+    func stopMicTx() {
+        if let micTx { kc_tx_stop(micTx) }
+    }
+
+    /// While keyed, one packet goes out every 20 ms: a queued frame, else the tone, else silence.
+    func setMicTxKeyed(_ keyed: Bool) {
+        if let micTx { kc_tx_set_keyed(micTx, keyed ? 1 : 0) }
+    }
+
+    /// Queue one 20 ms microphone frame (16 kHz mono PCM16, 320 samples) for the radio. Called from
+    /// one thread (the capture callback); doesn't allocate or block. Stop the capture before stop().
+    func queueMicFrame(_ samples: UnsafePointer<Int16>) {
+        guard let micTx else { return }
+        kc_tx_push(micTx, samples)
+    }
+
+    /// Generated TX: a tone for `frames` packets, sent while no mic frames are queued.
+    func sendTone(hz: Double, amplitude: Double, frames: Int) {
+        if let micTx { kc_tx_tone(micTx, hz, amplitude, Int32(clamping: frames)) }
+    }
+
+    /// Drops queued mic frames and any tone.
+    func clearMicTx() {
+        if let micTx { kc_tx_clear(micTx) }
+    }
+
+    /// Sender counters: packets, silence, late sends, drops. Zeros when stopped.
+    func micTxStats() -> kc_tx_stats {
+        var stats = kc_tx_stats()
+        if let micTx { kc_tx_read_stats(micTx, &stats) }
+        return stats
     }
 
     private func drain() {
-        var buffer = [UInt8](repeating: 0, count: 4096)
+        kc_rt_guard_enter()
+        defer { kc_rt_guard_leave() }
+        let drainStart = kc_stats_begin()
+        defer { kc_stats_end(KC_STATS_RX_DRAIN, drainStart) }
+        guard let udpRx else { return }
+        var packets: UnsafePointer<kc_udp_packet>?
         while true {
-            var from = sockaddr_in()
-            var fromLen: socklen_t = socklen_t(MemoryLayout<sockaddr_in>.size)
-            let n: Int = buffer.withUnsafeMutableBytes { raw in
-                let base = raw.baseAddress!.assumingMemoryBound(to: UInt8.self)
-                return withUnsafeMutablePointer(to: &from) { fromPtr in
-                    fromPtr.withMemoryRebound(to: sockaddr.self, capacity: 1) { sa in
-                        recvfrom(fd, base, raw.count, 0, sa, &fromLen)
-                    }
-                }
-            }
-
+            let n = kc_udp_rx_receive(udpRx, &packets)
             if n < 0 {
-                if errno == EWOULDBLOCK || errno == EAGAIN { break }
-                onError?("recvfrom() failed: \(String(cString: strerror(errno)))")
+                onError?("recvmsg() failed: \(String(cString: strerror(errno)))")
                 break
             }
-            if n == 0 { break }
-
-            if let expectedHostAddr, from.sin_addr.s_addr != expectedHostAddr.s_addr {
-                // Ignore stray packets.
-                continue
+            guard n > 0, let packets else { break }
+            for i in 0..<Int(n) {
+                let p = packets[i]
+                if let expectedHostAddr, p.fromAddr != expectedHostAddr.s_addr {
+                    // Ignore stray packets.
+                    continue
+                }
+                guard let data = p.data, p.length > 0 else { continue }
+                kc_capture_record(KC_CAPTURE_RTP_RX, p.arrivalNs, data, Int(p.length))
+                handlePacket(data, count: Int(p.length), arrivalNs: p.arrivalNs)
             }
-
-            handlePacket(buffer, count: n)
+            // A short batch emptied the socket; skip the EAGAIN round trip.
+            if n < Self.rxSlabPackets { break }
         }
+        playOut(now: DispatchTime.now().uptimeNanoseconds)
     }
 
-    private func handlePacket(_ bytes: [UInt8], count: Int) {
-        bytes.withUnsafeBufferPointer { buf in
-            guard let base = buf.baseAddress else { return }
-            guard let hdr = RTPHeader.parse(base, count: count) else { return }
-            // We expect dynamic PT 96 in observed captures; don't hard-fail on mismatch.
+    private func handlePacket(_ base: UnsafePointer<UInt8>, count: Int, arrivalNs: UInt64) {
+        guard let hdr = RTPHeader.parse(base, count: count) else { return }
+        // We expect dynamic PT 96 in observed captures; don't hard-fail on mismatch.
 
-            let payloadStart = hdr.headerLength
-            var payloadEnd = count
+        let payloadStart = hdr.headerLength
+        var payloadEnd = count
 
-            let padding = (base[0] & 0x20) != 0
-            if padding, payloadEnd > payloadStart {
-                let padLen = Int(base[payloadEnd - 1])
-                if padLen > 0, payloadEnd - padLen >= payloadStart {
-                    payloadEnd -= padLen
-                }
+        let padding = (base[0] & 0x20) != 0
+        if padding, payloadEnd > payloadStart {
+            let padLen = Int(base[payloadEnd - 1])
+            if padLen > 0, payloadEnd - padLen >= payloadStart {
+                payloadEnd -= padLen
             }
+        }
 
-            let payloadLen = payloadEnd - payloadStart
-            // Observed: 640 bytes of PCM16 in 20 ms frames (16 kHz * 0.02 s * 2 bytes = 640).
-            guard payloadLen >= 640 else { return }
-
-            onPacket?(hdr.sequenceNumber, hdr.ssrc, payloadLen)
-
-            // Packet loss concealment: if seq jumps, insert silence for each missing packet.
-            if let lastSeq {
-                let expected = lastSeq &+ 1
-                if hdr.sequenceNumber != expected {
-                    let delta = Int(hdr.sequenceNumber &- expected)
-                    // Clamp to avoid runaway on wrap/large jumps.
-                    let missing = max(0, min(delta, 10))
-                    if missing > 0 {
-                        // Each missing packet is ~20 ms => ~960 samples at 48k after upsample.
-                        for _ in 0..<missing {
-                            onAudio48kMono?(Array(repeating: 0, count: 960))
-                        }
-                    }
-                }
-            }
-            lastSeq = hdr.sequenceNumber
-
-            // Decode little-endian signed 16-bit PCM -> float [-1, 1]
-            let sampleCount16k = 320
-            var samples16k = [Float](repeating: 0, count: sampleCount16k)
-            for i in 0..<sampleCount16k {
-                let lo = UInt16(base[payloadStart + i * 2])
-                let hi = UInt16(base[payloadStart + i * 2 + 1]) << 8
-                let u = lo | hi
-                let s = Int16(bitPattern: u)
-                samples16k[i] = Float(s) / 32768.0
-            }
+        let payloadLen = payloadEnd - payloadStart
+        // Observed: 640 bytes of PCM16 in 20 ms frames (16 kHz * 0.02 s * 2 bytes = 640).
+        guard payloadLen >= Self.payloadBytes, let jitter else { return }
 
-            // Upsample 16 kHz -> 48 kHz (factor 3) with linear interpolation between samples.
-            // We intentionally hold one sample between calls so the steady-state output is 960 samples/packet.
-            var out48k: [Float] = []
-            out48k.reserveCapacity(960)
+        onPacket?(hdr.sequenceNumber, hdr.ssrc, payloadLen)
+        kc_stats_count(KC_STATS_PACKETS, 1)
 
-            if let pending = pendingSample, let first = samples16k.first {
-                appendUpsampleTriplet(from: pending, to: first, into: &out48k)
-            }
-            if samples16k.count >= 2 {
-                for i in 0..<(samples16k.count - 1) {
-                    appendUpsampleTriplet(from: samples16k[i], to: samples16k[i + 1], into: &out48k)
-                }
-            }
-            pendingSample = samples16k.last
+        switch kc_jitter_put(jitter, hdr.sequenceNumber, arrivalNs, base + payloadStart) {
+        case KC_JITTER_LATE:
+            kc_stats_count(KC_STATS_LATE_PACKETS, 1)
+        case KC_JITTER_REORDERED:
+            kc_stats_count(KC_STATS_REORDERED, 1)
+        default:
+            break
+        }
+    }
 
-            if !out48k.isEmpty {
-                onAudio48kMono?(out48k)
+    /// Plays every frame the jitter buffer has due by `now`. Missing frames (lost, or late enough
+    /// that playout had to hold) are concealed by kc_plc.
+    private func playOut(now: UInt64) {
+        guard let jitter, let plc, let frame = jitterFrame.baseAddress, let pcm = frame16k.baseAddress else { return }
+        while true {
+            let r = kc_jitter_get(jitter, now, frame)
+            if r == KC_JITTER_FRAME {
+                let start = kc_stats_begin()
+                decode(UnsafePointer(frame), into: pcm)
+                kc_plc_good(plc, pcm)
+                upsampleAndEmit(start: start)
+            } else if r == KC_JITTER_LOST || r == KC_JITTER_UNDERRUN {
+                if r == KC_JITTER_LOST { kc_stats_count(KC_STATS_LOST_PACKETS, 1) }
+                kc_stats_count(KC_STATS_PLC_INSERTS, 1)
+                let start = kc_stats_begin()
+                kc_plc_conceal(plc, pcm)
+                upsampleAndEmit(start: start)
+            } else {
+                return
             }
         }
     }
 
-    private func appendUpsampleTriplet(from a: Float, to b: Float, into out: inout [Float]) {
-        out.append(a)
-        let d = b - a
-        out.append(a + d / 3.0)
-        out.append(a + 2.0 * d / 3.0)
+    /// Little-endian signed 16-bit PCM -> float [-1, 1].
+    private func decode(_ payload: UnsafePointer<UInt8>, into out: UnsafeMutablePointer<Float>) {
+        kc_pcm_s16le_to_f32(payload, out, Self.samplesPerPacket16k, 1.0 / 32768.0)
+    }
+
+    /// Upsamples `frame16k` 16 kHz -> 48 kHz (factor 3) with linear interpolation and emits it.
+    /// The rx_upsample stage runs from `start`, so it covers decode or concealment too.
+    /// We intentionally hold one sample between calls so the steady-state output is 960 samples/packet.
+    private func upsampleAndEmit(start: UInt64) {
+        var produced = 0
+        var previous = pendingSample
+        for i in 0..<Self.samplesPerPacket16k {
+            let sample = frame16k[i]
+            if let a = previous {
+                let d = sample - a
+                out48k[produced] = a
+                out48k[produced + 1] = a + d / 3.0
+                out48k[produced + 2] = a + 2.0 * d / 3.0
+                produced += 3
+            }
+            previous = sample
+        }
+        pendingSample = previous
+        kc_stats_end(KC_STATS_RX_UPSAMPLE, start)
+
+        if produced > 0 {
+            onAudio48kMono?(UnsafeBufferPointer(rebasing: out48k[0..<produced]))
+        }
     }
 
     private func sendProbe() {
@@ -32,6 +32,9 @@ final class KenwoodLanMicCapture {
     private var isRunning: Bool = false
     private var scratch: [Float] = Array(repeating: 0, count: 4096)
     private var pending16k: [Int16] = []
+    // One render's worth of 16 kHz samples, as float and then int16 (grown with `scratch`).
+    private var decimated: [Float] = Array(repeating: 0, count: 4096 / 3 + 1)
+    private var decimated16: [Int16] = Array(repeating: 0, count: 4096 / 3 + 1)
 
     // 48k -> 16k (factor 3) carry.
     private var carry0: Float = 0
@@ -180,21 +183,33 @@ final class KenwoodLanMicCapture {
     }
 
     private func consume48kMono(_ ptr: UnsafePointer<Float>, frames: Int) {
-        // 48k float -> 16k int16 by averaging each group of 3 samples.
-        for i in 0..<frames {
-            let x = ptr[i]
-            if carryCount == 0 {
-                carry0 = x; carryCount = 1
-            } else if carryCount == 1 {
-                carry1 = x; carryCount = 2
-            } else {
-                let y = (carry0 + carry1 + x) / 3.0
-                carryCount = 0
-
-                let scaled = Int((y * 32767.0).rounded())
-                let clamped = max(Int(Int16.min), min(Int(Int16.max), scaled))
-                pending16k.append(Int16(clamped))
+        // 48k float -> 16k by averaging each group of 3 samples, then to int16 in one pass.
+        if decimated.count < frames / 3 + 1 {
+            decimated = Array(repeating: 0, count: frames / 3 + 1)
+            decimated16 = Array(repeating: 0, count: frames / 3 + 1)
+        }
+        var n = 0
+        decimated.withUnsafeMutableBufferPointer { out in
+            for i in 0..<frames {
+                let x = ptr[i]
+                if carryCount == 0 {
+                    carry0 = x; carryCount = 1
+                } else if carryCount == 1 {
+                    carry1 = x; carryCount = 2
+                } else {
+                    out[n] = (carry0 + carry1 + x) / 3.0
+                    n += 1
+                    carryCount = 0
+                }
+            }
+        }
+        if n > 0 {
+            decimated.withUnsafeBufferPointer { src in
+                decimated16.withUnsafeMutableBufferPointer { dst in
+                    kc_pcm_f32_to_s16(src.baseAddress, dst.baseAddress, n, 32767.0, nil)
+                }
             }
+            pending16k.append(contentsOf: decimated16[0..<n])
         }
 
         // Emit 20 ms frames (320 @ 16k).
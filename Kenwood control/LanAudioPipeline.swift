@@ -1,43 +1,89 @@
 import Foundation
 
 /// Receives 48 kHz mono float, frames to RNNoise-sized chunks, processes, and emits.
+///
+/// Runs on the LAN receive queue inside a real-time section (kc_rt_guard), so every buffer is
+/// allocated in init and `process48kMono` never allocates.
 final class LanAudioPipeline {
     private let processor: any NoiseReductionProcessor
     private let frameSize: Int
-    private var buffer: [Float] = []
+    // Input not yet handed to the processor. A delivery larger than this is taken in pieces.
+    private var staging: [Float]
+    private var staged = 0
+    // Backlog path: up to `maxBatchFrames` whole frames go to the processor in one call so EMNR can
+    // batch its hops. One block per frame count (index = frames), since the processor reads the
+    // frame count from the array length.
+    private let maxBatchFrames = 8
+    private var wetBlocks: [[Float]]
 
     var wetDry: Float = 1.0
 
     init(processor: any NoiseReductionProcessor, frameSize: Int = 480) {
         self.processor = processor
         self.frameSize = frameSize
-        buffer.reserveCapacity(frameSize * 4)
+        self.staging = Array(repeating: 0, count: frameSize * maxBatchFrames)
+        self.wetBlocks = (0...maxBatchFrames).map { Array(repeating: 0, count: $0 * frameSize) }
     }
 
     func reset() {
-        buffer.removeAll(keepingCapacity: true)
+        staged = 0
     }
 
-    func process48kMono(_ samples: [Float], onOutput: ([Float]) -> Void) {
-        guard !samples.isEmpty else { return }
-        buffer.append(contentsOf: samples)
+    /// `onOutput` receives one or more whole frames; the buffer is only valid during the call.
+    func process48kMono(_ samples: UnsafeBufferPointer<Float>, onOutput: (UnsafeBufferPointer<Float>) -> Void) {
+        guard let src = samples.baseAddress else { return }
+        var consumed = 0
+        while consumed < samples.count {
+            let take = min(samples.count - consumed, staging.count - staged)
+            staging.withUnsafeMutableBufferPointer { buf in
+                buf.baseAddress!.advanced(by: staged).update(from: src.advanced(by: consumed), count: take)
+            }
+            staged += take
+            consumed += take
 
-        while buffer.count >= frameSize {
-            var frame = Array(buffer.prefix(frameSize))
-            buffer.removeFirst(frameSize)
+            let frames = staged / frameSize
+            guard frames > 0 else { continue }
+            processStaged(frames: frames, onOutput: onOutput)
 
-            let dry = frame
-            processor.processFrame48kMonoInPlace(&frame)
+            // Keep the partial frame; it is shorter than the frames just taken, so the ranges don't overlap.
+            let used = frames * frameSize
+            let rest = staged - used
+            if rest > 0 {
+                staging.withUnsafeMutableBufferPointer { buf in
+                    buf.baseAddress!.update(from: buf.baseAddress!.advanced(by: used), count: rest)
+                }
+            }
+            staged = rest
+        }
+    }
 
-            let mix = wetDry
-            if mix < 1 {
-                let inv = 1 - mix
-                for i in 0..<frameSize {
-                    frame[i] = dry[i] * inv + frame[i] * mix
+    private func processStaged(frames: Int, onOutput: (UnsafeBufferPointer<Float>) -> Void) {
+        let n = frames * frameSize
+        staging.withUnsafeBufferPointer { dry in
+            wetBlocks[frames].withUnsafeMutableBufferPointer { wet in
+                wet.baseAddress!.update(from: dry.baseAddress!, count: n)
+            }
+        }
+
+        let nrStart = kc_stats_begin()
+        if frames >= 2 {
+            processor.processFrames48kMonoInPlace(&wetBlocks[frames], frameSize: frameSize)
+        } else {
+            processor.processFrame48kMonoInPlace(&wetBlocks[frames])
+        }
+        kc_stats_end(KC_STATS_NR, nrStart)
+
+        let mix = wetDry
+        staging.withUnsafeBufferPointer { dry in
+            wetBlocks[frames].withUnsafeMutableBufferPointer { wet in
+                if mix < 1 {
+                    let inv = 1 - mix
+                    for i in 0..<n {
+                        wet[i] = dry[i] * inv + wet[i] * mix
+                    }
                 }
+                onOutput(UnsafeBufferPointer(wet))
             }
-            onOutput(frame)
         }
     }
 }
-
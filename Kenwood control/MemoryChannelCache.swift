@@ -0,0 +1,67 @@
+//
+//  MemoryChannelCache.swift
+//  Kenwood control
+//
+//  The memory browser's last-known channel table, saved per radio so it
+//  shows at once on the next connect. Channels programmed from the app are
+//  kept as "dirty" until the radio has been read back.
+//
+
+import Foundation
+
+struct MemoryChannelCache: Codable {
+    struct Entry: Codable {
+        var id: Int
+        var frequencyHz: Int
+        var mode: Int             // KenwoodCAT.OperatingMode raw value
+        var name: String
+        var isEmpty: Bool
+        var checksum: UInt32      // MemoryChannel.checksum when saved; a mismatch drops the entry
+    }
+
+    static let formatVersion = 1
+
+    var version: Int = MemoryChannelCache.formatVersion
+    var savedAt: Date = .distantPast
+    var verifiedAt: Date = .distantPast   // last full read of all 120 channels
+    var entries: [Entry] = []
+    var dirty: Set<Int> = []
+
+    var channels: [MemoryChannel] {
+        entries.compactMap { e in
+            let ch = MemoryChannel(id: e.id, frequencyHz: e.frequencyHz,
+                                   mode: KenwoodCAT.OperatingMode(rawValue: e.mode) ?? .usb,
+                                   name: e.name, isEmpty: e.isEmpty)
+            return ch.checksum == e.checksum ? ch : nil
+        }
+    }
+
+    mutating func store(_ channels: [MemoryChannel]) {
+        entries = channels.map {
+            Entry(id: $0.id, frequencyHz: $0.frequencyHz, mode: $0.mode.rawValue, name: $0.name,
+                  isEmpty: $0.isEmpty, checksum: $0.checksum)
+        }
+    }
+
+    private static func key(host: String) -> String {
+        "MemoryChannelCache." + host.lowercased()
+    }
+
+    /// The saved table for `host`; nil if there is none or it is from another format.
+    static func load(host: String) -> MemoryChannelCache? {
+        guard !host.isEmpty,
+              let data = UserDefaults.standard.data(forKey: key(host: host)),
+              let cache = try? JSONDecoder().decode(MemoryChannelCache.self, from: data),
+              cache.version == formatVersion else { return nil }
+        return cache
+    }
+
+    func save(host: String) {
+        guard !host.isEmpty else { return }
+        var copy = self
+        copy.savedAt = Date()
+        if let data = try? JSONEncoder().encode(copy) {
+            UserDefaults.standard.set(data, forKey: Self.key(host: host))
+        }
+    }
+}
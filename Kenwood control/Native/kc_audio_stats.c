@@ -0,0 +1,305 @@
+/*  kc_audio_stats.c
+ *
+ *  See kc_audio_stats.h. The region is one flat struct with no pointers, so
+ *  the same bytes work as private memory, a MAP_SHARED file written by the app
+ *  and a read-only mapping in kc-stats.
+ */
+
+#include "kc_audio_stats.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#endif
+
+#define KC_STATS_MAGIC   0x5453434bu     /* "KCST" */
+#define KC_STATS_VERSION 6u
+
+typedef struct kc_stats_slot {
+    _Alignas(64) _Atomic uint64_t count[KC_STATS_STAGE_COUNT];
+    _Atomic uint64_t sumNs[KC_STATS_STAGE_COUNT];
+    _Atomic uint64_t maxNs[KC_STATS_STAGE_COUNT];
+    _Atomic uint64_t bucket[KC_STATS_STAGE_COUNT][KC_STATS_BUCKETS];
+    _Atomic uint64_t counter[KC_STATS_COUNTER_COUNT];
+} kc_stats_slot;
+
+struct kc_stats {
+    _Atomic uint32_t magic;             /* written last when a file is created */
+    uint32_t version;
+    uint32_t stages, counters, buckets, threads;
+    _Atomic uint32_t slotsInUse;        /* bit per slot held by a live thread; never the last */
+    kc_stats_slot slot[KC_STATS_MAX_THREADS];
+};
+
+static struct kc_stats g_private = {
+    .magic = KC_STATS_MAGIC, .version = KC_STATS_VERSION,
+    .stages = KC_STATS_STAGE_COUNT, .counters = KC_STATS_COUNTER_COUNT,
+    .buckets = KC_STATS_BUCKETS, .threads = KC_STATS_MAX_THREADS
+};
+static _Atomic(struct kc_stats *) g_current = &g_private;
+
+/* The thread's slot lives in a pthread key rather than a _Thread_local: on Apple
+ * platforms the first touch of a thread-local variable mallocs, which the
+ * real-time allocation guard (kc_rt_guard) would report from every new audio thread. */
+static pthread_key_t  g_slotKey;
+static pthread_once_t g_slotKeyOnce = PTHREAD_ONCE_INIT;
+
+static const char *const kStageNames[KC_STATS_STAGE_COUNT] = {
+    "rx_drain", "rx_upsample", "nr", "fifo_write", "output_pull", "tx_send"
+};
+static const char *const kCounterNames[KC_STATS_COUNTER_COUNT] = {
+    "packets", "lost_packets", "late_packets", "reordered", "plc_inserts",
+    "fifo_drops", "underruns", "deadline_misses", "rt_allocs",
+    "kernel_drops", "tx_late", "tx_silence", "tx_drops"
+};
+
+const char *kc_stats_stage_name(kc_stats_stage stage) {
+    return (unsigned)stage < KC_STATS_STAGE_COUNT ? kStageNames[stage] : "?";
+}
+
+const char *kc_stats_counter_name(kc_stats_counter counter) {
+    return (unsigned)counter < KC_STATS_COUNTER_COUNT ? kCounterNames[counter] : "?";
+}
+
+/* ---- Clock ---- */
+
+uint64_t kc_stats_ticks(void) {
+#ifdef __APPLE__
+    return mach_absolute_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static uint64_t ticks_to_ns(uint64_t ticks) {
+#ifdef __APPLE__
+    /* Same values on every call, so a racing first use is harmless. */
+    static mach_timebase_info_data_t tb;
+    if (tb.denom == 0) mach_timebase_info(&tb);
+    return tb.numer == tb.denom ? ticks : ticks * tb.numer / tb.denom;
+#else
+    return ticks;
+#endif
+}
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ---- Histogram ---- */
+
+#define SUB (1u << KC_STATS_SUB_BITS)
+
+static int bucket_index(uint64_t ns) {
+    if (ns < SUB) return (int)ns;
+    int e = 63 - __builtin_clzll(ns);                                   /* >= KC_STATS_SUB_BITS */
+    int idx = (e - KC_STATS_SUB_BITS + 1) * (int)SUB + (int)((ns >> (e - KC_STATS_SUB_BITS)) & (SUB - 1));
+    return idx < KC_STATS_BUCKETS ? idx : KC_STATS_BUCKETS - 1;
+}
+
+static double bucket_lo(int idx) {
+    if (idx < (int)SUB) return idx;
+    int e = idx / (int)SUB + KC_STATS_SUB_BITS - 1, m = idx % (int)SUB;
+    return (double)((uint64_t)(SUB + m) << (e - KC_STATS_SUB_BITS));
+}
+
+static double bucket_hi(int idx) {
+    return idx + 1 < KC_STATS_BUCKETS ? bucket_lo(idx + 1) : bucket_lo(idx) * 2.0;
+}
+
+/* ---- Recording ---- */
+
+/* Slots a thread can have to itself; the last one is shared by any threads beyond them. */
+#define OWNED_SLOTS_MASK ((1u << (KC_STATS_MAX_THREADS - 1)) - 1)
+
+/* Key destructor: the thread is exiting. Its totals stay in the slot for the next thread to
+ * add to. A slot in a region that has since been replaced is left claimed; nothing new uses it. */
+static void release_slot(void *p) {
+    struct kc_stats *r = atomic_load_explicit(&g_current, memory_order_acquire);
+    kc_stats_slot *s = p;
+    if (s < r->slot || s >= r->slot + KC_STATS_MAX_THREADS - 1) return;
+    atomic_fetch_and_explicit(&r->slotsInUse, ~(1u << (uint32_t)(s - r->slot)), memory_order_relaxed);
+}
+
+static void make_slot_key(void) {
+    pthread_key_create(&g_slotKey, release_slot);
+}
+
+static kc_stats_slot *claim_slot(struct kc_stats *r) {
+    uint32_t used = atomic_load_explicit(&r->slotsInUse, memory_order_relaxed);
+    for (;;) {
+        uint32_t free = ~used & OWNED_SLOTS_MASK;
+        if (free == 0) return &r->slot[KC_STATS_MAX_THREADS - 1];
+        uint32_t bit = free & -free;
+        if (atomic_compare_exchange_weak_explicit(&r->slotsInUse, &used, used | bit,
+                                                  memory_order_relaxed, memory_order_relaxed))
+            return &r->slot[__builtin_ctz(bit)];
+    }
+}
+
+static kc_stats_slot *my_slot(void) {
+    pthread_once(&g_slotKeyOnce, make_slot_key);
+    struct kc_stats *r = atomic_load_explicit(&g_current, memory_order_acquire);
+    kc_stats_slot *s = pthread_getspecific(g_slotKey);
+    if (s < r->slot || s >= r->slot + KC_STATS_MAX_THREADS) {      /* first use, or the region moved */
+        s = claim_slot(r);
+        pthread_setspecific(g_slotKey, s);
+    }
+    return s;
+}
+
+void kc_stats_record_ns(kc_stats_stage stage, uint64_t ns) {
+    if ((unsigned)stage >= KC_STATS_STAGE_COUNT) return;
+    kc_stats_slot *s = my_slot();
+    atomic_fetch_add_explicit(&s->count[stage], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->sumNs[stage], ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&s->bucket[stage][bucket_index(ns)], 1, memory_order_relaxed);
+    uint64_t m = atomic_load_explicit(&s->maxNs[stage], memory_order_relaxed);
+    while (ns > m && !atomic_compare_exchange_weak_explicit(&s->maxNs[stage], &m, ns,
+                                                           memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+void kc_stats_end(kc_stats_stage stage, uint64_t begin) {
+    kc_stats_record_ns(stage, ticks_to_ns(kc_stats_ticks() - begin));
+}
+
+void kc_stats_count(kc_stats_counter counter, uint64_t n) {
+    if ((unsigned)counter >= KC_STATS_COUNTER_COUNT) return;
+    atomic_fetch_add_explicit(&my_slot()->counter[counter], n, memory_order_relaxed);
+}
+
+/* ---- Setup ---- */
+
+int kc_stats_open(const char *path) {
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, (off_t)sizeof(struct kc_stats)) != 0) {
+        close(fd);
+        return -1;
+    }
+    void *p = mmap(NULL, sizeof(struct kc_stats), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return -1;
+
+    /* The file is zero-filled; fill in the layout, then publish it with the magic. */
+    struct kc_stats *r = (struct kc_stats *)p;
+    r->version = KC_STATS_VERSION;
+    r->stages = KC_STATS_STAGE_COUNT;
+    r->counters = KC_STATS_COUNTER_COUNT;
+    r->buckets = KC_STATS_BUCKETS;
+    r->threads = KC_STATS_MAX_THREADS;
+    atomic_store_explicit(&r->magic, KC_STATS_MAGIC, memory_order_release);
+
+    /* The previous region stays mapped: another thread may still be writing to it. */
+    atomic_store_explicit(&g_current, r, memory_order_release);
+    return 0;
+}
+
+const kc_stats *kc_stats_current(void) {
+    return atomic_load_explicit(&g_current, memory_order_acquire);
+}
+
+kc_stats *kc_stats_attach(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != sizeof(struct kc_stats)) {
+        close(fd);
+        return NULL;
+    }
+    void *p = mmap(NULL, sizeof(struct kc_stats), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+
+    struct kc_stats *r = (struct kc_stats *)p;
+    if (atomic_load_explicit(&r->magic, memory_order_acquire) != KC_STATS_MAGIC ||
+        r->version != KC_STATS_VERSION || r->stages != KC_STATS_STAGE_COUNT ||
+        r->counters != KC_STATS_COUNTER_COUNT || r->buckets != KC_STATS_BUCKETS ||
+        r->threads != KC_STATS_MAX_THREADS) {
+        munmap(p, sizeof(struct kc_stats));
+        return NULL;
+    }
+    return r;
+}
+
+void kc_stats_detach(kc_stats *s) {
+    if (s && s != &g_private) munmap(s, sizeof(struct kc_stats));
+}
+
+/* ---- Reading ---- */
+
+int kc_stats_take(const kc_stats *s, kc_stats_snapshot *out) {
+    if (!s || atomic_load_explicit(&((struct kc_stats *)s)->magic, memory_order_acquire) != KC_STATS_MAGIC)
+        return -1;
+    struct kc_stats *r = (struct kc_stats *)s;
+    memset(out, 0, sizeof(*out));
+    out->takenNs = monotonic_ns();
+    for (uint32_t t = 0; t < KC_STATS_MAX_THREADS; t++) {          /* unused slots are all zero */
+        kc_stats_slot *sl = &r->slot[t];
+        for (int st = 0; st < KC_STATS_STAGE_COUNT; st++) {
+            out->count[st] += atomic_load_explicit(&sl->count[st], memory_order_relaxed);
+            out->sumNs[st] += atomic_load_explicit(&sl->sumNs[st], memory_order_relaxed);
+            uint64_t m = atomic_load_explicit(&sl->maxNs[st], memory_order_relaxed);
+            if (m > out->maxNs[st]) out->maxNs[st] = m;
+            for (int b = 0; b < KC_STATS_BUCKETS; b++)
+                out->bucket[st][b] += atomic_load_explicit(&sl->bucket[st][b], memory_order_relaxed);
+        }
+        for (int c = 0; c < KC_STATS_COUNTER_COUNT; c++)
+            out->counter[c] += atomic_load_explicit(&sl->counter[c], memory_order_relaxed);
+    }
+    return 0;
+}
+
+static double percentile(const uint64_t *delta, uint64_t total, double q) {
+    uint64_t rank = (uint64_t)(q * (double)total);
+    if (rank >= total) rank = total - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < KC_STATS_BUCKETS; b++) {
+        seen += delta[b];
+        if (seen > rank) return 0.5 * (bucket_lo(b) + bucket_hi(b));
+    }
+    return bucket_lo(KC_STATS_BUCKETS - 1);
+}
+
+void kc_stats_summarize(const kc_stats_snapshot *cur, const kc_stats_snapshot *prev, kc_stats_summary *out) {
+    memset(out, 0, sizeof(*out));
+    out->seconds = prev && cur->takenNs > prev->takenNs ? (cur->takenNs - prev->takenNs) * 1e-9 : 0.0;
+
+    uint64_t delta[KC_STATS_BUCKETS];
+    for (int st = 0; st < KC_STATS_STAGE_COUNT; st++) {
+        kc_stats_stage_summary *s = &out->stage[st];
+        s->count = cur->count[st] - (prev ? prev->count[st] : 0);
+        if (out->seconds > 0.0) s->perSecond = s->count / out->seconds;
+        if (s->count == 0) continue;
+        s->meanNs = (double)(cur->sumNs[st] - (prev ? prev->sumNs[st] : 0)) / s->count;
+
+        int top = -1;
+        uint64_t total = 0;
+        for (int b = 0; b < KC_STATS_BUCKETS; b++) {
+            delta[b] = cur->bucket[st][b] - (prev ? prev->bucket[st][b] : 0);
+            total += delta[b];
+            if (delta[b]) top = b;
+        }
+        if (total == 0) continue;
+        s->p50Ns = percentile(delta, total, 0.50);
+        s->p99Ns = percentile(delta, total, 0.99);
+        s->maxNs = prev ? bucket_hi(top) : (double)cur->maxNs[st];
+        if (s->maxNs > (double)cur->maxNs[st]) s->maxNs = (double)cur->maxNs[st];
+    }
+    for (int c = 0; c < KC_STATS_COUNTER_COUNT; c++) {
+        out->counter[c] = cur->counter[c] - (prev ? prev->counter[c] : 0);
+        if (out->seconds > 0.0) out->counterPerSecond[c] = out->counter[c] / out->seconds;
+    }
+}
@@ -0,0 +1,125 @@
+/*  kc_audio_stats.h
+ *
+ *  Low-overhead timing histograms and event counters for the LAN RX audio path
+ *  (socket drain → decode/upsample → NR → FIFO write → CoreAudio pull) and
+ *  the paced mic TX sender.
+ *
+ *  Recording is lock-free and allocation-free: each thread gets its own slot
+ *  (per-stage log-linear histogram, sum, max, counters) on first use and
+ *  updates it with relaxed atomics. A thread's slot is freed when it exits and
+ *  the next new thread carries on adding to it, so short-lived workers don't
+ *  use the slots up. Threads beyond KC_STATS_MAX_THREADS - 1 alive at once
+ *  share the last slot, which stays correct because every update is an atomic
+ *  RMW.
+ *
+ *  The region can live in a shared file (kc_stats_open) so that the kc-stats
+ *  command-line tool can attach to a running app and read the same numbers
+ *  the UI shows. Without kc_stats_open, recording goes to a private region.
+ *
+ *  Timestamps are mach_absolute_time on Apple platforms and CLOCK_MONOTONIC
+ *  elsewhere; kc_stats_end converts to nanoseconds.
+ */
+
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    KC_STATS_RX_DRAIN,          /* one socket wakeup: every datagram read and handled */
+    KC_STATS_RX_UPSAMPLE,       /* one packet: PCM16 decode or concealment + 16 → 48 kHz */
+    KC_STATS_NR,                /* noise reduction on one delivery (LanAudioPipeline) */
+    KC_STATS_FIFO_WRITE,        /* one write into the output FIFO */
+    KC_STATS_OUTPUT_PULL,       /* one CoreAudio render callback */
+    KC_STATS_TX_SEND,           /* how late one mic packet went out against its 20 ms slot (kc_tx) */
+    KC_STATS_STAGE_COUNT
+} kc_stats_stage;
+
+typedef enum {
+    KC_STATS_PACKETS,           /* RTP packets accepted */
+    KC_STATS_LOST_PACKETS,      /* never arrived before their playout time */
+    KC_STATS_LATE_PACKETS,      /* arrived after their playout time (dropped by the jitter buffer) */
+    KC_STATS_REORDERED,         /* arrived out of order but in time */
+    KC_STATS_PLC_INSERTS,       /* packets' worth of concealment audio inserted */
+    KC_STATS_FIFO_DROPS,        /* samples dropped because the output FIFO was full */
+    KC_STATS_UNDERRUNS,         /* render callbacks that had to pad with silence */
+    KC_STATS_DEADLINE_MISSES,   /* NR frames that took longer than their own duration */
+    KC_STATS_RT_ALLOCS,         /* allocations caught on a real-time section (kc_rt_guard) */
+    KC_STATS_KERNEL_DROPS,      /* datagrams the kernel dropped before the socket was read (kc_udp_rx) */
+    KC_STATS_TX_LATE,           /* mic packets sent more than 5 ms after their slot */
+    KC_STATS_TX_SILENCE,        /* keyed mic slots with nothing queued: silence sent */
+    KC_STATS_TX_DROPS,          /* mic frames dropped to bound TX latency */
+    KC_STATS_COUNTER_COUNT
+} kc_stats_counter;
+
+#define KC_STATS_MAX_THREADS 16
+/* 8 buckets per power of two (≤ 12.5 % error), exact below 8 ns, up to 2^40 ns. */
+#define KC_STATS_SUB_BITS    3
+#define KC_STATS_BUCKETS     312
+
+/* ---- Recording (audio threads) ---- */
+
+uint64_t kc_stats_ticks(void);
+
+static inline uint64_t kc_stats_begin(void) { return kc_stats_ticks(); }
+
+/* Records the time since `begin` (from kc_stats_begin) under `stage`. */
+void kc_stats_end(kc_stats_stage stage, uint64_t begin);
+void kc_stats_record_ns(kc_stats_stage stage, uint64_t ns);
+void kc_stats_count(kc_stats_counter counter, uint64_t n);
+
+/* ---- Setup ---- */
+
+/* Create (or replace) `path` as a shared stats file and record into it from now on.
+ * Returns 0, or -1 (recording stays on the private region). Call once at startup. */
+int kc_stats_open(const char *path);
+
+typedef struct kc_stats kc_stats;
+
+/* The region this process records into. */
+const kc_stats *kc_stats_current(void);
+
+/* Read-only view of another process's stats file. NULL if missing or incompatible. */
+kc_stats *kc_stats_attach(const char *path);
+void      kc_stats_detach(kc_stats *s);
+
+/* ---- Reading ---- */
+
+typedef struct kc_stats_snapshot {
+    uint64_t takenNs;                                       /* CLOCK_MONOTONIC / uptime of the reader */
+    uint64_t count[KC_STATS_STAGE_COUNT];
+    uint64_t sumNs[KC_STATS_STAGE_COUNT];
+    uint64_t maxNs[KC_STATS_STAGE_COUNT];                   /* since the region was created */
+    uint64_t bucket[KC_STATS_STAGE_COUNT][KC_STATS_BUCKETS];
+    uint64_t counter[KC_STATS_COUNTER_COUNT];
+} kc_stats_snapshot;
+
+/* Sums every thread's slot. Lock-free; concurrent updates may land on either side. Returns 0 or -1. */
+int kc_stats_take(const kc_stats *s, kc_stats_snapshot *out);
+
+typedef struct kc_stats_stage_summary {
+    uint64_t count;
+    double   perSecond;
+    double   meanNs, p50Ns, p99Ns, maxNs;
+} kc_stats_stage_summary;
+
+typedef struct kc_stats_summary {
+    double                 seconds;                         /* interval covered (0 without prev) */
+    kc_stats_stage_summary stage[KC_STATS_STAGE_COUNT];
+    uint64_t               counter[KC_STATS_COUNTER_COUNT];
+    double                 counterPerSecond[KC_STATS_COUNTER_COUNT];
+} kc_stats_summary;
+
+/* Summary of what happened between prev and cur (prev NULL: since the region was created;
+ * rates are then 0). Percentiles are bucket midpoints. maxNs is exact without prev, and the
+ * top of the highest non-empty bucket with it. */
+void kc_stats_summarize(const kc_stats_snapshot *cur, const kc_stats_snapshot *prev, kc_stats_summary *out);
+
+const char *kc_stats_stage_name(kc_stats_stage stage);
+const char *kc_stats_counter_name(kc_stats_counter counter);
+
+#ifdef __cplusplus
+}
+#endif
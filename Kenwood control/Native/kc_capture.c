@@ -0,0 +1,343 @@
+/*  kc_capture.c
+ *
+ *  See kc_capture.h. The recorder is one process-wide state: `fill` is the
+ *  buffer records are appended to, the other one is either empty or owned by
+ *  the writer thread while it goes to disk.
+ */
+
+#include "kc_capture.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#endif
+
+#define MAGIC       "KCAP"
+#define VERSION     1u
+#define HEADER_LEN  24
+#define BUF_BYTES   (1u << 20)
+#define MAX_RECORD  (1u << 16)          /* larger records are dropped */
+#define FLUSH_SEC   2                   /* a partly filled buffer goes out after this long */
+
+static uint64_t now_ns(void) {
+#ifdef __APPLE__
+    static mach_timebase_info_data_t tb;
+    if (tb.denom == 0) mach_timebase_info(&tb);
+    uint64_t t = mach_absolute_time();
+    return tb.numer == tb.denom ? t : t * tb.numer / tb.denom;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void put_le32(uint8_t *p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static void put_le64(uint8_t *p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static uint32_t get_le32(const uint8_t *p) { uint32_t v = 0; for (int i = 3; i >= 0; i--) v = v << 8 | p[i]; return v; }
+static uint64_t get_le64(const uint8_t *p) { uint64_t v = 0; for (int i = 7; i >= 0; i--) v = v << 8 | p[i]; return v; }
+
+static size_t put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/* ---- Recording ---- */
+
+typedef struct capture_buf {
+    uint8_t *data;
+    size_t   used;
+} capture_buf;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+    pthread_t       writer;
+    int             fd;
+    capture_buf     buf[2];
+    int             fill;               /* index records go to */
+    int             pending;            /* the other buffer is waiting for the writer */
+    int             stopping;
+    uint64_t        startNs, lastNs;
+    atomic_int      active;
+    _Atomic uint64_t records, bytes, dropped;
+    atomic_int      writeError;
+} g_cap = { .lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER, .fd = -1 };
+
+static int write_all(int fd, const uint8_t *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+/* Writes each buffer handed over, and every FLUSH_SEC takes a partly filled one so a crash
+ * loses little. When stopping, takes the one being filled too. */
+static void *writer_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_cap.lock);
+    for (;;) {
+        while (!g_cap.pending && !g_cap.stopping) {
+            struct timeval tv;
+            gettimeofday(&tv, NULL);
+            struct timespec until = { .tv_sec = tv.tv_sec + FLUSH_SEC, .tv_nsec = tv.tv_usec * 1000 };
+            if (pthread_cond_timedwait(&g_cap.wake, &g_cap.lock, &until) == ETIMEDOUT &&
+                g_cap.buf[g_cap.fill].used > 0) {
+                g_cap.fill = 1 - g_cap.fill;
+                g_cap.pending = 1;
+            }
+        }
+        int last = !g_cap.pending;
+        if (last) g_cap.fill = 1 - g_cap.fill;
+        capture_buf *b = &g_cap.buf[1 - g_cap.fill];
+        pthread_mutex_unlock(&g_cap.lock);
+        if (b->used > 0 && write_all(g_cap.fd, b->data, b->used) != 0 && !atomic_load(&g_cap.writeError)) {
+            atomic_store(&g_cap.writeError, errno);
+            atomic_store(&g_cap.active, 0);
+        }
+        pthread_mutex_lock(&g_cap.lock);
+        b->used = 0;
+        g_cap.pending = 0;
+        if (last) break;
+    }
+    pthread_mutex_unlock(&g_cap.lock);
+    return NULL;
+}
+
+int kc_capture_start(const char *path) {
+    if (atomic_load(&g_cap.active) || g_cap.fd >= 0) {
+        errno = EBUSY;
+        return -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (!g_cap.buf[i].data) g_cap.buf[i].data = malloc(BUF_BYTES);
+        if (!g_cap.buf[i].data) {
+            errno = ENOMEM;
+            return -1;
+        }
+        g_cap.buf[i].used = 0;
+    }
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+
+    uint8_t h[HEADER_LEN];
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint64_t start = now_ns();
+    memcpy(h, MAGIC, 4);
+    put_le32(h + 4, VERSION);
+    put_le64(h + 8, start);
+    put_le64(h + 16, (uint64_t)tv.tv_sec * 1000000ull + (uint64_t)tv.tv_usec);
+    if (write_all(fd, h, sizeof h) != 0) {
+        int e = errno;
+        close(fd);
+        errno = e;
+        return -1;
+    }
+
+    g_cap.fd = fd;
+    g_cap.fill = 0;
+    g_cap.pending = 0;
+    g_cap.stopping = 0;
+    g_cap.startNs = g_cap.lastNs = start;
+    atomic_store(&g_cap.records, 0);
+    atomic_store(&g_cap.bytes, 0);
+    atomic_store(&g_cap.dropped, 0);
+    atomic_store(&g_cap.writeError, 0);
+    if (pthread_create(&g_cap.writer, NULL, writer_main, NULL) != 0) {
+        close(fd);
+        g_cap.fd = -1;
+        errno = EAGAIN;
+        return -1;
+    }
+    atomic_store(&g_cap.active, 1);
+
+    static int registered;
+    if (!registered) {
+        atexit(kc_capture_stop);
+        registered = 1;
+    }
+    return 0;
+}
+
+void kc_capture_stop(void) {
+    if (g_cap.fd < 0) return;
+    atomic_store(&g_cap.active, 0);
+    pthread_mutex_lock(&g_cap.lock);
+    g_cap.stopping = 1;
+    pthread_cond_signal(&g_cap.wake);
+    pthread_mutex_unlock(&g_cap.lock);
+    pthread_join(g_cap.writer, NULL);
+    close(g_cap.fd);
+    g_cap.fd = -1;
+}
+
+int kc_capture_active(void) {
+    return atomic_load_explicit(&g_cap.active, memory_order_relaxed);
+}
+
+uint64_t kc_capture_start_ns(void) {
+    return g_cap.startNs;
+}
+
+void kc_capture_record(kc_capture_kind kind, uint64_t timeNs, const void *data, size_t length) {
+    if (!atomic_load_explicit(&g_cap.active, memory_order_relaxed)) return;
+    if (length > MAX_RECORD) {
+        atomic_fetch_add_explicit(&g_cap.dropped, 1, memory_order_relaxed);
+        return;
+    }
+    if (timeNs == 0) timeNs = now_ns();
+
+    pthread_mutex_lock(&g_cap.lock);
+    capture_buf *b = &g_cap.buf[g_cap.fill];
+    size_t need = 1 + 10 + 10 + length;
+    if (b->used + need > BUF_BYTES) {
+        if (g_cap.pending) {
+            pthread_mutex_unlock(&g_cap.lock);
+            atomic_fetch_add_explicit(&g_cap.dropped, 1, memory_order_relaxed);
+            return;
+        }
+        g_cap.fill = 1 - g_cap.fill;
+        g_cap.pending = 1;
+        pthread_cond_signal(&g_cap.wake);
+        b = &g_cap.buf[g_cap.fill];
+    }
+    /* Records from different threads can arrive slightly out of time order; clamp to keep the
+     * deltas unsigned. */
+    uint64_t dt = timeNs > g_cap.lastNs ? timeNs - g_cap.lastNs : 0;
+    if (timeNs > g_cap.lastNs) g_cap.lastNs = timeNs;
+    uint8_t *p = b->data + b->used;
+    size_t n = 0;
+    p[n++] = (uint8_t)kind;
+    n += put_varint(p + n, dt);
+    n += put_varint(p + n, length);
+    memcpy(p + n, data, length);
+    b->used += n + length;
+    pthread_mutex_unlock(&g_cap.lock);
+
+    atomic_fetch_add_explicit(&g_cap.records, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_cap.bytes, n + length, memory_order_relaxed);
+}
+
+void kc_capture_read_stats(kc_capture_stats *out) {
+    out->records = atomic_load_explicit(&g_cap.records, memory_order_relaxed);
+    out->bytes = atomic_load_explicit(&g_cap.bytes, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&g_cap.dropped, memory_order_relaxed);
+    out->writeError = atomic_load_explicit(&g_cap.writeError, memory_order_relaxed);
+}
+
+/* ---- Reading ---- */
+
+struct kc_capture_reader {
+    uint8_t *data;
+    size_t   size, pos;
+    uint64_t wallStartUs;
+    uint64_t timeNs;
+};
+
+kc_capture_reader *kc_capture_reader_open(const char *path, char *err, size_t errSize) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        snprintf(err, errSize, "%s: %s", path, strerror(errno));
+        return NULL;
+    }
+    kc_capture_reader *r = calloc(1, sizeof *r);
+    struct stat st;
+    if (!r || fstat(fileno(f), &st) != 0 || !(r->data = malloc(st.st_size > 0 ? (size_t)st.st_size : 1))) {
+        snprintf(err, errSize, "%s: out of memory", path);
+        fclose(f);
+        free(r);
+        return NULL;
+    }
+    r->size = fread(r->data, 1, (size_t)st.st_size, f);
+    fclose(f);
+    if (r->size < HEADER_LEN || memcmp(r->data, MAGIC, 4) != 0) {
+        snprintf(err, errSize, "%s: not a capture file", path);
+        kc_capture_reader_close(r);
+        return NULL;
+    }
+    if (get_le32(r->data + 4) != VERSION) {
+        snprintf(err, errSize, "%s: capture version %u (this build reads %u)", path,
+                 get_le32(r->data + 4), VERSION);
+        kc_capture_reader_close(r);
+        return NULL;
+    }
+    r->wallStartUs = get_le64(r->data + 16);
+    kc_capture_reader_rewind(r);
+    return r;
+}
+
+void kc_capture_reader_close(kc_capture_reader *r) {
+    if (!r) return;
+    free(r->data);
+    free(r);
+}
+
+void kc_capture_reader_rewind(kc_capture_reader *r) {
+    r->pos = HEADER_LEN;
+    r->timeNs = 0;
+}
+
+uint64_t kc_capture_reader_wall_start_us(const kc_capture_reader *r) {
+    return r->wallStartUs;
+}
+
+static int get_varint(kc_capture_reader *r, uint64_t *out) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->size) return -1;
+        uint8_t b = r->data[r->pos++];
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int kc_capture_reader_next(kc_capture_reader *r, kc_capture_item *out) {
+    if (r->pos >= r->size) return 0;
+    uint8_t kind = r->data[r->pos++];
+    uint64_t dt, len;
+    if (kind < KC_CAPTURE_RTP_RX || kind > KC_CAPTURE_CAT_TX) return -1;
+    if (get_varint(r, &dt) != 0 || get_varint(r, &len) != 0 || len > r->size - r->pos) return -1;
+    r->timeNs += dt;
+    out->kind = (kc_capture_kind)kind;
+    out->timeNs = r->timeNs;
+    out->data = r->data + r->pos;
+    out->length = (uint32_t)len;
+    r->pos += len;
+    return 1;
+}
+
+const char *kc_capture_kind_name(kc_capture_kind kind) {
+    switch (kind) {
+    case KC_CAPTURE_RTP_RX: return "rtp_rx";
+    case KC_CAPTURE_RTP_TX: return "rtp_tx";
+    case KC_CAPTURE_CAT_RX: return "cat_rx";
+    case KC_CAPTURE_CAT_TX: return "cat_tx";
+    }
+    return "?";
+}
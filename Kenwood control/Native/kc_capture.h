@@ -0,0 +1,87 @@
+/*  kc_capture.h
+ *
+ *  Record the radio traffic (RTP audio both ways, CAT bytes both ways) to a
+ *  file, with timestamps, so field problems can be replayed later without
+ *  the radio (tools/replay, kc-replay).
+ *
+ *  File format, little-endian:
+ *
+ *    header   "KCAP"  u32 version (1)  u64 start time (ns, monotonic clock)
+ *             u64 wall-clock start (µs since the Unix epoch)
+ *    record   u8 kind   varint time since the previous record (ns)
+ *             varint length   `length` bytes
+ *
+ *  (varint: 7 bits per byte, least significant first, high bit = more.) A
+ *  20 ms RTP packet costs 7 bytes over its own size.
+ *
+ *  Recording: kc_capture_record copies into one of two preallocated 1 MB
+ *  buffers under a short lock; a writer thread writes full buffers out, and
+ *  a partly filled one every couple of seconds.
+ *  When both are full the record is dropped and counted, so a slow disk
+ *  never blocks the audio threads. Recording is off (a single atomic load)
+ *  until kc_capture_start.
+ *
+ *  Times are on the kc_audio_stats / kc_udp_rx clock (mach_absolute_time in
+ *  ns on Apple, CLOCK_MONOTONIC elsewhere); pass 0 for "now".
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    KC_CAPTURE_RTP_RX = 1,      /* datagram from the radio (whole packet) */
+    KC_CAPTURE_RTP_TX = 2,      /* mic datagram to the radio */
+    KC_CAPTURE_CAT_RX = 3,      /* CAT bytes as received, not split into frames */
+    KC_CAPTURE_CAT_TX = 4       /* CAT bytes as sent (credentials redacted by the caller) */
+} kc_capture_kind;
+
+/* ---- Recording (process-wide) ---- */
+
+/* Creates `path` and starts recording. Returns 0, or -1 (errno set; recording stays off). */
+int  kc_capture_start(const char *path);
+/* Writes out what is buffered and closes the file. Also runs at exit. */
+void kc_capture_stop(void);
+int  kc_capture_active(void);
+/* The recording's time origin, on the same clock (for records written with explicit times). */
+uint64_t kc_capture_start_ns(void);
+
+void kc_capture_record(kc_capture_kind kind, uint64_t timeNs, const void *data, size_t length);
+
+typedef struct kc_capture_stats {
+    uint64_t records, bytes;    /* written to the file so far, or buffered */
+    uint64_t dropped;           /* records lost because both buffers were full */
+    int      writeError;        /* errno of the first failed write (recording stops), else 0 */
+} kc_capture_stats;
+
+void kc_capture_read_stats(kc_capture_stats *out);
+
+/* ---- Reading (tools) ---- */
+
+typedef struct kc_capture_reader kc_capture_reader;
+
+typedef struct kc_capture_item {
+    kc_capture_kind kind;
+    uint64_t        timeNs;     /* since the recording started */
+    const uint8_t  *data;       /* valid until the reader is closed */
+    uint32_t        length;
+} kc_capture_item;
+
+/* Loads the whole file. NULL with a message in err (errSize bytes). */
+kc_capture_reader *kc_capture_reader_open(const char *path, char *err, size_t errSize);
+void               kc_capture_reader_close(kc_capture_reader *r);
+
+/* 1 and the next record, 0 at the end, -1 if the file is cut off or corrupt there. */
+int  kc_capture_reader_next(kc_capture_reader *r, kc_capture_item *out);
+void kc_capture_reader_rewind(kc_capture_reader *r);
+uint64_t kc_capture_reader_wall_start_us(const kc_capture_reader *r);
+
+const char *kc_capture_kind_name(kc_capture_kind kind);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,232 @@
+/*  kc_cat_codec.c
+ *
+ *  See kc_cat_codec.h. The dispatch tables are designated initializers
+ *  generated from the spec, so they are built by the compiler and a
+ *  duplicate letter pair is an "initialized field overwritten" warning.
+ */
+
+#include "kc_cat_codec.h"
+
+#include <string.h>
+
+typedef struct command {
+    const char *prefix;
+    const char *layout;
+    uint8_t     prefixLength;
+} command;
+
+/* A CMD or EXT id is its two letters. */
+#define DEF_CMD(id, c0, c1, layout)     [KC_CAT_##id] = { #id, layout, 2 },
+#define DEF_EXT(id, c0, c1, layout)     [KC_CAT_##id] = { "##" #id, layout, 4 },
+#define DEF_SET(id, prefix, layout)     [KC_CAT_##id] = { prefix, layout, sizeof(prefix) - 1 },
+
+static const command kCommands[KC_CAT_COMMAND_COUNT] = {
+    [KC_CAT_UNKNOWN] = { "", "", 0 },
+    KC_CAT_SPEC(DEF_CMD, DEF_EXT, DEF_SET)
+};
+
+/* Letter pair -> command. Names are two capitals, so 26 * 26 slots and no collisions. */
+#define KEY(c0, c1)                     (((c0) - 'A') * 26 + ((c1) - 'A'))
+#define SLOT(id, c0, c1, layout)        [KEY(c0, c1)] = KC_CAT_##id,
+#define SKIP4(id, c0, c1, layout)
+#define SKIP3(id, prefix, layout)
+
+static const uint8_t kPlain[26 * 26] = { KC_CAT_SPEC(SLOT, SKIP4, SKIP3) };
+static const uint8_t kExtended[26 * 26] = { KC_CAT_SPEC(SKIP4, SLOT, SKIP3) };
+
+_Static_assert(KC_CAT_COMMAND_COUNT <= 256, "dispatch tables hold a byte");
+
+static int is_space(char c) {
+    return (unsigned char)c <= 0x20 || c == 0x7f;
+}
+
+static int is_upper(char c) {
+    return c >= 'A' && c <= 'Z';
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/* A field's letter and width, advancing *layout past them and any spaces. */
+static char next_field(const char **layout, int *width) {
+    const char *l = *layout;
+    while (*l == ' ') l++;
+    char kind = *l;
+    if (kind) l++;
+    int w = 0;
+    while (*l >= '0' && *l <= '9') w = w * 10 + (*l++ - '0');
+    *width = w;
+    *layout = l;
+    return kind;
+}
+
+/* Up to `width` characters: leading spaces, then digits. Returns the digit count. */
+static int parse_digits(const char *p, const char *end, int width, int64_t *value, const char **stop) {
+    const char *limit = end - p > width ? p + width : end;
+    while (p < limit && *p == ' ') p++;
+    int64_t v = 0;
+    int digits = 0;
+    for (; p < limit && *p >= '0' && *p <= '9'; p++, digits++) v = v * 10 + (*p - '0');
+    *value = v;
+    *stop = p;
+    return digits;
+}
+
+static void trim_text(kc_cat_msg *m, const char *p, const char *end) {
+    while (p < end && *p == ' ') p++;
+    while (end > p && end[-1] == ' ') end--;
+    m->text = p;
+    m->textLength = (int)(end - p);
+}
+
+int kc_cat_decode(const char *frame, size_t length, kc_cat_msg *out) {
+    const char *p = frame, *end = frame + length;
+    while (p < end && is_space(*p)) p++;
+    while (end > p && is_space(end[-1])) end--;
+    if (end > p && end[-1] == ';') end--;
+
+    memset(out, 0, sizeof *out);
+    if (end - p >= 4 && p[0] == '#' && p[1] == '#' && is_upper(p[2]) && is_upper(p[3])) {
+        out->cmd = (kc_cat_cmd)kExtended[KEY(p[2], p[3])];
+        p += 4;
+    } else if (end - p >= 2 && is_upper(p[0]) && is_upper(p[1])) {
+        out->cmd = (kc_cat_cmd)kPlain[KEY(p[0], p[1])];
+        p += 2;
+    }
+    if (out->cmd == KC_CAT_UNKNOWN) return 0;
+
+    const char *layout = kCommands[out->cmd].layout;
+    int width, slot = 0;
+    for (char kind; (kind = next_field(&layout, &width)) != 0 && p < end;) {
+        if (slot == KC_CAT_MAX_FIELDS) break;
+        int ok = 0;
+        int64_t v = 0;
+        const char *stop = p;
+        switch (kind) {
+        case 'D':
+            ok = *p >= '0' && *p <= '9';
+            v = *p - '0';
+            stop = p + 1;
+            break;
+        case 'H':
+            v = hex_value(*p);
+            ok = v >= 0;
+            stop = p + 1;
+            break;
+        case 'U':
+            ok = parse_digits(p, end, width, &v, &stop) > 0;
+            if (!ok) stop = end - p > width ? p + width : end;
+            break;
+        case 'S': {
+            int negative = *p == '-';
+            ok = parse_digits(p + 1, end, width, &v, &stop) > 0;
+            if (!ok) stop = end - p > width + 1 ? p + width + 1 : end;
+            if (negative) v = -v;
+            break;
+        }
+        case 'V': {
+            int negative = *p == '-';
+            const char *q = p + (*p == '-' || *p == '+');
+            ok = q < end && *q != ' ' && parse_digits(q, end, (int)(end - q), &v, &stop) > 0;
+            if (negative) v = -v;
+            if (!ok) stop = p;
+            break;
+        }
+        case 'R': {
+            const char *from = end - p > width ? end - width : p;
+            trim_text(out, from, end);
+            stop = end;
+            ok = 1;
+            break;
+        }
+        default:
+            return 0;                   /* a bad layout in the spec */
+        }
+        out->v[slot] = ok ? v : 0;
+        if (ok) out->valid |= 1u << slot;
+        slot++;
+        if (kind == 'V' && !ok) break;  /* variable width: nothing to step over */
+        p = stop;
+    }
+    out->count = slot;
+    out->rest = (int)(end - p);
+    return 1;
+}
+
+static int put_number(char **q, char *end, int64_t v, int width) {
+    if (v < 0 || end - *q < width) return 0;
+    for (int i = width - 1; i >= 0; i--) {
+        (*q)[i] = (char)('0' + v % 10);
+        v /= 10;
+    }
+    if (v != 0) return 0;               /* doesn't fit */
+    *q += width;
+    return 1;
+}
+
+static int put_text(char **q, char *end, const char *text, size_t length, int width) {
+    if (end - *q < width) return 0;
+    for (int i = 0; i < width; i++) {
+        char c = (size_t)i < length && text ? text[i] : ' ';
+        (*q)[i] = c == ';' ? ' ' : c;
+    }
+    *q += width;
+    return 1;
+}
+
+size_t kc_cat_encode(char *buf, size_t capacity, kc_cat_cmd cmd, const int64_t *values, int count,
+                     const char *text, size_t textLength) {
+    if (cmd <= KC_CAT_UNKNOWN || cmd >= KC_CAT_COMMAND_COUNT) return 0;
+    const command *c = &kCommands[cmd];
+    char *q = buf, *end = buf + capacity;
+    if ((size_t)(end - q) < c->prefixLength) return 0;
+    memcpy(q, c->prefix, c->prefixLength);
+    q += c->prefixLength;
+
+    if (count > 0) {
+        const char *layout = c->layout;
+        int width, slot = 0;
+        for (char kind; (kind = next_field(&layout, &width)) != 0;) {
+            if (slot == count) break;
+            int64_t v = values[slot++];
+            int ok;
+            switch (kind) {
+            case 'D': ok = v <= 9 && put_number(&q, end, v, 1); break;
+            case 'H':
+                ok = v >= 0 && v <= 15 && q < end;
+                if (ok) *q++ = "0123456789ABCDEF"[v];
+                break;
+            case 'U': ok = put_number(&q, end, v, width); break;
+            case 'S':
+                ok = q < end;
+                if (ok) *q++ = v < 0 ? '-' : '+';
+                ok = ok && put_number(&q, end, v < 0 ? -v : v, width);
+                break;
+            case 'V': {
+                char digits[24];
+                int n = 0;
+                uint64_t u = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;
+                do digits[n++] = (char)('0' + u % 10); while ((u /= 10) != 0);
+                if (v < 0) digits[n++] = '-';
+                ok = end - q >= n;
+                for (int i = n - 1; ok && i >= 0; i--) *q++ = digits[i];
+                break;
+            }
+            case 'R': ok = put_text(&q, end, text, textLength, width); break;
+            default: ok = 0; break;
+            }
+            if (!ok) return 0;
+        }
+    }
+    if (q == end) return 0;
+    *q++ = ';';
+    return (size_t)(q - buf);
+}
+
+const char *kc_cat_name(kc_cat_cmd cmd) {
+    return cmd > KC_CAT_UNKNOWN && cmd < KC_CAT_COMMAND_COUNT ? kCommands[cmd].prefix : "";
+}
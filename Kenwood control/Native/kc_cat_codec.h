@@ -0,0 +1,75 @@
+/*  kc_cat_codec.h
+ *
+ *  Table-driven CAT decoding and encoding, built from kc_cat_spec.h.
+ *
+ *  kc_cat_decode finds the command from its first two letters (or the two
+ *  after "##") with one lookup in a table indexed by the letter pair, a
+ *  perfect hash the compiler lays out from the spec. It then walks the
+ *  command's layout and parses the fields straight from the frame: no
+ *  allocation, no copies, integers only. Text fields point into the frame.
+ *
+ *  Every field has a slot in `v`, in layout order. `count` is how
+ *  many fields the frame reached (callers check it the way they used to
+ *  check the frame length) and `valid` which of those parsed. A
+ *  fixed-width field that doesn't parse, such as a blank frequency, is
+ *  stepped over, so the fields after it still line up.
+ *
+ *  kc_cat_encode formats a command from the same layouts into the caller's
+ *  buffer, with the ';'.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kc_cat_spec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KC_CAT_ENUM_CMD(id, c0, c1, layout)  KC_CAT_##id,
+#define KC_CAT_ENUM_SET(id, prefix, layout)  KC_CAT_##id,
+
+typedef enum {
+    KC_CAT_UNKNOWN = 0,
+    KC_CAT_SPEC(KC_CAT_ENUM_CMD, KC_CAT_ENUM_CMD, KC_CAT_ENUM_SET)
+    KC_CAT_COMMAND_COUNT
+} kc_cat_cmd;
+
+#undef KC_CAT_ENUM_CMD
+#undef KC_CAT_ENUM_SET
+
+#define KC_CAT_MAX_FIELDS 8
+
+typedef struct kc_cat_msg {
+    kc_cat_cmd  cmd;                    /* KC_CAT_UNKNOWN: not in the spec, or not a frame */
+    int         count;                  /* fields the frame reached */
+    uint32_t    valid;                  /* bit i: v[i] (or the text) parsed */
+    int         rest;                   /* characters after the last field */
+    int64_t     v[KC_CAT_MAX_FIELDS];   /* numeric fields; a text field's slot holds 0 */
+    const char *text;                   /* the text field, spaces trimmed; points into the frame */
+    int         textLength;
+} kc_cat_msg;
+
+static inline int kc_cat_has(const kc_cat_msg *m, int field) {
+    return field < m->count && (m->valid >> field & 1u);
+}
+
+/* Decodes one frame, with or without its ';' (surrounding whitespace is ignored). Returns 1 for a
+ * command in the spec, 0 otherwise (out->cmd is then KC_CAT_UNKNOWN). */
+int kc_cat_decode(const char *frame, size_t length, kc_cat_msg *out);
+
+/* Formats `cmd` and its first `count` fields, then a ';'. Values are one per field slot as in
+ * kc_cat_msg; a text field takes `text` and ignores its value. Zero fields is the read form
+ * ("FA;"), one is a read with a parameter ("EX030;"). Returns the length written, without a NUL,
+ * or 0 if a value doesn't fit its field or the result doesn't fit `capacity`. */
+size_t kc_cat_encode(char *buf, size_t capacity, kc_cat_cmd cmd, const int64_t *values, int count,
+                     const char *text, size_t textLength);
+
+/* The command's prefix ("FA", "##KN", "MA1"), for logs and tools. "" for KC_CAT_UNKNOWN. */
+const char *kc_cat_name(kc_cat_cmd cmd);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,145 @@
+/*  kc_cat_framer.c
+ *
+ *  See kc_cat_framer.h. The scan for ';' is memchr, which libc vectorizes on
+ *  every platform the app runs on; the ASCII check reads eight bytes at a
+ *  time.
+ */
+
+#include "kc_cat_framer.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+struct kc_cat_framer {
+    char               *carry;          /* maxFrame bytes */
+    size_t              carryLen, maxFrame;
+    int                 discarding;     /* inside an oversized frame; skip to its ';' */
+    int                 carryReturned;  /* carry holds the frame last returned */
+    const char         *in;
+    size_t              inLen, pos;
+    kc_cat_framer_stats stats;
+};
+
+kc_cat_framer *kc_cat_framer_create(size_t maxFrame) {
+    if (maxFrame == 0) return NULL;
+    kc_cat_framer *f = calloc(1, sizeof *f);
+    if (!f) return NULL;
+    f->carry = malloc(maxFrame);
+    if (!f->carry) {
+        free(f);
+        return NULL;
+    }
+    f->maxFrame = maxFrame;
+    return f;
+}
+
+void kc_cat_framer_destroy(kc_cat_framer *f) {
+    if (!f) return;
+    free(f->carry);
+    free(f);
+}
+
+void kc_cat_framer_reset(kc_cat_framer *f) {
+    f->carryLen = 0;
+    f->discarding = 0;
+    f->carryReturned = 0;
+    f->in = NULL;
+    f->inLen = f->pos = 0;
+}
+
+static int is_space_or_control(unsigned char c) {
+    return c <= 0x20 || c == 0x7f;
+}
+
+static void carry_append(kc_cat_framer *f, const char *p, size_t n) {
+    /* A read that ends in the CR/LF after a ';' shouldn't push the next frame through the carry. */
+    if (f->carryLen == 0)
+        for (; n > 0 && is_space_or_control((unsigned char)*p); n--) p++;
+    if (f->discarding || n == 0) return;
+    if (f->carryLen + n > f->maxFrame) {
+        f->discarding = 1;
+        f->carryLen = 0;
+        return;
+    }
+    memcpy(f->carry + f->carryLen, p, n);
+    f->carryLen += n;
+}
+
+void kc_cat_framer_feed(kc_cat_framer *f, const void *data, size_t length) {
+    if (f->carryReturned) {
+        f->carryLen = 0;
+        f->carryReturned = 0;
+    }
+    f->in = data;
+    f->inLen = data ? length : 0;
+    f->pos = 0;
+    f->stats.bytes += f->inLen;
+}
+
+static int all_ascii(const char *p, size_t n) {
+    uint64_t acc = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, 8);
+        acc |= w;
+    }
+    for (; i < n; i++) acc |= (unsigned char)p[i];
+    return (acc & 0x8080808080808080ull) == 0;
+}
+
+int kc_cat_framer_next(kc_cat_framer *f, kc_cat_frame *out) {
+    if (f->carryReturned) {
+        f->carryLen = 0;
+        f->carryReturned = 0;
+    }
+    while (f->pos < f->inLen) {
+        const char *start = f->in + f->pos;
+        size_t avail = f->inLen - f->pos;
+        const char *semi = memchr(start, ';', avail);
+        if (!semi) {
+            carry_append(f, start, avail);
+            f->pos = f->inLen;
+            return 0;
+        }
+        size_t n = (size_t)(semi - start);
+        f->pos += n + 1;
+
+        /* Trim before checking the size, so the limit is on what would be returned. */
+        const char *p = start;
+        size_t len = n;
+        if (f->carryLen == 0)
+            for (; len > 0 && is_space_or_control((unsigned char)*p); len--) p++;
+        while (len > 0 && is_space_or_control((unsigned char)p[len - 1])) len--;
+        if (f->discarding || f->carryLen + len > f->maxFrame) {
+            f->discarding = 0;
+            f->carryLen = 0;
+            f->stats.oversized++;
+            continue;
+        }
+        if (f->carryLen > 0) {
+            memcpy(f->carry + f->carryLen, p, len);
+            p = f->carry;
+            len += f->carryLen;
+            while (len > 0 && is_space_or_control((unsigned char)p[len - 1])) len--;
+            f->carryReturned = 1;
+        }
+        if (len == 0) {
+            f->carryLen = 0;
+            f->carryReturned = 0;
+            continue;
+        }
+        if (f->carryReturned) f->stats.split++;
+        f->stats.frames++;
+        if (len > f->stats.longest) f->stats.longest = len;
+        out->data = p;
+        out->length = len;
+        out->ascii = all_ascii(p, len);
+        return 1;
+    }
+    return 0;
+}
+
+void kc_cat_framer_read_stats(const kc_cat_framer *f, kc_cat_framer_stats *out) {
+    *out = f->stats;
+}
@@ -0,0 +1,69 @@
+/*  kc_cat_framer.h
+ *
+ *  Splits the CAT byte stream from the radio into ';'-terminated frames.
+ *
+ *  The receive callback hands its bytes to kc_cat_framer_feed, then calls
+ *  kc_cat_framer_next until it returns 0. Frames that lie wholly inside
+ *  those bytes are returned in place, pointing into the caller's buffer, so
+ *  that buffer has to stay put until then. Only a frame split across reads
+ *  is copied: its start waits in the framer's carry buffer, and the rest is
+ *  appended when it arrives.
+ *
+ *  Each frame comes back without its ';' and with any whitespace and
+ *  control bytes around it (the CR/LF some bridges add) trimmed off by
+ *  moving the ends, as TS890Connection used to do with
+ *  trimmingCharacters. Empty frames are skipped. `ascii` says whether the
+ *  frame is 7-bit, so the caller can take the cheap decode and keep the
+ *  UTF-8 / Latin-1 fallback for the rest (Menu 9-01 makes 0x80..0xFF
+ *  keyboard-language dependent).
+ *
+ *  A frame longer than `maxFrame` is dropped whole and counted; the framer
+ *  picks up again after its ';'.
+ *
+ *  Not thread-safe; one receive path owns a framer.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct kc_cat_framer kc_cat_framer;
+
+typedef struct kc_cat_frame {
+    const char *data;           /* not NUL-terminated */
+    size_t      length;
+    int         ascii;          /* 1 if every byte is below 0x80 */
+} kc_cat_frame;
+
+/* NULL on allocation failure. */
+kc_cat_framer *kc_cat_framer_create(size_t maxFrame);
+void           kc_cat_framer_destroy(kc_cat_framer *f);
+
+/* Forgets a partial frame and any unread input (a new connection). */
+void kc_cat_framer_reset(kc_cat_framer *f);
+
+/* Sets the bytes the following kc_cat_framer_next calls read. Call next until it returns 0
+ * before feeding again; whatever was left unread is dropped. */
+void kc_cat_framer_feed(kc_cat_framer *f, const void *data, size_t length);
+
+/* The next complete frame, 1; or 0 once the fed bytes are used up (a trailing partial frame is
+ * then in the carry buffer). *out is valid until the next call on this framer. */
+int  kc_cat_framer_next(kc_cat_framer *f, kc_cat_frame *out);
+
+typedef struct kc_cat_framer_stats {
+    uint64_t bytes;             /* fed */
+    uint64_t frames;            /* returned */
+    uint64_t split;             /* returned from the carry buffer */
+    uint64_t oversized;         /* dropped for exceeding maxFrame */
+    size_t   longest;           /* longest frame returned */
+} kc_cat_framer_stats;
+
+void kc_cat_framer_read_stats(const kc_cat_framer *f, kc_cat_framer_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,289 @@
+/*  kc_cat_sched.c
+ *
+ *  See kc_cat_sched.h.
+ */
+
+#include "kc_cat_sched.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum { KIND_SET, KIND_QUERY, KIND_OTHER };
+
+/* Commands that set an absolute value, with 1 + their selector field count. Everything else
+ * (0) is "other". FR/FT/MV/MN/MA change what later commands apply to, RU/RD step, AC can start
+ * a tune, TX/RX key the radio: none of them may be merged or reordered. */
+static const uint8_t kKeyFields[KC_CAT_COMMAND_COUNT] = {
+    [KC_CAT_FA] = 1, [KC_CAT_FB] = 1, [KC_CAT_OM] = 2, [KC_CAT_MD] = 1, [KC_CAT_DA] = 1,
+    [KC_CAT_NR] = 1, [KC_CAT_NT] = 1, [KC_CAT_RT] = 1, [KC_CAT_XT] = 1, [KC_CAT_RF] = 1,
+    [KC_CAT_IS] = 1, [KC_CAT_SL] = 2, [KC_CAT_SH] = 2, [KC_CAT_PC] = 1, [KC_CAT_AG] = 1,
+    [KC_CAT_RG] = 1, [KC_CAT_SQ] = 1, [KC_CAT_SM] = 1, [KC_CAT_EX] = 2, [KC_CAT_AI] = 1,
+    [KC_CAT_KN] = 3,
+};
+
+typedef struct entry {
+    uint64_t key;
+    uint8_t  kind;
+    uint8_t  cmd;
+    uint8_t  length;
+    char     bytes[KC_CAT_SCHED_MAX_COMMAND];
+} entry;
+
+/* A written command the radio hasn't settled. Queries wait for their answer; sets and others
+ * are kept so that a "?;" can be put down to the command the radio rejected. */
+typedef struct in_flight {
+    uint64_t key;
+    uint64_t sentNs;
+    uint8_t  cmd;
+    uint8_t  kind;
+} in_flight;
+
+#define FLIGHT_CAP (2 * KC_CAT_SCHED_MAX_WINDOW)
+
+struct kc_cat_sched {
+    kc_cat_sched_config    config;
+    entry                  queue[KC_CAT_SCHED_MAX_QUEUED];
+    int                    queued;
+    int                    lastOther;           /* index of the last "other" in the queue, or -1 */
+    in_flight              flight[FLIGHT_CAP];  /* oldest first */
+    int                    flights;
+    int                    inFlight;            /* queries in flight[] */
+    uint64_t               lastWriteNs;
+    int                    hasWritten;
+    kc_cat_sched_stats     stats;
+    kc_cat_sched_cmd_stats cmd[KC_CAT_COMMAND_COUNT];
+};
+
+kc_cat_sched *kc_cat_sched_create(const kc_cat_sched_config *config) {
+    kc_cat_sched_config c = { 0 };
+    if (config) c = *config;
+    if (c.window == 0) c.window = 4;
+    if (c.timeoutNs == 0) c.timeoutNs = 1000000000ull;
+    if (c.window < 1 || c.window > KC_CAT_SCHED_MAX_WINDOW) return NULL;
+    kc_cat_sched *s = calloc(1, sizeof *s);
+    if (!s) return NULL;
+    s->config = c;
+    s->lastOther = -1;
+    return s;
+}
+
+void kc_cat_sched_destroy(kc_cat_sched *s) {
+    free(s);
+}
+
+void kc_cat_sched_reset(kc_cat_sched *s) {
+    s->queued = 0;
+    s->lastOther = -1;
+    s->flights = 0;
+    s->inFlight = 0;
+    s->hasWritten = 0;
+}
+
+/* The kind and key of a command or an answer. */
+static int classify(const char *frame, size_t length, uint64_t *key, uint8_t *cmd) {
+    kc_cat_msg m;
+    *key = 0;
+    *cmd = KC_CAT_UNKNOWN;
+    if (!kc_cat_decode(frame, length, &m)) return KIND_OTHER;
+    *cmd = (uint8_t)m.cmd;
+    int selectors = kKeyFields[m.cmd] - 1;
+    if (selectors < 0 || m.count < selectors) return KIND_OTHER;
+    uint64_t k = m.cmd;
+    for (int i = 0; i < selectors; i++) {
+        if (!kc_cat_has(&m, i) || m.v[i] < 0 || m.v[i] > 0xffff) return KIND_OTHER;
+        k |= (uint64_t)m.v[i] << (8 + 16 * i);
+    }
+    *key = k;
+    return m.count == selectors && m.rest == 0 ? KIND_QUERY : KIND_SET;
+}
+
+kc_cat_sched_result kc_cat_sched_submit(kc_cat_sched *s, const char *command, size_t length, uint64_t nowNs) {
+    (void)nowNs;
+    if (length == 0 || length > KC_CAT_SCHED_MAX_COMMAND) return KC_CAT_SCHED_INVALID;
+    s->stats.submitted++;
+
+    uint64_t key;
+    uint8_t cmd;
+    int kind = classify(command, length, &key, &cmd);
+    if (kind != KIND_OTHER) {
+        /* Back to the last "other": the newest queued command with this key. A set replaces
+         * the newest set (queries in between read the new value, which is what they want);
+         * a query is absorbed by a queued query unless a set comes after it. */
+        for (int i = s->queued - 1; i > s->lastOther; i--) {
+            entry *e = &s->queue[i];
+            if (e->key != key) continue;
+            if (kind == KIND_QUERY && e->kind == KIND_SET) break;
+            if (e->kind != kind) continue;
+            if (kind == KIND_SET) {
+                memcpy(e->bytes, command, length);
+                e->length = (uint8_t)length;
+            }
+            s->stats.coalesced++;
+            s->cmd[cmd].coalesced++;
+            return KC_CAT_SCHED_COALESCED;
+        }
+    }
+
+    if (s->queued == KC_CAT_SCHED_MAX_QUEUED) {
+        s->stats.full++;
+        return KC_CAT_SCHED_FULL;
+    }
+    entry *e = &s->queue[s->queued];
+    e->key = key;
+    e->kind = (uint8_t)kind;
+    e->cmd = cmd;
+    e->length = (uint8_t)length;
+    memcpy(e->bytes, command, length);
+    if (kind == KIND_OTHER) s->lastOther = s->queued;
+    s->queued++;
+    if (s->queued > s->stats.maxQueued) s->stats.maxQueued = s->queued;
+    return KC_CAT_SCHED_QUEUED;
+}
+
+static void drop_flight(kc_cat_sched *s, int i) {
+    if (s->flight[i].kind == KIND_QUERY) s->inFlight--;
+    memmove(&s->flight[i], &s->flight[i + 1], (size_t)(s->flights - i - 1) * sizeof s->flight[0]);
+    s->flights--;
+}
+
+static void push_flight(kc_cat_sched *s, const entry *e, uint64_t nowNs) {
+    if (s->flights == FLIGHT_CAP) {
+        /* Full of sets and others nothing has settled yet (at most `window` are queries): take
+         * the oldest of them as accepted. */
+        int i = 0;
+        while (s->flight[i].kind == KIND_QUERY) i++;
+        drop_flight(s, i);
+    }
+    s->flight[s->flights++] = (in_flight){ e->key, nowNs, e->cmd, e->kind };
+    if (e->kind == KIND_QUERY && ++s->inFlight > s->stats.maxInFlight) s->stats.maxInFlight = s->inFlight;
+}
+
+/* Queries past their timeout are given up; sets and others that old are taken as accepted. */
+static void expire(kc_cat_sched *s, uint64_t nowNs) {
+    int kept = 0, queries = 0;
+    for (int i = 0; i < s->flights; i++) {
+        in_flight *f = &s->flight[i];
+        if (nowNs - f->sentNs < s->config.timeoutNs) {
+            if (f->kind == KIND_QUERY) queries++;
+            s->flight[kept++] = *f;
+        } else if (f->kind == KIND_QUERY) {
+            s->stats.timeouts++;
+            s->cmd[f->cmd].timeouts++;
+        }
+    }
+    s->flights = kept;
+    s->inFlight = queries;
+}
+
+size_t kc_cat_sched_next_write(kc_cat_sched *s, uint64_t nowNs, char *buf, size_t capacity, uint64_t *waitNs) {
+    if (waitNs) *waitNs = 0;
+    expire(s, nowNs);
+
+    /* Only sets and queries queued: they wait out the write interval. */
+    if (s->lastOther < 0 && s->queued > 0 && s->hasWritten && nowNs - s->lastWriteNs < s->config.minIntervalNs) {
+        if (waitNs) *waitNs = s->config.minIntervalNs - (nowNs - s->lastWriteNs);
+        return 0;
+    }
+
+    size_t n = 0;
+    int kept = 0, held = 0, stopped = 0;
+    s->lastOther = -1;
+    for (int i = 0; i < s->queued; i++) {
+        entry *e = &s->queue[i];
+        int hold = stopped || (e->kind == KIND_QUERY && s->inFlight == s->config.window);
+        /* An "other" is a barrier: it waits for a query held back by the window, and so does
+         * everything after it. */
+        if (!hold && e->kind == KIND_OTHER && held) hold = stopped = 1;
+        if (!hold && capacity - n < e->length) hold = stopped = 1;
+        if (hold) {
+            held = 1;
+            if (kept != i) s->queue[kept] = *e;
+            if (e->kind == KIND_OTHER) s->lastOther = kept;
+            kept++;
+            continue;
+        }
+        memcpy(buf + n, e->bytes, e->length);
+        n += e->length;
+        s->stats.written++;
+        if (e->kind == KIND_SET) s->cmd[e->cmd].sets++;
+        else if (e->kind == KIND_QUERY) s->cmd[e->cmd].queries++;
+        push_flight(s, e, nowNs);
+    }
+    s->queued = kept;
+
+    if (n > 0) {
+        s->stats.writes++;
+        s->stats.bytes += n;
+        s->lastWriteNs = nowNs;
+        s->hasWritten = 1;
+    } else if (waitNs && s->inFlight > 0) {
+        /* Held back by the window: the oldest query's timeout frees a slot. */
+        int i = 0;
+        while (s->flight[i].kind != KIND_QUERY) i++;
+        *waitNs = s->flight[i].sentNs + s->config.timeoutNs - nowNs;
+    }
+    return n;
+}
+
+static void complete(kc_cat_sched *s, int i, uint64_t nowNs) {
+    in_flight *f = &s->flight[i];
+    kc_cat_sched_cmd_stats *c = &s->cmd[f->cmd];
+    uint64_t rtt = nowNs - f->sentNs;
+    c->answered++;
+    c->rttSumNs += rtt;
+    if (c->answered == 1 || rtt < c->rttMinNs) c->rttMinNs = rtt;
+    if (rtt > c->rttMaxNs) c->rttMaxNs = rtt;
+    s->stats.answered++;
+    drop_flight(s, i);
+}
+
+void kc_cat_sched_on_frame(kc_cat_sched *s, const char *frame, size_t length, uint64_t nowNs) {
+    if (s->flights == 0) return;
+    if (length >= 1 && frame[0] == '?') {
+        /* The radio answers in order, but accepts sets and others without a word, so those
+         * written ahead of the oldest query can't be told from rejected ones: they are taken
+         * as accepted and the query as the one refused. Only with no query in flight is "?;"
+         * put down to the oldest set or other. */
+        int q = 0;
+        while (q < s->flights && s->flight[q].kind != KIND_QUERY) q++;
+        if (q < s->flights) {
+            memmove(&s->flight[0], &s->flight[q], (size_t)(s->flights - q) * sizeof s->flight[0]);
+            s->flights -= q;
+            s->stats.errors++;
+        } else {
+            s->stats.rejected++;
+        }
+        drop_flight(s, 0);
+        return;
+    }
+    uint64_t key;
+    uint8_t cmd;
+    if (classify(frame, length, &key, &cmd) == KIND_OTHER) return;
+    for (int i = 0; i < s->flights; i++) {
+        if (s->flight[i].kind != KIND_QUERY || s->flight[i].key != key) continue;
+        /* Sets and others written before the query went through without a word. */
+        int kept = 0;
+        for (int j = 0; j < i; j++)
+            if (s->flight[j].kind == KIND_QUERY) s->flight[kept++] = s->flight[j];
+        memmove(&s->flight[kept], &s->flight[i], (size_t)(s->flights - i) * sizeof s->flight[0]);
+        s->flights -= i - kept;
+        complete(s, kept, nowNs);
+        return;
+    }
+}
+
+int kc_cat_sched_pending(const kc_cat_sched *s) {
+    return s->queued + s->inFlight;
+}
+
+void kc_cat_sched_read_stats(const kc_cat_sched *s, kc_cat_sched_stats *out) {
+    *out = s->stats;
+}
+
+void kc_cat_sched_read_cmd_stats(const kc_cat_sched *s, kc_cat_cmd cmd, kc_cat_sched_cmd_stats *out) {
+    if (cmd <= KC_CAT_UNKNOWN || cmd >= KC_CAT_COMMAND_COUNT) {
+        memset(out, 0, sizeof *out);
+        return;
+    }
+    *out = s->cmd[cmd];
+}
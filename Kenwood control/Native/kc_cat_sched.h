@@ -0,0 +1,129 @@
+/*  kc_cat_sched.h
+ *
+ *  The CAT write scheduler between the app's send calls and the control
+ *  socket. Commands are queued, and kc_cat_sched_next_write gathers
+ *  everything that may go now into one buffer, so a burst of sends costs
+ *  one TCP write (the socket runs with Nagle off).
+ *
+ *  Commands fall in three kinds, from kc_cat_codec and a table of the
+ *  commands that set an absolute value (FA, AG, RF, EX...):
+ *
+ *    set     such a command with its value. A newer set with the same key
+ *            replaces the queued one where it stands: the latest value
+ *            wins. The key is the command plus its selector fields (EX's
+ *            menu number, SL's type).
+ *    query   such a command in its read form ("AG;", "EX030;"). A query
+ *            already queued for the key absorbs a new one. At most
+ *            `window` queries await their answer at once; the rest wait
+ *            their turn, behind them in order.
+ *    other   anything else: PTT, relative steps (RU/RD), VFO and memory
+ *            selection, KNS. Never coalesced, and a barrier: it isn't
+ *            written ahead of anything queued before it (a query held
+ *            back by the window holds it too), and a set or query queued
+ *            after one is never merged into or written ahead of anything
+ *            before it.
+ *
+ *  A write holding only sets and queries goes out at most every
+ *  `minIntervalNs`, which is where a knob sweep collapses into its latest
+ *  values. A write with an "other" command in it goes at once, so PTT
+ *  never waits.
+ *
+ *  Answers are passed in with kc_cat_sched_on_frame. One with a query's
+ *  key completes the oldest such query and times its round trip, and
+ *  settles the sets and others written before it, which the radio
+ *  accepted silently. "?;" completes the oldest query awaiting an answer
+ *  as an error (the radio answers in order), and the sets and others
+ *  written ahead of it are taken as accepted: silence and a refusal look
+ *  the same until something after them is answered. With no query
+ *  awaiting an answer, it marks the oldest set or other as rejected. A
+ *  query without an answer after `timeoutNs` is given up; a set or other
+ *  is then taken as accepted.
+ *
+ *  Not thread-safe: TS890Connection uses it on its queue. Nothing
+ *  allocates after kc_cat_sched_create.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kc_cat_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KC_CAT_SCHED_MAX_COMMAND 128    /* bytes, with the ';' */
+#define KC_CAT_SCHED_MAX_QUEUED  256
+#define KC_CAT_SCHED_MAX_WINDOW  32
+
+typedef struct kc_cat_sched kc_cat_sched;
+
+typedef struct kc_cat_sched_config {
+    int      window;                    /* queries awaiting an answer at once; 0: 4 */
+    uint64_t minIntervalNs;             /* between writes of only sets and queries; 0: none */
+    uint64_t timeoutNs;                 /* a query is given up after this; 0: 1 s */
+} kc_cat_sched_config;
+
+/* NULL config: the defaults, with no write interval. NULL on bad arguments or no memory. */
+kc_cat_sched *kc_cat_sched_create(const kc_cat_sched_config *config);
+void          kc_cat_sched_destroy(kc_cat_sched *s);
+
+/* Drops the queue and the queries awaiting answers (a new connection). Statistics are kept. */
+void kc_cat_sched_reset(kc_cat_sched *s);
+
+typedef enum {
+    KC_CAT_SCHED_QUEUED = 0,
+    KC_CAT_SCHED_COALESCED,             /* replaced or absorbed by a queued command */
+    KC_CAT_SCHED_FULL,                  /* the queue is full: not queued */
+    KC_CAT_SCHED_INVALID                /* empty, or longer than KC_CAT_SCHED_MAX_COMMAND */
+} kc_cat_sched_result;
+
+/* Queues one command, with its ';'. */
+kc_cat_sched_result kc_cat_sched_submit(kc_cat_sched *s, const char *command, size_t length, uint64_t nowNs);
+
+/* Copies the commands that may be written at `nowNs` into `buf`, in order, and returns the byte
+ * count. 0 when nothing may go yet; *waitNs (if not NULL) is then how long until something might
+ * (a write interval ending, a query timing out), or 0 for nothing to wait for but answers and new
+ * commands. A command that doesn't fit in `capacity` waits for the next call. */
+size_t kc_cat_sched_next_write(kc_cat_sched *s, uint64_t nowNs, char *buf, size_t capacity, uint64_t *waitNs);
+
+/* One frame from the radio, without its ';' (as kc_cat_framer returns it). */
+void kc_cat_sched_on_frame(kc_cat_sched *s, const char *frame, size_t length, uint64_t nowNs);
+
+/* Commands queued and queries awaiting answers. */
+int kc_cat_sched_pending(const kc_cat_sched *s);
+
+typedef struct kc_cat_sched_stats {
+    uint64_t submitted;
+    uint64_t coalesced;                 /* submissions replaced or absorbed before they were written */
+    uint64_t written;                   /* commands written */
+    uint64_t writes;                    /* write buffers returned */
+    uint64_t bytes;
+    uint64_t answered;
+    uint64_t errors;                    /* queries answered with "?;" */
+    uint64_t rejected;                  /* sets and others answered with "?;" (no query awaiting one) */
+    uint64_t timeouts;
+    uint64_t full;                      /* submissions refused: queue full */
+    int      maxQueued;
+    int      maxInFlight;
+} kc_cat_sched_stats;
+
+/* Per command, for sets and queries. Round trips are from the query's write to its answer. */
+typedef struct kc_cat_sched_cmd_stats {
+    uint64_t sets;                      /* written */
+    uint64_t queries;                   /* written */
+    uint64_t coalesced;
+    uint64_t answered;
+    uint64_t timeouts;
+    uint64_t rttSumNs;
+    uint64_t rttMinNs;
+    uint64_t rttMaxNs;
+} kc_cat_sched_cmd_stats;
+
+void kc_cat_sched_read_stats(const kc_cat_sched *s, kc_cat_sched_stats *out);
+void kc_cat_sched_read_cmd_stats(const kc_cat_sched *s, kc_cat_cmd cmd, kc_cat_sched_cmd_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
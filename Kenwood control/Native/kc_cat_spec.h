@@ -0,0 +1,74 @@
+/*  kc_cat_spec.h
+ *
+ *  The CAT commands the app decodes and encodes, one line each. kc_cat_codec
+ *  builds its command enum, its dispatch tables and its field parsers and
+ *  formatters from this list, so a new command is a new line here and a
+ *  case in RadioState. docs/ts890_command_map.md says what they mean.
+ *
+ *    CMD(id, c0, c1, layout)     "c0c1" + fields. Decoded from answers and
+ *                                AI reports; encoded as set commands.
+ *    EXT(id, c0, c1, layout)     "##c0c1" + fields, likewise.
+ *    SET(id, prefix, layout)     prefix + fields; encoded only (a set
+ *                                format that differs from the answer).
+ *
+ *  Two-letter names must be unique within CMD and within EXT: the pair is
+ *  the dispatch key (a duplicate initializer warns at compile time).
+ *
+ *  A layout is a run of fields; spaces are for reading only.
+ *
+ *    D      one decimal digit
+ *    H      one hex digit (modes above 9)
+ *    U<n>   unsigned, n digits zero-padded. Decoding takes up to n digits
+ *           after any leading spaces and needs at least one.
+ *    S<n>   sign and n digits: '+' or '-' when encoding; anything but '-'
+ *           is positive when decoding (the radio sends '+' or ' ')
+ *    V      optional '-' or '+' and as many digits as there are
+ *    R<n>   text: decoding takes the last n characters of the frame,
+ *           wherever the fields before it ended, spaces trimmed; encoding
+ *           pads to n with spaces (a ';' becomes a space)
+ */
+
+#pragma once
+
+#define KC_CAT_SPEC(CMD, EXT, SET)                                                  \
+    CMD(FA, 'F', 'A', "U11")            /* VFO A Hz */                              \
+    CMD(FB, 'F', 'B', "U11")            /* VFO B Hz */                              \
+    CMD(OM, 'O', 'M', "D H")            /* display area, operating mode */          \
+    CMD(MD, 'M', 'D', "D")                                                          \
+    CMD(DA, 'D', 'A', "D")              /* data mode */                             \
+    CMD(FR, 'F', 'R', "D")              /* RX VFO */                                \
+    CMD(FT, 'F', 'T', "D")              /* TX VFO */                                \
+    CMD(NR, 'N', 'R', "D")                                                          \
+    CMD(NT, 'N', 'T', "D")                                                          \
+    CMD(RT, 'R', 'T', "D")                                                          \
+    CMD(XT, 'X', 'T', "D")                                                          \
+    CMD(RF, 'R', 'F', "D U4")           /* RIT/XIT direction (1 = down), Hz */      \
+    CMD(IS, 'I', 'S', "S4")             /* IF shift Hz */                           \
+    CMD(SL, 'S', 'L', "D U2")           /* type, low-cut setting ID */              \
+    CMD(SH, 'S', 'H', "D U3")           /* type, high-cut setting ID */             \
+    CMD(PC, 'P', 'C', "U3")             /* output power W */                        \
+    CMD(AG, 'A', 'G', "U3")                                                         \
+    CMD(RG, 'R', 'G', "U3")                                                         \
+    CMD(SQ, 'S', 'Q', "U3")                                                         \
+    CMD(SM, 'S', 'M', "U4")             /* meter dots */                            \
+    CMD(MV, 'M', 'V', "D")              /* 1 = memory mode */                       \
+    CMD(MN, 'M', 'N', "U3")             /* memory channel */                        \
+    CMD(MA, 'M', 'A', "D U3 U11 H R10") /* 0, channel, Hz, mode, ..., name */       \
+    CMD(AC, 'A', 'C', "D D D")          /* ATU RX, TX, tuning */                    \
+    CMD(SP, 'S', 'P', "D")              /* split offset setting active */           \
+    CMD(EX, 'E', 'X', "U3 V")           /* menu, value */                           \
+    CMD(AI, 'A', 'I', "D")                                                          \
+    CMD(RX, 'R', 'X', "")                                                           \
+    CMD(TX, 'T', 'X', "D")                                                          \
+    CMD(RC, 'R', 'C', "")               /* clear RIT/XIT offset */                  \
+    CMD(RU, 'R', 'U', "U5")             /* RIT/XIT offset up by Hz */               \
+    CMD(RD, 'R', 'D', "U5")             /* RIT/XIT offset down by Hz */             \
+    EXT(CN, 'C', 'N', "D")              /* KNS connect */                           \
+    EXT(ID, 'I', 'D', "D")              /* KNS login result */                      \
+    EXT(KN, 'K', 'N', "D D U3")         /* 3, VoIP level type (0 in, 1 out), level */ \
+    EXT(VP, 'V', 'P', "D")              /* VoIP stream */                           \
+    SET(MA0, "MA0", "U3")               /* read memory channel */                   \
+    SET(MA1, "MA1", "U11 H D")          /* write Hz, mode, FM narrow */             \
+    SET(SP0, "SP0", "D D")              /* split offset direction, kHz */           \
+    SET(EX_SIGNED, "EX", "U3 S2")       /* menu, signed dB (EQ) */                  \
+    SET(KN3, "##KN3", "D U3")           /* VoIP level type, level */
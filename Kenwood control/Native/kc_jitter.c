@@ -0,0 +1,231 @@
+/*  kc_jitter.c
+ *
+ *  See kc_jitter.h. Sequence numbers are extended to 64 bits against the
+ *  newest packet, so wraparound needs no special cases; frames live in a ring
+ *  indexed by extended sequence modulo KC_JITTER_CAPACITY.
+ */
+
+#include "kc_jitter.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MASK (KC_JITTER_CAPACITY - 1)
+/* Frames the queue must stay above target + 1 before one is dropped (1 s at 20 ms). */
+#define SHRINK_HOLD_FRAMES 50
+
+struct kc_jitter {
+    int      frameBytes;
+    uint64_t frameNs;
+    int      minDepth, maxDepth;
+
+    int      started, everStarted;
+    int64_t  playExt;               /* next frame to play */
+    int64_t  highestExt;            /* newest frame received */
+    uint64_t playDueNs;
+
+    double   jitterNs;              /* RFC 3550 J, kept across restarts */
+    int64_t  lastTransit;
+    int      haveTransit;
+
+    int      target;
+    int      excessFrames;          /* consecutive frames with more than target + 1 queued */
+    int      holdFrames;            /* consecutive underruns */
+
+    int64_t  slotExt[KC_JITTER_CAPACITY];       /* -1: empty */
+    uint8_t *data;
+
+    /* Published for kc_jitter_read_stats. */
+    _Atomic int      statDepth, statTarget;
+    _Atomic uint64_t statJitterNs;
+    _Atomic uint64_t received, reordered, late, duplicates, lost, underruns, dropped, restarts;
+};
+
+#define BUMP(jb, field) atomic_fetch_add_explicit(&(jb)->field, 1, memory_order_relaxed)
+
+kc_jitter *kc_jitter_create(int frameBytes, uint64_t frameNs, int minDepth, int maxDepth) {
+    if (frameBytes <= 0 || frameNs == 0 || minDepth < 1 || maxDepth < minDepth || maxDepth > KC_JITTER_CAPACITY / 2)
+        return NULL;
+    kc_jitter *jb = calloc(1, sizeof *jb);
+    if (!jb) return NULL;
+    jb->data = malloc((size_t)frameBytes * KC_JITTER_CAPACITY);
+    if (!jb->data) {
+        free(jb);
+        return NULL;
+    }
+    jb->frameBytes = frameBytes;
+    jb->frameNs = frameNs;
+    jb->minDepth = minDepth;
+    jb->maxDepth = maxDepth;
+    jb->target = minDepth;
+    atomic_store(&jb->statTarget, minDepth);
+    kc_jitter_reset(jb);
+    return jb;
+}
+
+void kc_jitter_destroy(kc_jitter *jb) {
+    if (!jb) return;
+    free(jb->data);
+    free(jb);
+}
+
+void kc_jitter_reset(kc_jitter *jb) {
+    jb->started = 0;
+    jb->haveTransit = 0;
+    jb->excessFrames = 0;
+    jb->holdFrames = 0;
+    for (int i = 0; i < KC_JITTER_CAPACITY; i++) jb->slotExt[i] = -1;
+    atomic_store_explicit(&jb->statDepth, 0, memory_order_relaxed);
+}
+
+static void update_target(kc_jitter *jb) {
+    int t = 1 + (int)ceil(3.0 * jb->jitterNs / (double)jb->frameNs);
+    if (t < jb->minDepth) t = jb->minDepth;
+    if (t > jb->maxDepth) t = jb->maxDepth;
+    jb->target = t;
+    atomic_store_explicit(&jb->statTarget, t, memory_order_relaxed);
+}
+
+static void publish_depth(kc_jitter *jb) {
+    int64_t queued = jb->highestExt - jb->playExt + 1;
+    atomic_store_explicit(&jb->statDepth, queued > 0 ? (int)queued : 0, memory_order_relaxed);
+}
+
+static void store(kc_jitter *jb, int64_t ext, const uint8_t *payload) {
+    jb->slotExt[ext & MASK] = ext;
+    memcpy(jb->data + (size_t)(ext & MASK) * (size_t)jb->frameBytes, payload, (size_t)jb->frameBytes);
+}
+
+static int present(const kc_jitter *jb, int64_t ext) {
+    return jb->slotExt[ext & MASK] == ext;
+}
+
+static kc_jitter_put_result start(kc_jitter *jb, uint16_t seq, uint64_t arrivalNs, const uint8_t *payload) {
+    kc_jitter_reset(jb);
+    if (jb->everStarted) BUMP(jb, restarts);
+    jb->everStarted = 1;
+    jb->started = 1;
+
+    /* Offset by one cycle so a backwards step never goes negative. */
+    int64_t ext = (int64_t)seq + 65536;
+    jb->playExt = jb->highestExt = ext;
+    update_target(jb);
+    jb->playDueNs = arrivalNs + (uint64_t)(jb->target - 1) * jb->frameNs;
+    jb->lastTransit = (int64_t)arrivalNs - ext * (int64_t)jb->frameNs;
+    jb->haveTransit = 1;
+
+    store(jb, ext, payload);
+    BUMP(jb, received);
+    publish_depth(jb);
+    return KC_JITTER_RESTARTED;
+}
+
+kc_jitter_put_result kc_jitter_put(kc_jitter *jb, uint16_t seq, uint64_t arrivalNs, const uint8_t *payload) {
+    if (!jb->started) return start(jb, seq, arrivalNs, payload);
+
+    int64_t ext = jb->highestExt + (int16_t)(uint16_t)(seq - (uint16_t)jb->highestExt);
+
+    /* A jump beyond the ring either way is a new stream (radio restart, long outage). */
+    if (ext >= jb->playExt + KC_JITTER_CAPACITY || ext < jb->playExt - KC_JITTER_CAPACITY)
+        return start(jb, seq, arrivalNs, payload);
+
+    /* RFC 3550 6.4.1: J += (|D(i-1,i)| - J) / 16, with transit = arrival - media time. */
+    int64_t transit = (int64_t)arrivalNs - ext * (int64_t)jb->frameNs;
+    if (jb->haveTransit) {
+        double d = fabs((double)(transit - jb->lastTransit));
+        jb->jitterNs += (d - jb->jitterNs) / 16.0;
+        atomic_store_explicit(&jb->statJitterNs, (uint64_t)jb->jitterNs, memory_order_relaxed);
+    }
+    jb->lastTransit = transit;
+    jb->haveTransit = 1;
+
+    if (ext < jb->playExt) {
+        BUMP(jb, late);
+        return KC_JITTER_LATE;
+    }
+    if (present(jb, ext)) {
+        BUMP(jb, duplicates);
+        return KC_JITTER_DUPLICATE;
+    }
+    store(jb, ext, payload);
+    BUMP(jb, received);
+
+    kc_jitter_put_result r = KC_JITTER_QUEUED;
+    if (ext < jb->highestExt) {
+        BUMP(jb, reordered);
+        r = KC_JITTER_REORDERED;
+    } else {
+        jb->highestExt = ext;
+    }
+    publish_depth(jb);
+    return r;
+}
+
+kc_jitter_get_result kc_jitter_get(kc_jitter *jb, uint64_t nowNs, uint8_t *out) {
+    if (!jb->started || nowNs < jb->playDueNs) return KC_JITTER_NONE;
+
+    /* The caller's timer stalled: don't play out the whole gap as a burst. */
+    if (nowNs - jb->playDueNs > (uint64_t)jb->maxDepth * jb->frameNs) jb->playDueNs = nowNs;
+    jb->playDueNs += jb->frameNs;
+    update_target(jb);
+
+    /* Queued well past the target for a while: skip the due frame to cut the delay. */
+    int64_t queued = jb->highestExt - jb->playExt + 1;     /* including the due frame */
+    if (queued > jb->target + 1) {
+        if (++jb->excessFrames >= SHRINK_HOLD_FRAMES) {
+            jb->slotExt[jb->playExt & MASK] = -1;
+            jb->playExt++;
+            jb->excessFrames = 0;
+            BUMP(jb, dropped);
+        }
+    } else {
+        jb->excessFrames = 0;
+    }
+
+    kc_jitter_get_result r;
+    if (present(jb, jb->playExt)) {
+        memcpy(out, jb->data + (size_t)(jb->playExt & MASK) * (size_t)jb->frameBytes, (size_t)jb->frameBytes);
+        jb->slotExt[jb->playExt & MASK] = -1;
+        jb->playExt++;
+        jb->holdFrames = 0;
+        r = KC_JITTER_FRAME;
+    } else if (jb->highestExt > jb->playExt) {
+        /* Later frames are here, so this one is lost rather than just slow. */
+        jb->playExt++;
+        jb->holdFrames = 0;
+        BUMP(jb, lost);
+        r = KC_JITTER_LOST;
+    } else {
+        /* Nothing queued: hold the playout point, which adds a frame of delay. A stream that
+         * stays silent for longer than the deepest buffer has stopped; go idle. */
+        if (++jb->holdFrames > jb->maxDepth) {
+            kc_jitter_reset(jb);
+            return KC_JITTER_NONE;
+        }
+        BUMP(jb, underruns);
+        r = KC_JITTER_UNDERRUN;
+    }
+    publish_depth(jb);
+    return r;
+}
+
+uint64_t kc_jitter_next_due_ns(const kc_jitter *jb) {
+    return jb->started ? jb->playDueNs : UINT64_MAX;
+}
+
+void kc_jitter_read_stats(const kc_jitter *jb, kc_jitter_stats *out) {
+    kc_jitter *j = (kc_jitter *)jb;     /* atomic loads take non-const pointers in C11 */
+    out->depth      = atomic_load_explicit(&j->statDepth, memory_order_relaxed);
+    out->target     = atomic_load_explicit(&j->statTarget, memory_order_relaxed);
+    out->jitterMs   = (double)atomic_load_explicit(&j->statJitterNs, memory_order_relaxed) / 1e6;
+    out->received   = atomic_load_explicit(&j->received, memory_order_relaxed);
+    out->reordered  = atomic_load_explicit(&j->reordered, memory_order_relaxed);
+    out->late       = atomic_load_explicit(&j->late, memory_order_relaxed);
+    out->duplicates = atomic_load_explicit(&j->duplicates, memory_order_relaxed);
+    out->lost       = atomic_load_explicit(&j->lost, memory_order_relaxed);
+    out->underruns  = atomic_load_explicit(&j->underruns, memory_order_relaxed);
+    out->dropped    = atomic_load_explicit(&j->dropped, memory_order_relaxed);
+    out->restarts   = atomic_load_explicit(&j->restarts, memory_order_relaxed);
+}
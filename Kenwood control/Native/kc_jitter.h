@@ -0,0 +1,84 @@
+/*  kc_jitter.h
+ *
+ *  Adaptive jitter buffer for the LAN RX stream (fixed-size 20 ms RTP packets).
+ *
+ *  Packets go in keyed by RTP sequence number and arrival time, in whatever
+ *  order the network delivers them; frames come out in sequence order on a
+ *  steady playout clock (kc_jitter_get, polled from a timer). The playout
+ *  delay follows the measured inter-arrival jitter (RFC 3550, section 6.4.1):
+ *
+ *    - the target depth is 1 + ceil(3 J / frame) frames, clamped to
+ *      [minDepth, maxDepth];
+ *    - when the next frame hasn't arrived and nothing after it has either
+ *      (an underrun), playout holds for one frame, which adds 20 ms of delay;
+ *    - when more than target + 1 frames have been queued for a full second,
+ *      one frame is dropped, which removes 20 ms.
+ *
+ *  Packets older than the playout point are late and discarded. A frame that
+ *  is still missing when it's due while later ones are queued is lost. The
+ *  caller conceals both underruns and losses.
+ *
+ *  The TS-890's RTP timestamps aren't dependable (its own TX stream sends 0),
+ *  so media time is sequence x frame duration.
+ *
+ *  One thread puts and gets; kc_jitter_read_stats may run on any thread.
+ *  Nothing allocates after kc_jitter_create.
+ */
+
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct kc_jitter kc_jitter;
+
+#define KC_JITTER_CAPACITY 64           /* queued frames, and the largest maxDepth */
+
+/* frameBytes: payload bytes per packet; frameNs: packet duration. NULL on bad arguments. */
+kc_jitter *kc_jitter_create(int frameBytes, uint64_t frameNs, int minDepth, int maxDepth);
+void       kc_jitter_destroy(kc_jitter *jb);
+
+/* Forget the stream; the next packet starts a new one. Counters are kept. */
+void kc_jitter_reset(kc_jitter *jb);
+
+typedef enum {
+    KC_JITTER_QUEUED,           /* in order */
+    KC_JITTER_REORDERED,        /* older than the newest packet, still in time */
+    KC_JITTER_LATE,             /* already played (or concealed); dropped */
+    KC_JITTER_DUPLICATE,        /* dropped */
+    KC_JITTER_RESTARTED         /* first packet, or a sequence jump: playout starts over */
+} kc_jitter_put_result;
+
+/* Copies frameBytes from `payload`. */
+kc_jitter_put_result kc_jitter_put(kc_jitter *jb, uint16_t seq, uint64_t arrivalNs, const uint8_t *payload);
+
+typedef enum {
+    KC_JITTER_NONE,             /* nothing due yet, or no stream */
+    KC_JITTER_FRAME,            /* `out` holds the next frame */
+    KC_JITTER_LOST,             /* the due frame never arrived; conceal one frame */
+    KC_JITTER_UNDERRUN          /* nothing queued; conceal one frame while playout holds */
+} kc_jitter_get_result;
+
+/* The next frame due at `nowNs`, if any. Call until it returns KC_JITTER_NONE. */
+kc_jitter_get_result kc_jitter_get(kc_jitter *jb, uint64_t nowNs, uint8_t *out);
+
+/* When the next kc_jitter_get will return something, or UINT64_MAX when idle. */
+uint64_t kc_jitter_next_due_ns(const kc_jitter *jb);
+
+typedef struct kc_jitter_stats {
+    int      depth;             /* frames queued ahead of the playout point */
+    int      target;            /* adaptive target depth, frames */
+    double   jitterMs;          /* RFC 3550 inter-arrival jitter */
+    uint64_t received, reordered, late, duplicates, lost;
+    uint64_t underruns;         /* frames concealed while holding playout (delay grew) */
+    uint64_t dropped;           /* frames dropped to shrink the delay */
+    uint64_t restarts;
+} kc_jitter_stats;
+
+void kc_jitter_read_stats(const kc_jitter *jb, kc_jitter_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,645 @@
+/*  kc_log.c
+ *
+ *  See kc_log.h. The ring is a byte array indexed by two ever-growing
+ *  positions: producers claim space by moving `head` with a CAS, fill it in
+ *  and publish it by storing the record's size last; the writer consumes at
+ *  `tail`, zeroes what it consumed and moves `tail`. A zero size at `tail`
+ *  is a record still being filled in, which the writer waits for. A record
+ *  that would run past the end of the array is preceded by a padding record
+ *  up to the end.
+ */
+
+#include "kc_log.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAGIC           "KCLG"
+#define VERSION         1u
+#define DEFAULT_MAX     (5u << 20)
+#define DEFAULT_RING    (1u << 20)
+#define MIN_RING        (1u << 16)
+#define MAX_KEEP        9
+#define STAGE_BYTES     (1u << 16)
+#define STAGE_SLACK     (KC_LOG_MAX_TEXT + 512)     /* room one rendered record always fits in */
+#define FLUSH_MS        50
+#define FLUSH_WAIT_MS   1                           /* while kc_log_flush waits on a record being filled in */
+#define PAD_FORMAT      0xffffu
+
+static const char *const g_templates[KC_LOG_FMT_COUNT] = {
+#define KC_LOG_TEMPLATE(name, templ) templ,
+    KC_LOG_FORMATS(KC_LOG_TEMPLATE)
+#undef KC_LOG_TEMPLATE
+};
+
+/* A record in the ring, followed by its integers and then its text; 8-byte aligned. A padding
+ * record may be only 8 bytes, so it uses `size` and `format` alone. */
+typedef struct ring_rec {
+    _Atomic uint32_t size;              /* header, integers and text; 0 until published */
+    uint16_t         format;
+    uint8_t          level;
+    uint8_t          intCount;
+    uint64_t         timeNs;
+} ring_rec;
+
+static uint64_t wall_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void put_le16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put_le32(uint8_t *p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static void put_le64(uint8_t *p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+static uint16_t get_le16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t get_le32(const uint8_t *p) { uint32_t v = 0; for (int i = 3; i >= 0; i--) v = v << 8 | p[i]; return v; }
+static uint64_t get_le64(const uint8_t *p) { uint64_t v = 0; for (int i = 7; i >= 0; i--) v = v << 8 | p[i]; return v; }
+
+static size_t put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/* ---- Logging ---- */
+
+static struct {
+    /* Producers. */
+    _Alignas(64) _Atomic uint64_t head;
+    _Atomic uint64_t dropped;
+    atomic_int       active;
+    atomic_int       wakeRequested;
+    uint8_t         *ring;
+    uint64_t         mask;
+
+    /* Writer. */
+    _Alignas(64) _Atomic uint64_t tail;
+    pthread_mutex_t  lock;
+    pthread_cond_t   wake, done;
+    pthread_t        writer;
+    int              stopping;
+    uint64_t         flushTarget;       /* a kc_log_flush waits for tail to reach this */
+    int              fd;
+    char            *path;
+    int              binary, keep;
+    uint64_t         maxBytes, fileBytes, headerBytes;
+    uint64_t         lastNs;            /* binary: the previous record's time */
+    uint64_t         droppedReported;
+    uint8_t         *stage;
+    size_t           staged;
+    _Atomic uint64_t records, written, writes, rotations;
+    atomic_int       writeError;
+} g_log = { .lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER,
+            .done = PTHREAD_COND_INITIALIZER, .fd = -1 };
+
+static int write_all(int fd, const uint8_t *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+static void fail_write(int e) {
+    if (!atomic_load(&g_log.writeError)) atomic_store(&g_log.writeError, e ? e : EIO);
+    atomic_store(&g_log.active, 0);
+}
+
+/* Binary file header: magic, version, start time, pid and the templates. */
+static int write_header(int fd, uint64_t startNs) {
+    uint8_t h[4096];
+    size_t n = 0;
+    memcpy(h, MAGIC, 4);
+    put_le32(h + 4, VERSION);
+    put_le64(h + 8, startNs);
+    put_le32(h + 16, (uint32_t)getpid());
+    put_le16(h + 20, KC_LOG_FMT_COUNT);
+    n = 22;
+    for (int i = 0; i < KC_LOG_FMT_COUNT; i++) {
+        size_t len = strlen(g_templates[i]);
+        put_le16(h + n, (uint16_t)len);
+        memcpy(h + n + 2, g_templates[i], len);
+        n += 2 + len;
+    }
+    if (write_all(fd, h, n) != 0) return -1;
+    g_log.fileBytes = g_log.headerBytes = n;
+    g_log.lastNs = startNs;
+    return 0;
+}
+
+static void rotated_name(char *out, size_t cap, int i) {
+    if (i == 0) snprintf(out, cap, "%s", g_log.path);
+    else snprintf(out, cap, "%s.%d", g_log.path, i);
+}
+
+/* path.keep-1 -> path.keep ... path -> path.1. */
+static void shift_files(void) {
+    char from[PATH_MAX], to[PATH_MAX];
+    for (int i = g_log.keep; i > 0; i--) {
+        rotated_name(from, sizeof from, i - 1);
+        rotated_name(to, sizeof to, i);
+        rename(from, to);
+    }
+}
+
+/* A new, empty file at path (with its header when binary). */
+static int create_file(uint64_t startNs) {
+    int fd = open(g_log.path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) return -1;
+    g_log.fileBytes = g_log.headerBytes = 0;
+    if (g_log.binary && write_header(fd, startNs) != 0) {
+        int e = errno;
+        close(fd);
+        errno = e;
+        return -1;
+    }
+    g_log.fd = fd;
+    return 0;
+}
+
+static size_t encode(uint8_t *p, const kc_log_item *it);
+
+/* Binary records are timed from the previous one, so the new file starts at `startNs`, the
+ * time of the first record going into it. */
+static void rotate(uint64_t startNs) {
+    close(g_log.fd);
+    g_log.fd = -1;
+    shift_files();
+    if (create_file(startNs) != 0) {
+        fail_write(errno);
+        return;
+    }
+    atomic_fetch_add_explicit(&g_log.rotations, 1, memory_order_relaxed);
+
+    char prev[PATH_MAX];
+    rotated_name(prev, sizeof prev, 1);
+    const char *base = strrchr(prev, '/');
+    base = base ? base + 1 : prev;
+    kc_log_item it = {
+        .level = KC_LOG_INFO, .format = KC_LOG_FMT_ROTATED, .templ = g_templates[KC_LOG_FMT_ROTATED],
+        .timeNs = startNs, .text = (const uint8_t *)base, .length = (uint32_t)strlen(base),
+    };
+    uint8_t line[PATH_MAX + 128];
+    size_t n = g_log.binary ? encode(line, &it) : kc_log_render(&it, (char *)line, sizeof line);
+    if (write_all(g_log.fd, line, n) != 0) fail_write(errno);
+    g_log.fileBytes += n;
+}
+
+static void write_stage(void) {
+    if (g_log.staged == 0) return;
+    if (g_log.fd >= 0 && !atomic_load(&g_log.writeError)) {
+        if (write_all(g_log.fd, g_log.stage, g_log.staged) != 0) {
+            fail_write(errno);
+        } else {
+            g_log.fileBytes += g_log.staged;
+            atomic_fetch_add_explicit(&g_log.written, g_log.staged, memory_order_relaxed);
+            atomic_fetch_add_explicit(&g_log.writes, 1, memory_order_relaxed);
+        }
+    }
+    g_log.staged = 0;
+}
+
+/* Binary record. Times from different threads can arrive slightly out of order; clamp to keep
+ * the deltas unsigned. */
+static size_t encode(uint8_t *p, const kc_log_item *it) {
+    uint64_t dt = it->timeNs > g_log.lastNs ? it->timeNs - g_log.lastNs : 0;
+    if (it->timeNs > g_log.lastNs) g_log.lastNs = it->timeNs;
+    size_t n = 0;
+    p[n++] = (uint8_t)it->format;
+    p[n++] = (uint8_t)(it->level | it->intCount << 4);
+    n += put_varint(p + n, dt);
+    for (int i = 0; i < it->intCount; i++) n += put_varint(p + n, it->ints[i]);
+    n += put_varint(p + n, it->length);
+    if (it->length) memcpy(p + n, it->text, it->length);
+    return n + it->length;
+}
+
+static void stage(const kc_log_item *it) {
+    if (g_log.staged + STAGE_SLACK > STAGE_BYTES) write_stage();
+    if (g_log.fd >= 0 && g_log.fileBytes + g_log.staged + STAGE_SLACK > g_log.maxBytes &&
+        g_log.fileBytes + g_log.staged > g_log.headerBytes) {
+        write_stage();
+        rotate(it->timeNs);
+    }
+    uint8_t *p = g_log.stage + g_log.staged;
+    g_log.staged += g_log.binary ? encode(p, it) : kc_log_render(it, (char *)p, STAGE_SLACK);
+}
+
+/* Everything published from `tail` on; stops at a record still being filled in. */
+static void drain(void) {
+    uint64_t t = atomic_load_explicit(&g_log.tail, memory_order_relaxed);
+    uint64_t h = atomic_load_explicit(&g_log.head, memory_order_acquire);
+    while (t != h) {
+        uint8_t *p = g_log.ring + (t & g_log.mask);
+        ring_rec *r = (ring_rec *)p;
+        uint32_t size = atomic_load_explicit(&r->size, memory_order_acquire);
+        if (size == 0) break;
+        size_t span = ((size_t)size + 7) & ~(size_t)7;
+        if (r->format != PAD_FORMAT) {
+            kc_log_item it = {
+                .level = (kc_log_level)r->level, .format = r->format, .templ = g_templates[r->format],
+                .timeNs = r->timeNs, .intCount = r->intCount,
+                .text = p + sizeof *r + 8 * (size_t)r->intCount,
+            };
+            memcpy(it.ints, p + sizeof *r, 8 * (size_t)r->intCount);
+            it.length = (uint32_t)(size - sizeof *r - 8 * (size_t)r->intCount);
+            stage(&it);
+            atomic_fetch_add_explicit(&g_log.records, 1, memory_order_relaxed);
+        }
+        memset(p, 0, span);
+        t += span;
+        atomic_store_explicit(&g_log.tail, t, memory_order_release);
+        if (t == h) h = atomic_load_explicit(&g_log.head, memory_order_acquire);
+    }
+
+    uint64_t dropped = atomic_load_explicit(&g_log.dropped, memory_order_relaxed);
+    if (dropped != g_log.droppedReported) {
+        kc_log_item it = {
+            .level = KC_LOG_ERROR, .format = KC_LOG_FMT_DROPPED, .templ = g_templates[KC_LOG_FMT_DROPPED],
+            .timeNs = wall_ns(), .ints = { dropped - g_log.droppedReported }, .intCount = 1,
+        };
+        stage(&it);
+        g_log.droppedReported = dropped;
+    }
+    write_stage();
+}
+
+static void wait_ms(int ms) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    long long ns = (long long)tv.tv_usec * 1000 + (long long)ms * 1000000;
+    struct timespec until = { .tv_sec = tv.tv_sec + (time_t)(ns / 1000000000), .tv_nsec = (long)(ns % 1000000000) };
+    pthread_cond_timedwait(&g_log.wake, &g_log.lock, &until);
+}
+
+static void *writer_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_log.lock);
+    for (;;) {
+        if (!g_log.stopping) {
+            int flushing = g_log.flushTarget > atomic_load_explicit(&g_log.tail, memory_order_relaxed);
+            wait_ms(flushing ? FLUSH_WAIT_MS : FLUSH_MS);
+        }
+        int last = g_log.stopping;
+        pthread_mutex_unlock(&g_log.lock);
+        atomic_store_explicit(&g_log.wakeRequested, 0, memory_order_relaxed);
+        drain();
+        pthread_mutex_lock(&g_log.lock);
+        pthread_cond_broadcast(&g_log.done);
+        if (last) break;
+    }
+    pthread_mutex_unlock(&g_log.lock);
+    return NULL;
+}
+
+int kc_log_open(const kc_log_config *config) {
+    if (atomic_load(&g_log.active) || g_log.fd >= 0) {
+        errno = EBUSY;
+        return -1;
+    }
+    if (!config || !config->path || !*config->path) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!g_log.ring) {
+        /* Never freed: a thread that saw the log active may still be writing into it. */
+        size_t want = config->ringBytes ? config->ringBytes : DEFAULT_RING;
+        size_t cap = MIN_RING;
+        while (cap < want && cap < ((size_t)1 << 30)) cap <<= 1;
+        g_log.ring = calloc(1, cap);
+        if (!g_log.ring) {
+            errno = ENOMEM;
+            return -1;
+        }
+        g_log.mask = cap - 1;
+    }
+    if (!g_log.stage && !(g_log.stage = malloc(STAGE_BYTES))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    char *path = strdup(config->path);
+    if (!path) {
+        errno = ENOMEM;
+        return -1;
+    }
+    free(g_log.path);
+    g_log.path = path;
+    g_log.binary = config->binary != 0;
+    g_log.maxBytes = config->maxBytes ? config->maxBytes : DEFAULT_MAX;
+    g_log.keep = config->keep <= 0 ? 1 : config->keep > MAX_KEEP ? MAX_KEEP : config->keep;
+    g_log.staged = 0;
+
+    struct stat st;
+    int exists = stat(g_log.path, &st) == 0 && st.st_size > 0;
+    if (g_log.binary || (exists && (uint64_t)st.st_size >= g_log.maxBytes)) {
+        /* A binary log starts a new file; so does a text one that is already full. */
+        if (exists) shift_files();
+        if (create_file(wall_ns()) != 0) return -1;
+    } else {
+        int fd = open(g_log.path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) return -1;
+        g_log.fd = fd;
+        g_log.fileBytes = exists ? (uint64_t)st.st_size : 0;
+        g_log.headerBytes = 0;
+    }
+
+    g_log.stopping = 0;
+    g_log.flushTarget = 0;
+    g_log.droppedReported = atomic_load(&g_log.dropped);
+    atomic_store(&g_log.writeError, 0);
+    if (pthread_create(&g_log.writer, NULL, writer_main, NULL) != 0) {
+        close(g_log.fd);
+        g_log.fd = -1;
+        errno = EAGAIN;
+        return -1;
+    }
+    atomic_store(&g_log.active, 1);
+
+    static int registered;
+    if (!registered) {
+        atexit(kc_log_close);
+        registered = 1;
+    }
+    return 0;
+}
+
+void kc_log_close(void) {
+    if (g_log.fd < 0) return;
+    atomic_store(&g_log.active, 0);
+    pthread_mutex_lock(&g_log.lock);
+    g_log.stopping = 1;
+    pthread_cond_signal(&g_log.wake);
+    pthread_mutex_unlock(&g_log.lock);
+    pthread_join(g_log.writer, NULL);
+    close(g_log.fd);
+    g_log.fd = -1;
+}
+
+int kc_log_active(void) {
+    return atomic_load_explicit(&g_log.active, memory_order_relaxed);
+}
+
+void kc_log_write(kc_log_level level, kc_log_format format,
+                  const uint64_t *ints, int intCount, const void *text, size_t length) {
+    if (!atomic_load_explicit(&g_log.active, memory_order_relaxed)) return;
+    if ((unsigned)format >= KC_LOG_FMT_COUNT) return;
+    if (!ints || intCount < 0) intCount = 0;
+    if (intCount > KC_LOG_MAX_INTS) intCount = KC_LOG_MAX_INTS;
+    if (!text) length = 0;
+    if (length > KC_LOG_MAX_TEXT) length = KC_LOG_MAX_TEXT;
+    uint64_t timeNs = wall_ns();
+
+    size_t size = sizeof(ring_rec) + 8 * (size_t)intCount + length;
+    uint64_t need = (size + 7) & ~(size_t)7, cap = g_log.mask + 1, pad, used;
+    uint64_t h = atomic_load_explicit(&g_log.head, memory_order_relaxed);
+    for (;;) {
+        uint64_t room = cap - (h & g_log.mask);
+        pad = room < need ? room : 0;
+        /* Acquire: the writer zeroed what it consumed before moving tail. */
+        uint64_t t = atomic_load_explicit(&g_log.tail, memory_order_acquire);
+        used = h + pad + need - t;
+        if (used > cap) {
+            atomic_fetch_add_explicit(&g_log.dropped, 1, memory_order_relaxed);
+            return;
+        }
+        if (atomic_compare_exchange_weak_explicit(&g_log.head, &h, h + pad + need,
+                                                  memory_order_relaxed, memory_order_relaxed))
+            break;
+    }
+    if (pad) {
+        ring_rec *r = (ring_rec *)(g_log.ring + (h & g_log.mask));
+        r->format = PAD_FORMAT;
+        atomic_store_explicit(&r->size, (uint32_t)pad, memory_order_release);
+        h += pad;
+    }
+    uint8_t *p = g_log.ring + (h & g_log.mask);
+    ring_rec *r = (ring_rec *)p;
+    r->format = (uint16_t)format;
+    r->level = (uint8_t)level;
+    r->intCount = (uint8_t)intCount;
+    r->timeNs = timeNs;
+    if (intCount) memcpy(p + sizeof *r, ints, 8 * (size_t)intCount);
+    if (length) memcpy(p + sizeof *r + 8 * (size_t)intCount, text, length);
+    atomic_store_explicit(&r->size, (uint32_t)size, memory_order_release);
+
+    if (used > cap / 2 && !atomic_exchange_explicit(&g_log.wakeRequested, 1, memory_order_relaxed))
+        pthread_cond_signal(&g_log.wake);
+}
+
+void kc_log_text(kc_log_level level, const void *text, size_t length) {
+    kc_log_write(level, KC_LOG_FMT_TEXT, NULL, 0, text, length);
+}
+
+void kc_log_flush(void) {
+    uint64_t target = atomic_load_explicit(&g_log.head, memory_order_acquire);
+    pthread_mutex_lock(&g_log.lock);
+    if (target > g_log.flushTarget) g_log.flushTarget = target;
+    pthread_cond_signal(&g_log.wake);
+    while (g_log.fd >= 0 && !g_log.stopping && !atomic_load(&g_log.writeError) &&
+           atomic_load_explicit(&g_log.tail, memory_order_acquire) < target)
+        pthread_cond_wait(&g_log.done, &g_log.lock);
+    pthread_mutex_unlock(&g_log.lock);
+}
+
+void kc_log_read_stats(kc_log_stats *out) {
+    out->records = atomic_load_explicit(&g_log.records, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&g_log.dropped, memory_order_relaxed);
+    out->written = atomic_load_explicit(&g_log.written, memory_order_relaxed);
+    out->writes = atomic_load_explicit(&g_log.writes, memory_order_relaxed);
+    out->rotations = atomic_load_explicit(&g_log.rotations, memory_order_relaxed);
+    out->writeError = atomic_load_explicit(&g_log.writeError, memory_order_relaxed);
+}
+
+/* ---- Rendering ---- */
+
+/* "[yyyy-mm-dd hh:mm:ss.mmm] " in local time. The date part is cached per second: the writer
+ * renders many records a second. */
+static size_t put_time(char *out, size_t cap, uint64_t timeNs) {
+    static _Thread_local time_t cachedSec = -1;
+    static _Thread_local char cached[24];
+    time_t sec = (time_t)(timeNs / 1000000000ull);
+    if (sec != cachedSec) {
+        struct tm tm;
+        localtime_r(&sec, &tm);
+        strftime(cached, sizeof cached, "%Y-%m-%d %H:%M:%S", &tm);
+        cachedSec = sec;
+    }
+    int n = snprintf(out, cap, "[%s.%03u] ", cached, (unsigned)(timeNs / 1000000ull % 1000));
+    return n < 0 ? 0 : (size_t)n < cap ? (size_t)n : cap - 1;
+}
+
+size_t kc_log_render(const kc_log_item *item, char *out, size_t cap) {
+    if (cap < 2) {
+        if (cap) out[0] = '\0';
+        return 0;
+    }
+    size_t room = cap - 2;              /* the newline and the NUL */
+    size_t n = put_time(out, room + 1, item->timeNs);
+#define PUT(s, len) do { size_t l_ = (len); if (l_ > room - n) l_ = room - n; memcpy(out + n, (s), l_); n += l_; } while (0)
+    if (item->level == KC_LOG_ERROR) PUT("ERROR: ", 7);
+    int next = 0;
+    for (const char *t = item->templ; *t; t++) {
+        if (t[0] != '%' || !t[1]) {
+            PUT(t, 1);
+            continue;
+        }
+        t++;
+        char num[24];
+        switch (*t) {
+        case 's':
+            if (item->length) PUT(item->text, item->length);
+            break;
+        case 'u':
+        case 'd': {
+            uint64_t v = next < item->intCount ? item->ints[next] : 0;
+            next++;
+            int len = *t == 'u' ? snprintf(num, sizeof num, "%llu", (unsigned long long)v)
+                                : snprintf(num, sizeof num, "%lld", (long long)v);
+            PUT(num, (size_t)len);
+            break;
+        }
+        default:
+            PUT(t, 1);
+            break;
+        }
+    }
+#undef PUT
+    out[n++] = '\n';
+    out[n] = '\0';
+    return n;
+}
+
+/* ---- Reading ---- */
+
+struct kc_log_reader {
+    uint8_t  *data;
+    size_t    size, pos;
+    uint64_t  startNs, timeNs;
+    uint32_t  pid;
+    int       formatCount;
+    char    **templates;
+};
+
+kc_log_reader *kc_log_reader_open(const char *path, char *err, size_t errSize) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        snprintf(err, errSize, "%s: %s", path, strerror(errno));
+        return NULL;
+    }
+    kc_log_reader *r = calloc(1, sizeof *r);
+    struct stat st;
+    if (!r || fstat(fileno(f), &st) != 0 || !(r->data = malloc(st.st_size > 0 ? (size_t)st.st_size : 1))) {
+        snprintf(err, errSize, "%s: out of memory", path);
+        fclose(f);
+        free(r);
+        return NULL;
+    }
+    r->size = fread(r->data, 1, (size_t)st.st_size, f);
+    fclose(f);
+    if (r->size < 22 || memcmp(r->data, MAGIC, 4) != 0) {
+        snprintf(err, errSize, "%s: not a binary log", path);
+        kc_log_reader_close(r);
+        return NULL;
+    }
+    if (get_le32(r->data + 4) != VERSION) {
+        snprintf(err, errSize, "%s: log version %u (this build reads %u)", path,
+                 get_le32(r->data + 4), VERSION);
+        kc_log_reader_close(r);
+        return NULL;
+    }
+    r->startNs = r->timeNs = get_le64(r->data + 8);
+    r->pid = get_le32(r->data + 16);
+    r->formatCount = get_le16(r->data + 20);
+    r->templates = calloc((size_t)r->formatCount + 1, sizeof *r->templates);
+    r->pos = 22;
+    for (int i = 0; r->templates && i < r->formatCount; i++) {
+        size_t len = r->pos + 2 <= r->size ? get_le16(r->data + r->pos) : SIZE_MAX;
+        if (len > r->size - r->pos - 2 || !(r->templates[i] = malloc(len + 1))) {
+            snprintf(err, errSize, "%s: header cut off", path);
+            kc_log_reader_close(r);
+            return NULL;
+        }
+        memcpy(r->templates[i], r->data + r->pos + 2, len);
+        r->templates[i][len] = '\0';
+        r->pos += 2 + len;
+    }
+    if (!r->templates) {
+        snprintf(err, errSize, "%s: out of memory", path);
+        kc_log_reader_close(r);
+        return NULL;
+    }
+    return r;
+}
+
+void kc_log_reader_close(kc_log_reader *r) {
+    if (!r) return;
+    for (int i = 0; r->templates && i < r->formatCount; i++) free(r->templates[i]);
+    free(r->templates);
+    free(r->data);
+    free(r);
+}
+
+uint64_t kc_log_reader_start_ns(const kc_log_reader *r) {
+    return r->startNs;
+}
+
+uint32_t kc_log_reader_pid(const kc_log_reader *r) {
+    return r->pid;
+}
+
+static int get_varint(kc_log_reader *r, uint64_t *out) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (r->pos >= r->size) return -1;
+        uint8_t b = r->data[r->pos++];
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int kc_log_reader_next(kc_log_reader *r, kc_log_item *out) {
+    if (r->pos >= r->size) return 0;
+    if (r->size - r->pos < 2) return -1;
+    int format = r->data[r->pos];
+    int level = r->data[r->pos + 1] & 0x0f, count = r->data[r->pos + 1] >> 4;
+    r->pos += 2;
+    if (format >= r->formatCount || level > KC_LOG_ERROR || count > KC_LOG_MAX_INTS) return -1;
+    uint64_t dt, len;
+    if (get_varint(r, &dt) != 0) return -1;
+    for (int i = 0; i < count; i++)
+        if (get_varint(r, &out->ints[i]) != 0) return -1;
+    if (get_varint(r, &len) != 0 || len > r->size - r->pos) return -1;
+    r->timeNs += dt;
+    out->level = (kc_log_level)level;
+    out->format = format;
+    out->templ = r->templates[format];
+    out->timeNs = r->timeNs;
+    out->intCount = count;
+    out->text = r->data + r->pos;
+    out->length = (uint32_t)len;
+    r->pos += len;
+    return 1;
+}
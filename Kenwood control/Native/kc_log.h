@@ -0,0 +1,138 @@
+/*  kc_log.h
+ *
+ *  The app's diagnostic log file (AppFileLogger), written off the threads
+ *  that log.
+ *
+ *  Logging: kc_log_write copies a binary record into a lock-free ring.
+ *  The record holds the time, a level, a format id from KC_LOG_FORMATS and
+ *  the format's arguments: up to four integers and one byte string.
+ *  Nothing is formatted and no lock is taken; any number of threads can log
+ *  at once. When the ring is full the record is dropped and counted, and
+ *  the file gets a line saying how many were lost.
+ *
+ *  Writing: one thread keeps the file open and drains the ring every
+ *  50 ms, or sooner when it is half full. It writes in large blocks. When
+ *  the file would pass `maxBytes`, it is renamed to path.1 (path.1 to
+ *  path.2, up to `keep`) and a new one is started.
+ *
+ *  The file holds either text or binary records:
+ *
+ *    text     "[2026-10-17 14:03:21.417] RX: FA00014074000;" per record, as
+ *             AppFileLogger always wrote; an existing file is appended to
+ *    binary   the records themselves, smaller and cheaper to write; read
+ *             them with kc_log_reader (kc-log decode). Each open starts a
+ *             new file.
+ *
+ *  Binary file format, little-endian:
+ *
+ *    header   "KCLG"  u32 version (1)  u64 wall-clock start (ns since the
+ *             Unix epoch)  u32 pid  u16 format count, then per format
+ *             u16 length and the template
+ *    record   u8 format   u8 level | integer count << 4
+ *             varint time since the previous record (ns)
+ *             varint per integer   varint length   `length` bytes
+ *
+ *  (varint as in kc_capture.h.) The templates travel with the file, so a
+ *  log decodes the same after KC_LOG_FORMATS changes.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    KC_LOG_DEBUG = 0,
+    KC_LOG_INFO  = 1,
+    KC_LOG_ERROR = 2                    /* rendered with an "ERROR: " prefix */
+} kc_log_level;
+
+/* X(name, template). %s takes the byte string, %u and %d the next integer (unsigned, signed). */
+#define KC_LOG_FORMATS(X)                                       \
+    X(TEXT,      "%s")                                          \
+    X(CAT_RX,    "RX: %s;")             /* frame without ';' */ \
+    X(CAT_TX,    "TX: %s")              /* command as sent */   \
+    X(CAT_SCOPE, "RX: %s... (%u chars)")                        \
+    X(DROPPED,   "=== %u log records dropped (ring full) ===")  \
+    X(ROTATED,   "=== log continues from %s ===")
+
+typedef enum {
+#define KC_LOG_FORMAT_ENUM(name, templ) KC_LOG_FMT_##name,
+    KC_LOG_FORMATS(KC_LOG_FORMAT_ENUM)
+#undef KC_LOG_FORMAT_ENUM
+    KC_LOG_FMT_COUNT
+} kc_log_format;
+
+#define KC_LOG_MAX_INTS 4
+#define KC_LOG_MAX_TEXT 4096            /* longer strings are cut */
+
+/* ---- Logging (process-wide) ---- */
+
+typedef struct kc_log_config {
+    const char *path;
+    int         binary;                 /* 0: text lines; 1: binary records */
+    size_t      maxBytes;               /* rotate before the file passes this; 0: 5 MB */
+    int         keep;                   /* rotated files kept (path.1 ...); 0: 1 */
+    size_t      ringBytes;              /* rounded up to a power of two; 0: 1 MB. Only the first open sizes it */
+} kc_log_config;
+
+/* Opens the file and starts the writer thread. Returns 0, or -1 (errno set; logging stays off). */
+int  kc_log_open(const kc_log_config *config);
+/* Writes out what was logged and closes the file. Also runs at exit. */
+void kc_log_close(void);
+int  kc_log_active(void);
+
+/* Any thread, never blocks. `ints` and `text` may be NULL when their counts are 0. */
+void kc_log_write(kc_log_level level, kc_log_format format,
+                  const uint64_t *ints, int intCount, const void *text, size_t length);
+void kc_log_text(kc_log_level level, const void *text, size_t length);
+
+/* Returns once everything logged before the call is in the file (handed to the kernel; no
+ * fsync), or the log is closed. Blocks. */
+void kc_log_flush(void);
+
+typedef struct kc_log_stats {
+    uint64_t records;                   /* logged */
+    uint64_t dropped;                   /* lost to a full ring */
+    uint64_t written;                   /* bytes written to files */
+    uint64_t writes;                    /* write calls */
+    uint64_t rotations;
+    int      writeError;                /* errno of the first failed write (logging stops), else 0 */
+} kc_log_stats;
+
+void kc_log_read_stats(kc_log_stats *out);
+
+/* ---- Reading binary logs (tools) ---- */
+
+typedef struct kc_log_reader kc_log_reader;
+
+typedef struct kc_log_item {
+    kc_log_level   level;
+    int            format;              /* index into the file's templates */
+    const char    *templ;               /* NUL-terminated; valid until the reader is closed */
+    uint64_t       timeNs;              /* wall clock, ns since the Unix epoch */
+    uint64_t       ints[KC_LOG_MAX_INTS];
+    int            intCount;
+    const uint8_t *text;                /* valid until the reader is closed */
+    uint32_t       length;
+} kc_log_item;
+
+/* Loads the whole file. NULL with a message in err (errSize bytes). */
+kc_log_reader *kc_log_reader_open(const char *path, char *err, size_t errSize);
+void           kc_log_reader_close(kc_log_reader *r);
+
+/* 1 and the next record, 0 at the end, -1 if the file is cut off or corrupt there. */
+int      kc_log_reader_next(kc_log_reader *r, kc_log_item *out);
+uint64_t kc_log_reader_start_ns(const kc_log_reader *r);
+uint32_t kc_log_reader_pid(const kc_log_reader *r);
+
+/* The record as a text-file line ("[time] message\n", local time), cut to fit and
+ * NUL-terminated. Returns the length written. */
+size_t kc_log_render(const kc_log_item *item, char *out, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
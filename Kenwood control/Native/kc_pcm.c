@@ -0,0 +1,419 @@
+/*  kc_pcm.c
+ *
+ *  See kc_pcm.h. Each kernel is a core that takes a byte-swap flag (byte-
+ *  order variants share it); the SIMD cores handle whole vectors and finish
+ *  the tail with the scalar core. Dither is generated a block at a time into
+ *  a stack buffer, which the cores add before rounding.
+ */
+
+#include "kc_pcm.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define KC_PCM_HAVE_NEON 1
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(_M_X64)
+#define KC_PCM_HAVE_X86 1
+#include <immintrin.h>
+/* AVX2 kernels finish their tails with the SSE2 ones; GCC doesn't put a vzeroupper before a
+ * tail call, so they clear the upper halves themselves to avoid the transition stall. */
+#define AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define HOST_BE 1
+#else
+#define HOST_BE 0
+#endif
+
+#define DITHER_BLOCK 256
+
+/* ---- Scalar ---- */
+
+static inline uint16_t swap16(uint16_t v) { return (uint16_t)((v << 8) | (v >> 8)); }
+
+static inline int16_t sat_round(float x) {
+    if (!(x > -32768.0f)) return INT16_MIN;     /* also NaN */
+    if (x >= 32767.0f) return INT16_MAX;
+    return (int16_t)lrintf(x);
+}
+
+static void s2f_scalar(const uint8_t *in, float *out, size_t n, float scale, int swap) {
+    for (size_t i = 0; i < n; i++) {
+        uint16_t v;
+        memcpy(&v, in + 2 * i, 2);
+        if (swap) v = swap16(v);
+        out[i] = (float)(int16_t)v * scale;
+    }
+}
+
+static void f2s_scalar(const float *in, uint8_t *out, size_t n, float scale, const float *dith, int swap) {
+    for (size_t i = 0; i < n; i++) {
+        uint16_t v = (uint16_t)sat_round(in[i] * scale + (dith ? dith[i] : 0.0f));
+        if (swap) v = swap16(v);
+        memcpy(out + 2 * i, &v, 2);
+    }
+}
+
+static void scale_scalar(const float *in, float *out, size_t n, float scale) {
+    for (size_t i = 0; i < n; i++) out[i] = in[i] * scale;
+}
+
+static void interleave_scalar(const float *l, const float *r, float *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[2 * i] = l[i];
+        out[2 * i + 1] = r[i];
+    }
+}
+
+static void deinterleave_scalar(const float *in, float *l, float *r, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        l[i] = in[2 * i];
+        r[i] = in[2 * i + 1];
+    }
+}
+
+/* ---- NEON ---- */
+
+#if KC_PCM_HAVE_NEON
+static void s2f_neon(const uint8_t *in, float *out, size_t n, float scale, int swap) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint8x16_t b = vld1q_u8(in + 2 * i);
+        if (swap) b = vrev16q_u8(b);
+        int16x8_t v = vreinterpretq_s16_u8(b);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(v)), scale));
+    }
+    s2f_scalar(in + 2 * i, out + i, n - i, scale, swap);
+}
+
+static inline int32x4_t f2i_neon(float32x4_t x, float scale, const float *dith) {
+    x = vmulq_n_f32(x, scale);
+    if (dith) x = vaddq_f32(x, vld1q_f32(dith));
+    /* vmaxnm picks the number over NaN, so NaN saturates low like the scalar path. */
+    x = vminq_f32(vmaxnmq_f32(x, vdupq_n_f32(-32768.0f)), vdupq_n_f32(32767.0f));
+    return vcvtnq_s32_f32(x);
+}
+
+static void f2s_neon(const float *in, uint8_t *out, size_t n, float scale, const float *dith, int swap) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int32x4_t a = f2i_neon(vld1q_f32(in + i), scale, dith ? dith + i : NULL);
+        int32x4_t b = f2i_neon(vld1q_f32(in + i + 4), scale, dith ? dith + i + 4 : NULL);
+        uint8x16_t v = vreinterpretq_u8_s16(vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+        if (swap) v = vrev16q_u8(v);
+        vst1q_u8(out + 2 * i, v);
+    }
+    f2s_scalar(in + i, out + 2 * i, n - i, scale, dith ? dith + i : NULL, swap);
+}
+
+static void scale_neon(const float *in, float *out, size_t n, float scale) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) vst1q_f32(out + i, vmulq_n_f32(vld1q_f32(in + i), scale));
+    scale_scalar(in + i, out + i, n - i, scale);
+}
+
+static void interleave_neon(const float *l, const float *r, float *out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t v = { { vld1q_f32(l + i), vld1q_f32(r + i) } };
+        vst2q_f32(out + 2 * i, v);
+    }
+    interleave_scalar(l + i, r + i, out + 2 * i, n - i);
+}
+
+static void deinterleave_neon(const float *in, float *l, float *r, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t v = vld2q_f32(in + 2 * i);
+        vst1q_f32(l + i, v.val[0]);
+        vst1q_f32(r + i, v.val[1]);
+    }
+    deinterleave_scalar(in + 2 * i, l + i, r + i, n - i);
+}
+#endif
+
+/* ---- SSE2 / AVX2 ---- */
+
+#if KC_PCM_HAVE_X86
+static inline __m128i swap16_sse2(__m128i v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+static void s2f_sse2(const uint8_t *in, float *out, size_t n, float scale, int swap) {
+    const __m128 k = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + 2 * i));
+        if (swap) v = swap16_sse2(v);
+        /* Sign-extend: put each sample in the top half of a 32-bit lane, shift it back down. */
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), k));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), k));
+    }
+    s2f_scalar(in + 2 * i, out + i, n - i, scale, swap);
+}
+
+/* _mm_max_ps returns its second operand when either is NaN, so NaN saturates low. */
+static inline __m128i f2i_sse2(__m128 x, __m128 k, const float *dith) {
+    x = _mm_mul_ps(x, k);
+    if (dith) x = _mm_add_ps(x, _mm_loadu_ps(dith));
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+    return _mm_cvtps_epi32(x);
+}
+
+static void f2s_sse2(const float *in, uint8_t *out, size_t n, float scale, const float *dith, int swap) {
+    const __m128 k = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = f2i_sse2(_mm_loadu_ps(in + i), k, dith ? dith + i : NULL);
+        __m128i b = f2i_sse2(_mm_loadu_ps(in + i + 4), k, dith ? dith + i + 4 : NULL);
+        __m128i v = _mm_packs_epi32(a, b);
+        if (swap) v = swap16_sse2(v);
+        _mm_storeu_si128((__m128i *)(out + 2 * i), v);
+    }
+    f2s_scalar(in + i, out + 2 * i, n - i, scale, dith ? dith + i : NULL, swap);
+}
+
+static void scale_sse2(const float *in, float *out, size_t n, float scale) {
+    const __m128 k = _mm_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), k));
+    scale_scalar(in + i, out + i, n - i, scale);
+}
+
+static void interleave_sse2(const float *l, const float *r, float *out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps(l + i), b = _mm_loadu_ps(r + i);
+        _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(a, b));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(a, b));
+    }
+    interleave_scalar(l + i, r + i, out + 2 * i, n - i);
+}
+
+static void deinterleave_sse2(const float *in, float *l, float *r, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps(in + 2 * i), b = _mm_loadu_ps(in + 2 * i + 4);
+        _mm_storeu_ps(l + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(r + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    deinterleave_scalar(in + 2 * i, l + i, r + i, n - i);
+}
+
+AVX2 static void s2f_avx2(const uint8_t *in, float *out, size_t n, float scale, int swap) {
+    const __m256 k = _mm256_set1_ps(scale);
+    const __m128i bswap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(in + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(in + 2 * i + 16));
+        if (swap) {
+            a = _mm_shuffle_epi8(a, bswap);
+            b = _mm_shuffle_epi8(b, bswap);
+        }
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), k));
+        _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), k));
+    }
+    _mm256_zeroupper();
+    s2f_sse2(in + 2 * i, out + i, n - i, scale, swap);
+}
+
+AVX2 static inline __m256i f2i_avx2(__m256 x, __m256 k, const float *dith) {
+    x = _mm256_mul_ps(x, k);
+    if (dith) x = _mm256_add_ps(x, _mm256_loadu_ps(dith));
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f));
+    return _mm256_cvtps_epi32(x);
+}
+
+AVX2 static void f2s_avx2(const float *in, uint8_t *out, size_t n, float scale, const float *dith, int swap) {
+    const __m256 k = _mm256_set1_ps(scale);
+    const __m256i bswap = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                           1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i a = f2i_avx2(_mm256_loadu_ps(in + i), k, dith ? dith + i : NULL);
+        __m256i b = f2i_avx2(_mm256_loadu_ps(in + i + 8), k, dith ? dith + i + 8 : NULL);
+        /* packs works within 128-bit lanes; put the four 64-bit groups back in order. */
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        if (swap) v = _mm256_shuffle_epi8(v, bswap);
+        _mm256_storeu_si256((__m256i *)(out + 2 * i), v);
+    }
+    _mm256_zeroupper();
+    f2s_sse2(in + i, out + 2 * i, n - i, scale, dith ? dith + i : NULL, swap);
+}
+
+AVX2 static void scale_avx2(const float *in, float *out, size_t n, float scale) {
+    const __m256 k = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(in + i), k));
+    _mm256_zeroupper();
+    scale_sse2(in + i, out + i, n - i, scale);
+}
+#endif
+
+/* ---- Dispatch ---- */
+
+static _Atomic int g_isa = -1;
+
+kc_pcm_isa kc_pcm_best_isa(void) {
+#if KC_PCM_HAVE_NEON
+    return KC_PCM_NEON;
+#elif KC_PCM_HAVE_X86
+    return __builtin_cpu_supports("avx2") ? KC_PCM_AVX2 : KC_PCM_SSE2;
+#else
+    return KC_PCM_SCALAR;
+#endif
+}
+
+kc_pcm_isa kc_pcm_current_isa(void) {
+    int isa = atomic_load_explicit(&g_isa, memory_order_relaxed);
+    if (isa < 0) {
+        isa = (int)kc_pcm_best_isa();
+        atomic_store_explicit(&g_isa, isa, memory_order_relaxed);
+    }
+    return (kc_pcm_isa)isa;
+}
+
+int kc_pcm_use_isa(kc_pcm_isa isa) {
+    kc_pcm_isa best = kc_pcm_best_isa();
+    int ok = isa == KC_PCM_SCALAR || isa == best || (isa == KC_PCM_SSE2 && best == KC_PCM_AVX2);
+    if (!ok) return -1;
+    atomic_store_explicit(&g_isa, (int)isa, memory_order_relaxed);
+    return 0;
+}
+
+const char *kc_pcm_isa_name(kc_pcm_isa isa) {
+    switch (isa) {
+    case KC_PCM_SCALAR: return "scalar";
+    case KC_PCM_SSE2:   return "sse2";
+    case KC_PCM_AVX2:   return "avx2";
+    case KC_PCM_NEON:   return "neon";
+    }
+    return "?";
+}
+
+static void s2f(const void *in, float *out, size_t n, float scale, int swap) {
+    switch (kc_pcm_current_isa()) {
+#if KC_PCM_HAVE_NEON
+    case KC_PCM_NEON: s2f_neon(in, out, n, scale, swap); return;
+#endif
+#if KC_PCM_HAVE_X86
+    case KC_PCM_AVX2: s2f_avx2(in, out, n, scale, swap); return;
+    case KC_PCM_SSE2: s2f_sse2(in, out, n, scale, swap); return;
+#endif
+    default: s2f_scalar(in, out, n, scale, swap); return;
+    }
+}
+
+static void f2s_block(const float *in, uint8_t *out, size_t n, float scale, const float *dith, int swap) {
+    switch (kc_pcm_current_isa()) {
+#if KC_PCM_HAVE_NEON
+    case KC_PCM_NEON: f2s_neon(in, out, n, scale, dith, swap); return;
+#endif
+#if KC_PCM_HAVE_X86
+    case KC_PCM_AVX2: f2s_avx2(in, out, n, scale, dith, swap); return;
+    case KC_PCM_SSE2: f2s_sse2(in, out, n, scale, dith, swap); return;
+#endif
+    default: f2s_scalar(in, out, n, scale, dith, swap); return;
+    }
+}
+
+void kc_pcm_dither_init(kc_pcm_dither *d, uint32_t seed) {
+    uint32_t x = seed ? seed : 0x9e3779b9u;
+    for (int k = 0; k < KC_PCM_DITHER_LANES; k++) {
+        x = x * 1664525u + 1013904223u;
+        d->state[k] = x ? x : 1;
+    }
+}
+
+/* Four xorshift32 generators in lock step (the compiler can keep them in one vector); each draw
+ * gives two 16-bit uniforms, whose difference is triangular on (-1, 1). `n` is a multiple of 4. */
+static void dither_fill(kc_pcm_dither *d, float *out, size_t n) {
+    uint32_t s[KC_PCM_DITHER_LANES];
+    memcpy(s, d->state, sizeof s);
+    for (size_t i = 0; i < n; i += KC_PCM_DITHER_LANES) {
+        for (int k = 0; k < KC_PCM_DITHER_LANES; k++) {
+            uint32_t x = s[k];
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            s[k] = x;
+            out[i + k] = (float)((int32_t)(x & 0xffff) - (int32_t)(x >> 16)) * (1.0f / 65536.0f);
+        }
+    }
+    memcpy(d->state, s, sizeof s);
+}
+
+static void f2s(const float *in, void *out, size_t n, float scale, kc_pcm_dither *d, int swap) {
+    uint8_t *o = out;
+    if (!d) {
+        f2s_block(in, o, n, scale, NULL, swap);
+        return;
+    }
+    float dith[DITHER_BLOCK];
+    for (size_t i = 0; i < n; i += DITHER_BLOCK) {
+        size_t m = n - i < DITHER_BLOCK ? n - i : DITHER_BLOCK;
+        dither_fill(d, dith, (m + 3) & ~(size_t)3);
+        f2s_block(in + i, o + 2 * i, m, scale, dith, swap);
+    }
+}
+
+void kc_pcm_s16_to_f32(const int16_t *in, float *out, size_t n, float scale) { s2f(in, out, n, scale, 0); }
+void kc_pcm_s16le_to_f32(const void *in, float *out, size_t n, float scale) { s2f(in, out, n, scale, HOST_BE); }
+void kc_pcm_s16be_to_f32(const void *in, float *out, size_t n, float scale) { s2f(in, out, n, scale, !HOST_BE); }
+
+void kc_pcm_f32_to_s16(const float *in, int16_t *out, size_t n, float scale, kc_pcm_dither *dither) {
+    f2s(in, out, n, scale, dither, 0);
+}
+void kc_pcm_f32_to_s16le(const float *in, void *out, size_t n, float scale, kc_pcm_dither *dither) {
+    f2s(in, out, n, scale, dither, HOST_BE);
+}
+void kc_pcm_f32_to_s16be(const float *in, void *out, size_t n, float scale, kc_pcm_dither *dither) {
+    f2s(in, out, n, scale, dither, !HOST_BE);
+}
+
+void kc_pcm_scale_f32(const float *in, float *out, size_t n, float scale) {
+    switch (kc_pcm_current_isa()) {
+#if KC_PCM_HAVE_NEON
+    case KC_PCM_NEON: scale_neon(in, out, n, scale); return;
+#endif
+#if KC_PCM_HAVE_X86
+    case KC_PCM_AVX2: scale_avx2(in, out, n, scale); return;
+    case KC_PCM_SSE2: scale_sse2(in, out, n, scale); return;
+#endif
+    default: scale_scalar(in, out, n, scale); return;
+    }
+}
+
+void kc_pcm_interleave2_f32(const float *left, const float *right, float *out, size_t n) {
+    switch (kc_pcm_current_isa()) {
+#if KC_PCM_HAVE_NEON
+    case KC_PCM_NEON: interleave_neon(left, right, out, n); return;
+#endif
+#if KC_PCM_HAVE_X86
+    case KC_PCM_AVX2:
+    case KC_PCM_SSE2: interleave_sse2(left, right, out, n); return;
+#endif
+    default: interleave_scalar(left, right, out, n); return;
+    }
+}
+
+void kc_pcm_deinterleave2_f32(const float *in, float *left, float *right, size_t n) {
+    switch (kc_pcm_current_isa()) {
+#if KC_PCM_HAVE_NEON
+    case KC_PCM_NEON: deinterleave_neon(in, left, right, n); return;
+#endif
+#if KC_PCM_HAVE_X86
+    case KC_PCM_AVX2:
+    case KC_PCM_SSE2: deinterleave_sse2(in, left, right, n); return;
+#endif
+    default: deinterleave_scalar(in, left, right, n); return;
+    }
+}
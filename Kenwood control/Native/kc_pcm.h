@@ -0,0 +1,63 @@
+/*  kc_pcm.h
+ *
+ *  Sample-format conversion kernels: 16-bit PCM (native, little- or
+ *  big-endian bytes) to and from float, float scaling, and stereo
+ *  interleaving. Every conversion takes a scale factor, so a call site
+ *  converts and normalises (÷32768, ×32767, ...) in one pass.
+ *
+ *  Float to 16-bit rounds to nearest (ties to even) and saturates; NaN
+ *  becomes the negative limit. Optional TPDF dither adds ±1 LSB triangular
+ *  noise before rounding.
+ *
+ *  Each kernel has NEON (arm64), SSE2 and AVX2 (x86-64; AVX2 is chosen at
+ *  run time) and scalar versions, all giving the same results. Byte-order
+ *  variants don't need aligned pointers. Nothing allocates; any thread.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 16-bit to float: out[i] = in[i] * scale. */
+void kc_pcm_s16_to_f32(const int16_t *in, float *out, size_t n, float scale);
+void kc_pcm_s16le_to_f32(const void *in, float *out, size_t n, float scale);
+void kc_pcm_s16be_to_f32(const void *in, float *out, size_t n, float scale);
+
+/* TPDF dither state: a seeded generator, one per stream. */
+#define KC_PCM_DITHER_LANES 4
+typedef struct kc_pcm_dither { uint32_t state[KC_PCM_DITHER_LANES]; } kc_pcm_dither;
+void kc_pcm_dither_init(kc_pcm_dither *d, uint32_t seed);
+
+/* Float to 16-bit: round(in[i] * scale), saturated. `dither` may be NULL. */
+void kc_pcm_f32_to_s16(const float *in, int16_t *out, size_t n, float scale, kc_pcm_dither *dither);
+void kc_pcm_f32_to_s16le(const float *in, void *out, size_t n, float scale, kc_pcm_dither *dither);
+void kc_pcm_f32_to_s16be(const float *in, void *out, size_t n, float scale, kc_pcm_dither *dither);
+
+/* out[i] = in[i] * scale; in and out may be the same buffer. */
+void kc_pcm_scale_f32(const float *in, float *out, size_t n, float scale);
+
+/* n frames of two channels. */
+void kc_pcm_interleave2_f32(const float *left, const float *right, float *out, size_t n);
+void kc_pcm_deinterleave2_f32(const float *in, float *left, float *right, size_t n);
+
+/* Which code path runs. kc_pcm_use_isa is for benchmarks and tests: it returns -1 (and changes
+ * nothing) if this CPU or build can't run `isa`. */
+typedef enum {
+    KC_PCM_SCALAR,
+    KC_PCM_SSE2,
+    KC_PCM_AVX2,
+    KC_PCM_NEON
+} kc_pcm_isa;
+
+kc_pcm_isa  kc_pcm_best_isa(void);
+kc_pcm_isa  kc_pcm_current_isa(void);
+int         kc_pcm_use_isa(kc_pcm_isa isa);
+const char *kc_pcm_isa_name(kc_pcm_isa isa);
+
+#ifdef __cplusplus
+}
+#endif
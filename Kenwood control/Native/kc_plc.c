@@ -0,0 +1,154 @@
+/*  kc_plc.c
+ *
+ *  See kc_plc.h. The history is two maximum pitch periods long: the pitch
+ *  search compares the last period with every lag up to one period back.
+ */
+
+#include "kc_plc.h"
+#include "pitch.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+struct kc_plc {
+    int    rate, frame;
+    int    minPeriod, maxPeriod;    /* samples: 400 Hz and 50 Hz */
+    int    histLen;                 /* 2 * maxPeriod */
+    int    holdSamples;             /* full level after a loss starts */
+    int    fadeVoiced, fadeUnvoiced;
+
+    float *hist;
+    float *lp;                      /* half-rate copy for the pitch search */
+    float *period;
+    int    haveHistory;
+
+    int    T, phase;
+    int    voiced;
+    int    concealed;               /* samples since the loss started */
+    int    lostFrames;
+
+    /* Carried between searches, as RNNoise does, so the period doesn't jump an octave. */
+    int    prevT;
+    float  prevGain;
+};
+
+kc_plc *kc_plc_create(int sampleRate, int frameSamples) {
+    if (sampleRate < 8000 || sampleRate > 48000 || frameSamples < 1) return NULL;
+    kc_plc *plc = calloc(1, sizeof *plc);
+    if (!plc) return NULL;
+    plc->rate = sampleRate;
+    plc->frame = frameSamples;
+    plc->maxPeriod = (sampleRate / 50) & ~1;
+    plc->minPeriod = sampleRate / 400;
+    plc->histLen = 2 * plc->maxPeriod;
+    plc->holdSamples = sampleRate / 100;
+    plc->fadeVoiced = sampleRate / 20;
+    plc->fadeUnvoiced = sampleRate / 50;
+    plc->hist = calloc((size_t)plc->histLen, sizeof(float));
+    plc->lp = calloc((size_t)plc->histLen / 2, sizeof(float));
+    plc->period = calloc((size_t)plc->maxPeriod, sizeof(float));
+    if (!plc->hist || !plc->lp || !plc->period) {
+        kc_plc_destroy(plc);
+        return NULL;
+    }
+    kc_plc_reset(plc);
+    return plc;
+}
+
+void kc_plc_destroy(kc_plc *plc) {
+    if (!plc) return;
+    free(plc->hist);
+    free(plc->lp);
+    free(plc->period);
+    free(plc);
+}
+
+void kc_plc_reset(kc_plc *plc) {
+    memset(plc->hist, 0, (size_t)plc->histLen * sizeof(float));
+    plc->haveHistory = 0;
+    plc->concealed = 0;
+    plc->lostFrames = 0;
+    plc->prevT = plc->maxPeriod / 2;
+    plc->prevGain = 0;
+}
+
+static void start_concealment(kc_plc *plc) {
+    const int L = plc->histLen;
+
+    float *x[1] = { plc->hist };
+    rnn_pitch_downsample(x, plc->lp, L, 1);
+    int pitch;
+    rnn_pitch_search(plc->lp + plc->maxPeriod / 2, plc->lp, plc->maxPeriod,
+                     plc->maxPeriod - plc->minPeriod, &pitch);
+    int T = plc->maxPeriod - pitch;
+    float gain = rnn_remove_doubling(plc->lp, plc->maxPeriod, plc->minPeriod, plc->maxPeriod,
+                                     &T, plc->prevT, plc->prevGain);
+    if (T < plc->minPeriod) T = plc->minPeriod;
+    if (T > plc->maxPeriod - 1) T = plc->maxPeriod - 1;
+    plc->prevT = T;
+    plc->prevGain = gain;
+    plc->T = T;
+    plc->voiced = gain >= 0.5f;
+
+    /* The last period, with its tail blended towards the samples just before its head so the
+     * loop point is continuous. */
+    const float *h = plc->hist;
+    memcpy(plc->period, h + L - T, (size_t)T * sizeof(float));
+    int ov = T / 4;
+    for (int k = 0; k < ov; k++) {
+        float w = (k + 0.5f) / (float)ov;
+        plc->period[T - ov + k] = (1.0f - w) * h[L - ov + k] + w * h[L - T - ov + k];
+    }
+    plc->phase = 0;
+}
+
+static float next_sample(kc_plc *plc) {
+    int e = plc->concealed++;
+    float g = 1.0f;
+    if (e >= plc->holdSamples) {
+        int fade = plc->voiced ? plc->fadeVoiced : plc->fadeUnvoiced;
+        g = 1.0f - (float)(e - plc->holdSamples) / (float)fade;
+        if (g <= 0.0f) return 0.0f;
+    }
+    float v = plc->period[plc->phase] * g;
+    if (++plc->phase == plc->T) plc->phase = 0;
+    return v;
+}
+
+void kc_plc_conceal(kc_plc *plc, float *out) {
+    plc->lostFrames++;
+    if (!plc->haveHistory) {
+        memset(out, 0, (size_t)plc->frame * sizeof(float));
+        return;
+    }
+    if (plc->concealed == 0) start_concealment(plc);
+    for (int i = 0; i < plc->frame; i++) out[i] = next_sample(plc);
+}
+
+void kc_plc_good(kc_plc *plc, float *frame) {
+    if (plc->lostFrames > 0 && plc->haveHistory) {
+        int xf = plc->rate / 200 + (plc->lostFrames - 1) * plc->rate / 400;
+        if (xf > plc->rate / 100) xf = plc->rate / 100;
+        if (xf > plc->frame) xf = plc->frame;
+        for (int i = 0; i < xf; i++) {
+            float w = 0.5f - 0.5f * cosf((float)M_PI * (i + 0.5f) / (float)xf);
+            frame[i] = w * frame[i] + (1.0f - w) * next_sample(plc);
+        }
+    }
+    plc->lostFrames = 0;
+    plc->concealed = 0;
+
+    const int L = plc->histLen, n = plc->frame;
+    if (n >= L) {
+        memcpy(plc->hist, frame + n - L, (size_t)L * sizeof(float));
+    } else {
+        memmove(plc->hist, plc->hist + n, (size_t)(L - n) * sizeof(float));
+        memcpy(plc->hist + L - n, frame, (size_t)n * sizeof(float));
+    }
+    plc->haveHistory = 1;
+}
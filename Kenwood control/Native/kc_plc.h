@@ -0,0 +1,46 @@
+/*  kc_plc.h
+ *
+ *  Packet-loss concealment for the LAN RX stream, on decoded mono float
+ *  frames before upsampling.
+ *
+ *  Every good frame goes through kc_plc_good, which keeps the recent audio.
+ *  When a frame is missing, kc_plc_conceal writes a replacement:
+ *
+ *    - the first missing frame looks for the pitch period of the last 40 ms
+ *      (RNNoise's pitch search and doubling check, from pitch.c) and cuts one
+ *      period out of the history, cross-faded at its ends so it loops
+ *      without a step;
+ *    - missing frames repeat that period, at full level for 10 ms, then
+ *      fading out to silence by 60 ms after the loss (30 ms when the history
+ *      wasn't voiced, where repetition sounds like a buzz);
+ *    - the next good frame fades in over 5 ms (plus 2.5 ms per further
+ *      missing frame, up to 10 ms) while the repetition fades out.
+ *
+ *  One thread uses a kc_plc. Nothing allocates after kc_plc_create; a
+ *  concealment that starts costs one pitch search, the rest are copies.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct kc_plc kc_plc;
+
+/* `frameSamples` per call, at `sampleRate` (8–48 kHz). NULL on bad arguments. */
+kc_plc *kc_plc_create(int sampleRate, int frameSamples);
+void    kc_plc_destroy(kc_plc *plc);
+
+/* Forget the history (a new stream). */
+void kc_plc_reset(kc_plc *plc);
+
+/* A frame that arrived. Cross-fades its start in place if the previous frame was concealed. */
+void kc_plc_good(kc_plc *plc, float *frame);
+
+/* Writes one frame of concealment to `out`. */
+void kc_plc_conceal(kc_plc *plc, float *out);
+
+#ifdef __cplusplus
+}
+#endif
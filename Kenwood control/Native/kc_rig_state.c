@@ -0,0 +1,256 @@
+/*  kc_rig_state.c
+ *
+ *  See kc_rig_state.h. The store's fields are relaxed atomics inside the
+ *  seqlock, so a reader racing a writer reads stale or mixed values (and
+ *  retries) rather than being undefined behaviour.
+ */
+
+#include "kc_rig_state.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_VERSION 1
+
+#define FIELD_TAG(id, tag, cmd)  [KC_RIG_##id] = tag,
+#define FIELD_CMD(id, tag, cmd)  [KC_RIG_##id] = KC_CAT_##cmd,
+#define FIELD_NAME(id, tag, cmd) [KC_RIG_##id] = #id,
+
+static const uint8_t    kTags[KC_RIG_FIELD_COUNT] = { KC_RIG_FIELDS(FIELD_TAG) };
+static const uint8_t    kCommands[KC_RIG_FIELD_COUNT] = { KC_RIG_FIELDS(FIELD_CMD) };
+static const char *const kNames[KC_RIG_FIELD_COUNT] = { KC_RIG_FIELDS(FIELD_NAME) };
+
+_Static_assert(KC_RIG_FIELD_COUNT <= 64, "valid is a 64-bit mask");
+_Static_assert(4 + 1 + 1 + KC_RIG_FIELD_COUNT * 11 + 4 <= KC_RIG_SNAPSHOT_MAX, "snapshot buffer size");
+
+static uint32_t fnv1a(const uint8_t *p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+size_t kc_rig_snapshot_encode(const kc_rig_values *values, uint8_t *buf, size_t capacity) {
+    if (capacity < KC_RIG_SNAPSHOT_MAX) return 0;
+    uint8_t *q = buf;
+    memcpy(q, "KCRS", 4);
+    q += 4;
+    *q++ = SNAPSHOT_VERSION;
+    uint8_t *count = q++;
+    *count = 0;
+    for (int f = 0; f < KC_RIG_FIELD_COUNT; f++) {
+        if (!(values->valid >> f & 1) || kTags[f] == 0) continue;
+        *q++ = kTags[f];
+        uint64_t z = ((uint64_t)values->v[f] << 1) ^ (uint64_t)(values->v[f] >> 63);
+        do {
+            uint8_t b = z & 0x7f;
+            z >>= 7;
+            *q++ = z ? b | 0x80 : b;
+        } while (z);
+        (*count)++;
+    }
+    uint32_t h = fnv1a(buf, (size_t)(q - buf));
+    for (int i = 0; i < 4; i++) *q++ = (uint8_t)(h >> (8 * i));
+    return (size_t)(q - buf);
+}
+
+int kc_rig_snapshot_decode(const uint8_t *buf, size_t length, kc_rig_values *out) {
+    memset(out, 0, sizeof *out);
+    if (length < 10 || memcmp(buf, "KCRS", 4) != 0 || buf[4] != SNAPSHOT_VERSION) return -1;
+    const uint8_t *end = buf + length - 4;
+    uint32_t h = (uint32_t)end[0] | (uint32_t)end[1] << 8 | (uint32_t)end[2] << 16 | (uint32_t)end[3] << 24;
+    if (h != fnv1a(buf, length - 4)) return -1;
+
+    const uint8_t *p = buf + 6;
+    for (int n = buf[5]; n > 0; n--) {
+        if (p >= end) return -1;
+        uint8_t tag = *p++;
+        uint64_t z = 0;
+        int shift = 0;
+        for (;;) {
+            if (p >= end || shift > 63) return -1;
+            uint8_t b = *p++;
+            z |= (uint64_t)(b & 0x7f) << shift;
+            shift += 7;
+            if (!(b & 0x80)) break;
+        }
+        for (int f = 0; f < KC_RIG_FIELD_COUNT && tag != 0; f++) {
+            if (kTags[f] != tag) continue;
+            out->v[f] = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+            out->valid |= 1ull << f;
+            break;
+        }
+    }
+    return p == end ? 0 : -1;
+}
+
+uint64_t kc_rig_values_diff(const kc_rig_values *a, const kc_rig_values *b) {
+    uint64_t diff = a->valid ^ b->valid;
+    uint64_t both = a->valid & b->valid;
+    for (int f = 0; f < KC_RIG_FIELD_COUNT; f++)
+        if ((both >> f & 1) && a->v[f] != b->v[f]) diff |= 1ull << f;
+    return diff;
+}
+
+uint64_t kc_rig_snapshot_fields(void) {
+    uint64_t mask = 0;
+    for (int f = 0; f < KC_RIG_FIELD_COUNT; f++)
+        if (kTags[f] != 0) mask |= 1ull << f;
+    return mask;
+}
+
+uint64_t kc_rig_fields_of(kc_cat_cmd cmd) {
+    uint64_t mask = 0;
+    for (int f = 0; f < KC_RIG_FIELD_COUNT; f++)
+        if (kCommands[f] == cmd) mask |= 1ull << f;
+    return mask;
+}
+
+const char *kc_rig_field_name(kc_rig_field field) {
+    return field >= 0 && field < KC_RIG_FIELD_COUNT ? kNames[field] : "";
+}
+
+/* ---- Store ---- */
+
+struct kc_rig_store {
+    pthread_mutex_t  writer;
+    _Atomic uint64_t seq;                               /* odd while a write is in progress */
+    _Atomic uint64_t valid;
+    _Atomic int64_t  v[KC_RIG_FIELD_COUNT];
+    _Atomic uint64_t changedAt[KC_RIG_FIELD_COUNT];    /* seq after the field's last change */
+    _Atomic uint64_t seen;
+};
+
+kc_rig_store *kc_rig_store_create(void) {
+    kc_rig_store *s = calloc(1, sizeof *s);
+    if (!s) return NULL;
+    if (pthread_mutex_init(&s->writer, NULL) != 0) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+void kc_rig_store_destroy(kc_rig_store *s) {
+    if (!s) return;
+    pthread_mutex_destroy(&s->writer);
+    free(s);
+}
+
+/* Writes the fields in `mask` (known ones from `values`, the rest unknown) in one section. */
+static void write_fields(kc_rig_store *s, uint64_t mask, const kc_rig_values *values) {
+    pthread_mutex_lock(&s->writer);
+    uint64_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    uint64_t valid = atomic_load_explicit(&s->valid, memory_order_relaxed);
+    uint64_t changed = 0;
+    for (int f = 0; f < KC_RIG_FIELD_COUNT; f++) {
+        uint64_t bit = 1ull << f;
+        if (!(mask & bit)) continue;
+        int known = (values->valid & bit) != 0;
+        if (known != ((valid & bit) != 0) ||
+            (known && atomic_load_explicit(&s->v[f], memory_order_relaxed) != values->v[f]))
+            changed |= bit;
+    }
+    atomic_fetch_or_explicit(&s->seen, mask, memory_order_relaxed);
+    if (changed) {
+        atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        for (int f = 0; f < KC_RIG_FIELD_COUNT; f++) {
+            if (!(changed >> f & 1)) continue;
+            atomic_store_explicit(&s->v[f], values->valid >> f & 1 ? values->v[f] : 0, memory_order_relaxed);
+            atomic_store_explicit(&s->changedAt[f], seq + 2, memory_order_relaxed);
+        }
+        atomic_store_explicit(&s->valid, (valid & ~changed) | (values->valid & changed), memory_order_relaxed);
+        atomic_store_explicit(&s->seq, seq + 2, memory_order_release);
+    }
+    pthread_mutex_unlock(&s->writer);
+}
+
+void kc_rig_store_set(kc_rig_store *s, kc_rig_field field, int64_t value, int known) {
+    if (field < 0 || field >= KC_RIG_FIELD_COUNT) return;
+    kc_rig_values values = { 0 };
+    values.v[field] = value;
+    if (known) values.valid = 1ull << field;
+    write_fields(s, 1ull << field, &values);
+}
+
+void kc_rig_store_load(kc_rig_store *s, const kc_rig_values *values) {
+    write_fields(s, KC_RIG_FIELD_COUNT == 64 ? ~0ull : (1ull << KC_RIG_FIELD_COUNT) - 1, values);
+}
+
+#define PUT(field, value) (r.v[KC_RIG_##field] = (value), r.valid |= 1ull << KC_RIG_##field)
+
+uint64_t kc_rig_store_apply(kc_rig_store *s, const kc_cat_msg *m) {
+    kc_rig_values r = { 0 };
+    const int64_t *v = m->v;
+    switch (m->cmd) {
+    case KC_CAT_FA: if (kc_cat_has(m, 0)) PUT(VFO_A, v[0]); break;
+    case KC_CAT_FB: if (kc_cat_has(m, 0)) PUT(VFO_B, v[0]); break;
+    case KC_CAT_OM: if (kc_cat_has(m, 1) && v[1] >= 1 && v[1] <= 7) PUT(MODE, v[1]); break;  /* OperatingMode */
+    case KC_CAT_FR: if (kc_cat_has(m, 0) && v[0] <= 1) PUT(RX_VFO, v[0]); break;
+    case KC_CAT_FT: if (kc_cat_has(m, 0) && v[0] <= 1) PUT(TX_VFO, v[0]); break;
+    case KC_CAT_NR: if (kc_cat_has(m, 0) && v[0] <= 2) PUT(NR_MODE, v[0]); break;
+    case KC_CAT_RT: if (kc_cat_has(m, 0)) PUT(RIT, v[0] == 1); break;
+    case KC_CAT_XT: if (kc_cat_has(m, 0)) PUT(XIT, v[0] == 1); break;
+    case KC_CAT_RF: if (kc_cat_has(m, 0) && kc_cat_has(m, 1)) PUT(RIT_XIT_OFFSET, v[0] == 1 ? -v[1] : v[1]); break;
+    case KC_CAT_IS: if (kc_cat_has(m, 0)) PUT(FILTER_SHIFT, v[0]); break;
+    case KC_CAT_SL: if (kc_cat_has(m, 0) && v[0] == 0 && kc_cat_has(m, 1)) PUT(LOW_CUT, v[1]); break;
+    case KC_CAT_SH: if (kc_cat_has(m, 0) && v[0] == 0 && kc_cat_has(m, 1)) PUT(HIGH_CUT, v[1]); break;
+    case KC_CAT_PC: if (kc_cat_has(m, 0)) PUT(POWER, v[0]); break;
+    case KC_CAT_MV: if (kc_cat_has(m, 0)) PUT(MEMORY_MODE, v[0] == 1); break;
+    case KC_CAT_MN: if (kc_cat_has(m, 0)) PUT(MEMORY_CHANNEL, v[0]); break;
+    case KC_CAT_SQ: if (kc_cat_has(m, 0)) PUT(SQUELCH, v[0]); break;
+    case KC_CAT_NT: if (kc_cat_has(m, 0)) PUT(NOTCH, v[0] == 1); break;
+    case KC_CAT_AG: if (kc_cat_has(m, 0)) PUT(AF_GAIN, v[0]); break;
+    case KC_CAT_RG: if (kc_cat_has(m, 0)) PUT(RF_GAIN, v[0]); break;
+    case KC_CAT_SM: if (kc_cat_has(m, 0)) PUT(S_METER, v[0]); break;
+    case KC_CAT_SP: if (kc_cat_has(m, 0)) PUT(SPLIT_ACTIVE, v[0] == 1); break;
+    case KC_CAT_DA: if (kc_cat_has(m, 0)) PUT(DATA_MODE, v[0] == 1); break;
+    case KC_CAT_TX: PUT(PTT, 1); break;
+    case KC_CAT_RX: if (m->count == 0 && m->rest == 0) PUT(PTT, 0); break;
+    case KC_CAT_AC:
+        if (m->count < 3) break;
+        if (kc_cat_has(m, 1)) PUT(ATU_TX, v[1] == 1);
+        if (kc_cat_has(m, 2)) PUT(ATU_TUNING, v[2] == 1);
+        break;
+    case KC_CAT_KN:
+        if (!kc_cat_has(m, 0) || v[0] != 3 || !kc_cat_has(m, 1) || !kc_cat_has(m, 2)) break;
+        if (v[1] == 0) PUT(VOIP_IN, v[2]);
+        if (v[1] == 1) PUT(VOIP_OUT, v[2]);
+        break;
+    default:
+        break;
+    }
+    if (r.valid) write_fields(s, r.valid, &r);
+    return r.valid;
+}
+
+#undef PUT
+
+uint64_t kc_rig_store_poll(const kc_rig_store *s, uint64_t *cursor, kc_rig_values *out) {
+    kc_rig_store *w = (kc_rig_store *)s;       /* atomics are read-only here */
+    for (;;) {
+        uint64_t seq = atomic_load_explicit(&w->seq, memory_order_acquire);
+        if (seq == *cursor) return 0;
+        if (seq & 1) continue;
+        uint64_t changed = 0;
+        out->valid = atomic_load_explicit(&w->valid, memory_order_relaxed);
+        for (int f = 0; f < KC_RIG_FIELD_COUNT; f++) {
+            out->v[f] = atomic_load_explicit(&w->v[f], memory_order_relaxed);
+            if (atomic_load_explicit(&w->changedAt[f], memory_order_relaxed) > *cursor) changed |= 1ull << f;
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&w->seq, memory_order_relaxed) != seq) continue;
+        *cursor = seq;
+        return changed;
+    }
+}
+
+uint64_t kc_rig_store_seen(const kc_rig_store *s) {
+    return atomic_load_explicit(&((kc_rig_store *)s)->seen, memory_order_relaxed);
+}
+
+void kc_rig_store_clear_seen(kc_rig_store *s) {
+    atomic_store_explicit(&s->seen, 0, memory_order_relaxed);
+}
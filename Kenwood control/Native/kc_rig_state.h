@@ -0,0 +1,136 @@
+/*  kc_rig_state.h
+ *
+ *  The rig state behind the main controls as one set of integer fields,
+ *  the store that holds them between the CAT queue and the UI, and their
+ *  snapshot: a compact binary record that RadioState saves at disconnect
+ *  and puts back on screen at the next connect, while the resync queries
+ *  are still out.
+ *
+ *  The store is written where frames arrive: kc_rig_store_apply turns a
+ *  decoded answer or AI report into field values. Each write is a seqlock
+ *  section, and every field remembers the sequence number of its last
+ *  change. The UI reads with kc_rig_store_poll at display rate and gets a
+ *  consistent copy of all fields plus the mask of those that changed since
+ *  its previous poll, however many frames came in between, so a fast VFO
+ *  spin costs one publication per display frame. Readers never block or
+ *  write; writers are serialized by a mutex (in practice there is one, the
+ *  CAT queue, plus the snapshot restore at connect).
+ *
+ *  A snapshot is "KCRS", a version byte, a field count byte, then per set
+ *  field a tag byte and a zigzag LEB128 value, and an FNV-1a 32 of all
+ *  that before it, little-endian. Tags are fixed per field, so adding a
+ *  field doesn't invalidate saved snapshots; unknown tags are skipped.
+ *
+ *  Each field also names the CAT command that reports it, for the resync:
+ *  kc_rig_fields_of says which fields an answer refreshes. Fields with tag
+ *  0 are live readings (the S-meter, a tune in progress, PTT) or aren't
+ *  part of the resync (data mode) and are not saved.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kc_cat_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* id, snapshot tag, reporting command. Values are as RadioState keeps them: booleans 0/1, enums
+ * their raw values, the RIT/XIT offset signed. */
+#define KC_RIG_FIELDS(X)                                        \
+    X(VFO_A,            1,  FA)                                 \
+    X(VFO_B,            2,  FB)                                 \
+    X(MODE,             3,  OM)                                 \
+    X(RX_VFO,           4,  FR)                                 \
+    X(TX_VFO,           5,  FT)                                 \
+    X(RIT,              6,  RT)                                 \
+    X(XIT,              7,  XT)                                 \
+    X(RIT_XIT_OFFSET,   8,  RF)                                 \
+    X(FILTER_SHIFT,     9,  IS)                                 \
+    X(LOW_CUT,          10, SL)                                 \
+    X(HIGH_CUT,         11, SH)                                 \
+    X(POWER,            12, PC)                                 \
+    X(ATU_TX,           13, AC)                                 \
+    X(SPLIT_ACTIVE,     14, SP)                                 \
+    X(MEMORY_MODE,      15, MV)                                 \
+    X(MEMORY_CHANNEL,   16, MN)                                 \
+    X(SQUELCH,          17, SQ)                                 \
+    X(NR_MODE,          18, NR)                                 \
+    X(NOTCH,            19, NT)                                 \
+    X(AF_GAIN,          20, AG)                                 \
+    X(RF_GAIN,          21, RG)                                 \
+    X(VOIP_IN,          22, KN)                                 \
+    X(VOIP_OUT,         23, KN)                                 \
+    X(S_METER,          0,  SM)                                 \
+    X(ATU_TUNING,       0,  AC)                                 \
+    X(DATA_MODE,        0,  DA)                                 \
+    X(PTT,              0,  TX)
+
+#define KC_RIG_ENUM(id, tag, cmd) KC_RIG_##id,
+
+typedef enum {
+    KC_RIG_FIELDS(KC_RIG_ENUM)
+    KC_RIG_FIELD_COUNT
+} kc_rig_field;
+
+#undef KC_RIG_ENUM
+
+typedef struct kc_rig_values {
+    uint64_t valid;                     /* bit f: v[f] is known */
+    int64_t  v[KC_RIG_FIELD_COUNT];
+} kc_rig_values;
+
+#define KC_RIG_SNAPSHOT_MAX 512        /* bytes; enough for every field */
+
+/* Writes the known fields. Returns the length, or 0 if `capacity` is too small. */
+size_t kc_rig_snapshot_encode(const kc_rig_values *values, uint8_t *buf, size_t capacity);
+
+/* Reads a snapshot into `out` (fields not in it are not valid). Returns 0, or -1 if it is
+ * truncated, corrupt or of another version. */
+int    kc_rig_snapshot_decode(const uint8_t *buf, size_t length, kc_rig_values *out);
+
+/* Fields valid in both whose values differ, and fields valid in only one. */
+uint64_t kc_rig_values_diff(const kc_rig_values *a, const kc_rig_values *b);
+
+/* The fields a snapshot holds (those with a tag). */
+uint64_t kc_rig_snapshot_fields(void);
+
+/* The fields an answer to `cmd` refreshes. */
+uint64_t kc_rig_fields_of(kc_cat_cmd cmd);
+
+/* ---- Store ---- */
+
+typedef struct kc_rig_store kc_rig_store;
+
+/* All fields unknown. NULL on no memory. */
+kc_rig_store *kc_rig_store_create(void);
+void          kc_rig_store_destroy(kc_rig_store *s);
+
+/* Writes the fields `msg` reports, with RadioState's rules (OM's mode, SL/SH only for type 0,
+ * ##KN3 by type...). Returns the fields it carried, changed or not; 0 if it isn't a rig-state
+ * frame or carried nothing usable. */
+uint64_t kc_rig_store_apply(kc_rig_store *s, const kc_cat_msg *msg);
+
+/* Sets one field; `known` 0 makes it unknown. */
+void kc_rig_store_set(kc_rig_store *s, kc_rig_field field, int64_t value, int known);
+
+/* Replaces every field with `values` (a restored snapshot). */
+void kc_rig_store_load(kc_rig_store *s, const kc_rig_values *values);
+
+/* The fields that changed since `*cursor` (0 at first), with a consistent copy of all fields in
+ * `out`, and moves the cursor on. Returns 0 without touching `out` if nothing was written since.
+ * Lock-free: retries while a write is in progress. Each consumer keeps its own cursor. */
+uint64_t kc_rig_store_poll(const kc_rig_store *s, uint64_t *cursor, kc_rig_values *out);
+
+/* Fields written (changed or not) since kc_rig_store_clear_seen: the resync's progress. */
+uint64_t kc_rig_store_seen(const kc_rig_store *s);
+void     kc_rig_store_clear_seen(kc_rig_store *s);
+
+/* "VFO_A", for logs. */
+const char *kc_rig_field_name(kc_rig_field field);
+
+#ifdef __cplusplus
+}
+#endif
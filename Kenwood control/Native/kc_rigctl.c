@@ -0,0 +1,722 @@
+/*  kc_rigctl.c
+ *
+ *  See kc_rigctl.h.
+ */
+
+#include "kc_rigctl.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define IN_MAX   512
+#define OUT_MAX  (32 * 1024)
+#define MAX_ARGS 16
+
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0                    /* SO_NOSIGPIPE is set on the socket instead */
+#endif
+
+/* Hamlib's error codes, as rigctld reports them (RPRT -n). */
+enum { RIG_OK = 0, RIG_EINVAL = 1, RIG_ENIMPL = 4, RIG_EIO = 6, RIG_ENAVAIL = 11 };
+
+/* Hamlib's mode and level bits, for dump_state. */
+#define MODE_AM     (1ull << 0)
+#define MODE_CW     (1ull << 1)
+#define MODE_USB    (1ull << 2)
+#define MODE_LSB    (1ull << 3)
+#define MODE_RTTY   (1ull << 4)
+#define MODE_FM     (1ull << 5)
+#define MODE_CWR    (1ull << 7)
+#define MODE_PKTLSB (1ull << 10)
+#define MODE_PKTUSB (1ull << 11)
+#define MODE_PKTFM  (1ull << 12)
+#define MODES_ALL   (MODE_AM | MODE_CW | MODE_USB | MODE_LSB | MODE_RTTY | MODE_FM | MODE_CWR | \
+                     MODE_PKTLSB | MODE_PKTUSB | MODE_PKTFM)
+#define LEVEL_AF       (1ull << 3)
+#define LEVEL_RF       (1ull << 4)
+#define LEVEL_SQL      (1ull << 5)
+#define LEVEL_RFPOWER  (1ull << 12)
+#define LEVEL_STRENGTH (1ull << 30)
+
+typedef struct client {
+    int    fd;
+    int    closing;
+    size_t inLen, outLen, outOff;
+    char   in[IN_MAX];
+    char   out[OUT_MAX];
+} client;
+
+struct kc_rigctl {
+    kc_rigctl_config config;
+    int              listenFd, wakeFd[2], port;
+    pthread_t        thread;
+    atomic_int       stop, online;
+    client          *clients;           /* config.maxClients slots; fd -1 is free */
+    struct pollfd   *pfds;
+    int              connected;
+    _Atomic uint64_t accepted, refused, dropped, requests, reads, sets, errors, submitted;
+    atomic_int       clientCount, maxClientCount;
+};
+
+static void count(_Atomic uint64_t *c) {
+    atomic_fetch_add_explicit(c, 1, memory_order_relaxed);
+}
+
+/* ---- Replies ---- */
+
+static void put(client *c, const char *fmt, ...) {
+    if (c->closing) return;
+    if (c->outOff > 0) {
+        memmove(c->out, c->out + c->outOff, c->outLen - c->outOff);
+        c->outLen -= c->outOff;
+        c->outOff = 0;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(c->out + c->outLen, OUT_MAX - c->outLen, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= OUT_MAX - c->outLen) {
+        c->closing = 2;                 /* the client isn't reading its replies */
+        return;
+    }
+    c->outLen += (size_t)n;
+}
+
+typedef struct request {
+    kc_rigctl     *s;
+    client        *c;
+    int            ext;                 /* extended response: "Label: value" lines */
+    kc_rig_values  rig;
+} request;
+
+/* One value of a get's answer. */
+static void value(request *q, const char *label, const char *fmt, ...) {
+    char v[64];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(v, sizeof v, fmt, ap);
+    va_end(ap);
+    if (q->ext) put(q->c, "%s: %s\n", label, v);
+    else put(q->c, "%s\n", v);
+}
+
+static int known(const request *q, kc_rig_field f, int64_t *out) {
+    if (!(q->rig.valid >> f & 1)) return 0;
+    *out = q->rig.v[f];
+    return 1;
+}
+
+/* ---- Sets ---- */
+
+static void submit(request *q, kc_cat_cmd cmd, const int64_t *values, int count) {
+    char buf[64];
+    size_t n = kc_cat_encode(buf, sizeof buf, cmd, values, count, NULL, 0);
+    if (n == 0) return;
+    q->s->config.submit(q->s->config.ctx, buf, n);
+    atomic_fetch_add_explicit(&q->s->submitted, 1, memory_order_relaxed);
+}
+
+/* The set, then the read that confirms it (its selector fields, if any). */
+static void submit_set(request *q, kc_cat_cmd cmd, const int64_t *values, int count, int selectors) {
+    submit(q, cmd, values, count);
+    submit(q, cmd, values, selectors);
+}
+
+static void store(request *q, kc_rig_field f, int64_t v) {
+    kc_rig_store_set(q->s->config.store, f, v, 1);
+    q->rig.v[f] = v;
+    q->rig.valid |= 1ull << f;
+}
+
+static int parse_int(const char *a, int64_t lo, int64_t hi, int64_t *out) {
+    char *end;
+    double d = strtod(a, &end);
+    if (end == a || *end || !isfinite(d) || d < (double)lo || d > (double)hi) return 0;
+    *out = (int64_t)llround(d);
+    return 1;
+}
+
+static int rx_vfo(const request *q) {
+    int64_t v;
+    return known(q, KC_RIG_RX_VFO, &v) ? (int)v : 0;
+}
+
+static int parse_vfo(const request *q, const char *a, int *out) {
+    if (!strcasecmp(a, "VFOA") || !strcasecmp(a, "Main") || !strcasecmp(a, "MainA")) *out = 0;
+    else if (!strcasecmp(a, "VFOB") || !strcasecmp(a, "Sub") || !strcasecmp(a, "MainB")) *out = 1;
+    else if (!strcasecmp(a, "currVFO") || !strcasecmp(a, "VFO")) *out = rx_vfo(q);
+    else return 0;
+    return 1;
+}
+
+static const char *vfo_name(int64_t v) {
+    return v == 1 ? "VFOB" : "VFOA";
+}
+
+/* ---- Modes ---- */
+
+static const struct {
+    const char *name;
+    int         mode;                   /* OM (KenwoodCAT.OperatingMode) */
+    int         data;
+} kModes[] = {
+    { "LSB", 1, 0 }, { "USB", 2, 0 }, { "CW", 3, 0 }, { "FM", 4, 0 }, { "AM", 5, 0 }, { "RTTY", 6, 0 },
+    { "CWR", 7, 0 }, { "PKTLSB", 1, 1 }, { "PKTUSB", 2, 1 }, { "PKTFM", 4, 1 },
+};
+
+static int get_mode(request *q, const char *label) {
+    int64_t mode, data = 0;
+    if (!known(q, KC_RIG_MODE, &mode)) return -RIG_ENAVAIL;
+    known(q, KC_RIG_DATA_MODE, &data);
+    const char *name = NULL, *plain = NULL;
+    for (size_t i = 0; i < sizeof kModes / sizeof kModes[0]; i++) {
+        if (kModes[i].mode != mode) continue;
+        if (kModes[i].data == (data == 1)) name = kModes[i].name;
+        if (!kModes[i].data) plain = kModes[i].name;
+    }
+    if (!name) name = plain;            /* RTTY, CW... with data mode on */
+    if (!name) return -RIG_ENAVAIL;
+    value(q, label, "%s", name);
+    value(q, "Passband", "0");
+    return RIG_OK;
+}
+
+static int set_mode(request *q, const char *name) {
+    for (size_t i = 0; i < sizeof kModes / sizeof kModes[0]; i++) {
+        if (strcasecmp(name, kModes[i].name)) continue;
+        int64_t om[2] = { 0, kModes[i].mode }, da = kModes[i].data;
+        submit_set(q, KC_CAT_OM, om, 2, 1);
+        submit_set(q, KC_CAT_DA, &da, 1, 0);
+        store(q, KC_RIG_MODE, kModes[i].mode);
+        store(q, KC_RIG_DATA_MODE, kModes[i].data);
+        return RIG_OK;
+    }
+    return -RIG_EINVAL;
+}
+
+/* ---- Commands ---- */
+
+static int get_vfo_freq(request *q, int vfo, const char *label) {
+    int64_t hz;
+    if (!known(q, vfo ? KC_RIG_VFO_B : KC_RIG_VFO_A, &hz)) return -RIG_ENAVAIL;
+    value(q, label, "%lld", (long long)hz);
+    return RIG_OK;
+}
+
+static int set_vfo_freq(request *q, int vfo, const char *arg) {
+    int64_t hz;
+    if (!parse_int(arg, 1, 99999999999ll, &hz)) return -RIG_EINVAL;
+    submit_set(q, vfo ? KC_CAT_FB : KC_CAT_FA, &hz, 1, 0);
+    store(q, vfo ? KC_RIG_VFO_B : KC_RIG_VFO_A, hz);
+    return RIG_OK;
+}
+
+static int tx_vfo(const request *q, int *out) {
+    int64_t v;
+    if (!known(q, KC_RIG_TX_VFO, &v)) return 0;
+    *out = (int)v;
+    return 1;
+}
+
+static int cmd_get_freq(request *q, char **a) {
+    (void)a;
+    return get_vfo_freq(q, rx_vfo(q), "Frequency");
+}
+
+static int cmd_set_freq(request *q, char **a) {
+    return set_vfo_freq(q, rx_vfo(q), a[0]);
+}
+
+static int cmd_get_mode(request *q, char **a) {
+    (void)a;
+    return get_mode(q, "Mode");
+}
+
+static int cmd_set_mode(request *q, char **a) {
+    return set_mode(q, a[0]);
+}
+
+static int cmd_get_vfo(request *q, char **a) {
+    (void)a;
+    int64_t mem;
+    if (known(q, KC_RIG_MEMORY_MODE, &mem) && mem == 1) value(q, "VFO", "MEM");
+    else value(q, "VFO", "%s", vfo_name(rx_vfo(q)));
+    return RIG_OK;
+}
+
+static int cmd_set_vfo(request *q, char **a) {
+    int vfo;
+    if (!parse_vfo(q, a[0], &vfo)) return -RIG_EINVAL;
+    int64_t v = vfo;
+    submit_set(q, KC_CAT_FR, &v, 1, 0);
+    store(q, KC_RIG_RX_VFO, v);
+    return RIG_OK;
+}
+
+static int cmd_get_ptt(request *q, char **a) {
+    (void)a;
+    int64_t ptt;
+    if (!known(q, KC_RIG_PTT, &ptt)) ptt = 0;
+    value(q, "PTT", "%d", (int)ptt);
+    return RIG_OK;
+}
+
+static int cmd_set_ptt(request *q, char **a) {
+    int64_t ptt;
+    if (!parse_int(a[0], 0, 3, &ptt)) return -RIG_EINVAL;
+    if (q->s->config.ptt) {
+        q->s->config.ptt(q->s->config.ctx, ptt != 0);
+    } else {
+        int64_t tx0 = 0;
+        submit(q, ptt ? KC_CAT_TX : KC_CAT_RX, &tx0, ptt ? 1 : 0);
+    }
+    store(q, KC_RIG_PTT, ptt != 0);
+    return RIG_OK;
+}
+
+static int cmd_get_split_vfo(request *q, char **a) {
+    (void)a;
+    int tx;
+    if (!tx_vfo(q, &tx)) return -RIG_ENAVAIL;
+    value(q, "Split", "%d", tx != rx_vfo(q));
+    value(q, "TX VFO", "%s", vfo_name(tx));
+    return RIG_OK;
+}
+
+static int cmd_set_split_vfo(request *q, char **a) {
+    int64_t split;
+    int rx = rx_vfo(q), tx;
+    if (!parse_int(a[0], 0, 1, &split) || !parse_vfo(q, a[1], &tx)) return -RIG_EINVAL;
+    if (!split) tx = rx;
+    else if (tx == rx) tx = !rx;        /* "split on, TX on currVFO" means the other one */
+    int64_t v = tx;
+    submit_set(q, KC_CAT_FT, &v, 1, 0);
+    store(q, KC_RIG_TX_VFO, v);
+    return RIG_OK;
+}
+
+static int cmd_get_split_freq(request *q, char **a) {
+    (void)a;
+    int tx;
+    if (!tx_vfo(q, &tx)) return -RIG_ENAVAIL;
+    return get_vfo_freq(q, tx, "TX Frequency");
+}
+
+static int cmd_set_split_freq(request *q, char **a) {
+    int tx;
+    if (!tx_vfo(q, &tx)) return -RIG_ENAVAIL;
+    return set_vfo_freq(q, tx, a[0]);
+}
+
+static int cmd_get_split_mode(request *q, char **a) {
+    (void)a;
+    return get_mode(q, "TX Mode");
+}
+
+static int cmd_set_split_mode(request *q, char **a) {
+    return set_mode(q, a[0]);
+}
+
+/* SM's 0..70 as dB over S9: S9 at 35, S9+60 dB at 70, 6 dB per S unit below. */
+static int strength_db(int64_t dots) {
+    if (dots <= 35) return (int)((dots - 35) * 54 / 35);
+    return (int)((dots - 35) * 60 / 35);
+}
+
+static const struct {
+    const char  *name;
+    kc_rig_field field;
+    kc_cat_cmd   cmd;                   /* KC_CAT_UNKNOWN: read only */
+    int          min, max;              /* the field's range; the level is value / max */
+} kLevels[] = {
+    { "RFPOWER", KC_RIG_POWER,   KC_CAT_PC, 5, 100 },
+    { "AF",      KC_RIG_AF_GAIN, KC_CAT_AG, 0, 255 },
+    { "RF",      KC_RIG_RF_GAIN, KC_CAT_RG, 0, 255 },
+    { "SQL",     KC_RIG_SQUELCH, KC_CAT_SQ, 0, 255 },
+    { "STRENGTH", KC_RIG_S_METER, KC_CAT_UNKNOWN, 0, 70 },
+};
+
+static int find_level(const char *name) {
+    for (int i = 0; i < (int)(sizeof kLevels / sizeof kLevels[0]); i++)
+        if (!strcasecmp(name, kLevels[i].name)) return i;
+    return -1;
+}
+
+static int cmd_get_level(request *q, char **a) {
+    int i = find_level(a[0]);
+    int64_t v;
+    if (i < 0) return -RIG_EINVAL;
+    if (!known(q, kLevels[i].field, &v)) return -RIG_ENAVAIL;
+    if (kLevels[i].field == KC_RIG_S_METER) value(q, "Level Value", "%d", strength_db(v));
+    else value(q, "Level Value", "%f", (double)v / kLevels[i].max);
+    return RIG_OK;
+}
+
+static int cmd_set_level(request *q, char **a) {
+    int i = find_level(a[0]);
+    char *end;
+    double level = strtod(a[1], &end);
+    if (i < 0 || kLevels[i].cmd == KC_CAT_UNKNOWN || end == a[1] || *end || !isfinite(level)) return -RIG_EINVAL;
+    int64_t v = llround(level * kLevels[i].max);
+    if (v < kLevels[i].min) v = kLevels[i].min;
+    if (v > kLevels[i].max) v = kLevels[i].max;
+    submit_set(q, kLevels[i].cmd, &v, 1, 0);
+    store(q, kLevels[i].field, v);
+    return RIG_OK;
+}
+
+static int cmd_get_info(request *q, char **a) {
+    (void)a;
+    value(q, "Info", "TS-890S via Kenwood control");
+    return RIG_OK;
+}
+
+static int cmd_get_powerstat(request *q, char **a) {
+    (void)a;
+    value(q, "Power Status", "%d", atomic_load(&q->s->online));
+    return RIG_OK;
+}
+
+static int cmd_chk_vfo(request *q, char **a) {
+    (void)a;
+    value(q, "ChkVFO", "0");            /* commands don't take a VFO argument */
+    return RIG_OK;
+}
+
+/* What Hamlib's netrigctl reads at open (protocol 1): ranges, steps, filters, capabilities. */
+static int cmd_dump_state(request *q, char **a) {
+    (void)a;
+    client *c = q->c;
+    put(c, "1\n2\n0\n");                                        /* protocol, model (NET rigctl), ITU region */
+    put(c, "30000 60000000 0x%llx -1 -1 0x3 0x1\n", MODES_ALL);  /* RX: modes, power, VFOs, antenna */
+    put(c, "0 0 0 0 0 0 0\n");
+    put(c, "1800000 54000000 0x%llx 5000 100000 0x3 0x1\n", MODES_ALL);
+    put(c, "0 0 0 0 0 0 0\n");
+    put(c, "0x%llx 1\n0 0\n", MODES_ALL);                      /* tuning steps */
+    put(c, "0x%llx 2400\n0x%llx 500\n0x%llx 6000\n0x%llx 12000\n0 0\n", MODE_USB | MODE_LSB | MODE_PKTUSB |
+        MODE_PKTLSB, MODE_CW | MODE_CWR | MODE_RTTY, MODE_AM, MODE_FM | MODE_PKTFM);
+    put(c, "9999\n9999\n0\n0\n\n\n");                          /* max RIT, XIT, IF shift; announces; preamp, att */
+    put(c, "0x0\n0x0\n0x%llx\n0x%llx\n0x0\n0x0\n", LEVEL_AF | LEVEL_RF | LEVEL_SQL | LEVEL_RFPOWER | LEVEL_STRENGTH,
+        LEVEL_AF | LEVEL_RF | LEVEL_SQL | LEVEL_RFPOWER);
+    put(c, "vfo_ops=0x0\nptt_type=0x1\ntargetable_vfo=0x0\nhas_set_vfo=1\nhas_get_vfo=1\nhas_set_freq=1\n"
+           "has_get_freq=1\ntimeout=0\ndone\n");
+    return RIG_OK;
+}
+
+typedef struct command {
+    char        letter;                 /* 0: long form only */
+    const char *name;
+    int         args;
+    int         set;                    /* answered RPRT 0 on success */
+    int         rig;                    /* needs the radio online */
+    int       (*run)(request *q, char **args);
+} command;
+
+static const command kCommands[] = {
+    { 'f', "get_freq",        0, 0, 1, cmd_get_freq },
+    { 'F', "set_freq",        1, 1, 1, cmd_set_freq },
+    { 'm', "get_mode",        0, 0, 1, cmd_get_mode },
+    { 'M', "set_mode",        2, 1, 1, cmd_set_mode },
+    { 'v', "get_vfo",         0, 0, 1, cmd_get_vfo },
+    { 'V', "set_vfo",         1, 1, 1, cmd_set_vfo },
+    { 't', "get_ptt",         0, 0, 1, cmd_get_ptt },
+    { 'T', "set_ptt",         1, 1, 1, cmd_set_ptt },
+    { 's', "get_split_vfo",   0, 0, 1, cmd_get_split_vfo },
+    { 'S', "set_split_vfo",   2, 1, 1, cmd_set_split_vfo },
+    { 'i', "get_split_freq",  0, 0, 1, cmd_get_split_freq },
+    { 'I', "set_split_freq",  1, 1, 1, cmd_set_split_freq },
+    { 'x', "get_split_mode",  0, 0, 1, cmd_get_split_mode },
+    { 'X', "set_split_mode",  2, 1, 1, cmd_set_split_mode },
+    { 'l', "get_level",       1, 0, 1, cmd_get_level },
+    { 'L', "set_level",       2, 1, 1, cmd_set_level },
+    { '_', "get_info",        0, 0, 0, cmd_get_info },
+    { 0,   "get_powerstat",   0, 0, 0, cmd_get_powerstat },
+    { 0,   "chk_vfo",         0, 0, 0, cmd_chk_vfo },
+    { 0,   "dump_state",      0, 0, 0, cmd_dump_state },
+};
+
+static const command *find_command(const char *token) {
+    for (size_t i = 0; i < sizeof kCommands / sizeof kCommands[0]; i++) {
+        const command *cmd = &kCommands[i];
+        if (token[0] == '\\' ? !strcmp(token + 1, cmd->name) : (token[1] == 0 && token[0] == cmd->letter))
+            return cmd;
+    }
+    return NULL;
+}
+
+static void handle_line(kc_rigctl *s, client *c, char *line) {
+    request q = { .s = s, .c = c };
+    if (line[0] == '+') {
+        q.ext = 1;
+        line++;
+    }
+    char *args[MAX_ARGS], *save = NULL;
+    int n = 0;
+    for (char *t = strtok_r(line, " \t", &save); t && n < MAX_ARGS; t = strtok_r(NULL, " \t", &save)) args[n++] = t;
+
+    int online = atomic_load(&s->online), fetched = 0;
+    for (int i = 0; i < n;) {
+        if (!strcmp(args[i], "q") || !strcmp(args[i], "Q") || !strcmp(args[i], "\\quit")) {
+            c->closing = 1;
+            return;
+        }
+        count(&s->requests);
+        const command *cmd = find_command(args[i]);
+        if (!cmd) {
+            if (q.ext) put(c, "%s:\n", args[i]);
+            put(c, "RPRT %d\n", -RIG_ENIMPL);
+            count(&s->errors);
+            i++;
+            continue;
+        }
+        char **a = &args[i + 1];
+        int rc;
+        if (q.ext) {
+            put(c, "%s:", cmd->name);
+            for (int k = 0; k < cmd->args && i + 1 + k < n; k++) put(c, " %s", a[k]);
+            put(c, "\n");
+        }
+        if (i + 1 + cmd->args > n) {
+            rc = -RIG_EINVAL;
+        } else if (cmd->rig && !online) {
+            rc = -RIG_EIO;
+        } else {
+            if (cmd->rig && !fetched) {
+                /* One consistent copy per line: a client's "f m" never sees half a VFO change. */
+                uint64_t cursor = 0;
+                q.rig.valid = 0;
+                kc_rig_store_poll(s->config.store, &cursor, &q.rig);
+                fetched = 1;
+            }
+            rc = cmd->run(&q, a);
+            if (cmd->rig) count(cmd->set ? &s->sets : &s->reads);
+        }
+        if (rc != RIG_OK) count(&s->errors);
+        if (q.ext || cmd->set || rc != RIG_OK) put(c, "RPRT %d\n", rc);
+        i += 1 + cmd->args;
+    }
+}
+
+/* ---- Connections ---- */
+
+static int set_nonblocking(int fd) {
+    int fl = fcntl(fd, F_GETFL, 0);
+    return fl < 0 ? -1 : fcntl(fd, F_SETFL, fl | O_NONBLOCK);
+}
+
+static void close_client(kc_rigctl *s, client *c) {
+    if (c->closing == 2) count(&s->dropped);
+    close(c->fd);
+    c->fd = -1;
+    s->connected--;
+    atomic_store_explicit(&s->clientCount, s->connected, memory_order_relaxed);
+}
+
+static void accept_clients(kc_rigctl *s) {
+    for (;;) {
+        int fd = accept(s->listenFd, NULL, NULL);
+        if (fd < 0) return;
+        if (s->connected == s->config.maxClients || set_nonblocking(fd) < 0) {
+            close(fd);
+            count(&s->refused);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+#ifdef SO_NOSIGPIPE
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof one);
+#endif
+        client *c = s->clients;
+        while (c->fd >= 0) c++;
+        c->fd = fd;
+        c->closing = 0;
+        c->inLen = c->outLen = c->outOff = 0;
+        s->connected++;
+        count(&s->accepted);
+        atomic_store_explicit(&s->clientCount, s->connected, memory_order_relaxed);
+        if (s->connected > atomic_load_explicit(&s->maxClientCount, memory_order_relaxed))
+            atomic_store_explicit(&s->maxClientCount, s->connected, memory_order_relaxed);
+    }
+}
+
+static void read_client(kc_rigctl *s, client *c) {
+    for (;;) {
+        ssize_t n = recv(c->fd, c->in + c->inLen, IN_MAX - c->inLen, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            c->closing = 1;
+            c->outLen = c->outOff = 0;  /* nobody to answer */
+            return;
+        }
+        if (n < 0) return;
+        c->inLen += (size_t)n;
+
+        size_t start = 0;
+        for (size_t i = c->inLen - (size_t)n; i < c->inLen && !c->closing; i++) {
+            if (c->in[i] != '\n') continue;
+            size_t end = i;
+            if (end > start && c->in[end - 1] == '\r') end--;
+            c->in[end] = 0;
+            handle_line(s, c, c->in + start);
+            start = i + 1;
+        }
+        if (c->closing) return;
+        memmove(c->in, c->in + start, c->inLen - start);
+        c->inLen -= start;
+        if (c->inLen == IN_MAX) {
+            c->closing = 2;             /* no line is this long */
+            return;
+        }
+    }
+}
+
+static void write_client(client *c) {
+    while (c->outOff < c->outLen) {
+        ssize_t n = send(c->fd, c->out + c->outOff, c->outLen - c->outOff, SEND_FLAGS);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return;
+            c->closing = 1;
+            c->outLen = c->outOff = 0;
+            return;
+        }
+        c->outOff += (size_t)n;
+    }
+    c->outLen = c->outOff = 0;
+}
+
+static void *server_main(void *arg) {
+    kc_rigctl *s = arg;
+    int max = s->config.maxClients;
+    while (!atomic_load(&s->stop)) {
+        s->pfds[0] = (struct pollfd){ .fd = s->wakeFd[0], .events = POLLIN };
+        s->pfds[1] = (struct pollfd){ .fd = s->listenFd, .events = POLLIN };
+        for (int i = 0; i < max; i++) {
+            client *c = &s->clients[i];
+            short events = c->fd >= 0 ? POLLIN : 0;
+            if (c->outOff < c->outLen) events |= POLLOUT;
+            s->pfds[2 + i] = (struct pollfd){ .fd = c->fd, .events = events };
+        }
+        if (poll(s->pfds, (nfds_t)(2 + max), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (s->pfds[0].revents) {
+            char b[16];
+            while (read(s->wakeFd[0], b, sizeof b) > 0) {}
+        }
+        if (s->pfds[1].revents & POLLIN) accept_clients(s);
+        for (int i = 0; i < max; i++) {
+            client *c = &s->clients[i];
+            short r = s->pfds[2 + i].revents;
+            if (c->fd < 0 || s->pfds[2 + i].fd != c->fd || !r) continue;
+            if (!c->closing && (r & (POLLIN | POLLHUP | POLLERR))) read_client(s, c);
+            write_client(c);
+            if (c->closing && (c->closing == 2 || c->outOff == c->outLen)) close_client(s, c);
+        }
+    }
+    return NULL;
+}
+
+/* ---- Lifetime ---- */
+
+kc_rigctl *kc_rigctl_create(const kc_rigctl_config *config) {
+    kc_rigctl_config cfg = *config;
+    if (cfg.maxClients == 0) cfg.maxClients = 64;
+    if (!cfg.store || !cfg.submit || cfg.maxClients < 1 || cfg.maxClients > KC_RIGCTL_MAX_CLIENTS ||
+        cfg.port < 0 || cfg.port > 65535) {
+        errno = EINVAL;
+        return NULL;
+    }
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons((uint16_t)cfg.port) };
+    if (inet_pton(AF_INET, cfg.address ? cfg.address : "127.0.0.1", &addr.sin_addr) != 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    kc_rigctl *s = calloc(1, sizeof *s);
+    if (!s) return NULL;
+    s->config = cfg;
+    s->listenFd = s->wakeFd[0] = s->wakeFd[1] = -1;
+    s->clients = calloc((size_t)cfg.maxClients, sizeof *s->clients);
+    s->pfds = calloc((size_t)cfg.maxClients + 2, sizeof *s->pfds);
+    if (!s->clients || !s->pfds) goto fail;
+    for (int i = 0; i < cfg.maxClients; i++) s->clients[i].fd = -1;
+
+    int one = 1;
+    socklen_t len = sizeof addr;
+    s->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->listenFd < 0) goto fail;
+    setsockopt(s->listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    if (bind(s->listenFd, (struct sockaddr *)&addr, sizeof addr) < 0 || listen(s->listenFd, 64) < 0 ||
+        set_nonblocking(s->listenFd) < 0 || getsockname(s->listenFd, (struct sockaddr *)&addr, &len) < 0)
+        goto fail;
+    s->port = ntohs(addr.sin_port);
+    if (pipe(s->wakeFd) < 0) goto fail;
+    set_nonblocking(s->wakeFd[0]);
+    if ((errno = pthread_create(&s->thread, NULL, server_main, s)) != 0) goto fail;
+    return s;
+
+fail:;
+    int e = errno;
+    if (s->listenFd >= 0) close(s->listenFd);
+    if (s->wakeFd[0] >= 0) close(s->wakeFd[0]);
+    if (s->wakeFd[1] >= 0) close(s->wakeFd[1]);
+    free(s->clients);
+    free(s->pfds);
+    free(s);
+    errno = e;
+    return NULL;
+}
+
+void kc_rigctl_destroy(kc_rigctl *s) {
+    if (!s) return;
+    atomic_store(&s->stop, 1);
+    char b = 0;
+    (void)!write(s->wakeFd[1], &b, 1);
+    pthread_join(s->thread, NULL);
+    for (int i = 0; i < s->config.maxClients; i++)
+        if (s->clients[i].fd >= 0) close(s->clients[i].fd);
+    close(s->listenFd);
+    close(s->wakeFd[0]);
+    close(s->wakeFd[1]);
+    free(s->clients);
+    free(s->pfds);
+    free(s);
+}
+
+int kc_rigctl_port(const kc_rigctl *s) {
+    return s->port;
+}
+
+void kc_rigctl_set_online(kc_rigctl *s, int online) {
+    atomic_store(&s->online, online != 0);
+}
+
+void kc_rigctl_read_stats(const kc_rigctl *s, kc_rigctl_stats *out) {
+    kc_rigctl *w = (kc_rigctl *)s;      /* atomics are read-only here */
+    out->accepted = atomic_load_explicit(&w->accepted, memory_order_relaxed);
+    out->refused = atomic_load_explicit(&w->refused, memory_order_relaxed);
+    out->dropped = atomic_load_explicit(&w->dropped, memory_order_relaxed);
+    out->requests = atomic_load_explicit(&w->requests, memory_order_relaxed);
+    out->reads = atomic_load_explicit(&w->reads, memory_order_relaxed);
+    out->sets = atomic_load_explicit(&w->sets, memory_order_relaxed);
+    out->errors = atomic_load_explicit(&w->errors, memory_order_relaxed);
+    out->submitted = atomic_load_explicit(&w->submitted, memory_order_relaxed);
+    out->clients = atomic_load_explicit(&w->clientCount, memory_order_relaxed);
+    out->maxClients = atomic_load_explicit(&w->maxClientCount, memory_order_relaxed);
+}
@@ -0,0 +1,100 @@
+/*  kc_rigctl.h
+ *
+ *  A Hamlib rigctld-compatible TCP server, so logging, digital-mode and
+ *  contest programs can share the app's one CAT connection to the radio.
+ *  They use Hamlib's "NET rigctl" rig (model 2) pointed at it, port 4532
+ *  by default, or talk the protocol themselves.
+ *
+ *  Reads are answered from the kc_rig_store and never reach the radio:
+ *  frequency, mode, VFO, PTT, split and a few levels. Sets become the CAT
+ *  command and its read, as RadioState sends them, handed to `submit` one
+ *  command at a time. RadioState queues them on the connection's
+ *  kc_cat_sched, so a client's sets coalesce with the app's own and with
+ *  every other client's. A set also writes its value to the store at once,
+ *  so a client that sets and reads back sees its value; the radio's answer
+ *  then confirms or corrects it. PTT goes to `ptt` instead, since keying
+ *  the radio involves more than TX0 (the LAN mic stream).
+ *
+ *  Commands, in short and long form (see rigctl(1)):
+ *
+ *    f F  get_freq set_freq          RX VFO frequency
+ *    m M  get_mode set_mode          USB LSB CW CWR AM FM RTTY PKTUSB PKTLSB
+ *                                    PKTFM; the passband is reported as 0
+ *                                    and ignored when set
+ *    v V  get_vfo set_vfo            VFOA VFOB (MEM in memory mode)
+ *    t T  get_ptt set_ptt
+ *    s S  get_split_vfo set_split_vfo
+ *    i I  get_split_freq set_split_freq    TX VFO frequency
+ *    x X  get_split_mode set_split_mode    the mode (the radio has one)
+ *    l L  get_level set_level        STRENGTH (read only), RFPOWER, AF, RF, SQL
+ *    _    get_info
+ *    q Q  quit
+ *         chk_vfo dump_state get_powerstat
+ *
+ *  A line can hold several commands. A line starting with '+' gets the
+ *  extended response ("get_freq:", "Frequency: 14074000", "RPRT 0").
+ *  While the radio is offline (kc_rigctl_set_online) rig commands answer
+ *  RPRT -6 (RIG_EIO).
+ *
+ *  One thread runs a poll loop over the listening socket and up to
+ *  `maxClients` connections; `submit` and `ptt` are called on it. A client
+ *  that sends a line longer than 512 bytes or lets 32 kB of replies back
+ *  up is disconnected.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kc_rig_state.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KC_RIGCTL_DEFAULT_PORT 4532
+#define KC_RIGCTL_MAX_CLIENTS  256
+
+typedef struct kc_rigctl kc_rigctl;
+
+typedef struct kc_rigctl_config {
+    const char   *address;              /* IPv4 to listen on; NULL: 127.0.0.1 */
+    int           port;                 /* 0: any free port (see kc_rigctl_port) */
+    int           maxClients;           /* connections at once; 0: 64 */
+    kc_rig_store *store;                /* read and written, not owned */
+    void        (*submit)(void *ctx, const char *command, size_t length);  /* one CAT command, with its ';' */
+    void        (*ptt)(void *ctx, int down);                               /* NULL: TX0; / RX; through submit */
+    void         *ctx;
+} kc_rigctl_config;
+
+/* Binds, listens and starts the server thread; it starts offline. NULL on failure (errno set). */
+kc_rigctl *kc_rigctl_create(const kc_rigctl_config *config);
+
+/* Closes every connection and the listening socket, and joins the thread. */
+void kc_rigctl_destroy(kc_rigctl *s);
+
+/* The port listened on. */
+int kc_rigctl_port(const kc_rigctl *s);
+
+/* Whether the radio is connected: offline, rig commands are refused. Any thread. */
+void kc_rigctl_set_online(kc_rigctl *s, int online);
+
+typedef struct kc_rigctl_stats {
+    uint64_t accepted;
+    uint64_t refused;                   /* over maxClients */
+    uint64_t dropped;                   /* disconnected for a long line or a reply backlog */
+    uint64_t requests;                  /* commands handled */
+    uint64_t reads;                     /* answered from the store */
+    uint64_t sets;
+    uint64_t errors;                    /* answered with a negative RPRT */
+    uint64_t submitted;                 /* CAT commands handed to submit */
+    int      clients;
+    int      maxClients;                /* most connected at once */
+} kc_rigctl_stats;
+
+/* Any thread. */
+void kc_rigctl_read_stats(const kc_rigctl *s, kc_rigctl_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
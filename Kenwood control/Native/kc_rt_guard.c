@@ -0,0 +1,205 @@
+/*  kc_rt_guard.c
+ *
+ *  See kc_rt_guard.h. On macOS the function pointers of every registered
+ *  malloc zone are swapped for wrappers that check whether the calling thread
+ *  is inside a real-time section and then forward to the original entry.
+ *
+ *  Per-thread state is kept in pthread keys, not _Thread_local: the first
+ *  touch of a thread-local variable mallocs on Apple platforms, which would
+ *  recurse straight back into the hook.
+ */
+
+#include "kc_rt_guard.h"
+#include "kc_audio_stats.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <execinfo.h>
+#include <mach/mach.h>
+#include <malloc/malloc.h>
+#endif
+
+/* Reports (with backtraces) printed in log mode; later violations are only counted. */
+#define KC_RT_GUARD_MAX_REPORTS 32
+
+static _Atomic int      g_mode = KC_RT_GUARD_OFF;
+static _Atomic uint64_t g_violations;
+static pthread_key_t    g_depthKey;     /* section nesting depth, as a pointer-sized integer */
+static pthread_key_t    g_busyKey;      /* set while reporting, so the report itself isn't checked */
+static pthread_once_t   g_keysOnce = PTHREAD_ONCE_INIT;
+
+static void make_keys(void) {
+    pthread_key_create(&g_depthKey, NULL);
+    pthread_key_create(&g_busyKey, NULL);
+}
+
+kc_rt_guard_mode kc_rt_guard_mode_named(const char *name) {
+    if (!name) return KC_RT_GUARD_OFF;
+    if (strcmp(name, "log") == 0) return KC_RT_GUARD_LOG;
+    if (strcmp(name, "abort") == 0) return KC_RT_GUARD_ABORT;
+    return KC_RT_GUARD_OFF;
+}
+
+kc_rt_guard_mode kc_rt_guard_current_mode(void) {
+    return (kc_rt_guard_mode)atomic_load_explicit(&g_mode, memory_order_relaxed);
+}
+
+uint64_t kc_rt_guard_violations(void) {
+    return atomic_load_explicit(&g_violations, memory_order_relaxed);
+}
+
+void kc_rt_guard_enter(void) {
+    if (atomic_load_explicit(&g_mode, memory_order_relaxed) == KC_RT_GUARD_OFF) return;
+    uintptr_t depth = (uintptr_t)pthread_getspecific(g_depthKey);
+    pthread_setspecific(g_depthKey, (void *)(depth + 1));
+}
+
+void kc_rt_guard_leave(void) {
+    if (atomic_load_explicit(&g_mode, memory_order_relaxed) == KC_RT_GUARD_OFF) return;
+    uintptr_t depth = (uintptr_t)pthread_getspecific(g_depthKey);
+    if (depth > 0) pthread_setspecific(g_depthKey, (void *)(depth - 1));
+}
+
+#if defined(__APPLE__)
+
+static int in_rt_section(void) {
+    return atomic_load_explicit(&g_mode, memory_order_relaxed) != KC_RT_GUARD_OFF &&
+           pthread_getspecific(g_depthKey) != NULL && pthread_getspecific(g_busyKey) == NULL;
+}
+
+static void violation(const char *what, size_t size) {
+    pthread_setspecific(g_busyKey, (void *)1);
+    uint64_t n = atomic_fetch_add_explicit(&g_violations, 1, memory_order_relaxed) + 1;
+    kc_stats_count(KC_STATS_RT_ALLOCS, 1);
+
+    int mode = atomic_load_explicit(&g_mode, memory_order_relaxed);
+    if (mode == KC_RT_GUARD_ABORT || n <= KC_RT_GUARD_MAX_REPORTS) {
+        char line[128];
+        int len = snprintf(line, sizeof line, "kc_rt_guard: %s(%zu) in a real-time section (#%llu)\n",
+                           what, size, (unsigned long long)n);
+        if (len > 0) write(STDERR_FILENO, line, (size_t)len < sizeof line ? (size_t)len : sizeof line - 1);
+        void *frames[48];
+        int depth = backtrace(frames, 48);
+        backtrace_symbols_fd(frames + 1, depth - 1, STDERR_FILENO);     /* skip violation() */
+    }
+    if (mode == KC_RT_GUARD_ABORT) abort();
+    pthread_setspecific(g_busyKey, NULL);
+}
+
+#define MAX_ZONES 8
+
+static malloc_zone_t *g_zone[MAX_ZONES];
+static malloc_zone_t  g_orig[MAX_ZONES];    /* each zone's entries before hooking */
+static unsigned       g_zoneCount;
+
+static const malloc_zone_t *orig(malloc_zone_t *zone) {
+    for (unsigned i = 0; i < g_zoneCount; i++) {
+        if (g_zone[i] == zone) return &g_orig[i];
+    }
+    return &g_orig[0];
+}
+
+static void *hook_malloc(malloc_zone_t *zone, size_t size) {
+    if (in_rt_section()) violation("malloc", size);
+    return orig(zone)->malloc(zone, size);
+}
+
+static void *hook_calloc(malloc_zone_t *zone, size_t count, size_t size) {
+    if (in_rt_section()) violation("calloc", count * size);
+    return orig(zone)->calloc(zone, count, size);
+}
+
+static void *hook_valloc(malloc_zone_t *zone, size_t size) {
+    if (in_rt_section()) violation("valloc", size);
+    return orig(zone)->valloc(zone, size);
+}
+
+static void *hook_realloc(malloc_zone_t *zone, void *ptr, size_t size) {
+    if (in_rt_section()) violation("realloc", size);
+    return orig(zone)->realloc(zone, ptr, size);
+}
+
+static void *hook_memalign(malloc_zone_t *zone, size_t alignment, size_t size) {
+    if (in_rt_section()) violation("memalign", size);
+    return orig(zone)->memalign(zone, alignment, size);
+}
+
+static void hook_free(malloc_zone_t *zone, void *ptr) {
+    if (ptr && in_rt_section()) violation("free", 0);
+    orig(zone)->free(zone, ptr);
+}
+
+static void hook_free_definite_size(malloc_zone_t *zone, void *ptr, size_t size) {
+    if (ptr && in_rt_section()) violation("free", size);
+    orig(zone)->free_definite_size(zone, ptr, size);
+}
+
+static int hook_zones(void) {
+    vm_address_t *zones = NULL;
+    unsigned count = 0;
+    if (malloc_get_all_zones(mach_task_self(), NULL, &zones, &count) != KERN_SUCCESS || count == 0) return -1;
+    if (count > MAX_ZONES) count = MAX_ZONES;
+
+    for (unsigned i = 0; i < count; i++) {
+        malloc_zone_t *z = (malloc_zone_t *)zones[i];
+        g_zone[i] = z;
+        g_orig[i] = *z;
+    }
+    g_zoneCount = count;
+
+    for (unsigned i = 0; i < count; i++) {
+        malloc_zone_t *z = g_zone[i];
+        /* Zone structs usually sit on a read-only page. It is left writable afterwards:
+         * restoring read-only would also cover whatever state a custom zone keeps next to it. */
+        vm_protect(mach_task_self(), (vm_address_t)z, sizeof *z, 0, VM_PROT_READ | VM_PROT_WRITE);
+        z->malloc = hook_malloc;
+        z->calloc = hook_calloc;
+        z->valloc = hook_valloc;
+        z->realloc = hook_realloc;
+        z->free = hook_free;
+        if (z->version >= 5 && z->memalign) z->memalign = hook_memalign;
+        if (z->version >= 6 && z->free_definite_size) z->free_definite_size = hook_free_definite_size;
+        /* Newer zones add fast paths (try_free_default, malloc_with_options, typed malloc)
+         * that bypass the classic entries. Advertising version 12 makes libmalloc fall back
+         * to the entries hooked above. Debug-only: the zone is never restored. */
+        if (z->version > 12) z->version = 12;
+    }
+    return 0;
+}
+
+int kc_rt_guard_install(kc_rt_guard_mode mode) {
+    static _Atomic int installed;
+    if (mode == KC_RT_GUARD_OFF) return 0;
+    pthread_once(&g_keysOnce, make_keys);
+    if (atomic_exchange(&installed, 1)) {
+        atomic_store(&g_mode, mode);
+        return 0;
+    }
+
+    /* backtrace() loads its unwinder lazily, and that allocates; do it here, outside any section. */
+    void *frames[4];
+    backtrace(frames, 4);
+
+    if (hook_zones() != 0) {
+        atomic_store(&installed, 0);
+        return -1;
+    }
+    atomic_store(&g_mode, mode);
+    return 0;
+}
+
+#else
+
+int kc_rt_guard_install(kc_rt_guard_mode mode) {
+    (void)mode;
+    pthread_once(&g_keysOnce, make_keys);
+    return mode == KC_RT_GUARD_OFF ? 0 : -1;
+}
+
+#endif
@@ -0,0 +1,49 @@
+/*  kc_rt_guard.h
+ *
+ *  Debug check that the real-time audio sections never allocate.
+ *
+ *  Audio code brackets its real-time work with kc_rt_guard_enter/leave (the
+ *  CoreAudio render callback, the LAN socket drain, the monitor's process
+ *  loop). Once kc_rt_guard_install has hooked the allocator, any malloc,
+ *  calloc, realloc or free made inside such a section is counted (also as
+ *  KC_STATS_RT_ALLOCS) and, depending on the mode, reported on stderr with a
+ *  backtrace or turned into an abort() so a debugger stops on the culprit.
+ *
+ *  Sections nest, and are per thread. Without install, enter/leave are a
+ *  mode check and nothing else, so the brackets stay in release builds.
+ *
+ *  Hooking is implemented for the macOS malloc zones only; elsewhere install
+ *  returns -1 (kc-bench counts per-kernel allocations on Linux).
+ */
+
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    KC_RT_GUARD_OFF,
+    KC_RT_GUARD_LOG,            /* count, and print a backtrace for the first few */
+    KC_RT_GUARD_ABORT           /* print a backtrace and abort() */
+} kc_rt_guard_mode;
+
+/* "log" or "abort" (e.g. from the KC_RT_ALLOC_GUARD environment variable); anything else is off. */
+kc_rt_guard_mode kc_rt_guard_mode_named(const char *name);
+
+/* Hook the allocator and start checking. Call once, early, before audio starts.
+ * Returns 0, or -1 if hooking isn't supported here (checking stays off). */
+int kc_rt_guard_install(kc_rt_guard_mode mode);
+
+kc_rt_guard_mode kc_rt_guard_current_mode(void);
+
+void kc_rt_guard_enter(void);
+void kc_rt_guard_leave(void);
+
+/* Allocations seen inside real-time sections since install. */
+uint64_t kc_rt_guard_violations(void);
+
+#ifdef __cplusplus
+}
+#endif
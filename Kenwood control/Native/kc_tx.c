@@ -0,0 +1,325 @@
+/*  kc_tx.c
+ *
+ *  See kc_tx.h. The ring is single-producer, single-consumer: kc_tx_push
+ *  owns `head`, the sender thread owns `tail` and only advances it after the
+ *  packet has gone out, so a slot is never rewritten while it is being sent.
+ *  Requests from other threads (clear, tone) are flags the sender picks up on
+ *  its next tick.
+ */
+
+#include "kc_tx.h"
+#include "kc_audio_stats.h"
+#include "kc_capture.h"
+#include "kc_pcm.h"
+
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+#include <mach/thread_policy.h>
+#else
+#include <sched.h>
+#endif
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define RING        16                  /* packets; a power of two */
+#define PERIOD_NS   20000000ull
+#define SSRC        0x38393000u         /* "890\0", as TS-Control sends */
+
+struct kc_tx {
+    int                     fd;
+    struct sockaddr_storage dest;
+    socklen_t               destLen;
+    uint32_t                maxQueued;
+
+    uint8_t *ring;                      /* RING * KC_TX_PACKET_BYTES */
+    uint8_t *spare;                     /* tone and silence packets */
+    _Atomic uint32_t head, tail;
+
+    pthread_t   thread;
+    int         started;
+    atomic_int  running;
+    atomic_int  keyed;
+    atomic_int  clearRequested;
+
+    /* Tone request: the fields, then toneGen (release); the sender notices the new generation. */
+    _Atomic double   toneHz, toneAmplitude;
+    atomic_int       toneFrames;
+    _Atomic uint32_t toneGen;
+    /* Sender thread only. */
+    uint32_t toneSeen;
+    int      toneLeft;
+    double   tonePhase, toneStep, toneAmp;
+    float    toneBuf[KC_TX_FRAME_SAMPLES];
+
+    _Atomic uint32_t seq;
+    _Atomic uint64_t sent, silence, late, rescheduled, dropped, sendErrors, maxLateNs;
+    atomic_int       lastError;
+};
+
+/* ---- Clock ---- */
+
+#ifdef __APPLE__
+static mach_timebase_info_data_t g_timebase;
+
+static uint64_t now_ns(void) {
+    uint64_t t = mach_absolute_time();
+    return g_timebase.numer == g_timebase.denom ? t : t * g_timebase.numer / g_timebase.denom;
+}
+
+static void sleep_until(uint64_t ns) {
+    uint64_t t = g_timebase.numer == g_timebase.denom ? ns : ns * g_timebase.denom / g_timebase.numer;
+    mach_wait_until(t);
+}
+
+/* A time-constraint thread is scheduled like CoreAudio's IO threads: 1 ms of work due within
+ * 2 ms of waking, every period. */
+static void make_realtime(void) {
+    double toAbs = (double)g_timebase.denom / (double)g_timebase.numer;
+    thread_time_constraint_policy_data_t p = {
+        .period      = (uint32_t)((double)PERIOD_NS * toAbs),
+        .computation = (uint32_t)(1000000.0 * toAbs),
+        .constraint  = (uint32_t)(2000000.0 * toAbs),
+        .preemptible = 1
+    };
+    thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_TIME_CONSTRAINT_POLICY,
+                      (thread_policy_t)&p, THREAD_TIME_CONSTRAINT_POLICY_COUNT);
+}
+#else
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ull), (long)(ns % 1000000000ull) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+}
+
+/* SCHED_FIFO needs privileges; without them the thread stays at normal priority. */
+static void make_realtime(void) {
+    struct sched_param sp = { .sched_priority = sched_get_priority_min(SCHED_FIFO) + 10 };
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+}
+#endif
+
+/* ---- Packets ---- */
+
+static uint8_t *slot(kc_tx *tx, uint32_t i) {
+    return tx->ring + (size_t)(i & (RING - 1)) * KC_TX_PACKET_BYTES;
+}
+
+static void put_be16(uint8_t *p, uint32_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+
+/* Timestamp stays 0, as in TS-Control's traffic. */
+static void rtp_header(uint8_t *p, uint16_t seq) {
+    p[0] = 0x80;                        /* V=2 */
+    p[1] = 0x60;                        /* PT=96 */
+    put_be16(p + 2, seq);
+    memset(p + 4, 0, 4);
+    put_be16(p + 8, SSRC >> 16);
+    put_be16(p + 10, SSRC & 0xffff);
+}
+
+kc_tx *kc_tx_create(int fd, const struct sockaddr *dest, socklen_t destLen,
+                    uint16_t firstSeq, int maxQueued) {
+    if (fd < 0 || !dest || destLen == 0 || destLen > sizeof(struct sockaddr_storage) || maxQueued < 1)
+        return NULL;
+#ifdef __APPLE__
+    if (g_timebase.denom == 0) mach_timebase_info(&g_timebase);
+#endif
+    kc_tx *tx = calloc(1, sizeof *tx);
+    if (!tx) return NULL;
+    tx->ring = calloc(RING, KC_TX_PACKET_BYTES);
+    tx->spare = calloc(1, KC_TX_PACKET_BYTES);
+    if (!tx->ring || !tx->spare) {
+        kc_tx_destroy(tx);
+        return NULL;
+    }
+    tx->fd = fd;
+    memcpy(&tx->dest, dest, destLen);
+    tx->destLen = destLen;
+    tx->maxQueued = maxQueued < RING ? (uint32_t)maxQueued : RING;
+    atomic_init(&tx->seq, firstSeq);
+    return tx;
+}
+
+void kc_tx_destroy(kc_tx *tx) {
+    if (!tx) return;
+    kc_tx_stop(tx);
+    free(tx->ring);
+    free(tx->spare);
+    free(tx);
+}
+
+/* ---- Producer ---- */
+
+int kc_tx_push(kc_tx *tx, const int16_t *frame) {
+    uint32_t head = atomic_load_explicit(&tx->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&tx->tail, memory_order_acquire);
+    if (head - tail >= RING) {
+        atomic_fetch_add_explicit(&tx->dropped, 1, memory_order_relaxed);
+        kc_stats_count(KC_STATS_TX_DROPS, 1);
+        return -1;
+    }
+    uint8_t *p = slot(tx, head) + 12;
+    for (int i = 0; i < KC_TX_FRAME_SAMPLES; i++) {
+        uint16_t v = (uint16_t)frame[i];
+        p[2 * i] = (uint8_t)v;
+        p[2 * i + 1] = (uint8_t)(v >> 8);
+    }
+    atomic_store_explicit(&tx->head, head + 1, memory_order_release);
+    return 0;
+}
+
+void kc_tx_set_keyed(kc_tx *tx, int keyed) {
+    atomic_store_explicit(&tx->keyed, keyed != 0, memory_order_relaxed);
+}
+
+void kc_tx_tone(kc_tx *tx, double hz, double amplitude, int frames) {
+    atomic_store_explicit(&tx->toneHz, hz, memory_order_relaxed);
+    atomic_store_explicit(&tx->toneAmplitude, amplitude < 0 ? 0 : amplitude > 1 ? 1 : amplitude,
+                          memory_order_relaxed);
+    atomic_store_explicit(&tx->toneFrames, frames > 0 ? frames : 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&tx->toneGen, 1, memory_order_release);
+}
+
+void kc_tx_clear(kc_tx *tx) {
+    atomic_store_explicit(&tx->clearRequested, 1, memory_order_relaxed);
+}
+
+/* ---- Sender ---- */
+
+static void next_tone_frame(kc_tx *tx) {
+    for (int i = 0; i < KC_TX_FRAME_SAMPLES; i++) {
+        tx->toneBuf[i] = (float)(sin(tx->tonePhase) * tx->toneAmp);
+        tx->tonePhase += tx->toneStep;
+        if (tx->tonePhase > 2.0 * M_PI) tx->tonePhase -= 2.0 * M_PI;
+    }
+    kc_pcm_f32_to_s16le(tx->toneBuf, tx->spare + 12, KC_TX_FRAME_SAMPLES, 32767.0f, NULL);
+}
+
+/* One 20 ms slot, `lateNs` after its deadline. */
+static void tick(kc_tx *tx, uint64_t lateNs) {
+    uint32_t tail = atomic_load_explicit(&tx->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&tx->head, memory_order_acquire);
+
+    /* A clear then a tone in the same period (keying for generated audio) keeps the tone. */
+    if (atomic_exchange_explicit(&tx->clearRequested, 0, memory_order_relaxed)) {
+        tail = head;
+        tx->toneLeft = 0;
+    }
+    uint32_t gen = atomic_load_explicit(&tx->toneGen, memory_order_acquire);
+    if (gen != tx->toneSeen) {
+        tx->toneSeen = gen;
+        tx->toneLeft = atomic_load_explicit(&tx->toneFrames, memory_order_relaxed);
+        tx->toneAmp = atomic_load_explicit(&tx->toneAmplitude, memory_order_relaxed);
+        tx->toneStep = 2.0 * M_PI * atomic_load_explicit(&tx->toneHz, memory_order_relaxed) / 16000.0;
+        tx->tonePhase = 0.0;
+    }
+    if (head - tail > tx->maxQueued) {
+        uint32_t n = head - tail - tx->maxQueued;
+        tail += n;
+        atomic_fetch_add_explicit(&tx->dropped, n, memory_order_relaxed);
+        kc_stats_count(KC_STATS_TX_DROPS, n);
+    }
+
+    if (atomic_load_explicit(&tx->keyed, memory_order_relaxed)) {
+        uint8_t *pkt;
+        int fromRing = head != tail;
+        if (fromRing) {
+            pkt = slot(tx, tail);
+        } else {
+            pkt = tx->spare;
+            if (tx->toneLeft > 0) {
+                tx->toneLeft--;
+                next_tone_frame(tx);
+            } else {
+                memset(pkt + 12, 0, KC_TX_PACKET_BYTES - 12);
+                atomic_fetch_add_explicit(&tx->silence, 1, memory_order_relaxed);
+                kc_stats_count(KC_STATS_TX_SILENCE, 1);
+            }
+        }
+        uint32_t seq = atomic_load_explicit(&tx->seq, memory_order_relaxed);
+        rtp_header(pkt, (uint16_t)seq);
+        if (sendto(tx->fd, pkt, KC_TX_PACKET_BYTES, 0, (const struct sockaddr *)&tx->dest, tx->destLen) < 0) {
+            atomic_store_explicit(&tx->lastError, errno, memory_order_relaxed);
+            atomic_fetch_add_explicit(&tx->sendErrors, 1, memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(&tx->sent, 1, memory_order_relaxed);
+            kc_capture_record(KC_CAPTURE_RTP_TX, 0, pkt, KC_TX_PACKET_BYTES);
+        }
+        atomic_store_explicit(&tx->seq, (uint16_t)(seq + 1), memory_order_relaxed);
+        if (fromRing) tail++;
+
+        kc_stats_record_ns(KC_STATS_TX_SEND, lateNs);
+        if (lateNs > PERIOD_NS / 4) {
+            atomic_fetch_add_explicit(&tx->late, 1, memory_order_relaxed);
+            kc_stats_count(KC_STATS_TX_LATE, 1);
+        }
+        if (lateNs > atomic_load_explicit(&tx->maxLateNs, memory_order_relaxed))
+            atomic_store_explicit(&tx->maxLateNs, lateNs, memory_order_relaxed);
+    }
+    atomic_store_explicit(&tx->tail, tail, memory_order_release);
+}
+
+static void *sender_main(void *arg) {
+    kc_tx *tx = arg;
+    make_realtime();
+    uint64_t deadline = now_ns();
+    while (atomic_load_explicit(&tx->running, memory_order_acquire)) {
+        sleep_until(deadline);
+        if (!atomic_load_explicit(&tx->running, memory_order_acquire)) break;
+        uint64_t t = now_ns();
+        uint64_t late = t > deadline ? t - deadline : 0;
+        tick(tx, late);
+        if (late >= PERIOD_NS) {
+            atomic_fetch_add_explicit(&tx->rescheduled, 1, memory_order_relaxed);
+            deadline = t + PERIOD_NS;
+        } else {
+            deadline += PERIOD_NS;
+        }
+    }
+    return NULL;
+}
+
+int kc_tx_start(kc_tx *tx) {
+    if (tx->started) return 0;
+    atomic_store_explicit(&tx->running, 1, memory_order_release);
+    if (pthread_create(&tx->thread, NULL, sender_main, tx) != 0) {
+        atomic_store_explicit(&tx->running, 0, memory_order_release);
+        return -1;
+    }
+    tx->started = 1;
+    return 0;
+}
+
+/* The sender notices within one period. */
+void kc_tx_stop(kc_tx *tx) {
+    if (!tx->started) return;
+    atomic_store_explicit(&tx->running, 0, memory_order_release);
+    pthread_join(tx->thread, NULL);
+    tx->started = 0;
+}
+
+void kc_tx_read_stats(kc_tx *tx, kc_tx_stats *out) {
+    out->sent        = atomic_load_explicit(&tx->sent, memory_order_relaxed);
+    out->silence     = atomic_load_explicit(&tx->silence, memory_order_relaxed);
+    out->late        = atomic_load_explicit(&tx->late, memory_order_relaxed);
+    out->rescheduled = atomic_load_explicit(&tx->rescheduled, memory_order_relaxed);
+    out->dropped     = atomic_load_explicit(&tx->dropped, memory_order_relaxed);
+    out->sendErrors  = atomic_load_explicit(&tx->sendErrors, memory_order_relaxed);
+    out->lastError   = atomic_load_explicit(&tx->lastError, memory_order_relaxed);
+    out->maxLateNs   = atomic_load_explicit(&tx->maxLateNs, memory_order_relaxed);
+    out->nextSeq     = (uint16_t)atomic_load_explicit(&tx->seq, memory_order_relaxed);
+}
@@ -0,0 +1,80 @@
+/*  kc_tx.h
+ *
+ *  Paced LAN mic TX: packetizes 20 ms frames of 16 kHz PCM16 into the RTP
+ *  packets the TS-890 expects (PT 96, timestamp 0, SSRC "890\0") and sends
+ *  one every 20 ms from its own thread.
+ *
+ *  Frames are written by kc_tx_push straight into a preallocated ring of
+ *  packets; the sender fills in the header in place and sends. Sends are
+ *  paced from an absolute deadline clock (clock_nanosleep TIMER_ABSTIME on
+ *  Linux, mach_wait_until on Apple, with a time-constraint thread policy),
+ *  so the cadence doesn't drift with wakeup latency. A wakeup more than a
+ *  whole period late starts a new schedule from now rather than sending a
+ *  burst to catch up.
+ *
+ *  While keyed, each tick sends the oldest queued frame, else the test tone
+ *  if one is playing, else silence. While not keyed nothing is sent, and
+ *  frames wait in the ring. The ring keeps at most `maxQueued` frames (the
+ *  oldest are dropped), which bounds TX latency.
+ *
+ *  How late each send was against its deadline is recorded as the
+ *  KC_STATS_TX_SEND stage, plus the tx_* counters, and in kc_tx_read_stats.
+ *
+ *  One thread pushes, and one (controlling) thread starts, stops and
+ *  destroys; the rest may be called from anywhere. Nothing allocates after
+ *  kc_tx_create.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <sys/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KC_TX_FRAME_SAMPLES 320         /* 20 ms at 16 kHz */
+#define KC_TX_PACKET_BYTES  (12 + 2 * KC_TX_FRAME_SAMPLES)
+
+typedef struct kc_tx kc_tx;
+
+/* Sends from `fd` (a bound UDP socket; the receiver's, so the source port is 60001) to `dest`.
+ * `firstSeq` is the first RTP sequence number. NULL on bad arguments or no memory. */
+kc_tx *kc_tx_create(int fd, const struct sockaddr *dest, socklen_t destLen,
+                    uint16_t firstSeq, int maxQueued);
+/* Stops the sender first. */
+void   kc_tx_destroy(kc_tx *tx);
+
+/* Starts or stops the sending thread (both idempotent). kc_tx_start returns 0, or -1 if the
+ * thread can't be created. */
+int    kc_tx_start(kc_tx *tx);
+void   kc_tx_stop(kc_tx *tx);
+
+void   kc_tx_set_keyed(kc_tx *tx, int keyed);
+
+/* Queues one frame of KC_TX_FRAME_SAMPLES samples. Returns 0, or -1 if the ring is full. */
+int    kc_tx_push(kc_tx *tx, const int16_t *frame);
+
+/* Plays a sine at `hz` for `frames` packets whenever no mic frame is queued (0 frames stops it). */
+void   kc_tx_tone(kc_tx *tx, double hz, double amplitude, int frames);
+
+/* Drops the queued frames and any tone (on the next tick). */
+void   kc_tx_clear(kc_tx *tx);
+
+typedef struct kc_tx_stats {
+    uint64_t sent;
+    uint64_t silence;           /* keyed ticks with nothing queued */
+    uint64_t late;              /* sends more than a quarter period after their deadline */
+    uint64_t rescheduled;       /* wakeups a whole period late (the schedule restarted) */
+    uint64_t dropped;           /* frames dropped: ring full, or over maxQueued */
+    uint64_t sendErrors;
+    int      lastError;         /* errno of the last failed send */
+    uint64_t maxLateNs;
+    uint16_t nextSeq;
+} kc_tx_stats;
+
+void kc_tx_read_stats(kc_tx *tx, kc_tx_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,292 @@
+/*  kc_udp_rx.c
+ *
+ *  See kc_udp_rx.h. Everything a receive touches (payload slab, iovecs,
+ *  message headers, control buffers, source addresses, the packet array) is
+ *  allocated in kc_udp_rx_create.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                     /* recvmmsg */
+#endif
+
+#include "kc_udp_rx.h"
+#include "kc_audio_stats.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
+#ifdef __APPLE__
+#include <mach/mach_time.h>
+#include <netinet/in_systm.h>
+#include <netinet/ip.h>
+#include <netinet/ip_var.h>
+#include <netinet/udp.h>
+#include <netinet/udp_var.h>
+#include <sys/sysctl.h>
+#endif
+
+#if defined(__linux__)
+#define CONTROL_BYTES (CMSG_SPACE(sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t)))
+#elif defined(__APPLE__)
+#define CONTROL_BYTES CMSG_SPACE(sizeof(uint64_t))
+#else
+#define CONTROL_BYTES CMSG_SPACE(sizeof(struct timeval))
+#endif
+
+struct kc_udp_rx {
+    int fd;
+    int slabPackets, packetBytes;
+
+    uint8_t            *slab;
+    uint8_t            *control;        /* CONTROL_BYTES per packet */
+    struct iovec       *iov;
+    struct sockaddr_in *from;
+    kc_udp_packet      *packets;
+#if defined(__linux__)
+    struct mmsghdr     *msgs;
+    uint32_t            lastOverflow;   /* SO_RXQ_OVFL counts from the socket's creation */
+#else
+    struct msghdr      *msgs;
+#endif
+#ifdef __APPLE__
+    uint64_t            baseFullSock;   /* udps_fullsock at create */
+#endif
+
+    _Atomic uint64_t packetCount, syscalls, truncated, kernelDrops;
+    _Atomic int      maxBatch, kernelTimestamps;
+};
+
+static uint64_t now_ns(void) {
+#ifdef __APPLE__
+    static mach_timebase_info_data_t tb;
+    if (tb.denom == 0) mach_timebase_info(&tb);
+    uint64_t t = mach_absolute_time();
+    return tb.numer == tb.denom ? t : t * tb.numer / tb.denom;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#ifdef __APPLE__
+static uint64_t mach_to_ns(uint64_t t) {
+    static mach_timebase_info_data_t tb;
+    if (tb.denom == 0) mach_timebase_info(&tb);
+    return tb.numer == tb.denom ? t : t * tb.numer / tb.denom;
+}
+
+static uint64_t udp_full_socket_drops(void) {
+    struct udpstat st;
+    size_t len = sizeof st;
+    if (sysctlbyname("net.inet.udp.stats", &st, &len, NULL, 0) != 0) return 0;
+    return st.udps_fullsock;
+}
+#endif
+
+/* The kernel shrinks these to what it filled in; put them back before the next read. */
+static void rearm(struct msghdr *m) {
+    m->msg_namelen = sizeof(struct sockaddr_in);
+    m->msg_controllen = CONTROL_BYTES;
+    m->msg_flags = 0;
+}
+
+static void prepare(kc_udp_rx *rx, struct msghdr *m, int i) {
+    m->msg_name = &rx->from[i];
+    m->msg_iov = &rx->iov[i];
+    m->msg_iovlen = 1;
+    m->msg_control = rx->control + (size_t)i * CONTROL_BYTES;
+    rearm(m);
+}
+
+kc_udp_rx *kc_udp_rx_create(int fd, int slabPackets, int packetBytes) {
+    if (fd < 0 || slabPackets < 1 || packetBytes < 1) {
+        errno = EINVAL;
+        return NULL;
+    }
+    kc_udp_rx *rx = calloc(1, sizeof *rx);
+    if (!rx) return NULL;
+    rx->fd = fd;
+    rx->slabPackets = slabPackets;
+    rx->packetBytes = packetBytes;
+    rx->slab    = malloc((size_t)slabPackets * (size_t)packetBytes);
+    rx->control = calloc((size_t)slabPackets, CONTROL_BYTES);
+    rx->iov     = calloc((size_t)slabPackets, sizeof *rx->iov);
+    rx->from    = calloc((size_t)slabPackets, sizeof *rx->from);
+    rx->packets = calloc((size_t)slabPackets, sizeof *rx->packets);
+    rx->msgs    = calloc((size_t)slabPackets, sizeof *rx->msgs);
+    if (!rx->slab || !rx->control || !rx->iov || !rx->from || !rx->packets || !rx->msgs) {
+        kc_udp_rx_destroy(rx);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    for (int i = 0; i < slabPackets; i++) {
+        rx->iov[i].iov_base = rx->slab + (size_t)i * (size_t)packetBytes;
+        rx->iov[i].iov_len = (size_t)packetBytes;
+#if defined(__linux__)
+        prepare(rx, &rx->msgs[i].msg_hdr, i);
+#else
+        prepare(rx, &rx->msgs[i], i);
+#endif
+    }
+
+    /* Best effort: without them, arrival is the read time and drops read 0. */
+    int on = 1;
+#if defined(__linux__)
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof on);
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof on);
+#elif defined(__APPLE__)
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMP_MONOTONIC, &on, sizeof on);
+    rx->baseFullSock = udp_full_socket_drops();
+#else
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMP, &on, sizeof on);
+#endif
+    return rx;
+}
+
+void kc_udp_rx_destroy(kc_udp_rx *rx) {
+    if (!rx) return;
+    free(rx->slab);
+    free(rx->control);
+    free(rx->iov);
+    free(rx->from);
+    free(rx->packets);
+    free(rx->msgs);
+    free(rx);
+}
+
+/* Kernel arrival time from the control messages, 0 if there is none. Also picks up the
+ * socket's drop counter on Linux. */
+static uint64_t parse_control(kc_udp_rx *rx, struct msghdr *m, int64_t realtimeToMonotonic) {
+    uint64_t arrival = 0;
+    (void)realtimeToMonotonic;
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(m); c; c = CMSG_NXTHDR(m, c)) {
+        if (c->cmsg_level != SOL_SOCKET) continue;
+#if defined(__linux__)
+        if (c->cmsg_type == SCM_TIMESTAMPNS) {
+            struct timespec ts;
+            memcpy(&ts, CMSG_DATA(c), sizeof ts);
+            int64_t real = (int64_t)ts.tv_sec * 1000000000ll + ts.tv_nsec;
+            arrival = (uint64_t)(real - realtimeToMonotonic);
+        } else if (c->cmsg_type == SO_RXQ_OVFL) {
+            uint32_t total;
+            memcpy(&total, CMSG_DATA(c), sizeof total);
+            if (total != rx->lastOverflow) {
+                uint32_t delta = total - rx->lastOverflow;
+                atomic_fetch_add_explicit(&rx->kernelDrops, delta, memory_order_relaxed);
+                kc_stats_count(KC_STATS_KERNEL_DROPS, delta);
+            }
+            rx->lastOverflow = total;
+        }
+#elif defined(__APPLE__)
+        if (c->cmsg_type == SCM_TIMESTAMP_MONOTONIC) {
+            uint64_t t;
+            memcpy(&t, CMSG_DATA(c), sizeof t);
+            arrival = mach_to_ns(t);
+        }
+#else
+        if (c->cmsg_type == SCM_TIMESTAMP) {
+            /* Wall clock only; leave it to the read-time fallback. */
+        }
+#endif
+    }
+    (void)rx;
+    return arrival;
+}
+
+int kc_udp_rx_receive(kc_udp_rx *rx, const kc_udp_packet **packets) {
+    int got = 0;
+    int64_t offset = 0;
+
+#if defined(__linux__)
+    int n = recvmmsg(rx->fd, rx->msgs, (unsigned)rx->slabPackets, MSG_DONTWAIT, NULL);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) n = 0;
+        else return -1;
+    }
+    if (n == 0) {
+        *packets = rx->packets;
+        return 0;
+    }
+    atomic_fetch_add_explicit(&rx->syscalls, 1, memory_order_relaxed);
+    /* SO_TIMESTAMPNS is wall-clock time; shift it onto the monotonic clock. */
+    struct timespec real, mono;
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    offset = ((int64_t)real.tv_sec - (int64_t)mono.tv_sec) * 1000000000ll + (real.tv_nsec - mono.tv_nsec);
+#else
+    int n = 0;
+    while (n < rx->slabPackets) {
+        ssize_t len = recvmsg(rx->fd, &rx->msgs[n], MSG_DONTWAIT);
+        if (len < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (n == 0) return -1;
+            break;                          /* report the error on the next call */
+        }
+        rx->packets[n].length = (int)len;  /* stashed; filled in below */
+        atomic_fetch_add_explicit(&rx->syscalls, 1, memory_order_relaxed);
+        n++;
+    }
+#endif
+
+    uint64_t readAt = now_ns();
+    for (int i = 0; i < n; i++) {
+#if defined(__linux__)
+        struct msghdr *m = &rx->msgs[i].msg_hdr;
+        int length = (int)rx->msgs[i].msg_len;
+#else
+        struct msghdr *m = &rx->msgs[i];
+        int length = rx->packets[i].length;
+#endif
+        if (m->msg_flags & MSG_TRUNC) {
+            atomic_fetch_add_explicit(&rx->truncated, 1, memory_order_relaxed);
+            continue;
+        }
+        uint64_t arrival = parse_control(rx, m, offset);
+        if (arrival) atomic_store_explicit(&rx->kernelTimestamps, 1, memory_order_relaxed);
+        kc_udp_packet *p = &rx->packets[got++];
+        p->data = rx->iov[i].iov_base;
+        p->length = length;
+        p->arrivalNs = arrival ? arrival : readAt;
+        p->fromAddr = rx->from[i].sin_addr.s_addr;
+        p->fromPort = ntohs(rx->from[i].sin_port);
+    }
+    for (int i = 0; i < n; i++) {
+#if defined(__linux__)
+        rearm(&rx->msgs[i].msg_hdr);
+#else
+        rearm(&rx->msgs[i]);
+#endif
+    }
+
+    if (got > 0) {
+        atomic_fetch_add_explicit(&rx->packetCount, (uint64_t)got, memory_order_relaxed);
+        int prev = atomic_load_explicit(&rx->maxBatch, memory_order_relaxed);
+        if (got > prev) atomic_store_explicit(&rx->maxBatch, got, memory_order_relaxed);
+    }
+    *packets = rx->packets;
+    return got;
+}
+
+void kc_udp_rx_read_stats(kc_udp_rx *rx, kc_udp_rx_stats *out) {
+#ifdef __APPLE__
+    /* No per-socket counter: publish the system-wide delta when asked. */
+    uint64_t total = udp_full_socket_drops();
+    uint64_t drops = total > rx->baseFullSock ? total - rx->baseFullSock : 0;
+    uint64_t prev = atomic_exchange_explicit(&rx->kernelDrops, drops, memory_order_relaxed);
+    if (drops > prev) kc_stats_count(KC_STATS_KERNEL_DROPS, drops - prev);
+#endif
+    out->packets          = atomic_load_explicit(&rx->packetCount, memory_order_relaxed);
+    out->syscalls         = atomic_load_explicit(&rx->syscalls, memory_order_relaxed);
+    out->truncated        = atomic_load_explicit(&rx->truncated, memory_order_relaxed);
+    out->kernelDrops      = atomic_load_explicit(&rx->kernelDrops, memory_order_relaxed);
+    out->maxBatch         = atomic_load_explicit(&rx->maxBatch, memory_order_relaxed);
+    out->kernelTimestamps = atomic_load_explicit(&rx->kernelTimestamps, memory_order_relaxed);
+}
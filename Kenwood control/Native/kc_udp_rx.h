@@ -0,0 +1,64 @@
+/*  kc_udp_rx.h
+ *
+ *  Batched, allocation-free UDP receive for the LAN RX audio socket.
+ *
+ *  Wraps a non-blocking datagram socket the caller has already bound. Each
+ *  kc_udp_rx_receive reads every datagram that is waiting (up to the slab
+ *  size) into preallocated buffers and returns them with their kernel arrival
+ *  times:
+ *
+ *    Linux   recvmmsg (one syscall per batch), SO_TIMESTAMPNS, and
+ *            SO_RXQ_OVFL for the socket's own drop count.
+ *    Apple   recvmsg per datagram (recvmmsg isn't available), and
+ *            SO_TIMESTAMP_MONOTONIC. There is no per-socket drop counter,
+ *            so drops are the system-wide "dropped due to full socket
+ *            buffers" UDP statistic, counted from kc_udp_rx_create.
+ *
+ *  Arrival times are on the monotonic clock kc_audio_stats and DispatchTime
+ *  use (mach_absolute_time in ns on Apple, CLOCK_MONOTONIC elsewhere), so
+ *  they can go straight to kc_jitter. A datagram without a kernel timestamp
+ *  gets the time it was read.
+ *
+ *  One thread receives; kc_udp_rx_read_stats may run on any thread.
+ */
+
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct kc_udp_rx kc_udp_rx;
+
+typedef struct kc_udp_packet {
+    const uint8_t *data;
+    int            length;
+    uint64_t       arrivalNs;
+    uint32_t       fromAddr;    /* IPv4, network byte order */
+    uint16_t       fromPort;    /* host byte order */
+} kc_udp_packet;
+
+/* `slabPackets` datagrams of up to `packetBytes` each per receive. Turns on the timestamp
+ * and drop-count socket options. NULL on failure (errno set). */
+kc_udp_rx *kc_udp_rx_create(int fd, int slabPackets, int packetBytes);
+void       kc_udp_rx_destroy(kc_udp_rx *rx);
+
+/* Reads what is waiting without blocking. Returns the number of packets in *packets (valid until
+ * the next call; 0 when nothing is waiting), or -1 on a socket error (errno set). */
+int kc_udp_rx_receive(kc_udp_rx *rx, const kc_udp_packet **packets);
+
+typedef struct kc_udp_rx_stats {
+    uint64_t packets;
+    uint64_t syscalls;          /* receive calls that returned data */
+    uint64_t truncated;         /* longer than packetBytes; dropped */
+    uint64_t kernelDrops;       /* see the header comment for what this counts on Apple */
+    int      maxBatch;          /* most packets returned by one kc_udp_rx_receive */
+    int      kernelTimestamps;  /* 1 once a kernel arrival time has been seen */
+} kc_udp_rx_stats;
+
+void kc_udp_rx_read_stats(kc_udp_rx *rx, kc_udp_rx_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,174 @@
+import Foundation
+import os
+
+/// Backends that can trade quality for CPU when the governor asks them to.
+protocol NoiseReductionQualityAdjustable: AnyObject {
+    /// The levels between `.full` and `.bypass` at which this backend actually does less work.
+    /// The governor skips the others, so every step down sheds load.
+    var qualityLevels: NoiseReductionGovernor.Levels { get }
+
+    /// Called on the audio thread between frames. Must not allocate or block for long.
+    func applyQualityLevel(_ level: NoiseReductionGovernor.Level)
+}
+
+/// Watches how long NR takes per frame against the frame's real-time budget and steps the
+/// active backend down to cheaper settings under sustained load, then back up once it's quiet.
+///
+/// `record(elapsedNanos:)` runs on the audio thread once per frame and never allocates.
+/// `snapshot()` can be called from any thread.
+final class NoiseReductionGovernor {
+    enum Level: Int, CaseIterable {
+        case full            // backend as configured
+        case noPostFilter    // EMNR: artifact-elimination / post2 filters off
+        case skipStationary  // RNNoise: skip inference on stationary noise-only frames
+        case bypass          // NR off, dry audio
+
+        var label: String {
+            switch self {
+            case .full:           return "Full"
+            case .noPostFilter:   return "No post filter"
+            case .skipStationary: return "Skip stationary frames"
+            case .bypass:         return "Bypassed"
+            }
+        }
+    }
+
+    /// Intermediate levels a backend supports (`.full` and `.bypass` always are).
+    struct Levels: OptionSet {
+        let rawValue: UInt8
+
+        init(rawValue: UInt8) { self.rawValue = rawValue }
+        init(_ level: Level) { rawValue = 1 << UInt8(level.rawValue) }
+
+        static let noPostFilter = Levels(.noPostFilter)
+        static let skipStationary = Levels(.skipStationary)
+    }
+
+    struct Snapshot {
+        var level: Level
+        var deadlineMisses: Int
+        var load: Double      // smoothed fraction of the frame period spent in NR
+    }
+
+    /// Smoothed load above which we step down (after `stepDownFrames` frames in a row).
+    var stepDownLoad: Double = 0.7
+    /// Smoothed load below which we step up (after the current up-hold period).
+    var stepUpLoad: Double = 0.3
+
+    private let frameNanos: Double
+    private let stepDownFrames = 20          // 200 ms at 10 ms frames
+    private let baseUpHoldFrames = 300       // 3 s
+    private let maxUpHoldFrames = 6_000      // 60 s
+
+    private var lock = os_unfair_lock_s()
+    private var level: Level = .full
+    private var supported: Levels = []
+    private var deadlineMisses = 0
+    private var load: Double = 0
+    private var overFrames = 0
+    private var underFrames = 0
+    private var upHoldFrames: Int
+    private var framesSinceStepUp = Int.max
+    private var framesSinceStepDown = 0
+
+    init(frameSize: Int, sampleRate: Double = 48_000) {
+        frameNanos = Double(frameSize) / sampleRate * 1e9
+        upHoldFrames = baseUpHoldFrames
+    }
+
+    func snapshot() -> Snapshot {
+        os_unfair_lock_lock(&lock)
+        let s = Snapshot(level: level, deadlineMisses: deadlineMisses, load: load)
+        os_unfair_lock_unlock(&lock)
+        return s
+    }
+
+    var currentLevel: Level { snapshot().level }
+
+    /// Feed one frame's processing time. Returns the new level if it changed.
+    func record(elapsedNanos: UInt64) -> Level? {
+        let fraction = Double(elapsedNanos) / frameNanos
+
+        os_unfair_lock_lock(&lock)
+        defer { os_unfair_lock_unlock(&lock) }
+
+        if fraction >= 1 {
+            deadlineMisses += 1
+            kc_stats_count(KC_STATS_DEADLINE_MISSES, 1)
+        }
+        load += (fraction - load) * 0.1
+        framesSinceStepUp = framesSinceStepUp == Int.max ? Int.max : framesSinceStepUp + 1
+        framesSinceStepDown += 1
+
+        if load > stepDownLoad || fraction >= 1 {
+            overFrames += 1
+            underFrames = 0
+        } else if load < stepUpLoad {
+            underFrames += 1
+            overFrames = 0
+        } else {
+            overFrames = 0
+            underFrames = 0
+        }
+
+        // A level that was stable for a long time earns a fresh, short up-hold.
+        if framesSinceStepDown > maxUpHoldFrames { upHoldFrames = baseUpHoldFrames }
+
+        if overFrames >= stepDownFrames, level != .bypass {
+            // Stepping straight back down after a step up: wait longer before the next try.
+            if framesSinceStepUp < upHoldFrames {
+                upHoldFrames = min(upHoldFrames * 2, maxUpHoldFrames)
+            }
+            level = nextLevel(from: level, step: 1)
+            overFrames = 0
+            underFrames = 0
+            framesSinceStepDown = 0
+            return level
+        }
+        if underFrames >= upHoldFrames, level != .full {
+            level = nextLevel(from: level, step: -1)
+            overFrames = 0
+            underFrames = 0
+            framesSinceStepUp = 0
+            return level
+        }
+        return nil
+    }
+
+    /// Tells the governor what the backend now in use supports; on the audio thread at a switch.
+    /// Returns the level to apply when the current one isn't one of them: the next better one.
+    func setSupportedLevels(_ levels: Levels) -> Level? {
+        os_unfair_lock_lock(&lock)
+        defer { os_unfair_lock_unlock(&lock) }
+        supported = levels
+        guard !isUsable(level) else { return nil }
+        level = nextLevel(from: level, step: -1)
+        return level
+    }
+
+    /// The nearest usable level from `level` in the direction of `step` (+1: cheaper).
+    private func nextLevel(from level: Level, step: Int) -> Level {
+        var raw = level.rawValue + step
+        while let next = Level(rawValue: raw) {
+            if isUsable(next) { return next }
+            raw += step
+        }
+        return step > 0 ? .bypass : .full
+    }
+
+    private func isUsable(_ level: Level) -> Bool {
+        level == .full || level == .bypass || supported.contains(Levels(level))
+    }
+
+    func reset() {
+        os_unfair_lock_lock(&lock)
+        level = .full
+        load = 0
+        overFrames = 0
+        underFrames = 0
+        upHoldFrames = baseUpHoldFrames
+        framesSinceStepUp = Int.max
+        framesSinceStepDown = 0
+        os_unfair_lock_unlock(&lock)
+    }
+}
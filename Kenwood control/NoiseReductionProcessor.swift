@@ -1,20 +1,48 @@
 import Foundation
+import os
 
 protocol NoiseReductionProcessor: AnyObject {
     var isAvailable: Bool { get }
     var isEnabled: Bool { get set }
 
+    /// How many samples the processed output trails the input by (0 while disabled).
+    var latencySamples: Int { get }
+
     /// Process a single 48 kHz mono frame. Frame length must match the engine's frame size.
+    /// Returns a new array, so it allocates; audio paths use the in-place calls.
     func processFrame48kMono(_ frame: [Float]) -> [Float]
 
     /// Process a single 48 kHz mono frame in place.
     func processFrame48kMonoInPlace(_ frame: inout [Float])
+
+    /// Process `block.count / frameSize` consecutive frames stored back to back, in place.
+    /// Used to drain a backlog in one call; backends with a batched path (WDSP EMNR) override it.
+    func processFrames48kMonoInPlace(_ block: inout [Float], frameSize: Int)
 }
 
+// The in-place calls run on real-time audio paths and must not allocate once the backend is
+// set up (see kc_rt_guard). The defaults below are for simple backends: the single-frame one
+// goes through `processFrame48kMono`, and the batch one allocates a scratch frame per call, so
+// backends used for live audio implement both themselves.
+
 extension NoiseReductionProcessor {
+    var latencySamples: Int { 0 }
+
     func processFrame48kMonoInPlace(_ frame: inout [Float]) {
         frame = processFrame48kMono(frame)
     }
+
+    func processFrames48kMonoInPlace(_ block: inout [Float], frameSize: Int) {
+        guard frameSize > 0, block.count >= frameSize else { return }
+        var frame = [Float](repeating: 0, count: frameSize)
+        var off = 0
+        while off + frameSize <= block.count {
+            for i in 0..<frameSize { frame[i] = block[off + i] }
+            processFrame48kMonoInPlace(&frame)
+            for i in 0..<frameSize { block[off + i] = frame[i] }
+            off += frameSize
+        }
+    }
 }
 
 /// Transparent pass-through — reports unavailable so the UI correctly disables the NR toggle.
@@ -25,27 +53,281 @@ final class PassthroughNoiseReduction: NoiseReductionProcessor {
     func processFrame48kMono(_ frame: [Float]) -> [Float] { frame }
 
     func processFrame48kMonoInPlace(_ frame: inout [Float]) { /* no-op */ }
+
+    func processFrames48kMonoInPlace(_ block: inout [Float], frameSize: Int) { /* no-op */ }
 }
 
 /// Proxy that forwards all calls to a swappable inner processor.
 /// Passing this proxy to LanAudioPipeline means backend switches take effect
 /// immediately without restarting the pipeline.
+///
+/// Switches are crossfaded: from the first frame after `switchTo(_:)` both the outgoing and the
+/// incoming backend process each frame and the output ramps linearly from one to the other, so
+/// there is no click. Backends with different latencies (EMNR trails its input by 1440 samples,
+/// RNNoise by 480) put out the same audio at different times, so the fade runs one frame longer
+/// than the latency difference and the time shift is spread across it rather than jumped.
+/// Backends are expected to be long-lived (RadioState keeps one of each), so
+/// the audio thread never constructs, plans or frees anything; it only swaps references.
+/// Before handing a backend over, `switchTo` primes it on a background queue with the most
+/// recent input so its overlap buffers and noise estimate already match the current signal.
+/// The audio thread's history ring is swapped for a spare one of the same size to get that
+/// input, so it never waits on a copy and nothing is allocated after init; frames recorded into
+/// the spare while priming are fed in the same way before the backend is handed over.
+///
+/// Every frame is timed and fed to `governor`; when it changes level the active backend is
+/// told (if it is `NoiseReductionQualityAdjustable`), and at `.bypass` frames pass through dry.
 final class NoiseReductionProcessorProxy: NoiseReductionProcessor {
-    var inner: any NoiseReductionProcessor
+    let governor: NoiseReductionGovernor
 
-    init(inner: any NoiseReductionProcessor) { self.inner = inner }
+    private var lock = os_unfair_lock_s()
+    private var appliedLevel: NoiseReductionGovernor.Level = .full
+    private var current: any NoiseReductionProcessor
+    private var pending: (any NoiseReductionProcessor)?
+    private var fadingOut: (any NoiseReductionProcessor)?
+    private var requested: (any NoiseReductionProcessor)?   // switched to, still being primed
+
+    private let frameSize: Int
+    private let historyFrames: Int
+    private var history: [Float]        // ring of the last `historyFrames` input frames
+    private var historyNext: Int = 0    // next frame slot to write
+    private var historyCount: Int = 0
+    private var fadeScratch: [Float]
+    private var frameScratch: [Float]
+    private var fadeFrames = 1          // audio thread only: length of the fade in progress
+    private var fadeDone = 0            // frames of it already output
+
+    private let primeQueue = DispatchQueue(label: "NoiseReductionProcessorProxy.prime", qos: .userInitiated)
+    private var primer: [Float]         // spare history ring; primeQueue only, outside the swap
+    private var primeFrame: [Float]
+
+    init(inner: any NoiseReductionProcessor, frameSize: Int = 480, historyFrames: Int = 50) {
+        self.current = inner
+        self.frameSize = frameSize
+        self.historyFrames = historyFrames
+        self.history = Array(repeating: 0, count: frameSize * historyFrames)
+        self.fadeScratch = Array(repeating: 0, count: frameSize)
+        self.frameScratch = Array(repeating: 0, count: frameSize)
+        self.primer = Array(repeating: 0, count: frameSize * historyFrames)
+        self.primeFrame = Array(repeating: 0, count: frameSize)
+        self.governor = NoiseReductionGovernor(frameSize: frameSize)
+        _ = governor.setSupportedLevels((inner as? NoiseReductionQualityAdjustable)?.qualityLevels ?? [])
+    }
+
+    /// The backend audio is (or is about to be) routed to. Setting it is the same as `switchTo(_:)`.
+    var inner: any NoiseReductionProcessor {
+        get {
+            os_unfair_lock_lock(&lock)
+            let p = requested ?? pending ?? current
+            os_unfair_lock_unlock(&lock)
+            return p
+        }
+        set { switchTo(newValue) }
+    }
 
     var isAvailable: Bool { inner.isAvailable }
+    var latencySamples: Int { inner.latencySamples }
     var isEnabled: Bool {
         get { inner.isEnabled }
         set { inner.isEnabled = newValue }
     }
 
+    /// Route audio to `next`, crossfading over at least the latency difference. Call from a non-audio thread; returns at
+    /// once, and audio moves over once `next` is primed. A later call supersedes an earlier one
+    /// still waiting to be primed.
+    func switchTo(_ next: any NoiseReductionProcessor) {
+        os_unfair_lock_lock(&lock)
+        requested = next
+        os_unfair_lock_unlock(&lock)
+        primeQueue.async { [self] in prime(next) }
+    }
+
+    /// On primeQueue. `waits` counts retries spent waiting for a fade to finish.
+    private func prime(_ next: any NoiseReductionProcessor, waits: Int = 0) {
+        os_unfair_lock_lock(&lock)
+        let inUse = next === current || next === pending || next === fadingOut
+        let primes = !inUse && next.isEnabled
+        // The audio thread keeps recording while a batch is primed; go round until it has
+        // recorded nothing new, so `next` has seen every frame before the one it takes over on
+        // (that frame is recorded and `pending` taken under the same lock). Mid-fade the audio
+        // thread won't take `pending` yet, so keep priming until the fade is over (or 100 ms
+        // have gone by, e.g. the stream stopped) rather than let it miss those frames.
+        while primes && requested === next && (historyCount > 0 || (fadingOut != nil && waits < 20)) {
+            if historyCount == 0 {
+                os_unfair_lock_unlock(&lock)
+                primeQueue.asyncAfter(deadline: .now() + .milliseconds(5)) { [self] in prime(next, waits: waits + 1) }
+                return
+            }
+            // Take the ring as it is and give the audio thread the spare one, empty.
+            swap(&history, &primer)
+            let start = (historyNext - historyCount + historyFrames) % historyFrames
+            let count = historyCount
+            historyNext = 0
+            historyCount = 0
+            os_unfair_lock_unlock(&lock)
+
+            // `next` is idle (not current, pending or fading), so it's safe to run it here. Oldest frame first.
+            for k in 0..<count {
+                let slot = (start + k) % historyFrames
+                primeFrame.withUnsafeMutableBufferPointer { dst in
+                    primer.withUnsafeBufferPointer { src in
+                        dst.baseAddress!.update(from: src.baseAddress!.advanced(by: slot * frameSize), count: frameSize)
+                    }
+                }
+                next.processFrame48kMonoInPlace(&primeFrame)
+            }
+            os_unfair_lock_lock(&lock)
+        }
+        if requested === next {
+            pending = next === current ? nil : next
+            requested = nil
+        }
+        os_unfair_lock_unlock(&lock)
+    }
+
     func processFrame48kMono(_ frame: [Float]) -> [Float] {
-        inner.processFrame48kMono(frame)
+        var out = frame
+        processFrame48kMonoInPlace(&out)
+        return out
     }
 
     func processFrame48kMonoInPlace(_ frame: inout [Float]) {
-        inner.processFrame48kMonoInPlace(&frame)
+        let fullFrame = frame.count == frameSize
+
+        os_unfair_lock_lock(&lock)
+        if fullFrame {
+            let base = historyNext * frameSize
+            history.withUnsafeMutableBufferPointer { dst in
+                frame.withUnsafeBufferPointer { src in
+                    dst.baseAddress!.advanced(by: base).update(from: src.baseAddress!, count: frameSize)
+                }
+            }
+            historyNext = (historyNext + 1) % historyFrames
+            historyCount = min(historyCount + 1, historyFrames)
+        }
+        // A switch that comes in mid-fade waits for the fade to finish.
+        let taken = fadingOut == nil ? pending : nil
+        if let taken {
+            fadingOut = current
+            current = taken
+            pending = nil
+        }
+        let active = current
+        let outgoing = fadingOut
+        var level = appliedLevel
+        os_unfair_lock_unlock(&lock)
+
+        let started = DispatchTime.now().uptimeNanoseconds
+        if let incoming = taken {
+            // The governor only steps through levels the incoming backend can shed load at.
+            let adjustable = incoming as? NoiseReductionQualityAdjustable
+            if let supportedLevel = governor.setSupportedLevels(adjustable?.qualityLevels ?? []) {
+                level = supportedLevel
+                os_unfair_lock_lock(&lock)
+                appliedLevel = supportedLevel
+                os_unfair_lock_unlock(&lock)
+            }
+            adjustable?.applyQualityLevel(level)
+            let skew = abs(incoming.latencySamples - (outgoing?.latencySamples ?? 0))
+            fadeFrames = 1 + (skew + frameSize - 1) / frameSize
+            fadeDone = 0
+        }
+        if let outgoing {
+            if level != .bypass && fullFrame {
+                crossfade(from: outgoing, to: active, frame: &frame)
+                fadeDone += 1
+            } else {
+                if level != .bypass { active.processFrame48kMonoInPlace(&frame) }
+                fadeDone = fadeFrames
+            }
+            if fadeDone >= fadeFrames {
+                os_unfair_lock_lock(&lock)
+                fadingOut = nil
+                os_unfair_lock_unlock(&lock)
+            }
+        } else if level != .bypass {
+            active.processFrame48kMonoInPlace(&frame)
+        }
+        let elapsed = DispatchTime.now().uptimeNanoseconds &- started
+
+        if let newLevel = governor.record(elapsedNanos: elapsed) {
+            (active as? NoiseReductionQualityAdjustable)?.applyQualityLevel(newLevel)
+            os_unfair_lock_lock(&lock)
+            appliedLevel = newLevel
+            os_unfair_lock_unlock(&lock)
+        }
+    }
+
+    /// Backlog path: hands the whole block to the backend so EMNR can batch its FFTs.
+    /// Falls back to frame-by-frame while a backend switch is pending or fading (the crossfade is per frame).
+    func processFrames48kMonoInPlace(_ block: inout [Float], frameSize size: Int) {
+        guard size == frameSize, block.count >= frameSize else { return }
+        let frames = block.count / frameSize
+
+        os_unfair_lock_lock(&lock)
+        // Only the batch path records history here; the per-frame path records in
+        // processFrame48kMonoInPlace, so recording both would prime the next backend twice.
+        let batched = pending == nil && fadingOut == nil && frames >= 2
+        let level = appliedLevel
+        let active = current
+        if batched {
+            for f in max(0, frames - historyFrames)..<frames {
+                let base = historyNext * frameSize
+                history.withUnsafeMutableBufferPointer { dst in
+                    block.withUnsafeBufferPointer { src in
+                        dst.baseAddress!.advanced(by: base).update(from: src.baseAddress!.advanced(by: f * frameSize),
+                                                                   count: frameSize)
+                    }
+                }
+                historyNext = (historyNext + 1) % historyFrames
+                historyCount = min(historyCount + 1, historyFrames)
+            }
+        }
+        os_unfair_lock_unlock(&lock)
+
+        if !batched {
+            for f in 0..<frames {
+                let off = f * frameSize
+                for i in 0..<frameSize { frameScratch[i] = block[off + i] }
+                processFrame48kMonoInPlace(&frameScratch)
+                for i in 0..<frameSize { block[off + i] = frameScratch[i] }
+            }
+            return
+        }
+
+        let started = DispatchTime.now().uptimeNanoseconds
+        if level != .bypass {
+            active.processFrames48kMonoInPlace(&block, frameSize: frameSize)
+        }
+        let perFrame = (DispatchTime.now().uptimeNanoseconds &- started) / UInt64(frames)
+        for _ in 0..<frames {
+            if let newLevel = governor.record(elapsedNanos: perFrame) {
+                (active as? NoiseReductionQualityAdjustable)?.applyQualityLevel(newLevel)
+                os_unfair_lock_lock(&lock)
+                appliedLevel = newLevel
+                os_unfair_lock_unlock(&lock)
+            }
+        }
+    }
+
+    /// Frame `fadeDone` of a `fadeFrames`-frame fade; both backends run on every frame of it.
+    private func crossfade(from old: any NoiseReductionProcessor, to incoming: any NoiseReductionProcessor,
+                           frame: inout [Float]) {
+        fadeScratch.withUnsafeMutableBufferPointer { dst in
+            frame.withUnsafeBufferPointer { src in
+                dst.baseAddress!.update(from: src.baseAddress!, count: frameSize)
+            }
+        }
+        old.processFrame48kMonoInPlace(&frame)
+        incoming.processFrame48kMonoInPlace(&fadeScratch)
+        let step = 1 / Float(frameSize * fadeFrames)
+        let offset = fadeDone * frameSize
+        frame.withUnsafeMutableBufferPointer { out in
+            fadeScratch.withUnsafeBufferPointer { next in
+                for i in 0..<frameSize {
+                    let t = Float(offset + i + 1) * step
+                    out[i] = out[i] * (1 - t) + next[i] * t
+                }
+            }
+        }
     }
 }
@@ -16,9 +16,24 @@ final class RNNoiseProcessor: NoiseReductionProcessor {
     private var inScaled: [Float]
     private var outScaled: [Float]
 
+    // Stationary-frame skip (governor level .skipStationary and below).
+    // A frame is skipped when the previous inference said "no voice" and the frame energy
+    // is within ±25% of the last inferred frame. A skipped frame still goes through RNNoise's
+    // analysis and synthesis (rnnoise_process_frame_hold) with the last band gains, so its
+    // overlap state and one-frame delay carry on unbroken; only the pitch search and the
+    // network are left out. At most `maxSkippedInRow` frames are skipped in a row so the
+    // RNN state stays current.
+    private var skipStationaryFrames = false
+    private var lastVoiceProbability: Float = 1
+    private var lastInferredEnergy: Float = 0
+    private var skippedInRow = 0
+    private let maxSkippedInRow = 2
+
     var isAvailable: Bool { state != nil }
     var isEnabled: Bool = false
     var backendDescription: String { "RNNoise (in-process C, frame=\(frameSize))" }
+    /// rnnoise_process_frame returns the previous frame's audio.
+    var latencySamples: Int { isEnabled ? frameSize : 0 }
 
     init?() {
         let sz = Int(rnnoise_get_frame_size())
@@ -52,25 +67,80 @@ final class RNNoiseProcessor: NoiseReductionProcessor {
     }
 
     func processFrame48kMonoInPlace(_ frame: inout [Float]) {
-        guard isEnabled, let state else { return }
+        guard isEnabled, state != nil else { return }
         guard frame.count == frameSize else { return }
+        frame.withUnsafeMutableBufferPointer { buf in
+            process(buf.baseAddress!)
+        }
+    }
+
+    /// Runs the frames one after another straight from the block, without a scratch copy.
+    func processFrames48kMonoInPlace(_ block: inout [Float], frameSize size: Int) {
+        guard isEnabled, state != nil, size == frameSize else { return }
+        let frames = block.count / frameSize
+        block.withUnsafeMutableBufferPointer { buf in
+            for f in 0..<frames {
+                process(buf.baseAddress! + f * frameSize)
+            }
+        }
+    }
+
+    /// One `frameSize` frame at `frame`, in place.
+    private func process(_ frame: UnsafeMutablePointer<Float>) {
+        guard let state else { return }
+
+        var energy: Float = 0
+        if skipStationaryFrames {
+            for i in 0..<frameSize {
+                energy += frame[i] * frame[i]
+            }
+        }
+        let skip = skipStationaryFrames && lastVoiceProbability < 0.2 && skippedInRow < maxSkippedInRow
+            && lastInferredEnergy > 0 && abs(energy - lastInferredEnergy) < 0.25 * lastInferredEnergy
 
         // Scale [-1, 1] float audio to RNNoise's expected float units (int16-like).
-        for i in 0..<frameSize {
-            inScaled[i] = frame[i] * 32768.0
+        inScaled.withUnsafeMutableBufferPointer { dst in
+            kc_pcm_scale_f32(frame, dst.baseAddress, frameSize, 32768.0)
         }
 
         // Process.
+        var vad: Float = 1
         inScaled.withUnsafeBufferPointer { inBuf in
             outScaled.withUnsafeMutableBufferPointer { outBuf in
                 guard let inBase = inBuf.baseAddress, let outBase = outBuf.baseAddress else { return }
-                _ = rnnoise_process_frame(state, outBase, inBase)
+                if skip {
+                    rnnoise_process_frame_hold(state, outBase, inBase)
+                } else {
+                    vad = rnnoise_process_frame(state, outBase, inBase)
+                }
             }
         }
 
+        if skip {
+            skippedInRow += 1
+        } else if skipStationaryFrames {
+            lastVoiceProbability = vad
+            lastInferredEnergy = energy
+            skippedInRow = 0
+        }
+
         // Scale back to [-1, 1].
-        for i in 0..<frameSize {
-            frame[i] = outScaled[i] / 32768.0
+        outScaled.withUnsafeBufferPointer { src in
+            kc_pcm_scale_f32(src.baseAddress, frame, frameSize, 1.0 / 32768.0)
+        }
+    }
+}
+
+extension RNNoiseProcessor: NoiseReductionQualityAdjustable {
+    /// Skipping inference on stationary frames is the one thing RNNoise can leave out.
+    var qualityLevels: NoiseReductionGovernor.Levels { .skipStationary }
+
+    func applyQualityLevel(_ level: NoiseReductionGovernor.Level) {
+        let skip = level.rawValue >= NoiseReductionGovernor.Level.skipStationary.rawValue
+        if skip != skipStationaryFrames {
+            skipStationaryFrames = skip
+            lastVoiceProbability = 1
+            skippedInRow = 0
         }
     }
 }
@@ -88,6 +158,8 @@ final class RNNoiseProcessor: NoiseReductionProcessor {
     func processFrame48kMono(_ frame: [Float]) -> [Float] { frame }
 
     func processFrame48kMonoInPlace(_ frame: inout [Float]) { /* no-op */ }
+
+    func processFrames48kMonoInPlace(_ block: inout [Float], frameSize: Int) { /* no-op */ }
 }
 
 #endif
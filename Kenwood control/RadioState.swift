@@ -1,4 +1,5 @@
 import Foundation
+import os
 import Combine
 import CoreAudio
 #if canImport(AppKit)
@@ -15,6 +16,15 @@ struct MemoryChannel: Identifiable {
     var frequencyMHz: String {
         String(format: "%.6f", Double(frequencyHz) / 1_000_000.0)
     }
+
+    /// FNV-1a over what the radio reported, to tell a changed channel from a re-read one.
+    var checksum: UInt32 {
+        var h: UInt32 = 2_166_136_261
+        for byte in "\(frequencyHz)|\(mode.rawValue)|\(name)|\(isEmpty)".utf8 {
+            h = (h ^ UInt32(byte)) &* 16_777_619
+        }
+        return h
+    }
 }
 
 final class RadioState: ObservableObject {
@@ -72,6 +82,14 @@ final class RadioState: ObservableObject {
     @Published var selectedNoiseReductionBackend: String = "Passthrough"
     @Published var noiseReductionStrength: Double = 1.0
     @Published var noiseReductionProfileRaw: String = NoiseReductionProfile.speech.rawValue
+    // From the EMNR spectrum tap (WDSP EMNR only, while NR runs). Whole dB, relative.
+    @Published var noiseFloorDB: Int?
+    @Published var estimatedSNRDB: Int?
+    // CPU governor: current NR quality level and NR frames that overran their real-time budget.
+    @Published var nrGovernorLevel: String = NoiseReductionGovernor.Level.full.label
+    @Published var nrDeadlineMisses: Int = 0
+    // Once-a-second digest of the audio-path timing histograms (kc_audio_stats); nil until audio has run.
+    @Published var audioTimingSummary: String?
     @Published var errorLog: [String] = []
     @Published var connectionLog: [String] = []
     @Published var smokeTestStatus: String = "Not run"
@@ -101,7 +119,13 @@ final class RadioState: ObservableObject {
     @Published var selectedLanAudioOutputUID: String = ""
     @Published var lanAudioPacketCount: Int = 0
     @Published var lanAudioLastPacketAt: Date?
+    // Jitter buffer depth, measured jitter, late/lost/reordered totals and kernel socket drops,
+    // refreshed once a second.
+    @Published var lanJitterSummary: String?
     @Published var autoStartLanAudio: Bool = true
+    // Hamlib rigctld-compatible server for logging/digital-mode software (kc_rigctl).
+    @Published private(set) var rigctlServerEnabled: Bool = false
+    @Published private(set) var rigctlServerStatus: String = "Off"
     @Published var voipOutputLevel: Int?
     @Published var voipInputLevel: Int?
     @Published var selectedLanMicInputUID: String = ""
@@ -124,43 +148,76 @@ final class RadioState: ObservableObject {
     // MARK: - Memory browser (all 120 channels)
     @Published var memoryChannels: [MemoryChannel] = []
     @Published var isLoadingAllMemories: Bool = false
+    // Channel reads in order of need, and those awaiting their MA0 answer (channel → attempts).
+    private var memoryLoadQueue: [Int] = []
+    private var memoryLoadInFlight: [Int: Int] = [:]
+    private var memoryLoadGeneration = 0
+    private var memoryLoadStartedAt: DispatchTime = .now()
+    private var memoryLoadChanged = 0
+    private var memoryLoadIsFull = false
+    private let memoryLoadWindow = 4
+    private let memoryLoadTimeout: TimeInterval = 1.0
+    private var memoryCache = MemoryChannelCache()
+    private var memoryCacheHost = ""
+    private var memoryCacheSaveScheduled = false
+
+    // Fast connect: the host whose snapshot is on screen, the values at connect and the fields
+    // the resync hasn't had answers for yet (kc_rig_store_seen).
+    private var rigSnapshotHost = ""
+    private var rigValuesAtConnect = kc_rig_values()
+    private var resyncPending: UInt64 = 0
+    private var resyncStartedAt: DispatchTime = .now()
+    private var resyncGeneration = 0
+    /// Channels are read in full on connect when the last full read is older than this.
+    private let memoryCacheMaxAge: TimeInterval = 24 * 60 * 60
 
     private let connection = TS890Connection()
     /// Proxy wrapping the active backend. Passed to LanAudioPipeline and AudioMonitor
     /// so backend switches (and enable/disable) immediately affect all running pipelines.
     private let processorProxy = NoiseReductionProcessorProxy(inner: PassthroughNoiseReduction())
-    private var noiseProcessor: any NoiseReductionProcessor {
-        get { processorProxy.inner }
-        set { processorProxy.inner = newValue }
-    }
+    private var noiseProcessor: any NoiseReductionProcessor { processorProxy.inner }
+    /// One long-lived instance per backend name, built at launch.
+    private var noiseBackends: [String: any NoiseReductionProcessor] = [:]
     private var audioMonitor: AudioMonitor?
     private var lanReceiver: KenwoodLanAudioReceiver?
     private var lanPipeline: LanAudioPipeline?
     private var lanPlayer: AudioOutputPlayer?
     private var micCapture: KenwoodLanMicCapture?
-    private let micSendQueue = DispatchQueue(label: "KenwoodLanMicSend.queue")
     private var micFrameLogCountdown: Int = 0
-    private var micTxFrames: [[Int16]] = []
-    private var micTxTimer: DispatchSourceTimer?
     private enum MicTxSource { case mic, generated }
     private var micTxSource: MicTxSource = .mic
-    private struct GeneratedTxState {
-        var framesRemaining: Int
-        var phase: Double
-        var frequencyHz: Double
-        var amplitude: Double
-    }
-    private var generatedTxState: GeneratedTxState?
     private var currentHost: String = ""
     private var cancellables: Set<AnyCancellable> = []
     private let lanRxTapQueue = DispatchQueue(label: "KenwoodLanAudio.tap")
+    // The LAN receive queue is a real-time section (kc_rt_guard) and can't allocate a copy or a
+    // dispatch block per packet. It writes the tap audio here and pokes `lanRxTapSignal`, a
+    // coalescing source on lanRxTapQueue that hands it on in packet-sized (960-sample) frames.
+    private let lanRxTapFifo = AudioRingBuffer(capacitySamples: 48_000 * 2)
+    private var lanRxTapSignal: DispatchSourceUserDataAdd?
 
     // Optional tap for consumers (FT8, recording, etc). Called off the main thread.
     // Frame format: 48 kHz mono float samples.
     var onLanRxAudio48kMono: (([Float]) -> Void)?
     // Keep high-rate packet counts off the main thread; publish a throttled view for UI/VoiceOver.
-    private var lanAudioPacketCountRaw: Int = 0
-    private var lanAudioLastPacketAtRaw: Date?
+    // Written by the receive queue under the lock, published by the status timer.
+    private struct LanPacketCounters {
+        var count = 0
+        var lastAt: Date?
+        var first: (seq: UInt16, ssrc: UInt32, bytes: Int)?
+    }
+    // Rig state written by the connection's queue (kc_rig_store_apply) and published to the
+    // @Published properties by a 30 Hz tick on main, only for the fields that changed.
+    private let rigStore: OpaquePointer? = kc_rig_store_create()
+    private var rigStoreCursor: UInt64 = 0
+    private var rigPublishTimer: DispatchSourceTimer?
+    private var rigctlServer: OpaquePointer?
+    private let rigctlBridge = RigctlBridge()
+    // The newest store-handled frame for lastRXFrame, under rxFrameLock.
+    private var rxFrameLock = os_unfair_lock_s()
+    private var pendingRXFrame: String?
+    private var lanPacketLock = os_unfair_lock_s()
+    private var lanPacketCounters = LanPacketCounters()
+    private var hasLoggedFirstLanPacket = false
     // Throttle noisy CAT frames so VoiceOver doesn't lose focus due to constant UI updates.
     private var lastRXFrameSMAt: Date = .distantPast
     private let nrStrengthKey        = "nr_strength"
@@ -169,39 +226,72 @@ final class RadioState: ObservableObject {
     private let lanAudioOutputUIDKey = "lan_audio_output_uid"
     private let lanMicInputUIDKey    = "lan_mic_input_uid"
     private let audioInputUIDKey     = "audio_input_uid"
+    private let rigctlEnabledKey     = "rigctl_server_enabled"
+    private let rigctlPortKey        = "rigctl_server_port"
     // Cache the most recently loaded/saved credentials so we don't touch Keychain on every connect.
     // Keyed by "\(accountTypeRaw)|\(host)".
     private var knsCredentialCache: [String: (username: String, password: String)] = [:]
     private var debouncedCAT: [String: DispatchWorkItem] = [:]
+    // EMNR noise-estimate snapshots per band, so NR is at full quality right after a band change.
+    private var noiseEstimateSnapshots: [String: Data] = [:]
+    private var noiseEstimateBand: String?
+    private var isNoiseEstimateHeld: Bool = false
+    // Latest EMNR spectrum hop. Not @Published: polled at 4 Hz, and republishing arrays
+    // that often would churn SwiftUI/VoiceOver. Read it from the main thread.
+    private(set) var latestNoiseSpectrum: EMNRSpectrum?
+    private var noiseSpectrumTimer: DispatchSourceTimer?
+    // Two kc_stats_snapshot buffers (current, previous) on the heap: each is ~13 KB of tuples.
+    private let audioStatsSnapshots: UnsafeMutablePointer<kc_stats_snapshot> = {
+        let p = UnsafeMutablePointer<kc_stats_snapshot>.allocate(capacity: 2)
+        p.initialize(repeating: kc_stats_snapshot(), count: 2)
+        return p
+    }()
+    private var hasAudioStatsBaseline = false
+    private var statusPollTick = 0      // 250 ms ticks of noiseSpectrumTimer
 
     init() {
-        // Build the list of available NR backends.
+        // Build every available NR backend once and keep them: switching is then a crossfade in
+        // the proxy, never a create_emnr/FFTW plan/RNNoise model load while audio is flowing.
         var available: [String] = []
-        if WDSPNoiseReductionProcessor(mode: .emnr) != nil { available.append("WDSP EMNR") }
-        if WDSPNoiseReductionProcessor(mode: .anr)  != nil { available.append("WDSP ANR") }
-        if RNNoiseProcessor() != nil { available.append("RNNoise (in-process)") }
+        if let emnr = WDSPNoiseReductionProcessor(mode: .emnr) {
+            noiseBackends["WDSP EMNR"] = emnr
+            available.append("WDSP EMNR")
+        }
+        if let anr = WDSPNoiseReductionProcessor(mode: .anr) {
+            noiseBackends["WDSP ANR"] = anr
+            available.append("WDSP ANR")
+        }
+        if let rnnoise = RNNoiseProcessor() {
+            noiseBackends["RNNoise (in-process)"] = rnnoise
+            available.append("RNNoise (in-process)")
+        }
+        noiseBackends["Passthrough (disabled)"] = PassthroughNoiseReduction()
         available.append("Passthrough (disabled)")
         self.availableNoiseReductionBackends = available
 
         // Pick the best available backend and wire it into the proxy.
         // Auto-selection order: WDSP EMNR → RNNoise C → Passthrough.
-        if let emnr = WDSPNoiseReductionProcessor(mode: .emnr) {
-            noiseProcessor = emnr
+        if let emnr = noiseBackends["WDSP EMNR"] {
+            processorProxy.switchTo(emnr)
             isNoiseReductionEnabled = false
             noiseReductionBackend = "WDSP EMNR"
             selectedNoiseReductionBackend = "WDSP EMNR"
-        } else if let rnnoise = RNNoiseProcessor() {
-            noiseProcessor = rnnoise
+        } else if let rnnoise = noiseBackends["RNNoise (in-process)"] as? RNNoiseProcessor {
+            processorProxy.switchTo(rnnoise)
             isNoiseReductionEnabled = rnnoise.isEnabled
             noiseReductionBackend = rnnoise.backendDescription
             selectedNoiseReductionBackend = "RNNoise (in-process)"
         } else {
-            noiseProcessor = PassthroughNoiseReduction()
+            processorProxy.switchTo(noiseBackends["Passthrough (disabled)"]!)
             isNoiseReductionEnabled = false
             noiseReductionBackend = "Passthrough (disabled)"
             selectedNoiseReductionBackend = "Passthrough (disabled)"
         }
         AppFileLogger.shared.log("Noise reduction backend: \(noiseReductionBackend)")
+        openAudioStatsFile()
+        installRealtimeAllocationGuard()
+        startTrafficCapture()
+        startLanRxTap()
 
         loadPersistedKnsSettings()
         loadPersistedNoiseReductionSettings()
@@ -255,6 +345,7 @@ final class RadioState: ObservableObject {
                 case .disconnected: mapped = .disconnected
                 }
                 self?.connectionStatus = mapped.rawValue.capitalized
+                if let server = self?.rigctlServer { kc_rigctl_set_online(server, mapped == .connected ? 1 : 0) }
                 self?.announceConnectionStatus(mapped)
 
                 guard let self else { return }
@@ -266,19 +357,19 @@ final class RadioState: ObservableObject {
                     } else {
                         self.startLanAudio(host: self.currentHost)
                     }
-                    // Prime basic audio/rf controls so sliders reflect real state.
-                    self.send(KenwoodCAT.getAFGain())
-                    self.send(KenwoodCAT.getRFGain())
-                    self.send(KenwoodCAT.getVoipInputLevel())
-                    self.send(KenwoodCAT.getVoipOutputLevel())
-                    // Prime common operating controls (top-5 features).
-                    self.queryTop5()
+                    self.resyncRigState()
+                }
+                if mapped == .connected {
+                    self.restoreMemoryChannels()
                 }
                 if mapped == .disconnected {
+                    self.saveRigSnapshot()
+                    self.cancelMemoryLoad()
                     self.stopMicCapture()
                     // Keep the UDP receiver alive so port 60001 stays bound.
                     // On reconnect we just re-send ##VP1 rather than rebinding.
                     self.isPTTDown = false
+                    self.setNoiseEstimateHeld(false)
                 }
             }
         }
@@ -293,6 +384,9 @@ final class RadioState: ObservableObject {
             }
         }
         connection.onFrame = { [weak self] frame in
+            // On the connection's queue. Rig-state reports, most of the AI traffic, only go into
+            // the store, which the display tick publishes; the rest is handled on main as before.
+            if self?.storeRigFrame(frame) == true { return }
             DispatchQueue.main.async {
                 guard let self else { return }
                 self.handleFrame(frame)
@@ -301,11 +395,15 @@ final class RadioState: ObservableObject {
                 }
             }
         }
+        startRigPublishing()
+        rigctlBridge.state = self
+        if UserDefaults.standard.bool(forKey: rigctlEnabledKey) { setRigctlServerEnabled(true) }
         connection.onLog = { [weak self] message in
             // Auto Information (AI) produces a lot of RX: SM.... frames; keep them out of logs for performance/VoiceOver.
             if message.hasPrefix("RX: SM") { return }
             AppLogger.info(message)
-            AppFileLogger.shared.log(message)
+            // Received frames are in the file log already: the connection logs them from their bytes.
+            if !message.hasPrefix("RX: ") { AppFileLogger.shared.log(message) }
             DispatchQueue.main.async {
                 guard let self else { return }
                 self.connectionLog.append(message)
@@ -346,6 +444,12 @@ final class RadioState: ObservableObject {
             .store(in: &cancellables)
     }
 
+    deinit {
+        rigPublishTimer?.cancel()
+        kc_rigctl_destroy(rigctlServer)
+        kc_rig_store_destroy(rigStore)
+    }
+
     func setAudioMuted(_ muted: Bool) {
         isAudioMuted = muted
         applyAudioMuteState()
@@ -371,6 +475,7 @@ final class RadioState: ObservableObject {
         let type = KenwoodKNS.AccountType(rawValue: knsAccountType) ?? .administrator
         persistKnsSettings(host: host, port: port, accountType: type)
         currentHost = host
+        restoreRigSnapshot(host: host)
         lastError = nil
         connection.connect(host: host, port: p, useKnsLogin: useKnsLogin, accountType: type, adminId: adminId, adminPassword: adminPassword)
         connectionStatus = ConnectionStatus.connecting.rawValue
@@ -404,6 +509,13 @@ final class RadioState: ObservableObject {
         connection.send(command)
     }
 
+    /// Several commands in one write (see TS890Connection.send(_:)).
+    private func send(_ commands: [String]) {
+        guard let last = commands.last else { return }
+        lastTXFrame = last
+        connection.send(commands)
+    }
+
     func setNoiseReduction(enabled: Bool) {
         guard isNoiseReductionEnabled != enabled else { return }
         isNoiseReductionEnabled = enabled
@@ -415,34 +527,27 @@ final class RadioState: ObservableObject {
     func setNoiseReductionBackend(_ backendName: String) {
         selectedNoiseReductionBackend = backendName
         persistNoiseReductionSettings()
-        switch backendName {
-        case "WDSP EMNR":
-            if let emnr = WDSPNoiseReductionProcessor(mode: .emnr) {
-                noiseProcessor = emnr
-                isNoiseReductionEnabled = emnr.isEnabled
-                noiseReductionBackend = "WDSP EMNR"
-                AppFileLogger.shared.log("NR backend switched to: WDSP EMNR")
-            }
-        case "WDSP ANR":
-            if let anr = WDSPNoiseReductionProcessor(mode: .anr) {
-                noiseProcessor = anr
-                isNoiseReductionEnabled = anr.isEnabled
-                noiseReductionBackend = "WDSP ANR"
-                AppFileLogger.shared.log("NR backend switched to: WDSP ANR")
-            }
-        case "RNNoise (in-process)":
-            if let rnnoise = RNNoiseProcessor() {
-                noiseProcessor = rnnoise
-                isNoiseReductionEnabled = rnnoise.isEnabled
-                noiseReductionBackend = rnnoise.backendDescription
-                AppFileLogger.shared.log("NR backend switched to: RNNoise (in-process)")
+        guard let next = noiseBackends[backendName] ?? noiseBackends["Passthrough (disabled)"] else { return }
+        guard next !== noiseProcessor else { return }
+
+        if let emnr = next as? WDSPNoiseReductionProcessor, emnr.mode == .emnr {
+            if let band = noiseEstimateBand, let snapshot = noiseEstimateSnapshots[band] {
+                emnr.restoreNoiseEstimate(snapshot)
             }
-        default: // "Passthrough (disabled)"
-            noiseProcessor = PassthroughNoiseReduction()
-            isNoiseReductionEnabled = false
-            noiseReductionBackend = "Passthrough (disabled)"
-            AppFileLogger.shared.log("NR backend switched to: Passthrough")
+            emnr.isNoiseEstimateFrozen = isNoiseEstimateHeld
         }
+        // Carry the on/off state across the switch so the crossfade goes wet → wet.
+        next.isEnabled = next.isAvailable && isNoiseReductionEnabled
+        processorProxy.switchTo(next)
+        isNoiseReductionEnabled = next.isEnabled
+
+        switch next {
+        case let rnnoise as RNNoiseProcessor:
+            noiseReductionBackend = rnnoise.backendDescription
+        default:
+            noiseReductionBackend = noiseBackends[backendName] == nil ? "Passthrough (disabled)" : backendName
+        }
+        AppFileLogger.shared.log("NR backend switched to: \(noiseReductionBackend)")
     }
 
     var isNoiseReductionAvailable: Bool { noiseProcessor.isAvailable }
@@ -493,29 +598,222 @@ final class RadioState: ObservableObject {
     // MARK: - Top-5 Operating Features
 
     func queryTop5() {
-        // VFO A (also pushed by AI, but query on connect for instant population).
-        send(KenwoodCAT.getVFOAFrequency())
-        // VFO B + split (FR/FT), RIT/XIT, RX filter, power, ATU.
-        send(KenwoodCAT.getVFOBFrequency())
-        send(KenwoodCAT.getReceiverVFO())
-        send(KenwoodCAT.getTransmitterVFO())
-        send(KenwoodCAT.ritGetState())
-        send(KenwoodCAT.xitGetState())
-        send(KenwoodCAT.ritXitGetOffset())
-        send(KenwoodCAT.getReceiveFilterShift())
-        send(KenwoodCAT.getReceiveFilterLowCutSettingID())
-        send(KenwoodCAT.getReceiveFilterHighCutSettingID())
-        send(KenwoodCAT.getOutputPower())
-        send(KenwoodCAT.getAntennaTuner())
-        send(KenwoodCAT.getSplitOffsetSettingState())
-        // Memory mode/channel are useful for quick operation.
-        send(KenwoodCAT.getMemoryMode())
-        send(KenwoodCAT.getMemoryChannelNumber())
-        // Mode, squelch, NR, notch — not pushed by AI mode.
-        send(KenwoodCAT.getOperatingMode(.left))
-        send(KenwoodCAT.getSquelchLevel())
-        send(KenwoodCAT.getNoiseReduction())
-        send(KenwoodCAT.getNotch())
+        send(top5Queries)
+    }
+
+    private var top5Queries: [String] {
+        [
+            // VFO A (also pushed by AI, but query on connect for instant population).
+            KenwoodCAT.getVFOAFrequency(),
+            // VFO B + split (FR/FT), RIT/XIT, RX filter, power, ATU.
+            KenwoodCAT.getVFOBFrequency(),
+            KenwoodCAT.getReceiverVFO(),
+            KenwoodCAT.getTransmitterVFO(),
+            KenwoodCAT.ritGetState(),
+            KenwoodCAT.xitGetState(),
+            KenwoodCAT.ritXitGetOffset(),
+            KenwoodCAT.getReceiveFilterShift(),
+            KenwoodCAT.getReceiveFilterLowCutSettingID(),
+            KenwoodCAT.getReceiveFilterHighCutSettingID(),
+            KenwoodCAT.getOutputPower(),
+            KenwoodCAT.getAntennaTuner(),
+            KenwoodCAT.getSplitOffsetSettingState(),
+            // Memory mode/channel are useful for quick operation.
+            KenwoodCAT.getMemoryMode(),
+            KenwoodCAT.getMemoryChannelNumber(),
+            // Mode, squelch, NR, notch — not pushed by AI mode.
+            KenwoodCAT.getOperatingMode(.left),
+            KenwoodCAT.getSquelchLevel(),
+            KenwoodCAT.getNoiseReduction(),
+            KenwoodCAT.getNotch(),
+        ]
+    }
+
+    // MARK: - Fast connect: rig-state snapshot and resync
+
+    private func rigSnapshotKey(host: String) -> String {
+        "RigStateSnapshot." + host.lowercased()
+    }
+
+    /// The rig state as the radio last reported it (or as restored).
+    private func currentRigValues() -> kc_rig_values {
+        var values = kc_rig_values()
+        var cursor: UInt64 = 0
+        kc_rig_store_poll(rigStore, &cursor, &values)
+        return values
+    }
+
+    /// Puts `r` in the store and on screen at once (a restored snapshot).
+    private func applyRigValues(_ r: kc_rig_values) {
+        var r = r
+        kc_rig_store_load(rigStore, &r)
+        publishRigState()
+    }
+
+    /// For a control set from the UI before the radio confirms it: the store holds what the control
+    /// shows, so a read-back that differs (the radio clamped or refused the value) is a change and
+    /// is published over it.
+    private func setRigField(_ field: kc_rig_field, _ value: Int) {
+        kc_rig_store_set(rigStore, field, Int64(value), 1)
+    }
+
+    /// Called by the connection for every frame, on its queue: a rig-state report goes into the
+    /// store and is done with (true); anything else is for handleFrame (false).
+    private func storeRigFrame(_ frame: String) -> Bool {
+        var frame = frame
+        let stored = frame.withUTF8 { bytes in
+            bytes.withMemoryRebound(to: CChar.self) { chars in
+                var msg = kc_cat_msg()
+                guard kc_cat_decode(chars.baseAddress, chars.count, &msg) != 0 else { return false }
+                // TX/RX are stored for the rigctl server, but keying stays on handleFrame's path.
+                let fields = kc_rig_store_apply(rigStore, &msg)
+                return fields != 0 && msg.cmd != KC_CAT_TX && msg.cmd != KC_CAT_RX
+            }
+        }
+        if stored {
+            os_unfair_lock_lock(&rxFrameLock)
+            pendingRXFrame = frame
+            os_unfair_lock_unlock(&rxFrameLock)
+        }
+        return stored
+    }
+
+    /// Publishes the store at display rate: however many frames arrived, each control is assigned
+    /// at most once per tick, and only when its value changed.
+    private func startRigPublishing() {
+        let t = DispatchSource.makeTimerSource(queue: .main)
+        t.schedule(deadline: .now(), repeating: .milliseconds(33), leeway: .milliseconds(5))
+        t.setEventHandler { [weak self] in self?.publishRigState() }
+        rigPublishTimer = t
+        t.resume()
+    }
+
+    private func publishRigState() {
+        var r = kc_rig_values()
+        let changed = kc_rig_store_poll(rigStore, &rigStoreCursor, &r)
+        if changed != 0 { publishRigValues(r, changed: changed) }
+
+        os_unfair_lock_lock(&rxFrameLock)
+        let frame = pendingRXFrame
+        pendingRXFrame = nil
+        os_unfair_lock_unlock(&rxFrameLock)
+        if let frame, shouldPublishLastRXFrame(frame) { lastRXFrame = frame }
+
+        if resyncPending != 0 {
+            resyncPending &= ~kc_rig_store_seen(rigStore)
+            if resyncPending == 0 { finishResync() }
+        }
+    }
+
+    private func publishRigValues(_ r: kc_rig_values, changed: UInt64) {
+        func has(_ f: kc_rig_field) -> Bool { (changed >> UInt64(f.rawValue)) & 1 != 0 }
+        if has(KC_RIG_VFO_A) { vfoAFrequencyHz = r[KC_RIG_VFO_A] }
+        if has(KC_RIG_VFO_B) { vfoBFrequencyHz = r[KC_RIG_VFO_B] }
+        if has(KC_RIG_MODE) { operatingMode = r[KC_RIG_MODE].flatMap { KenwoodCAT.OperatingMode(rawValue: $0) } }
+        if has(KC_RIG_RX_VFO) { rxVFO = r[KC_RIG_RX_VFO].flatMap { KenwoodCAT.VFO(rawValue: $0) } }
+        if has(KC_RIG_TX_VFO) { txVFO = r[KC_RIG_TX_VFO].flatMap { KenwoodCAT.VFO(rawValue: $0) } }
+        if has(KC_RIG_RIT) { ritEnabled = r[KC_RIG_RIT].map { $0 == 1 } }
+        if has(KC_RIG_XIT) { xitEnabled = r[KC_RIG_XIT].map { $0 == 1 } }
+        if has(KC_RIG_RIT_XIT_OFFSET) { ritXitOffsetHz = r[KC_RIG_RIT_XIT_OFFSET] }
+        if has(KC_RIG_FILTER_SHIFT) { rxFilterShiftHz = r[KC_RIG_FILTER_SHIFT] }
+        if has(KC_RIG_LOW_CUT) { rxFilterLowCutID = r[KC_RIG_LOW_CUT] }
+        if has(KC_RIG_HIGH_CUT) { rxFilterHighCutID = r[KC_RIG_HIGH_CUT] }
+        if has(KC_RIG_POWER) { outputPowerWatts = r[KC_RIG_POWER] }
+        if has(KC_RIG_ATU_TX) { atuTxEnabled = r[KC_RIG_ATU_TX].map { $0 == 1 } }
+        if has(KC_RIG_ATU_TUNING) { atuTuningActive = r[KC_RIG_ATU_TUNING].map { $0 == 1 } }
+        if has(KC_RIG_SPLIT_ACTIVE) { splitOffsetSettingActive = r[KC_RIG_SPLIT_ACTIVE].map { $0 == 1 } }
+        if has(KC_RIG_MEMORY_MODE) { isMemoryMode = r[KC_RIG_MEMORY_MODE].map { $0 == 1 } }
+        if has(KC_RIG_MEMORY_CHANNEL) { memoryChannelNumber = r[KC_RIG_MEMORY_CHANNEL] }
+        if has(KC_RIG_SQUELCH) { squelchLevel = r[KC_RIG_SQUELCH] }
+        if has(KC_RIG_NR_MODE) {
+            transceiverNRMode = r[KC_RIG_NR_MODE].flatMap { KenwoodCAT.NoiseReductionMode(rawValue: $0) }
+        }
+        if has(KC_RIG_NOTCH) { isNotchEnabled = r[KC_RIG_NOTCH].map { $0 == 1 } }
+        if has(KC_RIG_AF_GAIN) { afGain = r[KC_RIG_AF_GAIN] }
+        if has(KC_RIG_RF_GAIN) { rfGain = r[KC_RIG_RF_GAIN] }
+        if has(KC_RIG_VOIP_IN) { voipInputLevel = r[KC_RIG_VOIP_IN] }
+        if has(KC_RIG_VOIP_OUT) { voipOutputLevel = r[KC_RIG_VOIP_OUT] }
+        if has(KC_RIG_S_METER) { sMeterDots = r[KC_RIG_S_METER] }
+        // DA + P1 (0/1). Some rigs may respond with `?;` instead.
+        if has(KC_RIG_DATA_MODE) { dataModeEnabled = r[KC_RIG_DATA_MODE].map { $0 == 1 } }
+
+        // The receive VFO's frequency picks the band's EMNR noise estimate.
+        if has(KC_RIG_VFO_A), rxVFO != .b, let hz = vfoAFrequencyHz { noteReceiveFrequencyForNoiseEstimate(hz) }
+        if has(KC_RIG_VFO_B), rxVFO == .b, let hz = vfoBFrequencyHz { noteReceiveFrequencyForNoiseEstimate(hz) }
+    }
+
+    /// At disconnect: what the controls showed, for the next connect to this host.
+    private func saveRigSnapshot() {
+        guard !currentHost.isEmpty else { return }
+        var values = currentRigValues()
+        guard values.valid != 0 else { return }
+        var buf = [UInt8](repeating: 0, count: Int(KC_RIG_SNAPSHOT_MAX))
+        let n = kc_rig_snapshot_encode(&values, &buf, buf.count)
+        guard n > 0 else { return }
+        UserDefaults.standard.set(Data(buf.prefix(n)), forKey: rigSnapshotKey(host: currentHost))
+        rigSnapshotHost = currentHost
+    }
+
+    /// At connect: the controls show the last state seen on this radio straight away. A reconnect
+    /// to the radio already on screen keeps what is there (it is newer).
+    private func restoreRigSnapshot(host: String) {
+        defer { rigValuesAtConnect = currentRigValues() }
+        guard host != rigSnapshotHost else { return }
+        rigSnapshotHost = host
+        var values = kc_rig_values()
+        if let data = UserDefaults.standard.data(forKey: rigSnapshotKey(host: host)) {
+            let ok = data.withUnsafeBytes { raw in
+                kc_rig_snapshot_decode(raw.bindMemory(to: UInt8.self).baseAddress, raw.count, &values) == 0
+            }
+            if !ok { values = kc_rig_values() }
+        }
+        applyRigValues(values)
+        if values.valid != 0 {
+            AppFileLogger.shared.log("Connect: \(values.valid.nonzeroBitCount) controls restored from the last session")
+        }
+    }
+
+    /// Reads back everything the snapshot holds, in one write; answers replace the restored values
+    /// as they arrive. Logs how long until every field had been answered and published (checked
+    /// on the display tick) and which ones had changed.
+    private func resyncRigState() {
+        resyncStartedAt = .now()
+        kc_rig_store_clear_seen(rigStore)
+        resyncPending = kc_rig_snapshot_fields()
+        resyncGeneration &+= 1
+        send([
+            // Prime basic audio/rf controls so sliders reflect real state.
+            KenwoodCAT.getAFGain(),
+            KenwoodCAT.getRFGain(),
+            KenwoodCAT.getVoipInputLevel(),
+            KenwoodCAT.getVoipOutputLevel(),
+        ] + top5Queries)
+        let generation = resyncGeneration
+        DispatchQueue.main.asyncAfter(deadline: .now() + 3.0) { [weak self] in
+            guard let self, self.resyncGeneration == generation, self.resyncPending != 0 else { return }
+            self.finishResync()
+        }
+    }
+
+    private func finishResync() {
+        let ms = Double(DispatchTime.now().uptimeNanoseconds - resyncStartedAt.uptimeNanoseconds) / 1e6
+        var before = rigValuesAtConnect
+        var now = currentRigValues()
+        let changed = kc_rig_values_diff(&before, &now)
+        var line = "Connect: state resynced in \(Int(ms)) ms, \(changed.nonzeroBitCount) controls changed"
+        if before.valid == 0 { line += " (no snapshot)" }
+        if resyncPending != 0 {
+            line += "; no answer for " + Self.rigFieldNames(resyncPending).joined(separator: ", ")
+        }
+        resyncPending = 0
+        AppFileLogger.shared.log(line)
+        connectionLog.append(line)
+    }
+
+    private static func rigFieldNames(_ mask: UInt64) -> [String] {
+        (0..<Int(KC_RIG_FIELD_COUNT.rawValue)).filter { mask >> UInt64($0) & 1 != 0 }.map {
+            String(cString: kc_rig_field_name(kc_rig_field(rawValue: UInt32($0))))
+        }
     }
 
     func setVFOBFrequencyHz(_ hz: Int) {
@@ -602,6 +900,7 @@ final class RadioState: ObservableObject {
 
     func setOutputPowerWattsDebounced(_ watts: Int) {
         let clamped = max(5, min(watts, 100))
+        setRigField(KC_RIG_POWER, clamped)
         outputPowerWatts = clamped
         debounceCAT(key: "tx_power", delaySeconds: 0.20) { [weak self] in
             guard let self else { return }
@@ -616,6 +915,7 @@ final class RadioState: ObservableObject {
     }
 
     func setMemoryMode(enabled: Bool) {
+        setRigField(KC_RIG_MEMORY_MODE, enabled ? 1 : 0)
         isMemoryMode = enabled
         send(KenwoodCAT.setMemoryMode(enabled))
         send(KenwoodCAT.getMemoryMode())
@@ -624,6 +924,7 @@ final class RadioState: ObservableObject {
 
     func recallMemoryChannel(_ channel: Int) {
         let clamped = max(0, min(channel, 119))
+        setRigField(KC_RIG_MEMORY_CHANNEL, clamped)
         memoryChannelNumber = clamped
         send(KenwoodCAT.setMemoryChannelNumber(clamped))
         send(KenwoodCAT.getMemoryChannelNumber())
@@ -638,6 +939,7 @@ final class RadioState: ObservableObject {
     func programMemoryChannel(channel: Int, frequencyHz: Int, mode: KenwoodCAT.OperatingMode, fmNarrow: Bool, name: String) {
         let ch = max(0, min(channel, 119))
         let hz = max(0, min(frequencyHz, 99_999_999_999))
+        setRigField(KC_RIG_MEMORY_CHANNEL, ch)
         memoryChannelNumber = ch
         AppFileLogger.shared.log("UI: Program memory ch=\(ch) hz=\(hz) mode=\(mode.rawValue) fmNarrow=\(fmNarrow) name=\(name)")
 
@@ -650,34 +952,137 @@ final class RadioState: ObservableObject {
             send(KenwoodCAT.setMemoryChannelName(ch, name: trimmedName))
         }
 
-        // Read back for confirmation.
+        // Read back for confirmation. Until the answer arrives the cached copy is stale, including
+        // across a disconnect.
+        memoryCache.dirty.insert(ch)
+        scheduleMemoryCacheSave()
         send(KenwoodCAT.getMemoryChannelNumber())
         send(KenwoodCAT.getMemoryChannelConfiguration(ch))
     }
 
     // MARK: - Memory Browser — batch load all 120 channels
 
+    /// Reads all 120 channels again. The list keeps showing the cached copy meanwhile, and only
+    /// channels whose contents changed are republished.
     func loadAllMemoryChannels() {
         guard !isLoadingAllMemories else { return }
-        isLoadingAllMemories = true
-        memoryChannels = []
         AppFileLogger.shared.log("Memory: loading all 120 channels")
-        // Stagger requests by 50 ms to avoid flooding the radio's command queue.
-        for ch in 0..<120 {
-            let delay = Double(ch) * 0.05
-            DispatchQueue.main.asyncAfter(deadline: .now() + delay) { [weak self] in
-                guard let self else { return }
-                self.send(KenwoodCAT.getMemoryChannelConfiguration(ch))
-                if ch == 119 {
-                    // Allow last response time to arrive before clearing the flag.
-                    DispatchQueue.main.asyncAfter(deadline: .now() + 0.5) { [weak self] in
-                        self?.isLoadingAllMemories = false
-                    }
-                }
+        startMemoryLoad(Array(0..<120), full: true)
+    }
+
+    /// On connect: shows the radio's saved table at once, then reads the channels programmed from
+    /// the app since (their reads may not have been answered), or everything when there is no
+    /// table or its last full read is older than `memoryCacheMaxAge`. CAT has no per-channel change
+    /// counter, so channels changed from the radio's front panel show up on the next full read.
+    private func restoreMemoryChannels() {
+        if memoryCacheHost != currentHost {
+            memoryCacheHost = currentHost
+            memoryCache = MemoryChannelCache.load(host: currentHost) ?? MemoryChannelCache()
+            memoryChannels = memoryCache.channels.sorted { $0.id < $1.id }
+            if !memoryChannels.isEmpty {
+                AppFileLogger.shared.log("Memory: \(memoryChannels.count) channels from the cache, "
+                    + "\(memoryCache.dirty.count) to refresh")
+            }
+        }
+        if memoryChannels.isEmpty || Date().timeIntervalSince(memoryCache.verifiedAt) > memoryCacheMaxAge {
+            startMemoryLoad(Array(0..<120), full: true)
+        } else if !memoryCache.dirty.isEmpty {
+            startMemoryLoad(memoryCache.dirty.sorted(), full: false)
+        }
+    }
+
+    /// Reads `channels` with up to `memoryLoadWindow` MA0 queries awaiting answers at once; each
+    /// answer sends the next. Programmed (dirty) channels go first.
+    private func startMemoryLoad(_ channels: [Int], full: Bool) {
+        memoryLoadGeneration &+= 1
+        let dirty = memoryCache.dirty
+        memoryLoadQueue = channels.filter { dirty.contains($0) } + channels.filter { !dirty.contains($0) }
+        memoryLoadInFlight = [:]
+        memoryLoadStartedAt = .now()
+        memoryLoadChanged = 0
+        memoryLoadIsFull = full
+        isLoadingAllMemories = true
+        pumpMemoryLoad()
+    }
+
+    private func pumpMemoryLoad() {
+        while memoryLoadInFlight.count < memoryLoadWindow, !memoryLoadQueue.isEmpty {
+            sendMemoryRead(memoryLoadQueue.removeFirst(), attempts: 1)
+        }
+        guard isLoadingAllMemories, memoryLoadQueue.isEmpty, memoryLoadInFlight.isEmpty else { return }
+        isLoadingAllMemories = false
+        let ms = Double(DispatchTime.now().uptimeNanoseconds - memoryLoadStartedAt.uptimeNanoseconds) / 1e6
+        AppFileLogger.shared.log("Memory: load done in \(Int(ms)) ms, \(memoryLoadChanged) changed")
+        if memoryLoadIsFull, memoryCache.dirty.isEmpty { memoryCache.verifiedAt = Date() }
+        saveMemoryCache()
+    }
+
+    private func sendMemoryRead(_ ch: Int, attempts: Int) {
+        memoryLoadInFlight[ch] = attempts
+        send(KenwoodCAT.getMemoryChannelConfiguration(ch))
+        let generation = memoryLoadGeneration
+        DispatchQueue.main.asyncAfter(deadline: .now() + memoryLoadTimeout) { [weak self] in
+            guard let self, self.memoryLoadGeneration == generation,
+                  self.memoryLoadInFlight[ch] == attempts else { return }
+            self.memoryLoadInFlight[ch] = nil
+            if attempts < 2 {
+                self.sendMemoryRead(ch, attempts: attempts + 1)
+            } else {
+                AppFileLogger.shared.log("Memory: no answer for channel \(ch)")
+                self.pumpMemoryLoad()
+            }
+        }
+    }
+
+    /// Stops a load in progress (disconnect); the cache keeps what was read.
+    private func cancelMemoryLoad() {
+        memoryLoadGeneration &+= 1
+        memoryLoadQueue = []
+        memoryLoadInFlight = [:]
+        if isLoadingAllMemories {
+            isLoadingAllMemories = false
+            saveMemoryCache()
+        }
+    }
+
+    /// One MA0 answer: the browser row (republished only if it changed), the cache and the loader.
+    private func updateMemoryChannel(_ entry: MemoryChannel) {
+        let ch = entry.id
+        if let idx = memoryChannels.firstIndex(where: { $0.id == ch }) {
+            if memoryChannels[idx].checksum != entry.checksum {
+                memoryChannels[idx] = entry
+                memoryLoadChanged += 1
             }
+        } else {
+            // Insert in order
+            let insertIdx = memoryChannels.firstIndex(where: { $0.id > ch }) ?? memoryChannels.endIndex
+            memoryChannels.insert(entry, at: insertIdx)
+            memoryLoadChanged += 1
+        }
+        memoryCache.dirty.remove(ch)
+        if memoryLoadInFlight.removeValue(forKey: ch) != nil {
+            pumpMemoryLoad()
+        } else {
+            scheduleMemoryCacheSave()
         }
     }
 
+    private func scheduleMemoryCacheSave() {
+        guard !memoryCacheSaveScheduled else { return }
+        memoryCacheSaveScheduled = true
+        DispatchQueue.main.asyncAfter(deadline: .now() + 1.0) { [weak self] in
+            guard let self else { return }
+            self.memoryCacheSaveScheduled = false
+            self.saveMemoryCache()
+        }
+    }
+
+    private func saveMemoryCache() {
+        guard !memoryCacheHost.isEmpty else { return }
+        memoryCache.store(memoryChannels)
+        memoryCache.save(host: memoryCacheHost)
+    }
+
     func startATUTuning() {
         send(KenwoodCAT.startAntennaTuning())
         send(KenwoodCAT.getAntennaTuner())
@@ -737,6 +1142,7 @@ final class RadioState: ObservableObject {
             try monitor.start(inputDeviceID: inputID, outputDeviceID: outputID)
             audioMonitor = monitor
             isAudioMonitorRunning = true
+            startNoiseReductionStatusPolling()
         } catch {
             audioMonitorError = error.localizedDescription
             audioMonitor = nil
@@ -748,6 +1154,7 @@ final class RadioState: ObservableObject {
         audioMonitor?.stop()
         audioMonitor = nil
         isAudioMonitorRunning = false
+        stopNoiseReductionStatusPolling()
     }
 
     func setAudioMonitorWetDry(_ value: Double) {
@@ -772,10 +1179,14 @@ final class RadioState: ObservableObject {
             AppFileLogger.shared.log("LAN: startLanAudio skipped — already running")
             return
         }
-        lanAudioPacketCountRaw = 0
-        lanAudioLastPacketAtRaw = nil
+        os_unfair_lock_lock(&lanPacketLock)
+        lanPacketCounters = LanPacketCounters()
+        os_unfair_lock_unlock(&lanPacketLock)
+        hasLoggedFirstLanPacket = false
+        lanRxTapFifo.clear()
         lanAudioPacketCount = 0
         lanAudioLastPacketAt = nil
+        lanJitterSummary = nil
 
         // Start output first, so we can surface any errors early.
         let player = AudioOutputPlayer(sampleRate: 48_000)
@@ -813,35 +1224,25 @@ final class RadioState: ObservableObject {
         }
         receiver.onPacket = { [weak self] seq, ssrc, payloadBytes in
             guard let self else { return }
-            self.lanAudioPacketCountRaw &+= 1
-            self.lanAudioLastPacketAtRaw = Date()
-
-            // Updating @Published 50 times/sec can make SwiftUI + VoiceOver feel hung.
-            // Publish only occasionally while keeping accurate internal counts.
-            let n = self.lanAudioPacketCountRaw
-            if n == 1 || (n % 25) == 0 {
-                let lastAt = self.lanAudioLastPacketAtRaw
-                DispatchQueue.main.async {
-                    self.lanAudioPacketCount = n
-                    self.lanAudioLastPacketAt = lastAt
-                    if n == 1 {
-                        self.connectionLog.append("LAN: first packet seq=\(seq) ssrc=\(String(format: "0x%08X", ssrc)) bytes=\(payloadBytes)")
-                        AppLogger.info("LAN: first packet seq=\(seq) ssrc=\(String(format: "0x%08X", ssrc)) bytes=\(payloadBytes)")
-                        AppFileLogger.shared.log("LAN: first packet seq=\(seq) ssrc=\(String(format: "0x%08X", ssrc)) bytes=\(payloadBytes)")
-                    }
-                }
+            // Updating @Published 50 times/sec can make SwiftUI + VoiceOver feel hung, and this
+            // runs on the receive queue, which must not allocate: just count here, and let the
+            // status timer publish (pollLanPacketCounters).
+            os_unfair_lock_lock(&self.lanPacketLock)
+            self.lanPacketCounters.count &+= 1
+            self.lanPacketCounters.lastAt = Date()
+            if self.lanPacketCounters.first == nil {
+                self.lanPacketCounters.first = (seq, ssrc, payloadBytes)
             }
+            os_unfair_lock_unlock(&self.lanPacketLock)
         }
         receiver.onAudio48kMono = { [weak self] samples in
-            if let tap = self?.onLanRxAudio48kMono {
-                // Copy the frame to decouple from any internal buffers.
-                let frame = samples
-                self?.lanRxTapQueue.async {
-                    tap(frame)
-                }
+            guard let self else { return }
+            if self.onLanRxAudio48kMono != nil, let base = samples.baseAddress {
+                _ = self.lanRxTapFifo.write(from: base, count: samples.count)
+                self.lanRxTapSignal?.add(data: 1)
             }
-            pipeline.process48kMono(samples) { outFrame in
-                self?.lanPlayer?.enqueue48kMono(outFrame)
+            pipeline.process48kMono(samples) { outFrames in
+                self.lanPlayer?.enqueue48kMono(outFrames)
             }
         }
 
@@ -860,6 +1261,7 @@ final class RadioState: ObservableObject {
         lanPipeline = pipeline
         lanReceiver = receiver
         isLanAudioRunning = true
+        startNoiseReductionStatusPolling()
 
         AppFileLogger.shared.log("LAN: output device uid=\(selectedLanAudioOutputUID.isEmpty ? "(default)" : selectedLanAudioOutputUID)")
 
@@ -877,15 +1279,15 @@ final class RadioState: ObservableObject {
             connection.send("##VP0;")
         }
         stopMicCapture()
-        // Final publish snapshot (useful if UI throttling skipped the last updates).
-        lanAudioPacketCount = lanAudioPacketCountRaw
-        lanAudioLastPacketAt = lanAudioLastPacketAtRaw
         lanReceiver?.stop()
+        // Final publish snapshot (useful if UI throttling skipped the last updates).
+        pollLanPacketCounters(force: true)
         lanReceiver = nil
         lanPipeline = nil
         lanPlayer?.stop()
         lanPlayer = nil
         isLanAudioRunning = false
+        stopNoiseReductionStatusPolling()
     }
 
     func setLanAudioWetDry(_ value: Double) {
@@ -995,304 +1397,353 @@ final class RadioState: ObservableObject {
     }
 
     private func handleFrame(_ frame: String) {
-        let cleaned = frame.trimmingCharacters(in: .whitespacesAndNewlines.union(.controlCharacters))
-        let core = cleaned.hasSuffix(";") ? String(cleaned.dropLast()) : cleaned
-
-        if core.hasPrefix("FA") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let hz = Int(digits) { vfoAFrequencyHz = hz }
-            return
-        }
-
-        if core.hasPrefix("FB") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let hz = Int(digits) { vfoBFrequencyHz = hz }
-            return
-        }
-
-        if core.hasPrefix("OM"), core.count >= 4 {
-            // Format: OM + P1 + P2
-            let params = core.dropFirst(2)
-            let modeDigit = params.dropFirst().prefix(1)
-            if let raw = Int(modeDigit), let mode = KenwoodCAT.OperatingMode(rawValue: raw) {
-                operatingMode = mode
+        var frame = frame
+        frame.withUTF8 { bytes in
+            bytes.withMemoryRebound(to: CChar.self) { chars in
+                var msg = kc_cat_msg()
+                guard kc_cat_decode(chars.baseAddress, chars.count, &msg) != 0 else { return }
+                applyFrame(msg)
             }
-            return
-        }
-
-        if core.hasPrefix("MD") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let v = Int(digits) { mdMode = v }
-            return
         }
+    }
 
-        if core.hasPrefix("DA"), core.count >= 3 {
-            // DA + P1 (0/1). Some rigs may respond with `?;` instead.
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1) {
-                dataModeEnabled = (raw == 1)
-            }
-            return
-        }
+    /// One decoded frame (kc_cat_codec; field layouts in Native/kc_cat_spec.h) that isn't rig
+    /// state (kc_rig_store takes those, see storeRigFrame). `msg.text` points into the frame, so
+    /// this runs inside handleFrame's buffer access.
+    private func applyFrame(_ msg: kc_cat_msg) {
+        switch msg.cmd {
+        case KC_CAT_MD:
+            if let v = msg.int(0) { mdMode = v }
 
-        if core.hasPrefix("FR") {
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1), let vfo = KenwoodCAT.VFO(rawValue: raw) {
-                rxVFO = vfo
+        case KC_CAT_MA:
+            // MA0 + channel(3) + freq(11) + mode(1) + ... + name(<=10)
+            guard msg.int(0) == 0, let ch = msg.int(1) else { return }
+            let hz = msg.int(2)
+            let mode = msg.int(3).flatMap { KenwoodCAT.OperatingMode(rawValue: $0) }
+            let name = msg.textString
+
+            // Populate the MemoryBrowserView array regardless of selected channel.
+            updateMemoryChannel(MemoryChannel(id: ch, frequencyHz: hz ?? 0, mode: mode ?? .usb, name: name,
+                                              isEmpty: (hz ?? 0) == 0))
+
+            // Only overwrite details when the MA0 response matches the selected channel.
+            guard memoryChannelNumber == nil || memoryChannelNumber == ch else { return }
+            setRigField(KC_RIG_MEMORY_CHANNEL, ch)
+            memoryChannelNumber = ch
+            memoryChannelFrequencyHz = hz
+            memoryChannelMode = mode
+            memoryChannelName = name.isEmpty ? nil : name
+
+        case KC_CAT_EX:
+            // EX + 3-digit menu number + value (signed or unsigned)
+            guard let menuNum = msg.int(0), msg.count >= 2 else { return }
+            let value = msg.int(1) ?? 0
+            // Store in general map (used by RadioMenuView)
+            exMenuValues[menuNum] = value
+            // Dispatch to typed EQ properties
+            switch menuNum {
+            case 30: txEQLowGain = value
+            case 31: txEQMidGain = value
+            case 32: txEQHighGain = value
+            case 60: rxEQLowGain = value
+            case 61: rxEQMidGain = value
+            case 62: rxEQHighGain = value
+            default: break
             }
-            return
-        }
 
-        if core.hasPrefix("FT") {
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1), let vfo = KenwoodCAT.VFO(rawValue: raw) {
-                txVFO = vfo
-            }
-            return
-        }
+        case KC_CAT_RX:
+            guard msg.count == 0, msg.rest == 0 else { return }
+            isTransmitting = false
+            isPTTDown = false
+            setNoiseEstimateHeld(false)
 
-        if core.hasPrefix("NR") {
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1), let mode = KenwoodCAT.NoiseReductionMode(rawValue: raw) {
-                transceiverNRMode = mode
-            }
-            return
-        }
+        case KC_CAT_TX:
+            isTransmitting = true
+            isPTTDown = true
+            setNoiseEstimateHeld(true)
 
-        if core.hasPrefix("RT") {
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1) {
-                ritEnabled = (raw == 1)
-            }
-            return
+        default:
+            break
         }
+    }
 
-        if core.hasPrefix("XT") {
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1) {
-                xitEnabled = (raw == 1)
-            }
-            return
-        }
+    // MARK: - rigctl server
 
-        if core.hasPrefix("RF"), core.count >= 7 {
-            // RF + P1(direction 0/1) + P2P2P2P2 (Hz)
-            let params = core.dropFirst(2)
-            let dirChar = params.prefix(1)
-            let hzDigits = params.dropFirst(1).prefix(4)
-            if let dir = Int(dirChar), let hz = Int(hzDigits) {
-                ritXitOffsetHz = (dir == 1) ? -hz : hz
-            }
+    /// Starts or stops the rigctld-compatible server on localhost (port 4532, or the
+    /// "rigctl_server_port" default). Clients' reads come from the rig-state store; their sets
+    /// and PTT come back here on main and go out like the app's own.
+    func setRigctlServerEnabled(_ enabled: Bool) {
+        UserDefaults.standard.set(enabled, forKey: rigctlEnabledKey)
+        if !enabled {
+            stopRigctlServer()
             return
         }
-
-        if core.hasPrefix("IS"), core.count >= 7 {
-            // IS + sign (+/-/space) + 4 digits
-            let params = core.dropFirst(2)
-            let signChar = params.prefix(1)
-            let hzDigits = params.dropFirst(1).prefix(4)
-            if let hz = Int(hzDigits) {
-                let sign = (signChar == "-") ? -1 : 1
-                rxFilterShiftHz = hz * sign
-            }
+        guard rigctlServer == nil else { return }
+        let savedPort = UserDefaults.standard.integer(forKey: rigctlPortKey)
+        var config = kc_rigctl_config()
+        config.port = Int32(savedPort > 0 ? savedPort : Int(KC_RIGCTL_DEFAULT_PORT))
+        config.store = rigStore
+        config.ctx = Unmanaged.passUnretained(rigctlBridge).toOpaque()
+        config.submit = { ctx, command, length in
+            // On the server's thread.
+            guard let ctx, let command else { return }
+            let bridge = Unmanaged<RigctlBridge>.fromOpaque(ctx).takeUnretainedValue()
+            let text = String(decoding: UnsafeRawBufferPointer(start: command, count: length), as: UTF8.self)
+            DispatchQueue.main.async { bridge.state?.send(text) }
+        }
+        config.ptt = { ctx, down in
+            guard let ctx else { return }
+            let bridge = Unmanaged<RigctlBridge>.fromOpaque(ctx).takeUnretainedValue()
+            DispatchQueue.main.async { bridge.state?.setPTT(down: down != 0) }
+        }
+        guard let server = kc_rigctl_create(&config) else {
+            let err = "rigctl: can't listen on port \(config.port): \(String(cString: strerror(errno)))"
+            rigctlServerEnabled = false
+            rigctlServerStatus = "Off"
+            AppFileLogger.shared.log(err)
+            errorLog.append(err)
+            announceError(err)
             return
         }
+        rigctlServer = server
+        kc_rigctl_set_online(server, connectionStatus == ConnectionStatus.connected.rawValue.capitalized ? 1 : 0)
+        rigctlServerEnabled = true
+        rigctlServerStatus = "Listening on 127.0.0.1:\(kc_rigctl_port(server))"
+        AppFileLogger.shared.log("rigctl: \(rigctlServerStatus)")
+    }
 
-        if core.hasPrefix("SL"), core.count >= 5 {
-            // SL + P1(type) + P2P2
-            let params = core.dropFirst(2)
-            let typeChar = params.prefix(1)
-            let idDigits = params.dropFirst(1).prefix(2)
-            if typeChar == "0", let id = Int(idDigits) {
-                rxFilterLowCutID = id
-            }
-            return
-        }
+    private func stopRigctlServer() {
+        guard let server = rigctlServer else { return }
+        var st = kc_rigctl_stats()
+        kc_rigctl_read_stats(server, &st)
+        AppFileLogger.shared.log("rigctl: stopped; \(st.accepted) connections (\(st.maxClients) at once, \(st.refused) refused), " +
+                                 "\(st.reads) reads from the store, \(st.sets) sets, \(st.errors) errors")
+        kc_rigctl_destroy(server)
+        rigctlServer = nil
+        rigctlServerEnabled = false
+        rigctlServerStatus = "Off"
+    }
 
-        if core.hasPrefix("SH"), core.count >= 6 {
-            // SH + P1(type) + P2P2P2
-            let params = core.dropFirst(2)
-            let typeChar = params.prefix(1)
-            let idDigits = params.dropFirst(1).prefix(3)
-            if typeChar == "0", let id = Int(idDigits) {
-                rxFilterHighCutID = id
-            }
-            return
-        }
+    // MARK: - EMNR noise estimate hold / per-band snapshots
 
-        if core.hasPrefix("PC") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let w = Int(digits) { outputPowerWatts = w }
-            return
-        }
+    /// While we transmit, the LAN RX stream stops or carries our own signal; hold the EMNR
+    /// noise estimate so NR doesn't need seconds to re-converge after unkey.
+    private func setNoiseEstimateHeld(_ held: Bool) {
+        guard held != isNoiseEstimateHeld else { return }
+        isNoiseEstimateHeld = held
+        (noiseProcessor as? WDSPNoiseReductionProcessor)?.isNoiseEstimateFrozen = held
+    }
 
-        if core.hasPrefix("MV") {
-            // MV P1 ;; (0 = VFO, 1 = Memory Channel)
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1) {
-                isMemoryMode = (raw == 1)
-            }
-            return
+    /// On a band change, stash the EMNR noise estimate for the old band and restore the one
+    /// we last saw on the new band (if any).
+    private func noteReceiveFrequencyForNoiseEstimate(_ hz: Int) {
+        let band = Self.noiseEstimateBandKey(forHz: hz)
+        guard band != noiseEstimateBand else { return }
+        let emnr = noiseProcessor as? WDSPNoiseReductionProcessor
+        if let old = noiseEstimateBand, let emnr, let snapshot = emnr.saveNoiseEstimate() {
+            noiseEstimateSnapshots[old] = snapshot
         }
-
-        if core.hasPrefix("MN") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let ch = Int(digits) {
-                memoryChannelNumber = ch
-            }
-            return
+        noiseEstimateBand = band
+        if let emnr, let snapshot = noiseEstimateSnapshots[band], emnr.restoreNoiseEstimate(snapshot) {
+            AppFileLogger.shared.log("NR: restored EMNR noise estimate for \(band)")
         }
+    }
 
-        if core.hasPrefix("MA0"), core.count >= 7 {
-            // MA0 + channel(3) + freq(11) + mode(1) + ... + name(<=10)
-            let params = core.dropFirst(3)
-            let chStr = String(params.prefix(3)).trimmingCharacters(in: .whitespaces)
-            let rest = params.dropFirst(3)
-            if let ch = Int(chStr) {
-                // Only overwrite details when the MA0 response matches the selected channel.
-                if memoryChannelNumber == nil || memoryChannelNumber == ch {
-                    memoryChannelNumber = ch
-
-                    let freqField = String(rest.prefix(11))
-                    let freqDigits = freqField.filter(\.isNumber)
-                    if !freqDigits.isEmpty, let hz = Int(freqDigits) {
-                        memoryChannelFrequencyHz = hz
-                    } else {
-                        memoryChannelFrequencyHz = nil
-                    }
-
-                    let modeField = String(rest.dropFirst(11).prefix(1))
-                    if let raw = Int(modeField), let mode = KenwoodCAT.OperatingMode(rawValue: raw) {
-                        memoryChannelMode = mode
-                    } else {
-                        memoryChannelMode = nil
-                    }
-
-                    let name = String(core.suffix(10)).trimmingCharacters(in: .whitespaces)
-                    memoryChannelName = name.isEmpty ? nil : name
+    // MARK: - NR status readout (EMNR spectrum / noise floor, CPU governor)
 
-                    // Also populate the MemoryBrowserView array regardless of selected channel.
-                    let hz = memoryChannelFrequencyHz ?? 0
-                    let mode = memoryChannelMode ?? .usb
-                    let isEmpty = (hz == 0)
-                    let entry = MemoryChannel(id: ch, frequencyHz: hz, mode: mode, name: name, isEmpty: isEmpty)
-                    if let idx = memoryChannels.firstIndex(where: { $0.id == ch }) {
-                        memoryChannels[idx] = entry
-                    } else {
-                        // Insert in order
-                        let insertIdx = memoryChannels.firstIndex(where: { $0.id > ch }) ?? memoryChannels.endIndex
-                        memoryChannels.insert(entry, at: insertIdx)
-                    }
+    /// Polls at 4 Hz while either audio path (LAN RX or monitor) runs.
+    private func startNoiseReductionStatusPolling() {
+        guard noiseSpectrumTimer == nil else { return }
+        let t = DispatchSource.makeTimerSource(queue: .main)
+        t.schedule(deadline: .now() + .milliseconds(250), repeating: .milliseconds(250), leeway: .milliseconds(50))
+        t.setEventHandler { [weak self] in
+            guard let self else { return }
+            self.statusPollTick &+= 1
+            self.pollNoiseSpectrum()
+            self.pollNoiseReductionGovernor()
+            self.pollAudioStats()
+            self.pollLanPacketCounters()
+            self.pollJitterBuffer()
+        }
+        noiseSpectrumTimer = t
+        t.resume()
+    }
+
+    private func stopNoiseReductionStatusPolling() {
+        guard !isLanAudioRunning, !isAudioMonitorRunning else { return }
+        noiseSpectrumTimer?.cancel()
+        noiseSpectrumTimer = nil
+        latestNoiseSpectrum = nil
+        if noiseFloorDB != nil { noiseFloorDB = nil }
+        if estimatedSNRDB != nil { estimatedSNRDB = nil }
+    }
+
+    private func pollNoiseReductionGovernor() {
+        let snap = processorProxy.governor.snapshot()
+        let label = snap.level.label
+        if label != nrGovernorLevel {
+            nrGovernorLevel = label
+            AppFileLogger.shared.log("NR governor: level=\(label) load=\(String(format: "%.2f", snap.load)) deadlineMisses=\(snap.deadlineMisses)")
+        }
+        if snap.deadlineMisses != nrDeadlineMisses { nrDeadlineMisses = snap.deadlineMisses }
+    }
+
+    /// Publishes the receive queue's packet count and time of the last packet: the first one right
+    /// away, then at most every 500 ms (immediately when `force`).
+    private func pollLanPacketCounters(force: Bool = false) {
+        os_unfair_lock_lock(&lanPacketLock)
+        let counters = lanPacketCounters
+        os_unfair_lock_unlock(&lanPacketLock)
+
+        if let first = counters.first, !hasLoggedFirstLanPacket {
+            hasLoggedFirstLanPacket = true
+            let line = "LAN: first packet seq=\(first.seq) ssrc=\(String(format: "0x%08X", first.ssrc)) bytes=\(first.bytes)"
+            connectionLog.append(line)
+            AppLogger.info(line)
+            AppFileLogger.shared.log(line)
+        }
+        guard counters.count != lanAudioPacketCount else { return }
+        guard force || lanAudioPacketCount == 0 || statusPollTick % 2 == 0 else { return }
+        lanAudioPacketCount = counters.count
+        lanAudioLastPacketAt = counters.lastAt
+    }
+
+    /// Publishes the LAN jitter buffer's state once a second (every 4th status tick).
+    private func pollJitterBuffer() {
+        guard statusPollTick % 4 == 0, let receiver = lanReceiver else { return }
+        let j = receiver.jitterStats()
+        guard j.received > 0 else { return }
+        let sock = receiver.socketStats()
+        var text = "Buffer: \(j.depth * 20) ms (target \(j.target * 20))   Jitter: \(Int(j.jitterMs.rounded())) ms   "
+            + "Late: \(j.late)   Lost: \(j.lost)   Reordered: \(j.reordered)"
+        if sock.kernelDrops > 0 { text += "   Dropped by OS: \(sock.kernelDrops)" }
+        if text != lanJitterSummary { lanJitterSummary = text }
+    }
+
+    private func startLanRxTap() {
+        let signal = DispatchSource.makeUserDataAddSource(queue: lanRxTapQueue)
+        signal.setEventHandler { [weak self] in
+            guard let self else { return }
+            let packet = 960
+            while self.lanRxTapFifo.availableToRead() >= packet {
+                var frame = [Float](repeating: 0, count: packet)
+                let got = frame.withUnsafeMutableBufferPointer { buf in
+                    self.lanRxTapFifo.read(into: buf.baseAddress!, count: packet)
                 }
+                guard got == packet else { break }
+                self.onLanRxAudio48kMono?(frame)
             }
-            return
-        }
-
-        if core.hasPrefix("AC"), core.count >= 5 {
-            // AC + P1(rx) + P2(tx) + P3(tune active)
-            let params = core.dropFirst(2)
-            let p1 = params.prefix(1)
-            let p2 = params.dropFirst(1).prefix(1)
-            let p3 = params.dropFirst(2).prefix(1)
-            if let txRaw = Int(p2) { atuTxEnabled = (txRaw == 1) }
-            if let tuneRaw = Int(p3) { atuTuningActive = (tuneRaw == 1) }
-            // We don't surface rx AT yet; docs say use EX to set it.
-            _ = p1
-            return
-        }
-
-        if core.hasPrefix("SP") {
-            // Answer is SP + P1 (0/1). Setting details are not echoed.
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1) {
-                splitOffsetSettingActive = (raw == 1)
-            }
-            return
         }
+        signal.resume()
+        lanRxTapSignal = signal
+    }
 
-        if core.hasPrefix("##KN3"), core.count >= 7 {
-            // ##KN3 + P1(type) + P2P2P2(level)
-            let params = core.dropFirst(5)
-            let typeChar = params.prefix(1)
-            let levelDigits = params.dropFirst(1).prefix(3)
-            if let type = Int(typeChar), let level = Int(levelDigits) {
-                if type == 0 { voipInputLevel = level }
-                if type == 1 { voipOutputLevel = level }
-            }
-            return
+    /// Debug mode: with KC_RT_ALLOC_GUARD=log (or abort) in the environment, any allocation on the
+    /// real-time audio paths is reported on stderr with a backtrace (or stops the app there).
+    private func installRealtimeAllocationGuard() {
+        let name = ProcessInfo.processInfo.environment["KC_RT_ALLOC_GUARD"]
+        let mode = kc_rt_guard_mode_named(name)
+        guard mode != KC_RT_GUARD_OFF else { return }
+        if kc_rt_guard_install(mode) == 0 {
+            AppFileLogger.shared.log("Real-time allocation guard: \(name ?? "")")
+        } else {
+            AppFileLogger.shared.log("Real-time allocation guard: not supported on this system")
         }
+    }
 
-        if core.hasPrefix("AG") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let v = Int(digits) { afGain = v }
-            return
+    /// Debug mode: with KC_CAPTURE=/path/file.kcap in the environment, LAN audio and CAT traffic
+    /// are recorded for `kc-replay` (admin credentials are redacted).
+    private func startTrafficCapture() {
+        guard let path = ProcessInfo.processInfo.environment["KC_CAPTURE"], !path.isEmpty else { return }
+        if kc_capture_start(path) == 0 {
+            AppFileLogger.shared.log("Traffic capture: \(path)")
+        } else {
+            AppFileLogger.shared.log("Traffic capture: could not create \(path): \(String(cString: strerror(errno)))")
         }
+    }
 
-        if core.hasPrefix("RG") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let v = Int(digits) { rfGain = v }
-            return
+    /// Puts the audio timing region in a shared file so `kc-stats` can attach to the running app.
+    private func openAudioStatsFile() {
+        guard let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first else { return }
+        try? FileManager.default.createDirectory(at: caches, withIntermediateDirectories: true)
+        let url = caches.appendingPathComponent("audio-stats.kcstats")
+        if kc_stats_open(url.path) == 0 {
+            AppFileLogger.shared.log("Audio stats: \(url.path)")
+        } else {
+            AppFileLogger.shared.log("Audio stats: could not map \(url.path); recording in-process only")
         }
+    }
 
-        if core.hasPrefix("NT") {
-            let p1 = core.dropFirst(2).prefix(1)
-            if let raw = Int(p1) {
-                isNotchEnabled = (raw == 1)
-            }
-            return
+    /// Summarizes the last second of audio-path timing. Runs on every 4th status tick (1 Hz).
+    private func pollAudioStats() {
+        guard statusPollTick % 4 == 0 else { return }
+        let cur = audioStatsSnapshots, prev = audioStatsSnapshots + 1
+        guard kc_stats_take(kc_stats_current(), cur) == 0 else { return }
+        defer {
+            prev.update(from: cur, count: 1)
+            hasAudioStatsBaseline = true
         }
+        guard hasAudioStatsBaseline else { return }
 
-        if core.hasPrefix("SQ") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let v = Int(digits) { squelchLevel = v }
-            return
+        var summary = kc_stats_summary()
+        kc_stats_summarize(cur, prev, &summary)
+        // C arrays import as tuples; index them by the enum values instead of by tuple position.
+        let stage = { (s: kc_stats_stage) in
+            withUnsafeBytes(of: summary.stage) { $0.bindMemory(to: kc_stats_stage_summary.self)[Int(s.rawValue)] }
         }
-
-        if core.hasPrefix("SM") {
-            let digits = core.dropFirst(2).prefix { $0.isNumber }
-            if let v = Int(digits) { sMeterDots = v }
-            return
+        let counter = { (c: kc_stats_counter) in
+            withUnsafeBytes(of: summary.counter) { $0.bindMemory(to: UInt64.self)[Int(c.rawValue)] }
         }
-
-        if core.hasPrefix("EX"), core.count >= 6 {
-            // EX + 3-digit menu number + value (signed or unsigned)
-            let menuStr = String(core.dropFirst(2).prefix(3))
-            guard let menuNum = Int(menuStr) else { return }
-            let valueStr = String(core.dropFirst(5))
-            let value: Int
-            if valueStr.hasPrefix("+") {
-                value = Int(valueStr.dropFirst()) ?? 0
-            } else if valueStr.hasPrefix("-") {
-                value = -(Int(valueStr.dropFirst()) ?? 0)
-            } else {
-                value = Int(valueStr) ?? 0
-            }
-            // Store in general map (used by RadioMenuView)
-            exMenuValues[menuNum] = value
-            // Dispatch to typed EQ properties
-            switch menuNum {
-            case 30: txEQLowGain = value
-            case 31: txEQMidGain = value
-            case 32: txEQHighGain = value
-            case 60: rxEQLowGain = value
-            case 61: rxEQMidGain = value
-            case 62: rxEQHighGain = value
-            default: break
-            }
-            return
+        let rtAllocs = counter(KC_STATS_RT_ALLOCS)
+        if rtAllocs > 0 {
+            AppFileLogger.shared.log("Real-time allocation guard: \(rtAllocs) allocations on audio threads in the last second")
         }
+        let nr = stage(KC_STATS_NR), pull = stage(KC_STATS_OUTPUT_PULL)
+        guard nr.count > 0 || pull.count > 0 else { return }
 
-        if core == "RX" {
-            isTransmitting = false
-            isPTTDown = false
-            return
-        }
+        let text = "NR p99 \(Int(nr.p99Ns / 1_000)) µs   Output p99 \(Int(pull.p99Ns / 1_000)) µs   "
+            + "Lost \(counter(KC_STATS_LOST_PACKETS))   Underruns \(counter(KC_STATS_UNDERRUNS))   "
+            + "Dropped \(counter(KC_STATS_FIFO_DROPS))"
+        if text != audioTimingSummary { audioTimingSummary = text }
+    }
 
-        if core.hasPrefix("TX") {
-            isTransmitting = true
-            isPTTDown = true
+    /// Reads EMNR's own per-hop arrays through the lock-free tap — no extra FFT on the audio path.
+    private func pollNoiseSpectrum() {
+        guard let emnr = noiseProcessor as? WDSPNoiseReductionProcessor, emnr.mode == .emnr,
+              isNoiseReductionEnabled else {
+            latestNoiseSpectrum = nil
+            if noiseFloorDB != nil { noiseFloorDB = nil }
+            if estimatedSNRDB != nil { estimatedSNRDB = nil }
             return
         }
+        // The LAN stream is 16 kHz upsampled to 48 kHz, so nothing useful lives above 8 kHz.
+        if emnr.spectrumTapBins == 0 { emnr.enableSpectrumTap(bins: 64, maxHz: 8_000) }
+        guard let spectrum = emnr.readSpectrum() else { return }
+        latestNoiseSpectrum = spectrum
+
+        let floor = spectrum.noiseFloorDB(loHz: 300, hiHz: 3_000).map { Int($0.rounded()) }
+        let snr = spectrum.snrDB(loHz: 300, hiHz: 3_000).map { max(0, Int($0.rounded())) }
+        if floor != noiseFloorDB { noiseFloorDB = floor }
+        if snr != estimatedSNRDB { estimatedSNRDB = snr }
+    }
+
+    private static func noiseEstimateBandKey(forHz hz: Int) -> String {
+        let bands: [(String, ClosedRange<Int>)] = [
+            ("160m", 1_800_000...2_000_000),
+            ("80m", 3_500_000...4_000_000),
+            ("60m", 5_250_000...5_450_000),
+            ("40m", 7_000_000...7_300_000),
+            ("30m", 10_100_000...10_150_000),
+            ("20m", 14_000_000...14_350_000),
+            ("17m", 18_068_000...18_168_000),
+            ("15m", 21_000_000...21_450_000),
+            ("12m", 24_890_000...24_990_000),
+            ("10m", 28_000_000...29_700_000),
+            ("6m", 50_000_000...54_000_000),
+        ]
+        if let match = bands.first(where: { $0.1.contains(hz) }) { return match.0 }
+        // Outside the amateur bands (SWL, general coverage): bucket by MHz.
+        return "\(hz / 1_000_000) MHz"
     }
 
     func setPTT(down: Bool) {
@@ -1334,25 +1785,33 @@ final class RadioState: ObservableObject {
             } else {
                 micTxSource = .generated
                 stopMicCapture()
-                // Ensure the paced sender exists so generated frames can be delivered.
+                // Ensure the paced sender is running so generated frames can be delivered.
                 guard let receiver = lanReceiver else {
                     announceError("LAN audio receiver is not running")
                     return
                 }
-                micSendQueue.sync { micTxFrames.removeAll(keepingCapacity: true) }
-                startMicTxTimerIfNeeded(receiver: receiver)
+                receiver.clearMicTx()
+                receiver.startMicTx()
             }
             AppFileLogger.shared.logSync("PTT: sending TX0;")
             send(KenwoodCAT.pttDown())
             isPTTDown = true
+            lanReceiver?.setMicTxKeyed(true)
+            setNoiseEstimateHeld(true)
             announceInfo("PTT down")
         } else {
             AppFileLogger.shared.logSync("UI: PTT up")
-            generatedTxState = nil
+            lanReceiver?.setMicTxKeyed(false)
+            if let tx = lanReceiver?.micTxStats(), tx.sent > 0 {
+                AppFileLogger.shared.log("LAN mic TX: \(tx.sent) sent, \(tx.silence) silence, \(tx.late) late "
+                    + "(max \(tx.maxLateNs / 1_000) µs), \(tx.dropped) dropped, \(tx.sendErrors) send errors")
+            }
+            lanReceiver?.clearMicTx()
             stopMicCapture()
             AppFileLogger.shared.logSync("PTT: sending RX;")
             send(KenwoodCAT.pttUp())
             isPTTDown = false
+            setNoiseEstimateHeld(false)
             announceInfo("PTT up")
         }
     }
@@ -1370,9 +1829,9 @@ final class RadioState: ObservableObject {
         // Ensure we're ready to send generated audio frames.
         setPTT(down: true, useMicAudio: false)
 
-        // Timer sends 20ms frames (320 @ 16k). Convert duration to frames.
+        // The sender sends 20ms frames (320 @ 16k). Convert duration to frames.
         let frames = max(1, Int((durationSeconds / 0.02).rounded()))
-        generatedTxState = GeneratedTxState(framesRemaining: frames, phase: 0.0, frequencyHz: toneHz, amplitude: max(0.0, min(1.0, amplitude)))
+        lanReceiver?.sendTone(hz: toneHz, amplitude: max(0.0, min(1.0, amplitude)), frames: frames)
         AppFileLogger.shared.log("FT8: generated test tone hz=\(toneHz) dur=\(String(format: "%.2f", durationSeconds))s frames=\(frames)")
 
         DispatchQueue.main.asyncAfter(deadline: .now() + durationSeconds) { [weak self] in
@@ -1385,6 +1844,7 @@ final class RadioState: ObservableObject {
 
     func setVoipOutputLevel(_ level: Int) {
         let clamped = max(0, min(level, 100))
+        setRigField(KC_RIG_VOIP_OUT, clamped)
         voipOutputLevel = clamped
         send(KenwoodCAT.setVoipOutputLevel(clamped))
         send(KenwoodCAT.getVoipOutputLevel())
@@ -1392,6 +1852,7 @@ final class RadioState: ObservableObject {
 
     func setVoipOutputLevelDebounced(_ level: Int) {
         let clamped = max(0, min(level, 100))
+        setRigField(KC_RIG_VOIP_OUT, clamped)
         voipOutputLevel = clamped
         debounceCAT(key: "voip_out", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1402,6 +1863,7 @@ final class RadioState: ObservableObject {
 
     func setVoipInputLevel(_ level: Int) {
         let clamped = max(0, min(level, 100))
+        setRigField(KC_RIG_VOIP_IN, clamped)
         voipInputLevel = clamped
         send(KenwoodCAT.setVoipInputLevel(clamped))
         send(KenwoodCAT.getVoipInputLevel())
@@ -1409,6 +1871,7 @@ final class RadioState: ObservableObject {
 
     func setVoipInputLevelDebounced(_ level: Int) {
         let clamped = max(0, min(level, 100))
+        setRigField(KC_RIG_VOIP_IN, clamped)
         voipInputLevel = clamped
         debounceCAT(key: "voip_in", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1419,6 +1882,7 @@ final class RadioState: ObservableObject {
 
     func setRFGainDebounced(_ value: Int) {
         let clamped = max(0, min(value, 255))
+        setRigField(KC_RIG_RF_GAIN, clamped)
         rfGain = clamped
         debounceCAT(key: "rf_gain", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1429,6 +1893,7 @@ final class RadioState: ObservableObject {
 
     func setAFGainDebounced(_ value: Int) {
         let clamped = max(0, min(value, 255))
+        setRigField(KC_RIG_AF_GAIN, clamped)
         afGain = clamped
         debounceCAT(key: "af_gain", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1439,6 +1904,7 @@ final class RadioState: ObservableObject {
 
     func setSquelchLevelDebounced(_ value: Int) {
         let clamped = max(0, min(value, 255))
+        setRigField(KC_RIG_SQUELCH, clamped)
         squelchLevel = clamped
         debounceCAT(key: "squelch", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1449,6 +1915,7 @@ final class RadioState: ObservableObject {
 
     func setReceiveFilterLowCutIDDebounced(_ id: Int) {
         let clamped = max(0, min(id, 35))
+        setRigField(KC_RIG_LOW_CUT, clamped)
         rxFilterLowCutID = clamped
         debounceCAT(key: "rx_low_cut", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1459,6 +1926,7 @@ final class RadioState: ObservableObject {
 
     func setReceiveFilterHighCutIDDebounced(_ id: Int) {
         let clamped = max(0, min(id, 27))
+        setRigField(KC_RIG_HIGH_CUT, clamped)
         rxFilterHighCutID = clamped
         debounceCAT(key: "rx_high_cut", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1469,6 +1937,7 @@ final class RadioState: ObservableObject {
 
     func setReceiveFilterShiftHzDebounced(_ hz: Int) {
         let clamped = max(-9999, min(hz, 9999))
+        setRigField(KC_RIG_FILTER_SHIFT, clamped)
         rxFilterShiftHz = clamped
         debounceCAT(key: "rx_shift", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1479,6 +1948,7 @@ final class RadioState: ObservableObject {
 
     func setRitXitOffsetHzDebounced(_ hz: Int) {
         let clamped = max(-9999, min(hz, 9999))
+        setRigField(KC_RIG_RIT_XIT_OFFSET, clamped)
         ritXitOffsetHz = clamped
         debounceCAT(key: "rit_xit_offset", delaySeconds: 0.15) { [weak self] in
             guard let self else { return }
@@ -1576,11 +2046,9 @@ final class RadioState: ObservableObject {
             return
         }
 
-        // Reset paced TX queue.
-        micSendQueue.sync {
-            micTxFrames.removeAll(keepingCapacity: true)
-        }
-        startMicTxTimerIfNeeded(receiver: receiver)
+        // Reset the paced TX queue.
+        receiver.clearMicTx()
+        receiver.startMicTx()
 
         let cap = KenwoodLanMicCapture()
         cap.onLog = { msg in
@@ -1595,17 +2063,13 @@ final class RadioState: ObservableObject {
             guard let self else { return }
             // If we're in generated-TX mode, ignore microphone frames.
             guard self.micTxSource == .mic else { return }
-            // Keep the audio callback lightweight: copy and send on a separate queue.
-            var frame = [Int16](repeating: 0, count: 320)
-            frame.withUnsafeMutableBufferPointer { dst in
-                dst.baseAddress!.assign(from: ptr, count: 320)
-            }
 
             // Lightweight mic level indicator for debugging "keys but no modulation".
             // Log about once per second (50 frames @ 20ms).
             if self.micFrameLogCountdown <= 0 {
                 var peak: Int16 = 0
-                for s in frame {
+                for i in 0..<320 {
+                    let s = ptr[i]
                     let a = s == Int16.min ? Int16.max : abs(s)
                     if a > peak { peak = a }
                 }
@@ -1615,14 +2079,8 @@ final class RadioState: ObservableObject {
                 self.micFrameLogCountdown -= 1
             }
 
-            // Don't burst-send multiple frames back-to-back; queue and let the paced timer send at 20ms cadence.
-            self.micSendQueue.async {
-                self.micTxFrames.append(frame)
-                // Bound latency: keep ~120ms max queued.
-                if self.micTxFrames.count > 6 {
-                    self.micTxFrames.removeFirst(self.micTxFrames.count - 6)
-                }
-            }
+            // Copied into the sender's packet ring; it goes out on the next free 20 ms slot.
+            receiver?.queueMicFrame(ptr)
         }
 
         do {
@@ -1652,59 +2110,8 @@ final class RadioState: ObservableObject {
     private func stopMicCapture() {
         micCapture?.stop()
         micCapture = nil
-        stopMicTxTimer()
-        micSendQueue.async { [weak self] in
-            self?.micTxFrames.removeAll(keepingCapacity: true)
-        }
-    }
-
-    private func startMicTxTimerIfNeeded(receiver: KenwoodLanAudioReceiver) {
-        guard micTxTimer == nil else { return }
-        let timer = DispatchSource.makeTimerSource(queue: micSendQueue)
-        timer.schedule(deadline: .now() + 0.02, repeating: 0.02, leeway: .milliseconds(2))
-        let silence = [Int16](repeating: 0, count: 320)
-        timer.setEventHandler { [weak self, weak receiver] in
-            guard let self, let receiver else { return }
-            guard self.isPTTDown else { return }
-            let frame: [Int16]
-            switch self.micTxSource {
-            case .mic:
-                if !self.micTxFrames.isEmpty {
-                    frame = self.micTxFrames.removeFirst()
-                } else {
-                    frame = silence
-                }
-            case .generated:
-                if var st = self.generatedTxState, st.framesRemaining > 0 {
-                    var out = [Int16](repeating: 0, count: 320)
-                    let sampleRate = 16_000.0
-                    let step = 2.0 * Double.pi * st.frequencyHz / sampleRate
-                    for i in 0..<320 {
-                        let v = sin(st.phase) * st.amplitude
-                        let s = Int16(max(-32767.0, min(32767.0, v * 32767.0)))
-                        out[i] = s
-                        st.phase += step
-                        if st.phase > 2.0 * Double.pi { st.phase -= 2.0 * Double.pi }
-                    }
-                    st.framesRemaining -= 1
-                    self.generatedTxState = st
-                    frame = out
-                } else {
-                    frame = silence
-                }
-            }
-            frame.withUnsafeBufferPointer { src in
-                guard let base = src.baseAddress else { return }
-                receiver.sendMicFramePCM16(base, count: 320)
-            }
-        }
-        micTxTimer = timer
-        timer.resume()
-    }
-
-    private func stopMicTxTimer() {
-        micTxTimer?.cancel()
-        micTxTimer = nil
+        lanReceiver?.stopMicTx()
+        lanReceiver?.clearMicTx()
     }
 
     private func shouldPublishLastRXFrame(_ frame: String) -> Bool {
@@ -1829,3 +2236,45 @@ final class RadioState: ObservableObject {
         #endif
     }
 }
+
+private extension kc_cat_msg {
+    /// Field `i` as decoded, or nil if the frame didn't reach it or it didn't parse (kc_cat_has).
+    func int(_ i: Int) -> Int? {
+        guard i < Int(count), (valid >> UInt32(i)) & 1 != 0 else { return nil }
+        return withUnsafeBytes(of: v) { Int($0.load(fromByteOffset: i * MemoryLayout<Int64>.stride, as: Int64.self)) }
+    }
+
+    /// The text field, spaces trimmed; "" if there is none. Only valid while the frame is.
+    var textString: String {
+        guard let text, textLength > 0 else { return "" }
+        return String(decoding: UnsafeRawBufferPointer(start: text, count: Int(textLength)), as: UTF8.self)
+    }
+}
+
+/// What the rigctl server's callbacks hold: it has no strong reference to RadioState, so a
+/// request arriving while RadioState goes away finds `state` nil.
+private final class RigctlBridge {
+    weak var state: RadioState?
+}
+
+private extension kc_rig_values {
+    /// Field `f`, or nil if it isn't known.
+    subscript(_ f: kc_rig_field) -> Int? {
+        get {
+            let i = Int(f.rawValue)
+            guard (valid >> UInt64(i)) & 1 != 0 else { return nil }
+            return withUnsafeBytes(of: v) { Int($0.load(fromByteOffset: i * MemoryLayout<Int64>.stride, as: Int64.self)) }
+        }
+        set {
+            let i = Int(f.rawValue)
+            guard let newValue else {
+                valid &= ~(1 << UInt64(i))
+                return
+            }
+            withUnsafeMutableBytes(of: &v) {
+                $0.storeBytes(of: Int64(newValue), toByteOffset: i * MemoryLayout<Int64>.stride, as: Int64.self)
+            }
+            valid |= 1 << UInt64(i)
+        }
+    }
+}
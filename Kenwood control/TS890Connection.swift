@@ -13,7 +13,21 @@ final class TS890Connection {
     private(set) var status: Status = .disconnected
     private var connection: NWConnection?
     private let queue = DispatchQueue(label: "TS890Connection.queue")
-    private var receiveBuffer = Data()
+    // Splits received bytes into frames in place (kc_cat_framer); only a frame split across
+    // reads is copied. Used on `queue`. 64 KB is far above the largest bandscope frame.
+    private let framer: OpaquePointer? = kc_cat_framer_create(64 * 1024)
+    // Queues outgoing commands (kc_cat_sched): the newest value of a set wins while it waits,
+    // each write carries everything ready, and at most 24 queries await answers. Writes of only
+    // sets and queries go at most every 20 ms, so a knob sweep reaches the radio as its latest
+    // values; anything else (PTT) goes at once. Used on `queue`. The window holds the connect
+    // resync's reads, so they go in one write.
+    private let scheduler: OpaquePointer? = {
+        var config = kc_cat_sched_config(window: 24, minIntervalNs: 20_000_000, timeoutNs: 1_000_000_000)
+        return kc_cat_sched_create(&config)
+    }()
+    private var writeBuffer = [CChar](repeating: 0, count: 4096)
+    private var writeInFlight = false
+    private var flushScheduled = false
     private var authState: AuthState = .idle
     private var useKnsLogin: Bool = true
     private var accountType: KenwoodKNS.AccountType = .administrator
@@ -27,6 +41,11 @@ final class TS890Connection {
     private let connectTimeoutInterval: TimeInterval = 15
     private var currentHost: String?
 
+    deinit {
+        kc_cat_framer_destroy(framer)
+        kc_cat_sched_destroy(scheduler)
+    }
+
     private func isASCII(_ s: String) -> Bool {
         s.utf8.allSatisfy { $0 < 0x80 }
     }
@@ -49,7 +68,14 @@ final class TS890Connection {
         connection?.stateUpdateHandler = nil
         connection?.cancel()
         connection = nil
-        receiveBuffer.removeAll(keepingCapacity: true)
+        // Received bytes reach the framer and commands the scheduler on `queue`, so both are
+        // reset there, in order with them.
+        queue.async { [weak self] in
+            guard let self else { return }
+            kc_cat_framer_reset(self.framer)
+            kc_cat_sched_reset(self.scheduler)
+            self.writeInFlight = false
+        }
         stopAuthTimeout()
         stopConnectTimeout()
         stopKeepalive()
@@ -96,7 +122,10 @@ final class TS890Connection {
             onStatusChange?(status)
             return
         }
-        let connection = NWConnection(host: endpointHost, port: endpointPort, using: .tcp)
+        // Nagle off: the scheduler already batches, and a held-back PTT command costs airtime.
+        let tcp = NWProtocolTCP.Options()
+        tcp.noDelay = true
+        let connection = NWConnection(host: endpointHost, port: endpointPort, using: NWParameters(tls: nil, tcp: tcp))
         self.connection = connection
         connection.stateUpdateHandler = { [weak self] state in
             guard let self else { return }
@@ -140,6 +169,7 @@ final class TS890Connection {
     }
 
     func disconnect() {
+        queue.async { [weak self] in self?.logSchedulerStats() }
         teardown()
         status = .disconnected
         onStatusChange?(status)
@@ -147,19 +177,91 @@ final class TS890Connection {
     }
 
     func send(_ command: String) {
+        send([command])
+    }
+
+    /// Queues `commands` together, so they leave in the same write (window and buffer permitting).
+    func send(_ commands: [String]) {
         guard let connection else {
             onError?("Not connected")
             return
         }
-        let data = Data(command.utf8)
-        onLog?("TX: \(redactedForLog(command))")
+        for command in commands {
+            let logged = redactedForLog(command)
+            onLog?("TX: \(logged)")
+            if kc_capture_active() != 0 {
+                Array(logged.utf8).withUnsafeBytes { kc_capture_record(KC_CAPTURE_CAT_TX, 0, $0.baseAddress, $0.count) }
+            }
+        }
+        queue.async { [weak self] in
+            guard let self, self.connection === connection else { return }
+            let now = DispatchTime.now().uptimeNanoseconds
+            for command in commands {
+                var command = command
+                let result = command.withUTF8 { utf8 in
+                    utf8.withMemoryRebound(to: CChar.self) {
+                        kc_cat_sched_submit(self.scheduler, $0.baseAddress, $0.count, now)
+                    }
+                }
+                if result == KC_CAT_SCHED_FULL {
+                    self.onError?("CAT send queue full — radio not reading commands")
+                    break
+                }
+            }
+            self.flushWrites()
+        }
+    }
+
+    /// Writes whatever the scheduler lets go now, in one send; one write is outstanding at a time,
+    /// and commands queued meanwhile go together in the next. On `queue`.
+    private func flushWrites() {
+        guard let connection, !writeInFlight else { return }
+        var wait: UInt64 = 0
+        let n = writeBuffer.withUnsafeMutableBufferPointer {
+            kc_cat_sched_next_write(scheduler, DispatchTime.now().uptimeNanoseconds, $0.baseAddress, $0.count, &wait)
+        }
+        guard n > 0 else {
+            if wait > 0, !flushScheduled {
+                flushScheduled = true
+                queue.asyncAfter(deadline: .now() + .nanoseconds(Int(clamping: wait))) { [weak self] in
+                    self?.flushScheduled = false
+                    self?.flushWrites()
+                }
+            }
+            return
+        }
+        writeInFlight = true
+        let data = writeBuffer.withUnsafeBytes { Data($0.prefix(n)) }
         connection.send(content: data, completion: .contentProcessed { [weak self] error in
+            guard let self, self.connection === connection else { return }
+            self.writeInFlight = false
             if let error {
-                self?.onError?("Send failed: \(error.localizedDescription)")
+                self.onError?("Send failed: \(error.localizedDescription)")
+                return
             }
+            self.flushWrites()
         })
     }
 
+    /// Write batching and query round trips since the connection object was created, for the log.
+    /// On `queue`.
+    private func logSchedulerStats() {
+        var stats = kc_cat_sched_stats()
+        kc_cat_sched_read_stats(scheduler, &stats)
+        guard stats.written > 0 else { return }
+        var line = "CAT: \(stats.submitted) commands, \(stats.coalesced) coalesced, \(stats.written) written in "
+            + "\(stats.writes) writes; \(stats.answered) answered, \(stats.errors) queries and "
+            + "\(stats.rejected) commands rejected, \(stats.timeouts) timed out"
+        for cmd in [KC_CAT_FA, KC_CAT_AG, KC_CAT_RG, KC_CAT_EX] {
+            var c = kc_cat_sched_cmd_stats()
+            kc_cat_sched_read_cmd_stats(scheduler, cmd, &c)
+            guard c.answered > 0 else { continue }
+            line += String(format: "; %@ rtt %.1f/%.1f/%.1f ms", String(cString: kc_cat_name(cmd)),
+                           Double(c.rttMinNs) / 1e6, Double(c.rttSumNs) / Double(c.answered) / 1e6, Double(c.rttMaxNs) / 1e6)
+        }
+        onLog?(line)
+    }
+
     private func receiveLoop() {
         // Capture the specific NWConnection so stale completion handlers from a
         // previously-cancelled connection don't accidentally act on the new one.
@@ -167,8 +269,10 @@ final class TS890Connection {
         conn.receive(minimumIncompleteLength: 1, maximumLength: 4096) { [weak self] data, _, isComplete, error in
             guard let self, self.connection === conn else { return }
             if let data, !data.isEmpty {
-                self.receiveBuffer.append(data)
-                self.flushFrames()
+                if kc_capture_active() != 0 {
+                    data.withUnsafeBytes { kc_capture_record(KC_CAPTURE_CAT_RX, 0, $0.baseAddress, $0.count) }
+                }
+                self.flushFrames(data)
             }
             if let error {
                 self.onError?("Receive failed: \(error.localizedDescription)")
@@ -183,10 +287,41 @@ final class TS890Connection {
         }
     }
 
-    private func flushFrames() {
-        while let separatorRange = receiveBuffer.firstRange(of: Data([UInt8(ascii: ";")])) {
-            let frameData = receiveBuffer.subdata(in: 0..<separatorRange.lowerBound)
-            receiveBuffer.removeSubrange(0...separatorRange.lowerBound)
+    private func flushFrames(_ data: Data) {
+        data.withUnsafeBytes { raw in
+            kc_cat_framer_feed(framer, raw.baseAddress, raw.count)
+            var frame = kc_cat_frame()
+            while kc_cat_framer_next(framer, &frame) != 0 {
+                kc_cat_sched_on_frame(scheduler, frame.data, frame.length, DispatchTime.now().uptimeNanoseconds)
+                handleFrame(UnsafeRawBufferPointer(start: frame.data, count: frame.length), ascii: frame.ascii != 0)
+            }
+        }
+        // Answers free query slots.
+        if kc_cat_sched_pending(scheduler) > 0 { flushWrites() }
+    }
+
+    /// One frame from the framer: no ';', surrounding whitespace and control bytes already trimmed.
+    private func handleFrame(_ bytes: UnsafeRawBufferPointer, ascii: Bool) {
+        // AI can cause high-rate and/or huge frames (e.g. bandscope ##DD2/##DD3).
+        // Avoid building giant strings for the UI log, and skip onFrame for those until we need them.
+        if bytes.count >= 5, bytes[0] == UInt8(ascii: "#"), bytes[1] == UInt8(ascii: "#"),
+           bytes[2] == UInt8(ascii: "D"), bytes[3] == UInt8(ascii: "D"),
+           bytes[4] == UInt8(ascii: "2") || bytes[4] == UInt8(ascii: "3") {
+            AppFileLogger.shared.logScopeFrame(UnsafeRawBufferPointer(rebasing: bytes.prefix(5)), length: bytes.count + 1)
+            onLog?("RX: \(String(decoding: bytes.prefix(5), as: UTF8.self))... (\(bytes.count + 1) chars)")
+            return
+        }
+
+        let fullFrame: String
+        if ascii {
+            // The file log takes the bytes as they are. AI meter readings (SM) stay out of it, as
+            // RadioState keeps them out of the other logs.
+            if !(bytes.count >= 2 && bytes[0] == UInt8(ascii: "S") && bytes[1] == UInt8(ascii: "M")) {
+                AppFileLogger.shared.logReceivedFrame(bytes)
+            }
+            fullFrame = String(decoding: bytes, as: UTF8.self) + ";"
+        } else {
+            let frameData = Data(bytes)
             let frame: String
             if let decoded = String(data: frameData, encoding: .utf8) {
                 frame = decoded
@@ -197,26 +332,16 @@ final class TS890Connection {
                 // Worst case: preserve something useful for debugging rather than dropping.
                 frame = String(decoding: frameData, as: UTF8.self)
             }
-            do {
-                // Some radios/bridges insert CR/LF (or other control bytes) between frames.
-                // Normalize so auth parsing and command routing doesn't break.
-                let cleaned = frame.trimmingCharacters(in: .whitespacesAndNewlines.union(.controlCharacters))
-                guard !cleaned.isEmpty else { continue }
-                let fullFrame = cleaned.hasSuffix(";") ? cleaned : (cleaned + ";")
-
-                // AI can cause high-rate and/or huge frames (e.g. bandscope ##DD2/##DD3).
-                // Avoid pushing giant strings into the UI log, and skip onFrame for those until we need them.
-                if fullFrame.hasPrefix("##DD2") || fullFrame.hasPrefix("##DD3") {
-                    onLog?("RX: \(fullFrame.prefix(5))... (\(fullFrame.count) chars)")
-                    handleAuthFrame(fullFrame)
-                    continue
-                }
-
-                onLog?("RX: \(fullFrame)")
-                handleAuthFrame(fullFrame)
-                onFrame?(fullFrame)
-            }
+            // The framer trims ASCII whitespace; Unicode whitespace around the frame goes here.
+            let cleaned = frame.trimmingCharacters(in: .whitespacesAndNewlines.union(.controlCharacters))
+            guard !cleaned.isEmpty else { return }
+            fullFrame = cleaned + ";"
+            AppFileLogger.shared.log("RX: \(fullFrame)")
         }
+
+        onLog?("RX: \(fullFrame)")
+        if authState != .authenticated { handleAuthFrame(fullFrame) }
+        onFrame?(fullFrame)
     }
 
     private func handleAuthFrame(_ frame: String) {
@@ -1,5 +1,44 @@
 import Foundation
 
+/// One hop of EMNR's internal spectrum, averaged down to `power.count` bins starting at 0 Hz.
+/// Powers are per-sample and uncalibrated — compare them in relative dB.
+struct EMNRSpectrum {
+    var hop: UInt64
+    var binHz: Float
+    var power: [Float]   // noisy input (lambda_y)
+    var noise: [Float]   // noise estimate (lambda_d)
+    var gain: [Float]    // gain EMNR applied, 0…1
+
+    static func decibels(_ p: Float) -> Double { 10 * log10(Double(max(p, 1e-20))) }
+
+    /// Per-bin a-posteriori SNR in dB.
+    var snrDB: [Double] { zip(power, noise).map { Self.decibels($0) - Self.decibels($1) } }
+
+    /// Median noise power across bins in [loHz, hiHz], in dB.
+    func noiseFloorDB(loHz: Float, hiHz: Float) -> Double? {
+        let band = bins(loHz: loHz, hiHz: hiHz)
+        guard !band.isEmpty else { return nil }
+        let sorted = noise[band].sorted()
+        return Self.decibels(sorted[sorted.count / 2])
+    }
+
+    /// Broadband SNR (total power over total noise) across bins in [loHz, hiHz], in dB.
+    func snrDB(loHz: Float, hiHz: Float) -> Double? {
+        let band = bins(loHz: loHz, hiHz: hiHz)
+        guard !band.isEmpty else { return nil }
+        let p = power[band].reduce(0, +)
+        let n = noise[band].reduce(0, +)
+        return Self.decibels(p) - Self.decibels(n)
+    }
+
+    private func bins(loHz: Float, hiHz: Float) -> Range<Int> {
+        guard binHz > 0 else { return 0..<0 }
+        let lo = max(0, Int(loHz / binHz))
+        let hi = min(power.count, Int(hiHz / binHz) + 1)
+        return lo < hi ? lo..<hi : 0..<0
+    }
+}
+
 enum WDSPMode {
     case emnr  // Enhanced Minimum NR: Wiener filter + psychoacoustic artifact elimination
     case anr   // Adaptive NR: LMS adaptive filter (good for periodic tones/carriers)
@@ -11,9 +50,22 @@ final class WDSPNoiseReductionProcessor: NoiseReductionProcessor {
     private var emnrCtx: OpaquePointer?
     private var anrCtx:  OpaquePointer?
     private(set) var mode: WDSPMode
+    private(set) var spectrumTapBins: Int = 0
 
     var isAvailable: Bool { emnrCtx != nil || anrCtx != nil }
     var isEnabled: Bool = false
+    /// EMNR's overlap-add trails its input by fsize - incr (1920 - 480, see wdsp_emnr_create);
+    /// ANR filters sample by sample.
+    var latencySamples: Int { isEnabled && mode == .emnr ? 1440 : 0 }
+
+    /// Hold the EMNR noise estimate (e.g. while transmitting) so it doesn't have to re-converge afterwards.
+    /// No effect in ANR mode.
+    var isNoiseEstimateFrozen: Bool = false {
+        didSet {
+            guard oldValue != isNoiseEstimateFrozen, let c = emnrCtx else { return }
+            wdsp_emnr_set_noise_freeze(c, isNoiseEstimateFrozen ? 1 : 0)
+        }
+    }
 
     init?(mode: WDSPMode = .emnr, sampleRate: Int32 = 48000) {
         self.mode = mode
@@ -39,12 +91,77 @@ final class WDSPNoiseReductionProcessor: NoiseReductionProcessor {
         if let c = anrCtx  { wdsp_anr_destroy(c) }
     }
 
+    /// Snapshot of the EMNR noise estimator (minimum statistics + gain history). Nil in ANR mode.
+    func saveNoiseEstimate() -> Data? {
+        guard let c = emnrCtx else { return nil }
+        let size = Int(wdsp_emnr_noise_state_size(c))
+        guard size > 0 else { return nil }
+        var data = Data(count: size)
+        let written = data.withUnsafeMutableBytes { raw in
+            wdsp_emnr_save_noise_state(c, raw.baseAddress, Int32(raw.count))
+        }
+        return written > 0 ? data : nil
+    }
+
+    /// Restores a snapshot from `saveNoiseEstimate()`. Returns false (and keeps the current
+    /// estimate) if the snapshot came from an EMNR with a different sample rate or FFT size.
+    @discardableResult
+    func restoreNoiseEstimate(_ data: Data) -> Bool {
+        guard let c = emnrCtx else { return false }
+        return data.withUnsafeBytes { raw in
+            wdsp_emnr_restore_noise_state(c, raw.baseAddress, Int32(raw.count)) == 1
+        }
+    }
+
+    /// Publish EMNR's per-hop spectrum, noise estimate and gain (decimated to `bins` bins over
+    /// 0…maxHz) for `readSpectrum()`. `bins` 0 turns the tap off. Call from the same thread as
+    /// `readSpectrum()`. Returns the bin count in use; always 0 in ANR mode.
+    @discardableResult
+    func enableSpectrumTap(bins: Int, maxHz: Float = 0) -> Int {
+        guard let c = emnrCtx else { return 0 }
+        spectrumTapBins = Int(wdsp_emnr_enable_spectrum_tap(c, Int32(bins), maxHz))
+        return spectrumTapBins
+    }
+
+    /// Latest hop published by the spectrum tap, or nil if nothing new arrived since the last call
+    /// (NR disabled, stream stopped, or tap off). Lock-free; never blocks the audio thread.
+    func readSpectrum() -> EMNRSpectrum? {
+        guard let c = emnrCtx, spectrumTapBins > 0 else { return nil }
+        let n = spectrumTapBins
+        var power = [Float](repeating: 0, count: n)
+        var noise = [Float](repeating: 0, count: n)
+        var gain  = [Float](repeating: 0, count: n)
+        var hop: UInt64 = 0
+        let copied = power.withUnsafeMutableBufferPointer { p in
+            noise.withUnsafeMutableBufferPointer { d in
+                gain.withUnsafeMutableBufferPointer { g in
+                    wdsp_emnr_read_spectrum(c, p.baseAddress, d.baseAddress, g.baseAddress, Int32(n), &hop)
+                }
+            }
+        }
+        guard copied > 0 else { return nil }
+        return EMNRSpectrum(hop: hop, binHz: wdsp_emnr_spectrum_bin_hz(c),
+                            power: power, noise: noise, gain: gain)
+    }
+
+    // EMNR settings at full quality (must match wdsp_emnr_create).
+    private let baseGainMethod: Int32 = 2
+    private let baseArtifactElimination: Int32 = 1
+    private let basePostFilter: Int32 = 0
+    private var qualityLevel: NoiseReductionGovernor.Level = .full
+
     func processFrame48kMono(_ frame: [Float]) -> [Float] {
         var out = frame
         processFrame48kMonoInPlace(&out)
         return out
     }
 
+    /// wdsp_emnr_process takes any length and runs whole-block backlogs through EMNR's
+    /// batched multi-hop path, so a backlog goes down in a single call.
+    func processFrames48kMonoInPlace(_ block: inout [Float], frameSize: Int) {
+        processFrame48kMonoInPlace(&block)
+    }
+
     func processFrame48kMonoInPlace(_ frame: inout [Float]) {
         guard isEnabled else { return }
         frame.withUnsafeMutableBufferPointer { buf in
@@ -59,3 +176,20 @@ final class WDSPNoiseReductionProcessor: NoiseReductionProcessor {
         }
     }
 }
+
+extension WDSPNoiseReductionProcessor: NoiseReductionQualityAdjustable {
+    /// EMNR sheds its artifact elimination (and post2, if on). Its gain is already the table
+    /// lookup, the cheapest gain method WDSP has, and ANR has nothing cheaper than itself; the
+    /// governor's bypass level covers the rest.
+    var qualityLevels: NoiseReductionGovernor.Levels { mode == .emnr ? .noPostFilter : [] }
+
+    func applyQualityLevel(_ level: NoiseReductionGovernor.Level) {
+        guard level != qualityLevel, let c = emnrCtx else { return }
+        qualityLevel = level
+        let shedPostFilters = level.rawValue >= NoiseReductionGovernor.Level.noPostFilter.rawValue
+        wdsp_emnr_set_quality(c,
+                              baseGainMethod,
+                              shedPostFilters ? 0 : baseArtifactElimination,
+                              shedPostFilters ? 0 : basePostFilter)
+    }
+}
@@ -493,6 +493,49 @@ float rnnoise_process_frame(DenoiseState *st, float *out, const float *in) {
   return vad_prob;
 }
 
+/* The cheap path for frames judged stationary noise: the same analysis and synthesis as
+ * rnnoise_process_frame (so the overlap, pitch and cepstral history stay continuous and the
+ * output keeps its one-frame delay), but no pitch search, no network and no pitch filter; the
+ * previous frame's band gains are applied as they were. */
+void rnnoise_process_frame_hold(DenoiseState *st, float *out, const float *in) {
+  int i;
+  kiss_fft_cpx X[FREQ_SIZE];
+  float x[FRAME_SIZE];
+  float Ex[NB_BANDS];
+  float Ly[NB_BANDS];
+  float gf[FREQ_SIZE]={1};
+  float E = 0;
+  float follow, logMax;
+  static const float a_hp[2] = {-1.99599, 0.99600};
+  static const float b_hp[2] = {-2, 1};
+  biquad(x, st->mem_hp_x, in, b_hp, a_hp, FRAME_SIZE);
+  frame_analysis(st, X, Ex, x);
+  RNN_MOVE(st->pitch_buf, &st->pitch_buf[FRAME_SIZE], PITCH_BUF_SIZE-FRAME_SIZE);
+  RNN_COPY(&st->pitch_buf[PITCH_BUF_SIZE-FRAME_SIZE], x, FRAME_SIZE);
+  logMax = -2;
+  follow = -2;
+  for (i=0;i<NB_BANDS;i++) {
+    Ly[i] = log10(1e-2+Ex[i]);
+    Ly[i] = MAX16(logMax-7, MAX16(follow-1.5, Ly[i]));
+    logMax = MAX16(logMax, Ly[i]);
+    follow = MAX16(follow-1.5, Ly[i]);
+    E += Ex[i];
+  }
+  /* As in compute_frame_features, silence leaves the cepstral history alone. */
+  if (E >= 0.04) {
+    dct(st->cepstral_mem[st->memid], Ly);
+    st->cepstral_mem[st->memid][0] -= 12;
+    st->cepstral_mem[st->memid][1] -= 4;
+    if (++st->memid == CEPS_MEM) st->memid = 0;
+  }
+  interp_band_gain(gf, st->lastg);
+  for (i=0;i<FREQ_SIZE;i++) {
+    X[i].r *= gf[i];
+    X[i].i *= gf[i];
+  }
+  frame_synthesis(st, out, X);
+}
+
 #if TRAINING
 
 static float uni_rand() {
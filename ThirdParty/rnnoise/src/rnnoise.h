@@ -93,6 +93,13 @@ RNNOISE_EXPORT void rnnoise_destroy(DenoiseState *st);
  */
 RNNOISE_EXPORT float rnnoise_process_frame(DenoiseState *st, float *out, const float *in);
 
+/**
+ * Denoise a frame with the previous frame's band gains, skipping the pitch
+ * analysis and the network. The state stays continuous with
+ * rnnoise_process_frame, so the two can be mixed frame by frame.
+ */
+RNNOISE_EXPORT void rnnoise_process_frame_hold(DenoiseState *st, float *out, const float *in);
+
 /**
  * Load a model from a file
  *
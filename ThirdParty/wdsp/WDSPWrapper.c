@@ -11,18 +11,104 @@
  * needed by emnr.h (fftw_plan) and anr.h */
 #include "comm.h"
 #include "WDSPWrapper.h"
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
 
 /* Required global — stubs on macOS (no-op CRITICAL_SECTIONs) */
 CH ch[MAX_CHANNELS];
 
+/* Blocks handed to xemnrBatch_emnr at once when a backlog arrives (8 × 10 ms at 48 kHz). */
+#define EMNR_BATCH_BLOCKS 8
+
 /* ---- EMNR ---- */
 
+/* Spectrum tap: one slot = power[bins], noise[bins], gain[bins].
+ * Triple buffer — the audio thread fills `back`, then swaps it with `middle`
+ * (setting TAP_FRESH); the reader swaps `front` with `middle` only when TAP_FRESH is set.
+ * Neither side ever waits on the other. */
+#define TAP_FRESH 4
+
+typedef struct EMNRTap {
+    int      bins;
+    int      *edge;         /* bins+1 FFT-bin boundaries of each decimated bin */
+    float    binHz;         /* width of one decimated bin */
+    float    scale;         /* 1/fsize² — FFT power → per-sample power */
+    float    *slot[3];      /* 3*bins floats each */
+    uint64_t hop[3];        /* hop counter stamped into each slot */
+    uint64_t hops;          /* hops seen by the writer */
+    int      back;          /* writer-owned */
+    int      front;         /* reader-owned */
+    _Atomic int middle;     /* shared: slot index | TAP_FRESH */
+} EMNRTap;
+
+/* Requests from other threads, picked up by wdsp_emnr_process before its next block. While one
+ * is POSTED the poster may withdraw it; once APPLYING, the audio thread owns its buffer. */
+enum { REQ_IDLE, REQ_POSTED, REQ_APPLYING };
+
+/* Other threads never write EMNR's processing state: they post requests that the audio thread
+ * applies between blocks, and a noise-state snapshot is read as a seqlock against `busy`. So
+ * wdsp_emnr_process never waits for another thread and never skips a block. */
 struct WDSP_EMNR {
     EMNR   impl;        /* WDSP EMNR object */
     double *workBuf;    /* complex IQ buffer: [I0,Q0, I1,Q1, ...], size=2*bufSize */
     int    bufSize;     /* number of IQ pairs per xemnr call (= real samples) */
+    double *batchBuf;   /* complex IQ buffer for EMNR_BATCH_BLOCKS blocks (batched path) */
+    _Atomic uint64_t busy;      /* odd while wdsp_emnr_process runs */
+    _Atomic int freeze;         /* noise freeze to apply */
+    _Atomic int gainMethod;     /* quality settings to apply (wdsp_emnr_set_quality) */
+    _Atomic int aeRun;
+    _Atomic int post2Run;
+    void   *restoreBuf;         /* noise-state snapshot to restore (stateSize bytes) */
+    int    stateSize;
+    _Atomic int restoreReq;
+    EMNRTap *tap;       /* installed in EMNR; the audio thread's */
+    EMNRTap *tapNext;   /* to install */
+    EMNRTap *tapOld;    /* uninstalled by the audio thread, for the next enable (or destroy) to free */
+    EMNRTap *tapReader; /* the tap wdsp_emnr_read_spectrum reads; NULL unless enabled */
+    _Atomic int tapReq;
 };
 
+static void emnr_hop_tap(void *arg, EMNR a);
+static void emnr_tap_free(EMNRTap *tap);
+
+/* Audio thread: takes a posted request. */
+static int take_request(_Atomic int *req) {
+    int expected = REQ_POSTED;
+    return atomic_load_explicit(req, memory_order_relaxed) == REQ_POSTED &&
+           atomic_compare_exchange_strong_explicit(req, &expected, REQ_APPLYING,
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+/* Poster: withdraws a request the audio thread hasn't taken (returns 1), or waits out one it is
+ * applying (a copy; microseconds). Either way the request's buffers are the poster's again. */
+static int withdraw_request(_Atomic int *req) {
+    int expected = REQ_POSTED;
+    if (atomic_compare_exchange_strong_explicit(req, &expected, REQ_IDLE,
+                                                memory_order_acquire, memory_order_acquire))
+        return 1;
+    while (atomic_load_explicit(req, memory_order_acquire) == REQ_APPLYING) sched_yield();
+    return 0;
+}
+
+static void apply_requests(WDSP_EMNR *ctx) {
+    setNpeFreeze_emnr(ctx->impl, atomic_load_explicit(&ctx->freeze, memory_order_relaxed));
+    setGainMethod_emnr(ctx->impl, atomic_load_explicit(&ctx->gainMethod, memory_order_relaxed));
+    setAeRun_emnr(ctx->impl, atomic_load_explicit(&ctx->aeRun, memory_order_relaxed));
+    setPost2Run_emnr(ctx->impl, atomic_load_explicit(&ctx->post2Run, memory_order_relaxed));
+    if (take_request(&ctx->restoreReq)) {
+        restoreNpeState_emnr(ctx->impl, ctx->restoreBuf, ctx->stateSize);
+        atomic_store_explicit(&ctx->restoreReq, REQ_IDLE, memory_order_release);
+    }
+    if (take_request(&ctx->tapReq)) {
+        ctx->tapOld = ctx->tap;
+        ctx->tap = ctx->tapNext;
+        if (ctx->tap) setHopTap_emnr(ctx->impl, emnr_hop_tap, ctx->tap);
+        else          setHopTap_emnr(ctx->impl, NULL, NULL);
+        atomic_store_explicit(&ctx->tapReq, REQ_IDLE, memory_order_release);
+    }
+}
+
 WDSP_EMNR* wdsp_emnr_create(int sampleRate) {
     WDSP_EMNR *ctx = (WDSP_EMNR *)calloc(1, sizeof(WDSP_EMNR));
     if (!ctx) return NULL;
@@ -56,11 +142,42 @@ WDSP_EMNR* wdsp_emnr_create(int sampleRate) {
         1             /* ae_run: 1=artifact elimination on */
     );
     if (!ctx->impl) { free(ctx->workBuf); free(ctx); return NULL; }
+
+    /* Batched catch-up path: with bsize == incr every block completes one hop. */
+    ctx->batchBuf = (double *)calloc(2 * bsize * EMNR_BATCH_BLOCKS, sizeof(double));
+    if (ctx->batchBuf) setBatch_emnr(ctx->impl, EMNR_BATCH_BLOCKS);
+
+    atomic_init(&ctx->gainMethod, 2);
+    atomic_init(&ctx->aeRun, 1);
+    atomic_init(&ctx->post2Run, 0);
+    ctx->stateSize = getNpeStateSize_emnr(ctx->impl);
+    ctx->restoreBuf = malloc((size_t)ctx->stateSize);
     return ctx;
 }
 
 void wdsp_emnr_process(WDSP_EMNR *ctx, float *inOut, int frameCount) {
     int offset = 0;
+    uint64_t seq = atomic_load_explicit(&ctx->busy, memory_order_relaxed);
+    atomic_store_explicit(&ctx->busy, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    apply_requests(ctx);
+
+    /* Backlog (two or more whole blocks): run them through the batched multi-hop path. */
+    while (ctx->batchBuf && frameCount - offset >= 2 * ctx->bufSize) {
+        int blocks = (frameCount - offset) / ctx->bufSize;
+        if (blocks > EMNR_BATCH_BLOCKS) blocks = EMNR_BATCH_BLOCKS;
+        int n = blocks * ctx->bufSize;
+        for (int i = 0; i < n; i++) {
+            ctx->batchBuf[2 * i + 0] = (double)inOut[offset + i];
+            ctx->batchBuf[2 * i + 1] = 0.0;
+        }
+        xemnrBatch_emnr(ctx->impl, ctx->batchBuf, ctx->batchBuf, blocks);
+        for (int i = 0; i < n; i++) {
+            inOut[offset + i] = (float)ctx->batchBuf[2 * i + 0];
+        }
+        offset += n;
+    }
+
     while (offset < frameCount) {
         int chunk = frameCount - offset;
         if (chunk > ctx->bufSize) chunk = ctx->bufSize;
@@ -85,15 +202,162 @@ void wdsp_emnr_process(WDSP_EMNR *ctx, float *inOut, int frameCount) {
         }
         offset += chunk;
     }
+    atomic_store_explicit(&ctx->busy, seq + 2, memory_order_release);
+}
+
+static void emnr_tap_free(EMNRTap *tap) {
+    if (!tap) return;
+    for (int i = 0; i < 3; i++) free(tap->slot[i]);
+    free(tap->edge);
+    free(tap);
 }
 
 void wdsp_emnr_destroy(WDSP_EMNR *ctx) {
     if (!ctx) return;
     destroy_emnr(ctx->impl);
+    emnr_tap_free(ctx->tap);
+    if (atomic_load_explicit(&ctx->tapReq, memory_order_acquire) == REQ_POSTED) emnr_tap_free(ctx->tapNext);
+    emnr_tap_free(ctx->tapOld);
+    free(ctx->restoreBuf);
+    free(ctx->batchBuf);
     free(ctx->workBuf);
     free(ctx);
 }
 
+void wdsp_emnr_set_noise_freeze(WDSP_EMNR *ctx, int frozen) {
+    atomic_store_explicit(&ctx->freeze, frozen ? 1 : 0, memory_order_relaxed);
+}
+
+void wdsp_emnr_set_quality(WDSP_EMNR *ctx, int gainMethod, int aeRun, int post2Run) {
+    if (gainMethod < 0 || gainMethod > 3) return;
+    atomic_store_explicit(&ctx->gainMethod, gainMethod, memory_order_relaxed);
+    atomic_store_explicit(&ctx->aeRun, aeRun ? 1 : 0, memory_order_relaxed);
+    atomic_store_explicit(&ctx->post2Run, post2Run ? 1 : 0, memory_order_relaxed);
+}
+
+int wdsp_emnr_noise_state_size(WDSP_EMNR *ctx) {
+    return getNpeStateSize_emnr(ctx->impl);
+}
+
+int wdsp_emnr_save_noise_state(WDSP_EMNR *ctx, void *buf, int size) {
+    if (size < ctx->stateSize) return 0;
+    /* A restore not yet applied is what the next block starts from. Only this side writes
+     * restoreBuf, so reading it while the audio thread applies it is fine. */
+    if (atomic_load_explicit(&ctx->restoreReq, memory_order_acquire) != REQ_IDLE) {
+        memcpy(buf, ctx->restoreBuf, (size_t)ctx->stateSize);
+        return ctx->stateSize;
+    }
+    /* Seqlock read: a copy that no block overlapped is consistent. A block takes well under a
+     * millisecond, so a retry after one almost always gets a clean copy. */
+    for (int attempt = 0; attempt < 20; attempt++) {
+        uint64_t seq = atomic_load_explicit(&ctx->busy, memory_order_acquire);
+        if (!(seq & 1)) {
+            int n = saveNpeState_emnr(ctx->impl, buf, size);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&ctx->busy, memory_order_relaxed) == seq) return n;
+        }
+        usleep(1000);
+    }
+    return 0;
+}
+
+int wdsp_emnr_restore_noise_state(WDSP_EMNR *ctx, const void *buf, int size) {
+    if (!ctx->restoreBuf || !checkNpeState_emnr(ctx->impl, buf, size)) return 0;
+    withdraw_request(&ctx->restoreReq);
+    memcpy(ctx->restoreBuf, buf, (size_t)ctx->stateSize);
+    atomic_store_explicit(&ctx->restoreReq, REQ_POSTED, memory_order_release);
+    return 1;
+}
+
+/* Runs on the audio thread, once per EMNR hop, inside wdsp_emnr_process. */
+static void emnr_hop_tap(void *arg, EMNR a) {
+    EMNRTap *tap = (EMNRTap *)arg;
+    float *power = tap->slot[tap->back];
+    float *noise = power + tap->bins;
+    float *gain  = noise + tap->bins;
+
+    for (int b = 0; b < tap->bins; b++) {
+        double py = 0.0, pd = 0.0, m = 0.0;
+        int lo = tap->edge[b], hi = tap->edge[b + 1];
+        for (int k = lo; k < hi; k++) {
+            py += a->g.lambda_y[k];
+            pd += a->g.lambda_d[k];
+            m  += a->mask[k];
+        }
+        double inv = 1.0 / (double)(hi - lo);
+        power[b] = (float)(py * inv) * tap->scale;
+        noise[b] = (float)(pd * inv) * tap->scale;
+        gain[b]  = (float)(m * inv);
+    }
+    tap->hop[tap->back] = ++tap->hops;
+    tap->back = atomic_exchange_explicit(&tap->middle, tap->back | TAP_FRESH,
+                                         memory_order_acq_rel) & 3;
+}
+
+int wdsp_emnr_enable_spectrum_tap(WDSP_EMNR *ctx, int bins, float maxHz) {
+    EMNRTap *tap = NULL;
+
+    if (bins > 0) {
+        EMNR a = ctx->impl;
+        double fftBinHz = a->rate / (double)a->fsize;
+        int span = a->msize;
+        if (maxHz > 0.0f) {
+            int limit = (int)(maxHz / fftBinHz) + 1;
+            if (limit < span) span = limit;
+        }
+        if (bins > span) bins = span;
+
+        tap = (EMNRTap *)calloc(1, sizeof(EMNRTap));
+        if (!tap) return 0;
+        tap->bins  = bins;
+        tap->edge  = (int *)malloc((bins + 1) * sizeof(int));
+        for (int i = 0; i < 3; i++)
+            tap->slot[i] = (float *)calloc(3 * bins, sizeof(float));
+        if (!tap->edge || !tap->slot[0] || !tap->slot[1] || !tap->slot[2]) {
+            emnr_tap_free(tap);
+            return 0;
+        }
+        for (int b = 0; b <= bins; b++)
+            tap->edge[b] = (int)((int64_t)b * span / bins);
+        tap->binHz = (float)(fftBinHz * span / bins);
+        tap->scale = (float)(1.0 / ((double)a->fsize * (double)a->fsize));
+        tap->back  = 0;
+        tap->front = 1;
+        atomic_init(&tap->middle, 2);
+    }
+
+    /* The audio thread installs it before its next block. Taps it has uninstalled, or that
+     * were never installed, are freed here. */
+    if (withdraw_request(&ctx->tapReq)) emnr_tap_free(ctx->tapNext);
+    emnr_tap_free(ctx->tapOld);
+    ctx->tapOld = NULL;
+    ctx->tapNext = tap;
+    ctx->tapReader = tap;
+    atomic_store_explicit(&ctx->tapReq, REQ_POSTED, memory_order_release);
+    return tap ? tap->bins : 0;
+}
+
+float wdsp_emnr_spectrum_bin_hz(WDSP_EMNR *ctx) {
+    return ctx->tapReader ? ctx->tapReader->binHz : 0.0f;
+}
+
+int wdsp_emnr_read_spectrum(WDSP_EMNR *ctx, float *power, float *noise, float *gain,
+                            int bins, uint64_t *hop) {
+    EMNRTap *tap = ctx->tapReader;
+    if (!tap) return 0;
+    if (!(atomic_load_explicit(&tap->middle, memory_order_acquire) & TAP_FRESH)) return 0;
+
+    tap->front = atomic_exchange_explicit(&tap->middle, tap->front,
+                                          memory_order_acq_rel) & 3;
+    const float *src = tap->slot[tap->front];
+    int n = bins < tap->bins ? bins : tap->bins;
+    if (power) memcpy(power, src,                 n * sizeof(float));
+    if (noise) memcpy(noise, src + tap->bins,     n * sizeof(float));
+    if (gain)  memcpy(gain,  src + 2 * tap->bins, n * sizeof(float));
+    if (hop) *hop = tap->hop[tap->front];
+    return n;
+}
+
 /* ---- ANR ---- */
 
 struct WDSP_ANR {
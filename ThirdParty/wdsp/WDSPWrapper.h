@@ -25,11 +25,54 @@ WDSP_EMNR* wdsp_emnr_create(int sampleRate);
 
 /* Process audio in-place.
  * inOut: float buffer of frameCount samples.
- * Internally chunked to bufSize — all frames are handled correctly. */
+ * Internally chunked to bufSize — all frames are handled correctly.
+ * A backlog of several blocks in one call is processed as a batch (many-FFT plans,
+ * one pass per stage) and drains faster than block-by-block; the output is the same.
+ * Never blocks and never skips a block: what other threads ask for (noise freeze, quality,
+ * a noise-state restore, the spectrum tap) is applied here, before the block's first hop. */
 void wdsp_emnr_process(WDSP_EMNR* ctx, float* inOut, int frameCount);
 
 void wdsp_emnr_destroy(WDSP_EMNR* ctx);
 
+/* Hold the noise estimate (e.g. while transmitting), from the next block. Never blocks.
+ * frozen != 0: the noise-power estimator stops adapting; gain keeps using the held estimate. */
+void wdsp_emnr_set_noise_freeze(WDSP_EMNR* ctx, int frozen);
+
+/* Noise-estimator snapshot (minimum statistics + gain history) for fast re-convergence.
+ * wdsp_emnr_noise_state_size: bytes needed for a snapshot of this context.
+ * wdsp_emnr_save_noise_state: returns bytes written, or 0 if size is too small (or, rarely,
+ * if no clean copy could be taken between blocks within about 20 ms). The copy is read
+ * between blocks without stopping wdsp_emnr_process; a restore still waiting to be
+ * applied is returned as the state.
+ * wdsp_emnr_restore_noise_state: returns 1 if the snapshot is taken, to be applied before
+ * the next block; 0 if it came from an EMNR with a different FFT geometry or sample rate
+ * (the current estimate is kept). A newer restore replaces one not yet applied.
+ * Call save and restore from one thread (main), while another is in wdsp_emnr_process. */
+int  wdsp_emnr_noise_state_size(WDSP_EMNR* ctx);
+int  wdsp_emnr_save_noise_state(WDSP_EMNR* ctx, void* buf, int size);
+int  wdsp_emnr_restore_noise_state(WDSP_EMNR* ctx, const void* buf, int size);
+
+/* Quality / CPU trade-off, applied from the next block's first hop. Never blocks; any thread.
+ * gainMethod: 0–3 as in WDSP (2 = table lookup, cheapest; 3 = two-step + zeta, most expensive).
+ * aeRun: artifact-elimination post filter (aepf) on/off.  post2Run: comfort-noise post filter on/off. */
+void wdsp_emnr_set_quality(WDSP_EMNR* ctx, int gainMethod, int aeRun, int post2Run);
+
+/* Spectrum / noise-floor tap.
+ * Publishes EMNR's own per-hop arrays — noisy-input power (lambda_y), noise estimate
+ * (lambda_d) and applied gain (mask) — averaged down to `bins` bins covering 0…maxHz
+ * (maxHz <= 0: up to Nyquist).  Costs one decimation pass per hop; no extra FFT.
+ * Powers are per-sample (FFT power / fsize²) and uncalibrated: use them as relative dB.
+ * wdsp_emnr_enable_spectrum_tap: bins <= 0 disables the tap.  Returns the bin count actually
+ *   used (clamped to the FFT bins in range), or 0.  The tap goes in before the next block.
+ *   Allocates — call off the audio thread, from the reader's thread.
+ * wdsp_emnr_read_spectrum: lock-free copy of the latest hop into caller arrays (any may be NULL).
+ *   Returns the bins copied, or 0 if nothing new was published since the previous read.
+ *   Intended for a single reader; must not race enable/disable. */
+int   wdsp_emnr_enable_spectrum_tap(WDSP_EMNR* ctx, int bins, float maxHz);
+float wdsp_emnr_spectrum_bin_hz(WDSP_EMNR* ctx);
+int   wdsp_emnr_read_spectrum(WDSP_EMNR* ctx, float* power, float* noise, float* gain,
+                              int bins, uint64_t* hop);
+
 /* ---- ANR (Adaptive Noise Reduction / LMS) ---- */
 /* Time-domain LMS filter with delay line; no FFTW dependency */
 typedef struct WDSP_ANR WDSP_ANR;
@@ -296,6 +296,8 @@ void CwriteZetaHat(const char* cfile, int zetaHat_rows, int zetaHat_cols,
 }
 }
 void post2_calc_w(EMNR a);
+void calc_batch_emnr(EMNR a);
+void decalc_batch_emnr(EMNR a);
 
 void calc_emnr(EMNR a)
 {
@@ -571,11 +573,13 @@ void calc_emnr(EMNR a)
 	a->post2.noise_frame = (double*)malloc0(2 * a->msize * sizeof(double));
 	a->post2.olddmag = 0.0;
 	post2_calc_w(a);
+	if (a->bmax) calc_batch_emnr(a);
 }
 
 void decalc_emnr(EMNR a)
 {
 	int i;
+	if (a->bmax) decalc_batch_emnr(a);
 	// post2
 	_aligned_free(a->post2.noise_frame);
 	_aligned_free(a->post2.w);
@@ -1024,17 +1028,20 @@ void calc_gain (EMNR a)
 	{
 		a->g.lambda_y[k] = a->g.y[2 * k + 0] * a->g.y[2 * k + 0] + a->g.y[2 * k + 1] * a->g.y[2 * k + 1];
 	}
-	switch (a->g.npe_method)
+	if (!a->g.npe_freeze)
 	{
-	case 0:
-		LambdaD(a);
-		break;
-	case 1:
-		LambdaDs(a);
-		break;
-	case 2:
-		LambdaDl(a);
-		break;
+		switch (a->g.npe_method)
+		{
+		case 0:
+			LambdaD(a);
+			break;
+		case 1:
+			LambdaDs(a);
+			break;
+		case 2:
+			LambdaDl(a);
+			break;
+		}
 	}
 	switch (a->g.gain_method)
 	{
@@ -1168,6 +1175,8 @@ void xemnr (EMNR a, int pos)
 			a->nsamps -= a->incr;
 			fftw_execute (a->Rfor);
 			calc_gain(a);
+			if (a->hop_tap)
+				(*a->hop_tap)(a->hop_tap_arg, a);
 			for (i = 0; i < a->msize; i++)
 			{
 				g1 = a->gain * a->mask[i];
@@ -1224,9 +1233,337 @@ void setSize_emnr (EMNR a, int size)
 	calc_emnr (a);
 }
 
+/********************************************************************************************************
+*																										*
+*										Batched Multi-hop Processing									*
+*																										*
+********************************************************************************************************/
+
+// xemnrBatch_emnr() runs nblocks consecutive bsize blocks through the same pipeline as nblocks
+// calls to xemnr(), but in four passes per batch of up to bmax hops:
+//   1. push the blocks into inaccum and window every completed frame into a row of bforin
+//   2. forward FFT of all rows (one many-FFT plan when the batch is full)
+//   3. calc_gain / mask / post2 per hop, in order -- these carry state from hop to hop
+//   4. reverse FFT of all rows, then window + overlap-add per hop and emit each block's output
+// Every hop sees exactly the data it would see hop-by-hop, so the output matches xemnr()
+// up to FFT rounding (FFTW may pick different codelets for the many-FFT plan).
+
+void calc_batch_emnr (EMNR a)
+{
+	int n = a->fsize;
+	a->bforin  = (double *)malloc0(a->bmax * a->fsize * sizeof(double));
+	a->bforout = (double *)malloc0(a->bmax * a->msize * sizeof(complex));
+	a->brevin  = (double *)malloc0(a->bmax * a->msize * sizeof(complex));
+	a->brevout = (double *)malloc0(a->bmax * a->fsize * sizeof(double));
+	a->bhops   = (int *)malloc0(a->bmax * sizeof(int));
+	a->BRfor = fftw_plan_many_dft_r2c(1, &n, a->bmax, a->bforin, NULL, 1, a->fsize,
+		(fftw_complex *)a->bforout, NULL, 1, a->msize, FFTW_ESTIMATE);
+	a->BRrev = fftw_plan_many_dft_c2r(1, &n, a->bmax, (fftw_complex *)a->brevin, NULL, 1, a->msize,
+		a->brevout, NULL, 1, a->fsize, FFTW_ESTIMATE);
+}
+
+void decalc_batch_emnr (EMNR a)
+{
+	fftw_destroy_plan(a->BRrev);
+	fftw_destroy_plan(a->BRfor);
+	_aligned_free(a->bhops);
+	_aligned_free(a->brevout);
+	_aligned_free(a->brevin);
+	_aligned_free(a->bforout);
+	_aligned_free(a->bforin);
+}
+
+// maxhops: hops per batch (0 turns the batch path off and frees its buffers).  Allocates and
+// plans; call from a non-realtime thread.  Processing state is not reset.
+void setBatch_emnr (EMNR a, int maxhops)
+{
+	int minhops = a->bsize / a->incr + 1;
+	if (maxhops > 0 && maxhops < minhops) maxhops = minhops;
+	if (a->bmax) decalc_batch_emnr (a);
+	a->bmax = maxhops > 0 ? maxhops : 0;
+	if (a->bmax) calc_batch_emnr (a);
+}
+
+void xemnrBatch_emnr (EMNR a, double* in, double* out, int nblocks)
+{
+	int i, j, k, k2, h, b, nb, nh, sbuff, sbegin;
+	double g1;
+	if (!a->run || !a->bmax)
+	{
+		double* sin = a->in;
+		double* sout = a->out;
+		for (b = 0; b < nblocks; b++)
+		{
+			a->in  = in  + 2 * a->bsize * b;
+			a->out = out + 2 * a->bsize * b;
+			xemnr (a, a->position);
+		}
+		a->in = sin;
+		a->out = sout;
+		return;
+	}
+	for (b = 0; b < nblocks; b += nb)
+	{
+		double* sforout = a->forfftout;
+		double* srevin  = a->revfftin;
+		// 1. input
+		for (nb = 0, nh = 0; b + nb < nblocks && nb < a->bmax; nb++)
+		{
+			double* bin = in + 2 * a->bsize * (b + nb);
+			int ns = a->nsamps + a->bsize;
+			if (ns >= a->fsize && nh + (ns - a->fsize) / a->incr + 1 > a->bmax) break;
+			for (i = 0; i < 2 * a->bsize; i += 2)
+			{
+				a->inaccum[a->iainidx] = bin[i];
+				a->iainidx = (a->iainidx + 1) % a->iasize;
+			}
+			a->nsamps += a->bsize;
+			while (a->nsamps >= a->fsize)
+			{
+				double* fin = a->bforin + nh * a->fsize;
+				for (i = 0, j = a->iaoutidx; i < a->fsize; i++, j = (j + 1) % a->iasize)
+					fin[i] = a->window[i] * a->inaccum[j];
+				a->iaoutidx = (a->iaoutidx + a->incr) % a->iasize;
+				a->nsamps -= a->incr;
+				nh++;
+			}
+			a->bhops[nb] = nh;
+		}
+		// 2. forward FFTs
+		if (nh == a->bmax)
+			fftw_execute (a->BRfor);
+		else
+			for (h = 0; h < nh; h++)
+				fftw_execute_dft_r2c (a->Rfor, a->bforin + h * a->fsize,
+					(fftw_complex *)(a->bforout + 2 * h * a->msize));
+		// 3. gain, hop by hop
+		for (h = 0; h < nh; h++)
+		{
+			a->forfftout = a->g.y = a->bforout + 2 * h * a->msize;
+			a->revfftin  = a->brevin + 2 * h * a->msize;
+			calc_gain(a);
+			if (a->hop_tap)
+				(*a->hop_tap)(a->hop_tap_arg, a);
+			for (i = 0; i < a->msize; i++)
+			{
+				g1 = a->gain * a->mask[i];
+				a->revfftin[2 * i + 0] = g1 * a->forfftout[2 * i + 0];
+				a->revfftin[2 * i + 1] = g1 * a->forfftout[2 * i + 1];
+			}
+			post2(a);
+		}
+		a->forfftout = a->g.y = sforout;
+		a->revfftin = srevin;
+		// 4. reverse FFTs, overlap-add, output
+		if (nh == a->bmax)
+			fftw_execute (a->BRrev);
+		else
+			for (h = 0; h < nh; h++)
+				fftw_execute_dft_c2r (a->Rrev, (fftw_complex *)(a->brevin + 2 * h * a->msize),
+					a->brevout + h * a->fsize);
+		for (k = 0, h = 0; k < nb; k++)
+		{
+			double* bout = out + 2 * a->bsize * (b + k);
+			for (; h < a->bhops[k]; h++)
+			{
+				double* rout = a->brevout + h * a->fsize;
+				for (i = 0; i < a->fsize; i++)
+					a->save[a->saveidx][i] = a->window[i] * rout[i];
+				for (i = a->ovrlp; i > 0; i--)
+				{
+					sbuff = (a->saveidx + i) % a->ovrlp;
+					sbegin = a->incr * (a->ovrlp - i);
+					for (j = sbegin, k2 = a->oainidx; j < a->incr + sbegin; j++, k2 = (k2 + 1) % a->oasize)
+					{
+						if ( i == a->ovrlp)
+							a->outaccum[k2]  = a->save[sbuff][j];
+						else
+							a->outaccum[k2] += a->save[sbuff][j];
+					}
+				}
+				a->saveidx = (a->saveidx + 1) % a->ovrlp;
+				a->oainidx = (a->oainidx + a->incr) % a->oasize;
+			}
+			for (i = 0; i < a->bsize; i++)
+			{
+				bout[2 * i + 0] = a->outaccum[a->oaoutidx];
+				bout[2 * i + 1] = 0.0;
+				a->oaoutidx = (a->oaoutidx + 1) % a->oasize;
+			}
+		}
+	}
+}
+
+/********************************************************************************************************
+*																										*
+*									Noise Estimate Freeze / Snapshot									*
+*																										*
+********************************************************************************************************/
+
+// While frozen, lambda_d is held at its last value and none of the noise-power estimators
+// (LambdaD, LambdaDs, LambdaDl) advance.  The gain computation keeps running against the
+// held estimate, so a transmit interval does not pollute the minimum-statistics history.
+
+void setNpeFreeze_emnr (EMNR a, int freeze)
+{
+	a->g.npe_freeze = freeze;
+}
+
+// The snapshot holds every array that carries estimator state from one hop to the next,
+// for all three npe methods, plus the gain-smoothing history.  Per-hop scratch arrays
+// (alphaOptHat, alphaHat, Qeq, bmin, bmin_sub, k_mod, PH1y, EN2y) are recomputed
+// before use and are not saved.  A snapshot only restores into an EMNR with the same
+// msize and U, i.e. the same fsize, ovrlp and rate.
+
+#define EMNR_NPE_MAGIC		0x454d4e53		// 'EMNS'
+#define EMNR_NPE_VERSION	1
+
+typedef struct _emnr_npe_hdr
+{
+	int magic;
+	int version;
+	int msize;
+	int U;
+	int subwc;
+	int amb_idx;
+	double alphaC;
+} emnr_npe_hdr;
+
+static int npe_arrays (EMNR a, double** arrs)
+{
+	int i, n = 0;
+	arrs[n++] = a->g.lambda_d;
+	arrs[n++] = a->g.prev_mask;
+	arrs[n++] = a->g.prev_gamma;
+	arrs[n++] = a->np.p;
+	arrs[n++] = a->np.sigma2N;
+	arrs[n++] = a->np.pbar;
+	arrs[n++] = a->np.p2bar;
+	arrs[n++] = a->np.actmin;
+	arrs[n++] = a->np.actmin_sub;
+	arrs[n++] = a->np.pmin_u;
+	arrs[n++] = a->nps.sigma2N;
+	arrs[n++] = a->nps.Pbar;
+	arrs[n++] = a->npl.P;
+	arrs[n++] = a->npl.Pmin;
+	arrs[n++] = a->npl.p;
+	arrs[n++] = a->npl.D;
+	for (i = 0; i < a->np.U; i++)
+		arrs[n++] = a->np.actminbuff[i];
+	return n;
+}
+
+#define EMNR_NPE_FIXED_ARRAYS 16
+
+int getNpeStateSize_emnr (EMNR a)
+{
+	return (int)sizeof (emnr_npe_hdr)
+		+ (EMNR_NPE_FIXED_ARRAYS + a->np.U) * a->msize * (int)sizeof (double)
+		+ a->msize * (int)sizeof (int);
+}
+
+// returns the number of bytes written, or 0 if 'size' is too small
+int saveNpeState_emnr (EMNR a, void* buff, int size)
+{
+	int i, n;
+	double* arrs[EMNR_NPE_FIXED_ARRAYS + 64];
+	emnr_npe_hdr hdr;
+	char* p = (char*)buff;
+	if (size < getNpeStateSize_emnr (a) || a->np.U > 64) return 0;
+	hdr.magic   = EMNR_NPE_MAGIC;
+	hdr.version = EMNR_NPE_VERSION;
+	hdr.msize   = a->msize;
+	hdr.U       = a->np.U;
+	hdr.subwc   = a->np.subwc;
+	hdr.amb_idx = a->np.amb_idx;
+	hdr.alphaC  = a->np.alphaC;
+	memcpy (p, &hdr, sizeof (hdr));
+	p += sizeof (hdr);
+	n = npe_arrays (a, arrs);
+	for (i = 0; i < n; i++)
+	{
+		memcpy (p, arrs[i], a->msize * sizeof (double));
+		p += a->msize * sizeof (double);
+	}
+	memcpy (p, a->np.lmin_flag, a->msize * sizeof (int));
+	p += a->msize * sizeof (int);
+	return (int)(p - (char*)buff);
+}
+
+// returns 1 if the snapshot matches this EMNR's geometry.  Reads only the geometry, which is
+// fixed after creation, so it is safe while another thread runs xemnr().
+int checkNpeState_emnr (EMNR a, const void* buff, int size)
+{
+	emnr_npe_hdr hdr;
+	if (size < (int)sizeof (hdr)) return 0;
+	memcpy (&hdr, buff, sizeof (hdr));
+	return hdr.magic == EMNR_NPE_MAGIC && hdr.version == EMNR_NPE_VERSION
+		&& hdr.msize == a->msize && hdr.U == a->np.U && a->np.U <= 64
+		&& size >= getNpeStateSize_emnr (a);
+}
+
+// returns 1 on success, 0 if the snapshot does not match this EMNR's geometry
+int restoreNpeState_emnr (EMNR a, const void* buff, int size)
+{
+	int i, n;
+	double* arrs[EMNR_NPE_FIXED_ARRAYS + 64];
+	emnr_npe_hdr hdr;
+	const char* p = (const char*)buff;
+	if (!checkNpeState_emnr (a, buff, size)) return 0;
+	memcpy (&hdr, p, sizeof (hdr));
+	p += sizeof (hdr);
+	a->np.subwc   = hdr.subwc;
+	a->np.amb_idx = hdr.amb_idx;
+	a->np.alphaC  = hdr.alphaC;
+	n = npe_arrays (a, arrs);
+	for (i = 0; i < n; i++)
+	{
+		memcpy (arrs[i], p, a->msize * sizeof (double));
+		p += a->msize * sizeof (double);
+	}
+	memcpy (a->np.lmin_flag, p, a->msize * sizeof (int));
+	return 1;
+}
+
+/********************************************************************************************************
+*																										*
+*											Per-hop Tap													*
+*																										*
+********************************************************************************************************/
+
+// The tap is called once per hop, right after calc_gain(), from inside xemnr().  At that point
+// g.lambda_y holds the periodogram of the current frame, g.lambda_d the noise-power estimate and
+// mask the gain about to be applied.  The callback must not block or allocate; pass tap = 0 to
+// remove it.
+
+void setHopTap_emnr (EMNR a, void (*tap)(void* arg, EMNR a), void* arg)
+{
+	a->hop_tap = 0;
+	a->hop_tap_arg = arg;
+	a->hop_tap = tap;
+}
+
 /********************************************************************************************************
 *																										*
 *											RXA Properties												*
 *																										*
 ********************************************************************************************************/
 
+// Quality knobs for load shedding.  All three take effect on the next hop; gain_method 3
+// additionally requires the zeta tables loaded by calc_emnr.
+
+void setGainMethod_emnr (EMNR a, int method)
+{
+	a->g.gain_method = method;
+}
+
+void setAeRun_emnr (EMNR a, int run)
+{
+	a->g.ae_run = run;
+}
+
+void setPost2Run_emnr (EMNR a, int run)
+{
+	a->post2.run = run;
+}
+
@@ -62,10 +62,21 @@ typedef struct _emnr
 	int saveidx;
 	fftw_plan Rfor;
 	fftw_plan Rrev;
+	void (*hop_tap)(void* arg, struct _emnr* a);
+	void* hop_tap_arg;
+	int bmax;
+	double* bforin;
+	double* bforout;
+	double* brevin;
+	double* brevout;
+	int* bhops;
+	fftw_plan BRfor;
+	fftw_plan BRrev;
 	struct _g
 	{
 		int gain_method;
 		int npe_method;
+		int npe_freeze;
 		int ae_run;
 		double msize;
 		double* mask;
@@ -218,4 +229,26 @@ extern void setSamplerate_emnr (EMNR a, int rate);
 
 extern void setSize_emnr (EMNR a, int size);
 
+extern void setBatch_emnr (EMNR a, int maxhops);
+
+extern void xemnrBatch_emnr (EMNR a, double* in, double* out, int nblocks);
+
+extern void setNpeFreeze_emnr (EMNR a, int freeze);
+
+extern int getNpeStateSize_emnr (EMNR a);
+
+extern int saveNpeState_emnr (EMNR a, void* buff, int size);
+
+extern int checkNpeState_emnr (EMNR a, const void* buff, int size);
+
+extern int restoreNpeState_emnr (EMNR a, const void* buff, int size);
+
+extern void setGainMethod_emnr (EMNR a, int method);
+
+extern void setAeRun_emnr (EMNR a, int run);
+
+extern void setPost2Run_emnr (EMNR a, int run);
+
+extern void setHopTap_emnr (EMNR a, void (*tap)(void* arg, EMNR a), void* arg);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,857 @@
+/*  kc_bench.c
+ *
+ *  Per-kernel DSP microbenchmarks: WDSP xemnr (single hop and batched), xanr,
+ *  the wrapper's float<->IQ pack/unpack loops, the whole wdsp_emnr_process
+ *  call, rnnoise_process_frame and RNNoise's compute_rnn, rnn_pitch_search
+ *  and rnn_fft, and the app's kc_pcm sample-format conversions.
+ *
+ *  Each kernel is fed consecutive 48 kHz frames of a deterministic synthetic
+ *  mix (voice + CW + 8-FSK + white noise) and of any recordings given with -i.
+ *  Staging a frame into the kernel's buffers is not timed; each call is timed
+ *  on its own (p50/p99/max), user-space instructions are counted around the
+ *  calls only (perf_event, Linux), and so are heap allocations (glibc: the
+ *  allocator functions are interposed by symbol). Results go to a table and,
+ *  with --json, to a file that --baseline can compare against on a later run.
+ *
+ *  Usage: kc-bench [options]   (kc-bench --help)
+ */
+
+#include "kc_chain.h"
+#include "kc_pcm.h"
+#include "kc_perf.h"
+#include "kc_resample.h"
+#include "kc_signal.h"
+#include "kc_wav.h"
+
+#include "kiss_fft.h"
+#include "pitch.h"
+#include "rnn.h"
+#include "rnn_data.h"
+#include "rnnoise.h"
+#if KC_HAVE_WDSP
+#include "comm.h"
+#include "WDSPWrapper.h"
+#endif
+
+#include <errno.h>
+#include <getopt.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef KC_GIT_REV
+#define KC_GIT_REV "unknown"
+#endif
+
+#define BENCH_RATE      KC_CHAIN_RATE
+#define BENCH_FRAME     KC_CHAIN_FRAME      /* "ns/frame" is per 480 samples (10 ms) */
+#define BENCH_MAX_INPUTS 8
+
+/* ---- Allocation counting ----
+ * glibc only: malloc and friends are replaced for the whole process and forward to the
+ * __libc_* implementations; they count while g_counting is set (around timed calls only). */
+
+#if defined(__GLIBC__)
+#define BENCH_COUNTS_ALLOCS 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *p, size_t size);
+extern void *__libc_memalign(size_t align, size_t size);
+extern void  __libc_free(void *p);
+
+static atomic_int         g_counting;
+static atomic_ullong      g_allocs;
+static atomic_ullong      g_allocBytes;
+
+static inline void note_alloc(size_t size) {
+    if (atomic_load_explicit(&g_counting, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&g_allocs, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&g_allocBytes, size, memory_order_relaxed);
+    }
+}
+
+void *malloc(size_t size)                 { note_alloc(size); return __libc_malloc(size); }
+void *calloc(size_t n, size_t size)       { note_alloc(n * size); return __libc_calloc(n, size); }
+void *realloc(void *p, size_t size)       { note_alloc(size); return __libc_realloc(p, size); }
+void *memalign(size_t align, size_t size) { note_alloc(size); return __libc_memalign(align, size); }
+void *aligned_alloc(size_t align, size_t size) { note_alloc(size); return __libc_memalign(align, size); }
+void  free(void *p)                       { __libc_free(p); }
+
+int posix_memalign(void **out, size_t align, size_t size) {
+    note_alloc(size);
+    void *p = __libc_memalign(align, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+static void counting(int on) { atomic_store_explicit(&g_counting, on, memory_order_relaxed); }
+#else
+#define BENCH_COUNTS_ALLOCS 0
+static void counting(int on) { (void)on; }
+#endif
+
+/* ---- Kernels ---- */
+
+typedef struct bench_kernel {
+    const char *name;
+    const char *what;
+    int    samples;                            /* 48 kHz input samples consumed per call */
+    void  *(*create)(void);
+    void   (*load)(void *s, const float *in);  /* untimed: stage `samples` input samples */
+    void   (*run)(void *s);                    /* timed */
+    void   (*destroy)(void *s);
+} bench_kernel;
+
+#if KC_HAVE_WDSP
+/* Same geometry and settings as wdsp_emnr_create / wdsp_anr_create. */
+#define BENCH_EMNR_FSIZE  1920
+#define BENCH_EMNR_OVRLP  4
+#define BENCH_EMNR_BATCH  8
+
+typedef struct emnr_state {
+    EMNR    e;
+    double *buf;
+    int     blocks;
+} emnr_state;
+
+static void pack_iq(double *buf, const float *in, int n) {
+    for (int i = 0; i < n; i++) {
+        buf[2 * i + 0] = (double)in[i];
+        buf[2 * i + 1] = 0.0;
+    }
+}
+
+static void *emnr_create_n(int blocks) {
+    emnr_state *s = (emnr_state *)calloc(1, sizeof(*s));
+    s->blocks = blocks;
+    s->buf = (double *)calloc(2 * BENCH_FRAME * blocks, sizeof(double));
+    s->e = create_emnr(1, 0, BENCH_FRAME, s->buf, s->buf, BENCH_EMNR_FSIZE, BENCH_EMNR_OVRLP,
+                       BENCH_RATE, 0, 1.0, 2, 0, 1);
+    if (blocks > 1) setBatch_emnr(s->e, blocks);
+    return s;
+}
+static void *emnr_create(void)       { return emnr_create_n(1); }
+static void *emnr_batch_create(void) { return emnr_create_n(BENCH_EMNR_BATCH); }
+static void  emnr_load(void *p, const float *in) {
+    emnr_state *s = (emnr_state *)p;
+    pack_iq(s->buf, in, BENCH_FRAME * s->blocks);
+}
+static void  emnr_run(void *p)       { xemnr(((emnr_state *)p)->e, 0); }
+static void  emnr_batch_run(void *p) {
+    emnr_state *s = (emnr_state *)p;
+    xemnrBatch_emnr(s->e, s->buf, s->buf, s->blocks);
+}
+static void  emnr_destroy(void *p) {
+    emnr_state *s = (emnr_state *)p;
+    destroy_emnr(s->e);
+    free(s->buf);
+    free(s);
+}
+
+typedef struct anr_state {
+    ANR     a;
+    double *buf;
+} anr_state;
+
+static void *anr_create(void) {
+    anr_state *s = (anr_state *)calloc(1, sizeof(*s));
+    s->buf = (double *)calloc(2 * BENCH_FRAME, sizeof(double));
+    s->a = create_anr(1, 0, BENCH_FRAME, s->buf, s->buf, ANR_DLINE_SIZE, 64, 16, 0.0001, 0.1,
+                      120.0, 120.0, 200.0, 0.001, 6.25e-10, 1.0, 3.0);
+    return s;
+}
+static void  anr_load(void *p, const float *in) { pack_iq(((anr_state *)p)->buf, in, BENCH_FRAME); }
+static void  anr_run(void *p) { xanr(((anr_state *)p)->a, 0); }
+static void  anr_destroy(void *p) {
+    anr_state *s = (anr_state *)p;
+    destroy_anr(s->a);
+    free(s->buf);
+    free(s);
+}
+
+/* The pack and unpack loops of wdsp_emnr_process / wdsp_anr_process, one 480-sample block. */
+typedef struct pack_state {
+    double *buf;
+    float   io[BENCH_FRAME];
+} pack_state;
+
+static void *pack_create(void) {
+    pack_state *s = (pack_state *)calloc(1, sizeof(*s));
+    s->buf = (double *)calloc(2 * BENCH_FRAME, sizeof(double));
+    return s;
+}
+static void  pack_load(void *p, const float *in) { memcpy(((pack_state *)p)->io, in, sizeof(float) * BENCH_FRAME); }
+static void  pack_run(void *p) {
+    pack_state *s = (pack_state *)p;
+    for (int i = 0; i < BENCH_FRAME; i++) {
+        s->buf[2 * i + 0] = (double)s->io[i];
+        s->buf[2 * i + 1] = 0.0;
+    }
+    for (int i = 0; i < BENCH_FRAME; i++) {
+        s->io[i] = (float)s->buf[2 * i + 0];
+    }
+}
+static void  pack_destroy(void *p) {
+    free(((pack_state *)p)->buf);
+    free(p);
+}
+
+typedef struct wrapper_state {
+    WDSP_EMNR *ctx;
+    float      io[BENCH_FRAME];
+} wrapper_state;
+
+static void *wrapper_create(void) {
+    wrapper_state *s = (wrapper_state *)calloc(1, sizeof(*s));
+    s->ctx = wdsp_emnr_create(BENCH_RATE);
+    return s;
+}
+static void  wrapper_load(void *p, const float *in) { memcpy(((wrapper_state *)p)->io, in, sizeof(float) * BENCH_FRAME); }
+static void  wrapper_run(void *p) {
+    wrapper_state *s = (wrapper_state *)p;
+    wdsp_emnr_process(s->ctx, s->io, BENCH_FRAME);
+}
+static void  wrapper_destroy(void *p) {
+    wdsp_emnr_destroy(((wrapper_state *)p)->ctx);
+    free(p);
+}
+#endif /* KC_HAVE_WDSP */
+
+/* RNNoise works in int16-like units. */
+typedef struct rnnoise_state {
+    DenoiseState *st;
+    float in[BENCH_FRAME], out[BENCH_FRAME];
+} rnnoise_state;
+
+static void *rnnoise_bench_create(void) {
+    rnnoise_state *s = (rnnoise_state *)calloc(1, sizeof(*s));
+    s->st = rnnoise_create(NULL);
+    return s;
+}
+static void  rnnoise_bench_load(void *p, const float *in) {
+    rnnoise_state *s = (rnnoise_state *)p;
+    for (int i = 0; i < BENCH_FRAME; i++) s->in[i] = in[i] * 32768.0f;
+}
+static void  rnnoise_bench_run(void *p) {
+    rnnoise_state *s = (rnnoise_state *)p;
+    rnnoise_process_frame(s->st, s->out, s->in);
+}
+static void  rnnoise_bench_destroy(void *p) {
+    rnnoise_destroy(((rnnoise_state *)p)->st);
+    free(p);
+}
+
+/* compute_rnn on the built-in model. Its cost doesn't depend on the feature values, so the
+ * 42 features (NB_FEATURES in denoise.c) are just decimated input samples. */
+#define BENCH_RNN_FEATURES 42
+#define BENCH_RNN_BANDS    22
+
+extern const struct RNNModel rnnoise_model_orig;   /* rnn_data.c; declared in denoise.c only */
+
+typedef struct rnn_state {
+    RNNState rnn;
+    float    features[BENCH_RNN_FEATURES];
+    float    gains[BENCH_RNN_BANDS];
+    float    vad;
+} rnn_state;
+
+static void *rnn_create(void) {
+    rnn_state *s = (rnn_state *)calloc(1, sizeof(*s));
+    s->rnn.model = &rnnoise_model_orig;
+    s->rnn.vad_gru_state = (float *)calloc(s->rnn.model->vad_gru_size, sizeof(float));
+    s->rnn.noise_gru_state = (float *)calloc(s->rnn.model->noise_gru_size, sizeof(float));
+    s->rnn.denoise_gru_state = (float *)calloc(s->rnn.model->denoise_gru_size, sizeof(float));
+    return s;
+}
+static void  rnn_load(void *p, const float *in) {
+    rnn_state *s = (rnn_state *)p;
+    for (int i = 0; i < BENCH_RNN_FEATURES; i++) s->features[i] = 4.0f * in[i * (BENCH_FRAME / BENCH_RNN_FEATURES)];
+}
+static void  rnn_run(void *p) {
+    rnn_state *s = (rnn_state *)p;
+    compute_rnn(&s->rnn, s->gains, &s->vad, s->features);
+}
+static void  rnn_destroy(void *p) {
+    rnn_state *s = (rnn_state *)p;
+    free(s->rnn.vad_gru_state);
+    free(s->rnn.noise_gru_state);
+    free(s->rnn.denoise_gru_state);
+    free(s);
+}
+
+/* rnn_pitch_search as compute_frame_features calls it; the history shift and
+ * rnn_pitch_downsample happen in load. Constants from denoise.c. */
+#define BENCH_PITCH_MIN_PERIOD 60
+#define BENCH_PITCH_MAX_PERIOD 768
+#define BENCH_PITCH_FRAME_SIZE 960
+#define BENCH_PITCH_BUF_SIZE   (BENCH_PITCH_MAX_PERIOD + BENCH_PITCH_FRAME_SIZE)
+
+typedef struct pitch_state {
+    celt_sig   buf[BENCH_PITCH_BUF_SIZE];
+    opus_val16 lp[BENCH_PITCH_BUF_SIZE >> 1];
+    int        index;
+} pitch_state;
+
+static void *pitch_create(void) { return calloc(1, sizeof(pitch_state)); }
+static void  pitch_load(void *p, const float *in) {
+    pitch_state *s = (pitch_state *)p;
+    memmove(s->buf, s->buf + BENCH_FRAME, sizeof(celt_sig) * (BENCH_PITCH_BUF_SIZE - BENCH_FRAME));
+    for (int i = 0; i < BENCH_FRAME; i++) s->buf[BENCH_PITCH_BUF_SIZE - BENCH_FRAME + i] = in[i] * 32768.0f;
+    celt_sig *pre[1] = { s->buf };
+    rnn_pitch_downsample(pre, s->lp, BENCH_PITCH_BUF_SIZE, 1);
+}
+static void  pitch_run(void *p) {
+    pitch_state *s = (pitch_state *)p;
+    rnn_pitch_search(s->lp + (BENCH_PITCH_MAX_PERIOD >> 1), s->lp, BENCH_PITCH_FRAME_SIZE,
+                     BENCH_PITCH_MAX_PERIOD - 3 * BENCH_PITCH_MIN_PERIOD, &s->index);
+}
+static void  pitch_destroy(void *p) { free(p); }
+
+/* One 960-point complex FFT over the last two frames, as forward_transform does. */
+#define BENCH_FFT_SIZE (2 * BENCH_FRAME)
+
+typedef struct fft_state {
+    kiss_fft_state *cfg;
+    kiss_fft_cpx    x[BENCH_FFT_SIZE], y[BENCH_FFT_SIZE];
+} fft_state;
+
+static void *fft_create(void) {
+    fft_state *s = (fft_state *)calloc(1, sizeof(*s));
+    s->cfg = rnn_fft_alloc_twiddles(BENCH_FFT_SIZE, NULL, NULL, NULL, 0);
+    return s;
+}
+static void  fft_load(void *p, const float *in) {
+    fft_state *s = (fft_state *)p;
+    memmove(s->x, s->x + BENCH_FRAME, sizeof(kiss_fft_cpx) * BENCH_FRAME);
+    for (int i = 0; i < BENCH_FRAME; i++) {
+        s->x[BENCH_FRAME + i].r = in[i] * 32768.0f;
+        s->x[BENCH_FRAME + i].i = 0.0f;
+    }
+}
+static void  fft_run(void *p) {
+    fft_state *s = (fft_state *)p;
+    rnn_fft_c(s->cfg, s->x, s->y);
+}
+static void  fft_destroy(void *p) {
+    fft_state *s = (fft_state *)p;
+    rnn_fft_free(s->cfg, 0);
+    free(s);
+}
+
+/* kc_pcm conversions, once with the best code path for this CPU and once scalar. The path is
+ * selected in load, so every kernel's calls run the one it names. */
+typedef struct pcm_state {
+    int16_t s16[BENCH_FRAME];
+    uint8_t bytes[2 * BENCH_FRAME];
+    float   f[BENCH_FRAME];
+    kc_pcm_dither dither;
+    kc_pcm_isa isa;
+} pcm_state;
+
+static void *pcm_create_isa(kc_pcm_isa isa) {
+    pcm_state *s = (pcm_state *)calloc(1, sizeof(*s));
+    kc_pcm_dither_init(&s->dither, 1);
+    s->isa = isa;
+    return s;
+}
+static void *pcm_create(void)        { return pcm_create_isa(kc_pcm_best_isa()); }
+static void *pcm_scalar_create(void) { return pcm_create_isa(KC_PCM_SCALAR); }
+static void  pcm_load(void *p, const float *in) {
+    pcm_state *s = (pcm_state *)p;
+    kc_pcm_use_isa(s->isa);
+    memcpy(s->f, in, sizeof(float) * BENCH_FRAME);
+    kc_pcm_f32_to_s16le(in, s->bytes, BENCH_FRAME, 32767.0f, NULL);
+}
+static void  pcm_decode_run(void *p) {
+    pcm_state *s = (pcm_state *)p;
+    kc_pcm_s16le_to_f32(s->bytes, s->f, BENCH_FRAME, 1.0f / 32768.0f);
+}
+static void  pcm_encode_run(void *p) {
+    pcm_state *s = (pcm_state *)p;
+    kc_pcm_f32_to_s16(s->f, s->s16, BENCH_FRAME, 32767.0f, &s->dither);
+}
+static void  pcm_destroy(void *p) {
+    free(p);
+    kc_pcm_use_isa(kc_pcm_best_isa());
+}
+
+static const bench_kernel kKernels[] = {
+#if KC_HAVE_WDSP
+    { "xemnr", "WDSP EMNR, one 480-sample hop (fsize 1920, ovrlp 4)", BENCH_FRAME,
+      emnr_create, emnr_load, emnr_run, emnr_destroy },
+    { "xemnr_batch", "WDSP EMNR batched catch-up path, 8 hops per call", BENCH_FRAME * BENCH_EMNR_BATCH,
+      emnr_batch_create, emnr_load, emnr_batch_run, emnr_destroy },
+    { "xanr", "WDSP ANR (LMS), one 480-sample block", BENCH_FRAME,
+      anr_create, anr_load, anr_run, anr_destroy },
+    { "wdsp_pack_unpack", "wrapper float->IQ pack and IQ->float unpack, one block", BENCH_FRAME,
+      pack_create, pack_load, pack_run, pack_destroy },
+    { "wdsp_emnr_process", "whole wrapper call: lock, pack, xemnr, unpack", BENCH_FRAME,
+      wrapper_create, wrapper_load, wrapper_run, wrapper_destroy },
+#endif
+    { "rnnoise_process_frame", "RNNoise, one 480-sample frame", BENCH_FRAME,
+      rnnoise_bench_create, rnnoise_bench_load, rnnoise_bench_run, rnnoise_bench_destroy },
+    { "compute_rnn", "RNNoise GRU network, one frame of features", BENCH_FRAME,
+      rnn_create, rnn_load, rnn_run, rnn_destroy },
+    { "rnn_pitch_search", "RNNoise pitch search (960-sample frame, 768 max period)", BENCH_FRAME,
+      pitch_create, pitch_load, pitch_run, pitch_destroy },
+    { "rnn_fft", "RNNoise 960-point complex FFT", BENCH_FRAME,
+      fft_create, fft_load, fft_run, fft_destroy },
+    { "pcm_s16le_to_f32", "kc_pcm 16-bit LE to float, best path for this CPU", BENCH_FRAME,
+      pcm_create, pcm_load, pcm_decode_run, pcm_destroy },
+    { "pcm_s16le_to_f32_scalar", "kc_pcm 16-bit LE to float, scalar path", BENCH_FRAME,
+      pcm_scalar_create, pcm_load, pcm_decode_run, pcm_destroy },
+    { "pcm_f32_to_s16", "kc_pcm float to 16-bit with TPDF dither, best path", BENCH_FRAME,
+      pcm_create, pcm_load, pcm_encode_run, pcm_destroy },
+    { "pcm_f32_to_s16_scalar", "kc_pcm float to 16-bit with TPDF dither, scalar path", BENCH_FRAME,
+      pcm_scalar_create, pcm_load, pcm_encode_run, pcm_destroy },
+};
+#define KERNEL_COUNT ((int)(sizeof(kKernels) / sizeof(kKernels[0])))
+
+/* ---- Inputs ---- */
+
+typedef struct bench_input {
+    char   name[128];
+    float *x;               /* 48 kHz mono */
+    size_t n;
+} bench_input;
+
+static int make_synthetic(bench_input *in, double seconds) {
+    in->n = (size_t)(seconds * BENCH_RATE);
+    in->x = (float *)calloc(in->n, sizeof(float));
+    if (!in->x) return -1;
+    snprintf(in->name, sizeof(in->name), "synthetic");
+    kc_sig_voice(in->x, in->n, BENCH_RATE, 1, 0.3);
+    kc_sig_cw(in->x, in->n, BENCH_RATE, 700.0, 22.0, "CQ TEST DE K1ABC", 0.2);
+    kc_sig_fsk8(in->x, in->n, BENCH_RATE, 1500.0, 2, 0.1);
+    kc_sig_noise(in->x, in->n, 0.05, 3);
+    return 0;
+}
+
+static int load_recording(bench_input *in, const char *path, int rawRate) {
+    char err[256];
+    kc_audio_file f;
+    if (kc_audio_open(&f, path, rawRate, err, sizeof(err)) != 0) {
+        fprintf(stderr, "kc-bench: %s\n", err);
+        return -1;
+    }
+    float *mono = (float *)malloc(sizeof(float) * (f.frames ? f.frames : 1));
+    kc_resampler *rs = kc_resampler_create(f.sampleRate, BENCH_RATE);
+    if (!mono || !rs) {
+        fprintf(stderr, "kc-bench: %s: can't resample %d Hz\n", path, f.sampleRate);
+        free(mono);
+        kc_resampler_destroy(rs);
+        kc_audio_close(&f);
+        return -1;
+    }
+    kc_audio_read_mono(&f, 0, f.frames, mono);
+    in->n = kc_resample_length(rs, f.frames);
+    in->x = (float *)malloc(sizeof(float) * (in->n ? in->n : 1));
+    if (in->x) kc_resample(rs, mono, f.frames, in->x);
+    free(mono);
+    kc_resampler_destroy(rs);
+    kc_audio_close(&f);
+    if (!in->x) return -1;
+
+    const char *base = strrchr(path, '/');
+    snprintf(in->name, sizeof(in->name), "%s", base ? base + 1 : path);
+    return 0;
+}
+
+/* ---- Measurement ---- */
+
+typedef struct bench_result {
+    const bench_kernel *kernel;
+    const char *input;
+    int      calls;
+    double   nsPerFrame;        /* mean, per 480 samples */
+    double   rtf;               /* processing time / audio time */
+    double   p50, p99, max;     /* ns per call */
+    double   insnPerSample;     /* < 0: no counter */
+    long long allocs;           /* < 0: not counted */
+    long long allocBytes;
+} bench_result;
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int run_kernel(const bench_kernel *k, const bench_input *in, int warmup, int calls,
+                      kc_perf *perf, uint64_t *ns, bench_result *r) {
+    if (in->n < (size_t)k->samples) return -1;
+    void *s = k->create();
+    if (!s) return -1;
+
+    size_t pos = 0;
+    for (int i = 0; i < warmup; i++) {
+        k->load(s, in->x + pos);
+        k->run(s);
+        pos += k->samples;
+        if (pos + k->samples > in->n) pos = 0;
+    }
+
+#if BENCH_COUNTS_ALLOCS
+    atomic_store(&g_allocs, 0);
+    atomic_store(&g_allocBytes, 0);
+#endif
+    uint64_t insn = 0, total = 0;
+    for (int i = 0; i < calls; i++) {
+        k->load(s, in->x + pos);
+        pos += k->samples;
+        if (pos + k->samples > in->n) pos = 0;
+
+        kc_perf_start(perf);
+        counting(1);
+        uint64_t t0 = now_ns();
+        k->run(s);
+        uint64_t t1 = now_ns();
+        counting(0);
+        kc_perf_stop(perf);
+
+        insn += kc_perf_read(perf);
+        ns[i] = t1 - t0;
+        total += ns[i];
+    }
+    k->destroy(s);
+
+    qsort(ns, calls, sizeof(uint64_t), cmp_u64);
+    double mean = (double)total / calls;
+    r->kernel = k;
+    r->input = in->name;
+    r->calls = calls;
+    r->nsPerFrame = mean * BENCH_FRAME / k->samples;
+    r->rtf = mean / (1e9 * k->samples / BENCH_RATE);
+    r->p50 = (double)ns[calls / 2];
+    r->p99 = (double)ns[(size_t)((calls - 1) * 0.99)];
+    r->max = (double)ns[calls - 1];
+    r->insnPerSample = perf->fd >= 0 ? (double)insn / ((double)calls * k->samples) : -1.0;
+#if BENCH_COUNTS_ALLOCS
+    r->allocs = (long long)atomic_load(&g_allocs);
+    r->allocBytes = (long long)atomic_load(&g_allocBytes);
+#else
+    r->allocs = r->allocBytes = -1;
+#endif
+    return 0;
+}
+
+/* ---- Output ---- */
+
+static void json_string(FILE *f, const char *s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+        else if (c < 0x20) fprintf(f, "\\u%04x", c);
+        else fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+static void cpu_model(char *out, size_t size) {
+    snprintf(out, size, "unknown");
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (!f) return;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "model name", 10) == 0) {
+            char *v = strchr(line, ':');
+            if (v) {
+                v += strspn(v + 1, " \t") + 1;
+                v[strcspn(v, "\n")] = 0;
+                snprintf(out, size, "%s", v);
+            }
+            break;
+        }
+    }
+    fclose(f);
+}
+
+/* One result object per line, keys in a fixed order, so --baseline can read it back without
+ * a JSON parser. */
+static int write_json(const char *path, const char *label, int warmup, const bench_result *r, int count) {
+    FILE *f = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "kc-bench: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    char cpu[256];
+    cpu_model(cpu, sizeof(cpu));
+    fprintf(f, "{\n  \"tool\": \"kc-bench\",\n  \"format\": 1,\n  \"label\": ");
+    json_string(f, label);
+    fprintf(f, ",\n  \"rev\": ");
+    json_string(f, KC_GIT_REV);
+    fprintf(f, ",\n  \"cpu\": ");
+    json_string(f, cpu);
+    fprintf(f, ",\n  \"compiler\": ");
+    json_string(f, __VERSION__);
+    fprintf(f, ",\n  \"wdsp\": %s,\n  \"warmup_calls\": %d,\n  \"results\": [\n",
+            KC_HAVE_WDSP ? "true" : "false", warmup);
+    for (int i = 0; i < count; i++) {
+        fprintf(f, "    {\"kernel\": ");
+        json_string(f, r[i].kernel->name);
+        fprintf(f, ", \"input\": ");
+        json_string(f, r[i].input);
+        fprintf(f, ", \"samples_per_call\": %d, \"calls\": %d, \"ns_per_frame\": %.1f, \"rtf\": %.6f, "
+                   "\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"max_ns\": %.0f, ",
+                r[i].kernel->samples, r[i].calls, r[i].nsPerFrame, r[i].rtf, r[i].p50, r[i].p99, r[i].max);
+        if (r[i].insnPerSample >= 0.0) fprintf(f, "\"instructions_per_sample\": %.2f, ", r[i].insnPerSample);
+        else fprintf(f, "\"instructions_per_sample\": null, ");
+        if (r[i].allocs >= 0) fprintf(f, "\"allocations\": %lld, \"alloc_bytes\": %lld}", r[i].allocs, r[i].allocBytes);
+        else fprintf(f, "\"allocations\": null, \"alloc_bytes\": null}");
+        fprintf(f, "%s\n", i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    if (f != stdout) fclose(f);
+    return 0;
+}
+
+/* Copies the string value of "key": "..." in line into out; 0 on success. */
+static int json_field_str(const char *line, const char *key, char *out, size_t size) {
+    char pat[64];
+    snprintf(pat, sizeof(pat), "\"%s\": \"", key);
+    const char *p = strstr(line, pat);
+    if (!p) return -1;
+    p += strlen(pat);
+    size_t n = 0;
+    while (*p && *p != '"' && n + 1 < size) {
+        if (*p == '\\' && p[1]) p++;
+        out[n++] = *p++;
+    }
+    out[n] = 0;
+    return 0;
+}
+
+static int json_field_num(const char *line, const char *key, double *out) {
+    char pat[64];
+    snprintf(pat, sizeof(pat), "\"%s\": ", key);
+    const char *p = strstr(line, pat);
+    if (!p) return -1;
+    char *end;
+    *out = strtod(p + strlen(pat), &end);
+    return end == p + strlen(pat) ? -1 : 0;
+}
+
+/* Prints ns/frame against a previous --json file. Returns the number of kernels slower than
+ * maxRegressPct (never counts when maxRegressPct < 0), or -1 if the file can't be read. */
+static int compare_baseline(FILE *out, const char *path, const bench_result *r, int count, double maxRegressPct) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "kc-bench: %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    char label[128] = "", line[1024];
+    int regressions = 0;
+    fprintf(out, "\nvs %s", path);
+    while (fgets(line, sizeof(line), f)) {
+        if (!label[0] && json_field_str(line, "label", label, sizeof(label)) == 0) fprintf(out, " (%s)", label);
+        char kernel[64], input[128];
+        double base;
+        if (json_field_str(line, "kernel", kernel, sizeof(kernel)) != 0) continue;
+        if (json_field_str(line, "input", input, sizeof(input)) != 0) continue;
+        if (json_field_num(line, "ns_per_frame", &base) != 0 || base <= 0.0) continue;
+        for (int i = 0; i < count; i++) {
+            if (strcmp(r[i].kernel->name, kernel) != 0 || strcmp(r[i].input, input) != 0) continue;
+            double pct = 100.0 * (r[i].nsPerFrame - base) / base;
+            int bad = maxRegressPct >= 0.0 && pct > maxRegressPct;
+            if (bad) regressions++;
+            fprintf(out, "\n  %-22s %-18s %12.1f -> %12.1f ns/frame  %+6.1f%%%s",
+                   kernel, input, base, r[i].nsPerFrame, pct, bad ? "  REGRESSION" : "");
+        }
+    }
+    fprintf(out, "\n");
+    fclose(f);
+    return regressions;
+}
+
+static void print_table_header(FILE *out) {
+    fprintf(out, "%-22s %-18s %12s %10s %10s %10s %10s %9s %8s\n",
+           "kernel", "input", "ns/frame", "rtf", "p50 ns", "p99 ns", "max ns", "insn/smp", "allocs");
+}
+
+static void print_result(FILE *out, const bench_result *r) {
+    char insn[32], allocs[32];
+    if (r->insnPerSample >= 0.0) snprintf(insn, sizeof(insn), "%.1f", r->insnPerSample);
+    else snprintf(insn, sizeof(insn), "-");
+    if (r->allocs >= 0) snprintf(allocs, sizeof(allocs), "%lld", r->allocs);
+    else snprintf(allocs, sizeof(allocs), "-");
+    fprintf(out, "%-22s %-18.18s %12.1f %10.5f %10.0f %10.0f %10.0f %9s %8s\n",
+           r->kernel->name, r->input, r->nsPerFrame, r->rtf, r->p50, r->p99, r->max, insn, allocs);
+}
+
+/* ---- main ---- */
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-bench [options]\n"
+        "  -k, --kernel LIST     comma-separated kernels to run (default: all; see --list)\n"
+        "  -i, --input FILE      also run on a recording (WAV or raw s16le; repeatable)\n"
+        "      --raw-rate HZ     treat inputs as headerless s16le mono at HZ\n"
+        "      --no-synthetic    skip the built-in synthetic mix\n"
+        "      --seconds S       length of the synthetic mix (default: 20)\n"
+        "  -n, --calls N         timed calls per kernel and input (default: 3000)\n"
+        "  -w, --warmup N        untimed calls first (default: 300)\n"
+        "      --cpu N           pin to CPU N\n"
+        "      --json FILE       write results as JSON (\"-\" for stdout)\n"
+        "      --label TEXT      label stored in the JSON (default: git revision at configure time)\n"
+        "      --baseline FILE   compare ns/frame with an earlier --json file\n"
+        "      --max-regress PCT with --baseline: exit 1 if any kernel is more than PCT%% slower\n"
+        "      --list            list kernels and exit\n"
+        "  -h, --help\n"
+        "ns/frame is per 480 samples (10 ms at 48 kHz); rtf = processing time / audio time.\n");
+}
+
+static int kernel_selected(const char *list, const char *name) {
+    if (!list) return 1;
+    size_t len = strlen(name);
+    for (const char *p = list; *p;) {
+        const char *e = strchr(p, ',');
+        size_t n = e ? (size_t)(e - p) : strlen(p);
+        if (n == len && strncmp(p, name, n) == 0) return 1;
+        if (!e) break;
+        p = e + 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *kernels = NULL, *jsonPath = NULL, *baseline = NULL, *label = KC_GIT_REV;
+    const char *inputs[BENCH_MAX_INPUTS];
+    int inputCount = 0, rawRate = 0, synthetic = 1, calls = 3000, warmup = 300, cpu = -1;
+    double seconds = 20.0, maxRegress = -1.0;
+
+    enum { OPT_RAW_RATE = 256, OPT_NO_SYNTH, OPT_SECONDS, OPT_CPU, OPT_JSON, OPT_LABEL,
+           OPT_BASELINE, OPT_MAX_REGRESS, OPT_LIST };
+    static const struct option longOpts[] = {
+        { "kernel", required_argument, NULL, 'k' },
+        { "input", required_argument, NULL, 'i' },
+        { "raw-rate", required_argument, NULL, OPT_RAW_RATE },
+        { "no-synthetic", no_argument, NULL, OPT_NO_SYNTH },
+        { "seconds", required_argument, NULL, OPT_SECONDS },
+        { "calls", required_argument, NULL, 'n' },
+        { "warmup", required_argument, NULL, 'w' },
+        { "cpu", required_argument, NULL, OPT_CPU },
+        { "json", required_argument, NULL, OPT_JSON },
+        { "label", required_argument, NULL, OPT_LABEL },
+        { "baseline", required_argument, NULL, OPT_BASELINE },
+        { "max-regress", required_argument, NULL, OPT_MAX_REGRESS },
+        { "list", no_argument, NULL, OPT_LIST },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "k:i:n:w:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'k': kernels = optarg; break;
+        case 'i':
+            if (inputCount == BENCH_MAX_INPUTS) { fprintf(stderr, "kc-bench: too many inputs\n"); return 2; }
+            inputs[inputCount++] = optarg;
+            break;
+        case OPT_RAW_RATE: rawRate = atoi(optarg); break;
+        case OPT_NO_SYNTH: synthetic = 0; break;
+        case OPT_SECONDS: seconds = atof(optarg); break;
+        case 'n': calls = atoi(optarg); break;
+        case 'w': warmup = atoi(optarg); break;
+        case OPT_CPU: cpu = atoi(optarg); break;
+        case OPT_JSON: jsonPath = optarg; break;
+        case OPT_LABEL: label = optarg; break;
+        case OPT_BASELINE: baseline = optarg; break;
+        case OPT_MAX_REGRESS: maxRegress = atof(optarg); break;
+        case OPT_LIST:
+            for (int k = 0; k < KERNEL_COUNT; k++) printf("%-22s %s\n", kKernels[k].name, kKernels[k].what);
+            return 0;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    if (calls < 1 || warmup < 0 || seconds <= 0.0) { usage(stderr); return 2; }
+    if (kernels) {
+        for (const char *p = kernels; *p;) {
+            const char *e = strchr(p, ',');
+            size_t n = e ? (size_t)(e - p) : strlen(p);
+            int found = 0;
+            for (int k = 0; k < KERNEL_COUNT; k++)
+                if (strlen(kKernels[k].name) == n && strncmp(p, kKernels[k].name, n) == 0) found = 1;
+            if (!found) {
+                fprintf(stderr, "kc-bench: unknown kernel '%.*s'%s\n", (int)n, p,
+                        KC_HAVE_WDSP ? "" : " (WDSP kernels need FFTW at build time)");
+                return 2;
+            }
+            if (!e) break;
+            p = e + 1;
+        }
+    }
+
+#ifdef __linux__
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0)
+            fprintf(stderr, "kc-bench: can't pin to CPU %d: %s\n", cpu, strerror(errno));
+    }
+#else
+    (void)cpu;
+#endif
+
+    bench_input in[BENCH_MAX_INPUTS + 1];
+    int nin = 0;
+    if (synthetic && make_synthetic(&in[nin], seconds) == 0) nin++;
+    for (int i = 0; i < inputCount; i++)
+        if (load_recording(&in[nin], inputs[i], rawRate) == 0) nin++;
+    if (nin == 0) { fprintf(stderr, "kc-bench: no input\n"); return 1; }
+
+    kc_perf perf;
+    if (kc_perf_open(&perf) != 0)
+        fprintf(stderr, "kc-bench: no instruction counter here (perf_event); insn/smp not reported\n");
+#if !BENCH_COUNTS_ALLOCS
+    fprintf(stderr, "kc-bench: allocation counting needs glibc; allocs not reported\n");
+#endif
+
+    uint64_t *ns = (uint64_t *)malloc(sizeof(uint64_t) * calls);
+    bench_result *results = (bench_result *)calloc((size_t)KERNEL_COUNT * nin, sizeof(bench_result));
+    if (!ns || !results) return 1;
+    int count = 0;
+
+    /* With --json -, stdout carries the JSON and the table goes to stderr. */
+    FILE *out = jsonPath && strcmp(jsonPath, "-") == 0 ? stderr : stdout;
+    print_table_header(out);
+    for (int k = 0; k < KERNEL_COUNT; k++) {
+        if (!kernel_selected(kernels, kKernels[k].name)) continue;
+        for (int i = 0; i < nin; i++) {
+            if (run_kernel(&kKernels[k], &in[i], warmup, calls, &perf, ns, &results[count]) != 0) {
+                fprintf(stderr, "kc-bench: %s on %s: input too short or setup failed\n", kKernels[k].name, in[i].name);
+                continue;
+            }
+            print_result(out, &results[count++]);
+            fflush(out);
+        }
+    }
+    kc_perf_close(&perf);
+
+    int status = 0;
+    if (jsonPath && write_json(jsonPath, label, warmup, results, count) != 0) status = 1;
+    if (baseline) {
+        int regressions = compare_baseline(out, baseline, results, count, maxRegress);
+        if (regressions < 0) status = 1;
+        else if (regressions > 0) {
+            fprintf(stderr, "kc-bench: %d kernel(s) regressed more than %.1f%%\n", regressions, maxRegress);
+            status = 1;
+        }
+    }
+
+    for (int i = 0; i < nin; i++) free(in[i].x);
+    free(results);
+    free(ns);
+    return status;
+}
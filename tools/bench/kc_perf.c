@@ -0,0 +1,57 @@
+/*  kc_perf.c
+ *
+ *  See kc_perf.h.
+ */
+
+#include "kc_perf.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int kc_perf_open(kc_perf *p) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    p->fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    return p->fd >= 0 ? 0 : -1;
+}
+
+void kc_perf_close(kc_perf *p) {
+    if (p->fd >= 0) close(p->fd);
+    p->fd = -1;
+}
+
+void kc_perf_start(kc_perf *p) {
+    if (p->fd < 0) return;
+    ioctl(p->fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(p->fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+void kc_perf_stop(kc_perf *p) {
+    if (p->fd >= 0) ioctl(p->fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+uint64_t kc_perf_read(const kc_perf *p) {
+    uint64_t v = 0;
+    if (p->fd < 0 || read(p->fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) return 0;
+    return v;
+}
+
+#else
+
+int      kc_perf_open(kc_perf *p) { p->fd = -1; return -1; }
+void     kc_perf_close(kc_perf *p) { p->fd = -1; }
+void     kc_perf_start(kc_perf *p) { (void)p; }
+void     kc_perf_stop(kc_perf *p) { (void)p; }
+uint64_t kc_perf_read(const kc_perf *p) { (void)p; return 0; }
+
+#endif
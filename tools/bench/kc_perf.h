@@ -0,0 +1,24 @@
+/*  kc_perf.h
+ *
+ *  User-space retired-instruction counter for the benchmarks (Linux
+ *  perf_event_open). Unavailable elsewhere, or when perf_event_paranoid / the
+ *  container forbids it — callers then report instructions as unknown.
+ */
+
+#pragma once
+#include <stdint.h>
+
+typedef struct kc_perf {
+    int fd;     /* -1: no counter */
+} kc_perf;
+
+/* Returns 0 if a counter is available for the calling thread, -1 otherwise (p->fd = -1). */
+int      kc_perf_open(kc_perf *p);
+void     kc_perf_close(kc_perf *p);
+
+/* Reset + enable / disable. No-ops without a counter. */
+void     kc_perf_start(kc_perf *p);
+void     kc_perf_stop(kc_perf *p);
+
+/* Instructions counted between the last start/stop pair (0 without a counter). */
+uint64_t kc_perf_read(const kc_perf *p);
@@ -0,0 +1,1102 @@
+/*  kc_catbench.c
+ *
+ *  Benchmarks the CAT receive path on synthetic auto-information traffic.
+ *
+ *  framer: builds a stream like the one the radio pushes with AI on
+ *  (frequency steps while tuning, meter readings, the odd mode or filter
+ *  change, bandscope and audio-scope frames, optionally CR/LF after each
+ *  frame), cuts it into reads the way the control socket delivers it, and
+ *  frames it two ways:
+ *
+ *    kc_cat_framer   what TS890Connection uses.
+ *    naive           a C rendering of the old flushFrames: append each
+ *                    read to one buffer, copy every frame out, shift the
+ *                    rest down, validate it as UTF-8 and copy it twice
+ *                    more on the way to a trimmed, ';'-terminated string.
+ *
+ *  Both run over "reads" (random sizes up to --chunk) and "burst" (a whole
+ *  second of traffic in one read, as after a stall), and must produce the
+ *  same frames. Reports time per frame, throughput and how many times
+ *  faster than real time each is.
+ *
+ *  codec: decodes the same traffic with kc_cat_decode and encodes every
+ *  command in the spec with kc_cat_encode, and reports the time per frame,
+ *  per command. --max-ns makes it a gate: exit 1 if the average decode of
+ *  the non-scope frames takes longer.
+ *
+ *  fuzz: checks the codec against the spec it is built from. Random values
+ *  for every command's fields must survive encode and decode unchanged;
+ *  frames mutated from those (bytes flipped, cut short, spliced, spaces
+ *  and junk inserted) and random bytes must decode without reading outside
+ *  the frame or breaking kc_cat_msg's invariants. Each frame sits in its
+ *  own exactly-sized allocation, so a build with -fsanitize=address
+ *  catches any overread.
+ *
+ *  sched: the send side. A simulated session (a knob sweep of FA sets at
+ *  --tune per second, AF gain set-and-read pairs from a slider, keepalive
+ *  reads and a PTT press) is sent to a simulated radio that takes
+ *  --radio-us to handle each command and answers reads. It runs twice on a
+ *  virtual clock: one write per command, as TS890Connection used to send,
+ *  and through kc_cat_sched. Reported: writes and commands the radio had to
+ *  handle, its busy time, how long a tuning value took to take effect and
+ *  how long PTT took, and the scheduler's round trips. Then a set followed by
+ *  a query the radio refuses with "?;" checks that the refusal is put down
+ *  to the query; a wrong answer exits 1.
+ *
+ *  store: the receive side's last step. The traffic is applied to a
+ *  kc_rig_store by a writer thread at its real rate while the main thread
+ *  polls at 30 Hz, as RadioState's display tick does, and another thread
+ *  polls flat out. Reported: the cost of an apply and a poll, and how many
+ *  main-thread publications and field assignments the frames turned into.
+ *  Then a writer loads values that are all equal while readers check every
+ *  copy they get for a mix of two writes; any torn read exits 1.
+ *
+ *  Usage: kc-catbench framer|codec|fuzz|sched|store [options]   (kc-catbench --help)
+ */
+
+#include "kc_cat_codec.h"
+#include "kc_cat_framer.h"
+#include "kc_cat_sched.h"
+#include "kc_rig_state.h"
+#include "kc_signal.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t fnv1a(uint64_t h, const void *p, size_t n) {
+    const uint8_t *b = p;
+    for (size_t i = 0; i < n; i++) h = (h ^ b[i]) * 0x100000001b3ull;
+    return h;
+}
+
+#define FNV_OFFSET 0xcbf29ce484222325ull
+
+/* ---- Traffic ---- */
+
+typedef struct traffic_opts {
+    double seconds;
+    double tuneRate;                    /* FA steps per second */
+    double meterRate;                   /* SM readings per second */
+    double otherRate;                   /* assorted state changes per second */
+    double scopeRate;                   /* ##DD2 and ##DD3 frames per second, each */
+    int    crlf;
+    int    chunk;                       /* largest read */
+    uint64_t seed;
+} traffic_opts;
+
+typedef struct buf {
+    char  *p;
+    size_t n, cap;
+} buf;
+
+static void buf_put(buf *b, const char *p, size_t n) {
+    if (b->n + n > b->cap) {
+        size_t cap = b->cap ? b->cap : 1 << 16;
+        while (cap < b->n + n) cap *= 2;
+        char *q = realloc(b->p, cap);
+        if (!q) {
+            fprintf(stderr, "kc-catbench: out of memory\n");
+            exit(1);
+        }
+        b->p = q;
+        b->cap = cap;
+    }
+    memcpy(b->p + b->n, p, n);
+    b->n += n;
+}
+
+static void put_frame(buf *b, const traffic_opts *o, const char *f) {
+    buf_put(b, f, strlen(f));
+    if (o->crlf) buf_put(b, "\r\n", 2);
+}
+
+static void put_scope(buf *b, const traffic_opts *o, kc_rng *rng, const char *head, int points) {
+    static const char hex[] = "0123456789ABCDEF";
+    char f[2 * 1024 + 16];
+    size_t n = strlen(head);
+    memcpy(f, head, n);
+    for (int i = 0; i < points; i++) {
+        unsigned v = (unsigned)(kc_rng_next(rng) >> 56) & 0x7f;
+        f[n++] = hex[v >> 4];
+        f[n++] = hex[v & 15];
+    }
+    f[n++] = ';';
+    f[n] = 0;
+    put_frame(b, o, f);
+}
+
+/* Frames for `seconds` of radio time, in time order, as one byte string. Returns the frame count. */
+static size_t make_traffic(const traffic_opts *o, buf *out) {
+    static const char *other[] = {
+        "MD2;", "MD1;", "OM02;", "OM01;", "SH0005;", "SL004;", "RG200;", "AG120;", "NR1;", "NR0;",
+        "PC050;", "SQ000;", "RT1;", "RT0;", "RF00050;", "IS+0300;", "BY10;", "TX0;", "RX;", "FR0;",
+    };
+    kc_rng rng;
+    kc_rng_seed(&rng, o->seed);
+    double next[5] = { 0 };
+    const double rate[5] = { o->tuneRate, o->meterRate, o->otherRate, o->scopeRate, o->scopeRate };
+    long long fa = 14074000;
+    size_t frames = 0;
+    char f[32];
+    for (;;) {
+        int k = -1;
+        for (int i = 0; i < 5; i++)
+            if (rate[i] > 0.0 && (k < 0 || next[i] < next[k])) k = i;
+        if (k < 0 || next[k] >= o->seconds) break;
+        next[k] += 1.0 / rate[k];
+        switch (k) {
+        case 0:
+            fa += 10;
+            snprintf(f, sizeof f, "FA%011lld;", fa);
+            put_frame(out, o, f);
+            break;
+        case 1:
+            snprintf(f, sizeof f, "SM%04d;", (int)(kc_rng_uniform(&rng) * 70.0));
+            put_frame(out, o, f);
+            break;
+        case 2:
+            put_frame(out, o, other[kc_rng_next(&rng) % (sizeof other / sizeof other[0])]);
+            break;
+        case 3: put_scope(out, o, &rng, "##DD2", 640); break;
+        case 4: put_scope(out, o, &rng, "##DD3", 213); break;
+        }
+        frames++;
+    }
+    return frames;
+}
+
+/* ---- The old flushFrames, in C ---- */
+
+typedef struct naive {
+    buf buffer;
+} naive;
+
+static int valid_utf8(const uint8_t *p, size_t n) {
+    for (size_t i = 0; i < n;) {
+        uint8_t c = p[i];
+        size_t len = c < 0x80 ? 1 : (c >> 5) == 6 ? 2 : (c >> 4) == 14 ? 3 : (c >> 3) == 30 ? 4 : 0;
+        if (len == 0 || i + len > n) return 0;
+        for (size_t k = 1; k < len; k++)
+            if ((p[i + k] & 0xc0) != 0x80) return 0;
+        i += len;
+    }
+    return 1;
+}
+
+typedef void (*frame_fn)(void *ctx, const char *p, size_t n);
+
+static void naive_feed(naive *s, const char *data, size_t n, frame_fn fn, void *ctx) {
+    buf_put(&s->buffer, data, n);
+    for (;;) {
+        char *semi = memchr(s->buffer.p, ';', s->buffer.n);           /* firstRange(of:) */
+        if (!semi) return;
+        size_t len = (size_t)(semi - s->buffer.p);
+        char *frame = malloc(len + 1);                                 /* subdata */
+        memcpy(frame, s->buffer.p, len);
+        memmove(s->buffer.p, semi + 1, s->buffer.n - len - 1);         /* removeSubrange */
+        s->buffer.n -= len + 1;
+        char *decoded = malloc(len + 1);                               /* String(data:encoding:) */
+        int ok = valid_utf8((const uint8_t *)frame, len);
+        memcpy(decoded, frame, len);
+        if (!ok) memcpy(decoded, frame, len);                          /* the Latin-1 retry */
+        size_t a = 0, b = len;                                         /* trimmingCharacters */
+        while (a < b && ((unsigned char)decoded[a] <= 0x20 || decoded[a] == 0x7f)) a++;
+        while (b > a && ((unsigned char)decoded[b - 1] <= 0x20 || decoded[b - 1] == 0x7f)) b--;
+        if (b > a) {
+            char *full = malloc(b - a + 2);                            /* cleaned + ";" */
+            memcpy(full, decoded + a, b - a);
+            full[b - a] = ';';
+            fn(ctx, full, b - a);
+            free(full);
+        }
+        free(decoded);
+        free(frame);
+    }
+}
+
+/* ---- Runs ---- */
+
+typedef struct sink {
+    uint64_t hash;
+    size_t   frames;
+} sink;
+
+static void on_frame(void *ctx, const char *p, size_t n) {
+    sink *s = ctx;
+    s->hash = fnv1a(s->hash, p, n);
+    s->hash = fnv1a(s->hash, ";", 1);
+    s->frames++;
+}
+
+typedef struct run_result {
+    uint64_t ns, hash;
+    size_t   frames;
+    kc_cat_framer_stats stats;
+} run_result;
+
+/* Read sizes are drawn once per scenario so both framers see the same reads. */
+static size_t *make_reads(size_t bytes, int chunk, uint64_t seed, size_t *count) {
+    kc_rng rng;
+    kc_rng_seed(&rng, seed);
+    size_t cap = bytes + 1, n = 0, at = 0;
+    size_t *v = malloc(cap * sizeof *v);
+    while (v && at < bytes) {
+        size_t len = 1 + (size_t)(kc_rng_uniform(&rng) * chunk);
+        if (len > bytes - at) len = bytes - at;
+        v[n++] = len;
+        at += len;
+    }
+    *count = n;
+    return v;
+}
+
+static run_result run_framer(const buf *t, const size_t *reads, size_t nReads, int iterations) {
+    run_result r = { 0 };
+    kc_cat_framer *f = kc_cat_framer_create(64 * 1024);
+    sink s = { FNV_OFFSET, 0 };
+    kc_cat_frame frame;
+    uint64_t start = now_ns();
+    for (int it = 0; it < iterations; it++) {
+        size_t at = 0;
+        s.hash = FNV_OFFSET;
+        s.frames = 0;
+        for (size_t i = 0; i < nReads; i++) {
+            kc_cat_framer_feed(f, t->p + at, reads[i]);
+            while (kc_cat_framer_next(f, &frame)) on_frame(&s, frame.data, frame.length);
+            at += reads[i];
+        }
+    }
+    r.ns = now_ns() - start;
+    r.hash = s.hash;
+    r.frames = s.frames;
+    kc_cat_framer_read_stats(f, &r.stats);
+    kc_cat_framer_destroy(f);
+    return r;
+}
+
+static run_result run_naive(const buf *t, const size_t *reads, size_t nReads, int iterations) {
+    run_result r = { 0 };
+    naive n = { { 0 } };
+    sink s = { FNV_OFFSET, 0 };
+    uint64_t start = now_ns();
+    for (int it = 0; it < iterations; it++) {
+        size_t at = 0;
+        s.hash = FNV_OFFSET;
+        s.frames = 0;
+        n.buffer.n = 0;
+        for (size_t i = 0; i < nReads; i++) {
+            naive_feed(&n, t->p + at, reads[i], on_frame, &s);
+            at += reads[i];
+        }
+    }
+    r.ns = now_ns() - start;
+    r.hash = s.hash;
+    r.frames = s.frames;
+    free(n.buffer.p);
+    return r;
+}
+
+static void print_result(const char *scenario, const char *name, const run_result *r, int iterations,
+                         size_t bytes, double seconds) {
+    double ns = (double)r->ns / iterations;
+    printf("  %-7s %-14s %8.1f ns/frame  %8.1f MB/s  %9.0fx real time\n", scenario, name,
+           ns / (double)r->frames, (double)bytes / ns * 1e3, seconds * 1e9 / ns);
+}
+
+static int bench_framer(const traffic_opts *o, int iterations) {
+    buf t = { 0 };
+    size_t frames = make_traffic(o, &t);
+    if (frames == 0) {
+        fprintf(stderr, "kc-catbench: no traffic; raise the rates or --seconds\n");
+        return 2;
+    }
+    printf("%.0f s of AI traffic: %zu frames (%.0f/s), %.2f MB (%.0f kB/s)%s\n", o->seconds, frames,
+           (double)frames / o->seconds, t.n / 1e6, t.n / 1e3 / o->seconds, o->crlf ? ", CR/LF after each" : "");
+
+    int failed = 0;
+    for (int scenario = 0; scenario < 2; scenario++) {
+        size_t nReads = 0, *reads;
+        if (scenario == 0) {
+            reads = make_reads(t.n, o->chunk, o->seed + 1, &nReads);
+        } else {
+            /* One read per second of traffic, cut at the byte, not the frame. */
+            size_t per = (size_t)((double)t.n / o->seconds);
+            if (per == 0) per = 1;
+            nReads = (t.n + per - 1) / per;
+            reads = malloc(nReads * sizeof *reads);
+            for (size_t i = 0; reads && i < nReads; i++) reads[i] = i + 1 < nReads ? per : t.n - per * i;
+        }
+        if (!reads) {
+            fprintf(stderr, "kc-catbench: out of memory\n");
+            return 1;
+        }
+        const char *name = scenario == 0 ? "reads" : "burst";
+        run_result a = run_framer(&t, reads, nReads, iterations);
+        run_result b = run_naive(&t, reads, nReads, iterations);
+        printf("%s: %zu reads, %llu frames split across reads\n", name, nReads, (unsigned long long)(a.stats.split / (uint64_t)iterations));
+        print_result(name, "kc_cat_framer", &a, iterations, t.n, o->seconds);
+        print_result(name, "naive", &b, iterations, t.n, o->seconds);
+        if (a.frames != frames || b.frames != frames || a.hash != b.hash) {
+            fprintf(stderr, "kc-catbench: %s: framers disagree (%zu and %zu frames of %zu, hashes %016llx %016llx)\n",
+                    name, a.frames, b.frames, frames, (unsigned long long)a.hash, (unsigned long long)b.hash);
+            failed = 1;
+        }
+        free(reads);
+    }
+    free(t.p);
+    return failed;
+}
+
+/* ---- Codec ---- */
+
+typedef struct spec_entry {
+    kc_cat_cmd  cmd;
+    const char *layout;
+    int         decodes;                /* CMD or EXT: encode then decode gives the values back */
+} spec_entry;
+
+#define SPEC_CMD(id, c0, c1, layout)    { KC_CAT_##id, layout, 1 },
+#define SPEC_SET(id, prefix, layout)    { KC_CAT_##id, layout, 0 },
+
+static const spec_entry kSpec[] = { KC_CAT_SPEC(SPEC_CMD, SPEC_CMD, SPEC_SET) };
+#define SPEC_COUNT ((int)(sizeof kSpec / sizeof kSpec[0]))
+
+/* The fields of a layout, as letter and width pairs. Returns the count. */
+static int layout_fields(const char *l, char *kinds, int *widths) {
+    int n = 0;
+    while (*l && n < KC_CAT_MAX_FIELDS) {
+        if (*l == ' ') {
+            l++;
+            continue;
+        }
+        kinds[n] = *l++;
+        int w = 0;
+        while (*l >= '0' && *l <= '9') w = w * 10 + (*l++ - '0');
+        widths[n++] = w;
+    }
+    return n;
+}
+
+static int64_t pow10_of(int n) {
+    int64_t p = 1;
+    while (n-- > 0) p *= 10;
+    return p;
+}
+
+/* A random value that fits the field. */
+static int64_t random_field(kc_rng *rng, char kind, int width) {
+    uint64_t r = kc_rng_next(rng);
+    switch (kind) {
+    case 'D': return (int64_t)(r % 10);
+    case 'H': return (int64_t)(r % 16);
+    case 'U': return (int64_t)(r % (uint64_t)pow10_of(width));
+    case 'S': {
+        int64_t v = (int64_t)(r % (uint64_t)pow10_of(width));
+        return (r >> 62) & 1 ? -v : v;
+    }
+    case 'V': return (int64_t)(r % 2000000) - 1000000;
+    default: return 0;
+    }
+}
+
+/* Decodes a copy of the frame in its own exactly-sized allocation, for the sanitizer to watch,
+ * and checks the result. Returns -1 if it breaks an invariant. */
+static int decode_exact(const char *frame, size_t n, kc_cat_msg *m) {
+    char *copy = malloc(n ? n : 1);
+    if (!copy) return -1;
+    memcpy(copy, frame, n);
+    int r = kc_cat_decode(copy, n, m);
+    int bad = m->count < 0 || m->count > KC_CAT_MAX_FIELDS || m->rest < 0 || (size_t)m->rest > n ||
+              (m->count < 32 && (m->valid >> m->count) != 0) || (r == 0) != (m->cmd == KC_CAT_UNKNOWN) ||
+              (m->text && (m->text < copy || m->textLength < 0 || m->text + m->textLength > copy + n));
+    if (m->text) m->text = frame + (m->text - copy);     /* the caller's frame has the same bytes */
+    free(copy);
+    return bad ? -1 : r;
+}
+
+static void print_frame(FILE *to, const char *f, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)f[i];
+        if (c >= 0x20 && c < 0x7f) fputc(c, to);
+        else fprintf(to, "\\x%02x", c);
+    }
+}
+
+static int fuzz_codec(long iterations, uint64_t seed) {
+    kc_rng rng;
+    kc_rng_seed(&rng, seed);
+    long roundTrips = 0, mutated = 0, randomFrames = 0, failures = 0;
+    char text[16], frame[128];
+    for (long it = 0; it < iterations && failures < 10; it++) {
+        const spec_entry *e = &kSpec[kc_rng_next(&rng) % SPEC_COUNT];
+        char kinds[KC_CAT_MAX_FIELDS];
+        int widths[KC_CAT_MAX_FIELDS];
+        int nf = layout_fields(e->layout, kinds, widths);
+        int64_t v[KC_CAT_MAX_FIELDS] = { 0 };
+        size_t textLength = 0;
+        for (int i = 0; i < nf; i++) {
+            v[i] = random_field(&rng, kinds[i], widths[i]);
+            if (kinds[i] == 'R') {
+                textLength = kc_rng_next(&rng) % ((size_t)widths[i] + 1);
+                for (size_t k = 0; k < textLength; k++) text[k] = (char)('A' + kc_rng_next(&rng) % 26);
+            }
+        }
+        int count = (int)(kc_rng_next(&rng) % (uint64_t)(nf + 1));
+        if (kc_rng_uniform(&rng) < 0.5) count = nf;
+        size_t n = kc_cat_encode(frame, sizeof frame, e->cmd, v, count, text, textLength);
+        if (n == 0) {
+            fprintf(stderr, "kc-catbench: %s: encode failed for %d fields\n", kc_cat_name(e->cmd), count);
+            failures++;
+            continue;
+        }
+
+        kc_cat_msg m;
+        int r = decode_exact(frame, n, &m);
+        if (e->decodes) {
+            int ok = r == 1 && m.cmd == e->cmd && m.count == count && m.rest == 0 &&
+                     m.valid == (count ? (1u << count) - 1 : 0);
+            for (int i = 0; ok && i < count; i++) {
+                if (kinds[i] == 'R') {
+                    ok = (size_t)m.textLength == textLength && !memcmp(m.text, text, textLength);
+                } else {
+                    ok = m.v[i] == v[i];
+                }
+            }
+            if (!ok) {
+                fprintf(stderr, "kc-catbench: round trip failed: ");
+                print_frame(stderr, frame, n);
+                fputc('\n', stderr);
+                failures++;
+            }
+            roundTrips++;
+        } else if (r < 0) {
+            failures++;
+        }
+
+        /* Mutations of the valid frame. */
+        size_t len = n;
+        int edits = 1 + (int)(kc_rng_next(&rng) % 4);
+        for (int k = 0; k < edits; k++) {
+            size_t at = len ? kc_rng_next(&rng) % len : 0;
+            switch (kc_rng_next(&rng) % 6) {
+            case 0: if (len) frame[at] = (char)kc_rng_next(&rng); break;
+            case 1: len = at; break;
+            case 2: if (len) frame[at] = ' '; break;
+            case 3: if (len) frame[at] = "+-;#0 9"[kc_rng_next(&rng) % 7]; break;
+            case 4:
+                if (len < sizeof frame) {
+                    memmove(frame + at + 1, frame + at, len - at);
+                    frame[at] = (char)kc_rng_next(&rng);
+                    len++;
+                }
+                break;
+            case 5:
+                if (len) {
+                    memmove(frame + at, frame + at + 1, len - at - 1);
+                    len--;
+                }
+                break;
+            }
+        }
+        if (decode_exact(frame, len, &m) < 0) {
+            fprintf(stderr, "kc-catbench: bad decode of mutated frame: ");
+            print_frame(stderr, frame, len);
+            fputc('\n', stderr);
+            failures++;
+        }
+        mutated++;
+
+        len = kc_rng_next(&rng) % 24;
+        for (size_t k = 0; k < len; k++) frame[k] = (char)kc_rng_next(&rng);
+        if (len >= 2 && kc_rng_uniform(&rng) < 0.5) {
+            frame[0] = (char)('A' + kc_rng_next(&rng) % 26);
+            frame[1] = (char)('A' + kc_rng_next(&rng) % 26);
+        }
+        if (decode_exact(frame, len, &m) < 0) {
+            fprintf(stderr, "kc-catbench: bad decode of random frame: ");
+            print_frame(stderr, frame, len);
+            fputc('\n', stderr);
+            failures++;
+        }
+        randomFrames++;
+    }
+    printf("fuzz: %ld round trips, %ld mutated frames, %ld random frames, %ld failures\n", roundTrips, mutated,
+           randomFrames, failures);
+    return failures ? 1 : 0;
+}
+
+typedef struct frame_ref {
+    const char *p;
+    size_t      n;
+} frame_ref;
+
+static int bench_codec(const traffic_opts *o, int iterations, double maxNs) {
+    buf t = { 0 };
+    size_t total = make_traffic(o, &t);
+    frame_ref *frames = malloc(total * sizeof *frames);
+    kc_cat_framer *f = kc_cat_framer_create(64 * 1024);
+    if (!frames || !f) {
+        fprintf(stderr, "kc-catbench: out of memory\n");
+        return 1;
+    }
+    size_t n = 0;
+    kc_cat_frame fr;
+    kc_cat_framer_feed(f, t.p, t.n);
+    while (kc_cat_framer_next(f, &fr) && n < total) frames[n++] = (frame_ref){ fr.data, fr.length };
+
+    /* Per command: frames, time. Scope frames are decoded too (as unknown) but timed apart. */
+    uint64_t ns[KC_CAT_COMMAND_COUNT] = { 0 }, hits[KC_CAT_COMMAND_COUNT] = { 0 };
+    uint64_t scopeNs = 0, scopeHits = 0, sink = 0;
+    kc_cat_msg m;
+    for (int it = 0; it < iterations; it++) {
+        for (size_t i = 0; i < n; i++) {
+            uint64_t start = now_ns();
+            kc_cat_decode(frames[i].p, frames[i].n, &m);
+            uint64_t d = now_ns() - start;
+            sink += (uint64_t)m.v[0];
+            if (frames[i].n > 2 && frames[i].p[0] == '#' && frames[i].p[2] == 'D') {
+                scopeNs += d;
+                scopeHits++;
+            } else {
+                ns[m.cmd] += d;
+                hits[m.cmd]++;
+            }
+        }
+    }
+    /* Whole-corpus timing without the per-frame clock reads. */
+    uint64_t start = now_ns();
+    for (int it = 0; it < iterations; it++)
+        for (size_t i = 0; i < n; i++) {
+            kc_cat_decode(frames[i].p, frames[i].n, &m);
+            sink += (uint64_t)m.count;
+        }
+    double batchNs = (double)(now_ns() - start) / ((double)n * iterations);
+
+    uint64_t plainNs = 0, plainHits = 0;
+    for (int c = 0; c < KC_CAT_COMMAND_COUNT; c++) {
+        plainNs += ns[c];
+        plainHits += hits[c];
+    }
+    printf("decode: %zu frames x %d, %.1f ns/frame over all of them\n", n, iterations, batchNs);
+    printf("  per frame, clock read included:\n");
+    for (int c = 0; c < KC_CAT_COMMAND_COUNT; c++)
+        if (hits[c])
+            printf("    %-8s %8llu frames  %6.1f ns\n", c ? kc_cat_name((kc_cat_cmd)c) : "unknown",
+                   (unsigned long long)hits[c], (double)ns[c] / hits[c]);
+    if (scopeHits)
+        printf("    %-8s %8llu frames  %6.1f ns\n", "##DD", (unsigned long long)scopeHits, (double)scopeNs / scopeHits);
+
+    /* The timer's own cost, to read the per-command figures against. */
+    start = now_ns();
+    for (int i = 0; i < 100000; i++) sink += now_ns();
+    double clockNs = (double)(now_ns() - start) / 100000;
+    printf("  (a clock read costs %.1f ns)\n", clockNs);
+
+    printf("encode:\n");
+    char out[64];
+    for (int s = 0; s < SPEC_COUNT; s++) {
+        char kinds[KC_CAT_MAX_FIELDS];
+        int widths[KC_CAT_MAX_FIELDS];
+        int nf = layout_fields(kSpec[s].layout, kinds, widths);
+        int64_t v[KC_CAT_MAX_FIELDS] = { 0 };
+        for (int i = 0; i < nf; i++) v[i] = kinds[i] == 'H' ? 2 : 1;
+        int reps = 200000;
+        start = now_ns();
+        for (int i = 0; i < reps; i++) sink += kc_cat_encode(out, sizeof out, kSpec[s].cmd, v, nf, "NAME", 4);
+        double e = (double)(now_ns() - start) / reps;
+        size_t len = kc_cat_encode(out, sizeof out, kSpec[s].cmd, v, nf, "NAME", 4);
+        printf("    %-20.*s %6.1f ns\n", (int)len, out, e);
+    }
+    if (sink == 42) printf(" ");           /* keep the loops */
+
+    kc_cat_framer_destroy(f);
+    free(frames);
+    free(t.p);
+    double plain = plainHits ? (double)(plainNs / plainHits) - clockNs : 0.0;
+    if (maxNs > 0.0 && plain > maxNs) {
+        fprintf(stderr, "kc-catbench: decode takes %.1f ns per frame, over --max-ns %.1f\n", plain, maxNs);
+        return 1;
+    }
+    return 0;
+}
+
+/* ---- Scheduler ---- */
+
+#define SIM_STEP_NS 100000ull           /* 0.1 ms */
+#define SIM_NET_NS  500000ull           /* one way, LAN */
+#define SIM_FIFO    65536
+
+typedef struct sim_cmd {
+    uint64_t arriveNs;
+    uint64_t submitNs;                  /* when the app sent it (the newest value it stands for) */
+    char     text[32];
+    uint8_t  length;
+} sim_cmd;
+
+typedef struct sim_answer {
+    uint64_t atNs;
+    char     text[32];
+    uint8_t  length;
+} sim_answer;
+
+typedef struct sim_result {
+    uint64_t submitted, writes, handled;
+    uint64_t busyNs;
+    uint64_t tuneLagSumNs, tuneLagMaxNs, tuneApplied;
+    uint64_t pttLagNs;
+    uint64_t backlogMax;
+    uint64_t endNs;                     /* when the radio caught up */
+} sim_result;
+
+/* Runs the session; `s` NULL sends every command as its own write. */
+static void run_session(const traffic_opts *o, kc_cat_sched *s, uint64_t radioNs, sim_result *r) {
+    static sim_cmd fifo[SIM_FIFO];
+    static sim_answer answers[SIM_FIFO];
+    static uint64_t submittedAt[1 << 20];
+    size_t head = 0, tail = 0, ansHead = 0, ansTail = 0;
+    memset(r, 0, sizeof *r);
+
+    uint64_t duration = (uint64_t)(o->seconds * 1e9);
+    uint64_t tunePeriod = o->tuneRate > 0 ? (uint64_t)(1e9 / o->tuneRate) : UINT64_MAX;
+    uint64_t nextTune = 0, nextSlider = 0, nextKeepalive = 0, busyUntil = 0, writeDoneAt = 0, flushAt = 0;
+    uint64_t pttAt = duration / 2, pttSubmitNs = 0, tuneSeq = 0;
+    int pttSent = 0, writing = 0;
+    char batch[4096];
+
+    for (uint64_t t = 0;; t += SIM_STEP_NS) {
+        /* The app. */
+        int n = 0;
+        char cmds[8][32];
+        if (t < duration) {
+            for (; nextTune <= t; nextTune += tunePeriod) {
+                uint64_t seq = tuneSeq++ & ((1 << 20) - 1);
+                submittedAt[seq] = t;
+                snprintf(cmds[n++], 32, "FA%011llu;", (unsigned long long)(7000000 + seq * 10));
+                if (n == 4) break;
+            }
+            if (nextSlider <= t) {                  /* debounced every 150 ms */
+                snprintf(cmds[n++], 32, "AG%03d;", (int)(t / 1000000 % 256));
+                snprintf(cmds[n++], 32, "AG;");
+                nextSlider += 150000000;
+            }
+            if (nextKeepalive <= t) {
+                snprintf(cmds[n++], 32, "FA;");
+                nextKeepalive += 5000000000ull;
+            }
+            if (!pttSent && pttAt <= t) {
+                snprintf(cmds[n++], 32, "TX0;");
+                pttSubmitNs = t;
+                pttSent = 1;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            size_t len = strlen(cmds[i]);
+            r->submitted++;
+            if (s) {
+                kc_cat_sched_submit(s, cmds[i], len, t);
+                flushAt = t;
+            } else if (tail - head < SIM_FIFO) {
+                sim_cmd *c = &fifo[tail++ % SIM_FIFO];
+                c->arriveNs = t + SIM_NET_NS;
+                c->submitNs = t;
+                memcpy(c->text, cmds[i], len);
+                c->length = (uint8_t)len;
+                r->writes++;
+            }
+        }
+
+        /* The connection: one write outstanding; commands queued meanwhile go in the next. */
+        if (writing && writeDoneAt <= t) {
+            writing = 0;
+            flushAt = t;
+        }
+        if (s && !writing && flushAt <= t) {
+            uint64_t wait = 0;
+            size_t bytes = kc_cat_sched_next_write(s, t, batch, sizeof batch, &wait);
+            flushAt = bytes ? UINT64_MAX : wait ? t + wait : UINT64_MAX;
+            if (bytes) {
+                r->writes++;
+                writing = 1;
+                writeDoneAt = t + 200000;
+                for (size_t a = 0, b = 0; b < bytes; b++) {
+                    if (batch[b] != ';') continue;
+                    if (tail - head < SIM_FIFO) {
+                        sim_cmd *c = &fifo[tail++ % SIM_FIFO];
+                        c->arriveNs = t + SIM_NET_NS;
+                        c->submitNs = t;
+                        c->length = (uint8_t)(b + 1 - a);
+                        memcpy(c->text, batch + a, c->length);
+                    }
+                    a = b + 1;
+                }
+            }
+        }
+
+        /* The radio: one command at a time, answers to reads. */
+        if (tail - head > r->backlogMax) r->backlogMax = tail - head;
+        if (busyUntil <= t && head < tail && fifo[head % SIM_FIFO].arriveNs <= t) {
+            sim_cmd *c = &fifo[head++ % SIM_FIFO];
+            busyUntil = t + radioNs;
+            r->busyNs += radioNs;
+            r->handled++;
+            if (c->length > 3 && c->text[0] == 'F' && c->text[1] == 'A') {
+                unsigned long long hz = strtoull(c->text + 2, NULL, 10);
+                uint64_t seq = (hz - 7000000) / 10 & ((1 << 20) - 1);
+                uint64_t lag = busyUntil - submittedAt[seq];
+                r->tuneLagSumNs += lag;
+                if (lag > r->tuneLagMaxNs) r->tuneLagMaxNs = lag;
+                r->tuneApplied++;
+            } else if (c->length == 3 && ansTail - ansHead < SIM_FIFO) {
+                sim_answer *a = &answers[ansTail++ % SIM_FIFO];
+                a->atNs = busyUntil + SIM_NET_NS;
+                a->length = (uint8_t)snprintf(a->text, sizeof a->text, c->text[0] == 'F' ? "FA00007000000" : "AG100");
+            } else if (!memcmp(c->text, "TX0", 3)) {
+                r->pttLagNs = busyUntil - pttSubmitNs;
+            }
+        }
+        while (ansHead < ansTail && answers[ansHead % SIM_FIFO].atNs <= t) {
+            sim_answer *a = &answers[ansHead++ % SIM_FIFO];
+            if (s) {
+                kc_cat_sched_on_frame(s, a->text, a->length, t);
+                flushAt = t;
+            }
+        }
+
+        if (t >= duration && head == tail && busyUntil <= t && ansHead == ansTail &&
+            (!s || kc_cat_sched_pending(s) == 0)) {
+            r->endNs = t;
+            break;
+        }
+    }
+}
+
+static void print_session(const char *name, const traffic_opts *o, const sim_result *r) {
+    printf("%-10s %7llu sent  %7llu writes  %7llu handled  radio busy %5.1f%%  caught up %+.2f s\n", name,
+           (unsigned long long)r->submitted, (unsigned long long)r->writes, (unsigned long long)r->handled,
+           100.0 * (double)r->busyNs / (double)r->endNs, (double)r->endNs / 1e9 - o->seconds);
+    printf("           tuning lag avg %.1f ms, max %.1f ms; PTT %.1f ms\n",
+           r->tuneApplied ? (double)r->tuneLagSumNs / r->tuneApplied / 1e6 : 0.0, (double)r->tuneLagMaxNs / 1e6,
+           (double)r->pttLagNs / 1e6);
+}
+
+/* Where "?;" goes: a set the radio accepts without a word, then a query it refuses, must cost
+ * the query its slot in the window, not the set. Returns 0 if it does. */
+static int check_sched_refusal(void) {
+    kc_cat_sched *s = kc_cat_sched_create(NULL);
+    if (!s) return 1;
+    char buf[64];
+    kc_cat_sched_submit(s, "AG100;", 6, 0);
+    kc_cat_sched_submit(s, "EX999;", 6, 0);
+    size_t n = kc_cat_sched_next_write(s, 0, buf, sizeof buf, NULL);
+    kc_cat_sched_on_frame(s, "?", 1, 1000000);
+
+    kc_cat_sched_stats st;
+    kc_cat_sched_read_stats(s, &st);
+    int ok = n == 12 && st.errors == 1 && st.rejected == 0 && kc_cat_sched_pending(s) == 0;
+    printf("           set then refused query: %llu query errors, %llu sets rejected, %d pending: %s\n",
+           (unsigned long long)st.errors, (unsigned long long)st.rejected, kc_cat_sched_pending(s),
+           ok ? "ok" : "WRONG");
+    kc_cat_sched_destroy(s);
+    return !ok;
+}
+
+static int bench_sched(const traffic_opts *o, uint64_t radioNs, uint64_t intervalNs) {
+    kc_cat_sched_config config = { .window = 4, .minIntervalNs = intervalNs };
+    kc_cat_sched *s = kc_cat_sched_create(&config);
+    if (!s) {
+        fprintf(stderr, "kc-catbench: out of memory\n");
+        return 1;
+    }
+    sim_result direct, sched;
+    printf("%.0f s, FA sets at %.0f/s, radio %.2f ms per command, write interval %.0f ms\n", o->seconds,
+           o->tuneRate, (double)radioNs / 1e6, (double)intervalNs / 1e6);
+    run_session(o, NULL, radioNs, &direct);
+    print_session("direct", o, &direct);
+    run_session(o, s, radioNs, &sched);
+    print_session("scheduled", o, &sched);
+
+    kc_cat_sched_stats st;
+    kc_cat_sched_read_stats(s, &st);
+    printf("           %llu coalesced, %llu answered, %llu timed out, queue max %d, in flight max %d\n",
+           (unsigned long long)st.coalesced, (unsigned long long)st.answered, (unsigned long long)st.timeouts,
+           st.maxQueued, st.maxInFlight);
+    const kc_cat_cmd shown[] = { KC_CAT_FA, KC_CAT_AG };
+    for (size_t i = 0; i < sizeof shown / sizeof shown[0]; i++) {
+        kc_cat_sched_cmd_stats c;
+        kc_cat_sched_read_cmd_stats(s, shown[i], &c);
+        printf("           %-3s %6llu sets %5llu reads %7llu coalesced  rtt %.1f/%.1f/%.1f ms\n",
+               kc_cat_name(shown[i]), (unsigned long long)c.sets, (unsigned long long)c.queries,
+               (unsigned long long)c.coalesced, (double)c.rttMinNs / 1e6,
+               c.answered ? (double)c.rttSumNs / c.answered / 1e6 : 0.0, (double)c.rttMaxNs / 1e6);
+    }
+    kc_cat_sched_destroy(s);
+    return check_sched_refusal();
+}
+
+/* ---- Rig-state store ---- */
+
+typedef struct store_run {
+    kc_rig_store      *store;
+    const kc_cat_msg  *msgs;
+    size_t             n;
+    uint64_t           durationNs;
+    atomic_int         done;
+    uint64_t           stored;              /* frames that carried rig state */
+    uint64_t           applyNs;
+    _Atomic uint64_t   polls;               /* the flat-out readers' */
+    uint64_t           pollNs, pollMaxNs;
+    long               loads;               /* torn-read phase */
+    _Atomic uint64_t   torn;
+} store_run;
+
+static void sleep_until(uint64_t dueNs) {
+    uint64_t now = now_ns();
+    if (dueNs <= now) return;
+    struct timespec ts = { (time_t)((dueNs - now) / 1000000000ull), (long)((dueNs - now) % 1000000000ull) };
+    nanosleep(&ts, NULL);
+}
+
+/* Applies the frames spread evenly over the traffic's duration, a few at a time. */
+static void *store_writer(void *arg) {
+    store_run *r = arg;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < r->n; i++) {
+        if (i % 16 == 0) sleep_until(start + (uint64_t)((double)r->durationNs * (double)i / (double)r->n));
+        uint64_t t = now_ns();
+        if (kc_rig_store_apply(r->store, &r->msgs[i])) r->stored++;
+        r->applyNs += now_ns() - t;
+    }
+    atomic_store(&r->done, 1);
+    return NULL;
+}
+
+static void *store_reader(void *arg) {
+    store_run *r = arg;
+    uint64_t cursor = 0, polls = 0;
+    kc_rig_values v;
+    while (!atomic_load(&r->done)) {
+        uint64_t t = now_ns();
+        kc_rig_store_poll(r->store, &cursor, &v);
+        uint64_t d = now_ns() - t;
+        r->pollNs += d;
+        if (d > r->pollMaxNs) r->pollMaxNs = d;
+        polls++;
+    }
+    atomic_store(&r->polls, polls);
+    return NULL;
+}
+
+static void *torn_writer(void *arg) {
+    store_run *r = arg;
+    kc_rig_values v = { .valid = (1ull << KC_RIG_FIELD_COUNT) - 1 };
+    for (long i = 1; i <= r->loads; i++) {
+        for (int f = 0; f < KC_RIG_FIELD_COUNT; f++) v.v[f] = i;
+        kc_rig_store_load(r->store, &v);
+        /* Back to back, readers would only ever see a write in progress and retry. */
+        for (uint64_t until = now_ns() + 500; now_ns() < until;) {}
+    }
+    atomic_store(&r->done, 1);
+    return NULL;
+}
+
+static void *torn_reader(void *arg) {
+    store_run *r = arg;
+    uint64_t cursor = 0, polls = 0, torn = 0;
+    kc_rig_values v;
+    while (!atomic_load(&r->done)) {
+        if (!kc_rig_store_poll(r->store, &cursor, &v)) continue;
+        for (int f = 1; f < KC_RIG_FIELD_COUNT; f++)
+            if (v.v[f] != v.v[0]) {
+                torn++;
+                break;
+            }
+        polls++;
+    }
+    atomic_fetch_add(&r->polls, polls);
+    atomic_fetch_add(&r->torn, torn);
+    return NULL;
+}
+
+static int bench_store(const traffic_opts *o, long loads) {
+    buf t = { 0 };
+    size_t total = make_traffic(o, &t);
+    kc_cat_msg *msgs = malloc(total * sizeof *msgs);
+    kc_cat_framer *f = kc_cat_framer_create(64 * 1024);
+    store_run r = { .store = kc_rig_store_create(), .durationNs = (uint64_t)(o->seconds * 1e9) };
+    if (!msgs || !f || !r.store) {
+        fprintf(stderr, "kc-catbench: out of memory\n");
+        return 1;
+    }
+    kc_cat_frame fr;
+    kc_cat_framer_feed(f, t.p, t.n);
+    while (kc_cat_framer_next(f, &fr) && r.n < total) kc_cat_decode(fr.data, fr.length, &msgs[r.n++]);
+    r.msgs = msgs;
+
+    /* Session: the writer at the traffic's rate, the display tick here, a reader flat out. */
+    pthread_t writer, reader;
+    if (pthread_create(&writer, NULL, store_writer, &r) != 0 || pthread_create(&reader, NULL, store_reader, &r) != 0) {
+        fprintf(stderr, "kc-catbench: can't start threads\n");
+        return 1;
+    }
+    uint64_t cursor = 0, ticks = 0, published = 0, assigned = 0, tickNs = 0, start = now_ns();
+    kc_rig_values v;
+    for (int last = 0; !last;) {
+        last = atomic_load(&r.done);
+        uint64_t t0 = now_ns();
+        uint64_t changed = kc_rig_store_poll(r.store, &cursor, &v);
+        tickNs += now_ns() - t0;
+        ticks++;
+        if (changed) {
+            published++;
+            assigned += (uint64_t)__builtin_popcountll(changed);
+        }
+        if (!last) sleep_until(start + ticks * 1000000000ull / 30);
+    }
+    pthread_join(writer, NULL);
+    pthread_join(reader, NULL);
+
+    /* What the UI ends up with must be what the frames say. */
+    kc_rig_store *ref = kc_rig_store_create();
+    kc_rig_values want;
+    uint64_t refCursor = 0;
+    for (size_t i = 0; i < r.n; i++) kc_rig_store_apply(ref, &msgs[i]);
+    kc_rig_store_poll(ref, &refCursor, &want);
+    int stale = want.valid != v.valid || kc_rig_values_diff(&want, &v) != 0;
+    kc_rig_store_destroy(ref);
+
+    printf("%zu frames over %.1f s, %llu with rig state (%.0f/s)\n", r.n, o->seconds,
+           (unsigned long long)r.stored, (double)r.stored / o->seconds);
+    printf("  apply            %8.1f ns/frame\n", r.n ? (double)r.applyNs / (double)r.n : 0.0);
+    printf("  poll (30 Hz)     %8.1f ns/tick\n", (double)tickNs / (double)ticks);
+    printf("  poll (flat out)  %8.1f ns avg, %llu ns max, %llu polls\n",
+           r.polls ? (double)r.pollNs / (double)r.polls : 0.0, (unsigned long long)r.pollMaxNs,
+           (unsigned long long)r.polls);
+    printf("  main thread      %llu publications, %llu field assignments (one hop per frame before: %llu)\n",
+           (unsigned long long)published, (unsigned long long)assigned, (unsigned long long)r.stored);
+    printf("  final state      %s\n", stale ? "DIFFERS from the frames" : "matches the frames");
+
+    /* Torn reads: every load writes one value to every field. */
+    kc_rig_store_destroy(r.store);
+    store_run tr = { .store = kc_rig_store_create(), .loads = loads };
+    pthread_t tw, trd[2];
+    if (!tr.store) {
+        fprintf(stderr, "kc-catbench: out of memory\n");
+        return 1;
+    }
+    pthread_create(&tw, NULL, torn_writer, &tr);
+    for (int i = 0; i < 2; i++) pthread_create(&trd[i], NULL, torn_reader, &tr);
+    uint64_t t0 = now_ns();
+    pthread_join(tw, NULL);
+    double loadNs = (double)(now_ns() - t0) / (double)loads;
+    for (int i = 0; i < 2; i++) pthread_join(trd[i], NULL);
+    uint64_t torn = atomic_load(&tr.torn);
+    printf("torn reads: %ld loads (%.0f ns each) against 2 readers, %llu copies read, %llu torn\n", loads, loadNs,
+           (unsigned long long)atomic_load(&tr.polls), (unsigned long long)torn);
+    kc_rig_store_destroy(tr.store);
+
+    kc_cat_framer_destroy(f);
+    free(msgs);
+    free(t.p);
+    return stale || torn ? 1 : 0;
+}
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-catbench framer [options]   frame synthetic AI traffic with kc_cat_framer and the old way\n"
+        "       kc-catbench codec [options]    time kc_cat_decode on that traffic and kc_cat_encode per command\n"
+        "       kc-catbench fuzz [options]     check the codec with round trips and mangled frames\n"
+        "       kc-catbench sched [options]    a knob sweep sent directly and through kc_cat_sched\n"
+        "       kc-catbench store [options]    AI traffic through kc_rig_store at its real rate, polled at 30 Hz\n"
+        "  -t, --seconds S      traffic to generate (default 10; store: 3, played in real time)\n"
+        "      --tune RATE      FA steps per second (default 1000; sched: 500 sets from a knob)\n"
+        "      --meter RATE     SM readings per second (default 50)\n"
+        "      --other RATE     assorted state changes per second (default 20)\n"
+        "      --scope RATE     ##DD2 and ##DD3 frames per second, each (default 30)\n"
+        "      --crlf           CR/LF after every frame, as some bridges send\n"
+        "      --chunk N        largest read, bytes (default 4096, as TS890Connection asks for)\n"
+        "  -i, --iterations N   passes over the traffic (default 5; fuzz: frames per kind, default 1000000;\n"
+        "                       store: loads in the torn-read check, default 1000000)\n"
+        "      --max-ns N       codec: exit 1 if decoding takes longer per frame\n"
+        "      --radio-us N     sched: the radio's time per command (default 2500)\n"
+        "      --interval-ms N  sched: the scheduler's write interval (default 20)\n"
+        "      --seed N         random seed (default 1)\n"
+        "  -h, --help\n");
+}
+
+int main(int argc, char **argv) {
+    traffic_opts o = { .seconds = 0.0, .tuneRate = 1000.0, .meterRate = 50.0, .otherRate = 20.0,
+                       .scopeRate = 30.0, .chunk = 4096, .seed = 1 };
+    long iterations = 0;
+    double maxNs = 0.0, radioUs = 2500.0, intervalMs = 20.0, tuneRate = 0.0;
+    enum { OPT_TUNE = 256, OPT_METER, OPT_OTHER, OPT_SCOPE, OPT_CRLF, OPT_CHUNK, OPT_SEED, OPT_MAX_NS, OPT_RADIO_US,
+           OPT_INTERVAL_MS };
+    static const struct option longOpts[] = {
+        { "seconds", required_argument, NULL, 't' },
+        { "tune", required_argument, NULL, OPT_TUNE },
+        { "meter", required_argument, NULL, OPT_METER },
+        { "other", required_argument, NULL, OPT_OTHER },
+        { "scope", required_argument, NULL, OPT_SCOPE },
+        { "crlf", no_argument, NULL, OPT_CRLF },
+        { "chunk", required_argument, NULL, OPT_CHUNK },
+        { "iterations", required_argument, NULL, 'i' },
+        { "seed", required_argument, NULL, OPT_SEED },
+        { "max-ns", required_argument, NULL, OPT_MAX_NS },
+        { "radio-us", required_argument, NULL, OPT_RADIO_US },
+        { "interval-ms", required_argument, NULL, OPT_INTERVAL_MS },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "t:i:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 't': o.seconds = atof(optarg); break;
+        case OPT_TUNE: tuneRate = atof(optarg); break;
+        case OPT_METER: o.meterRate = atof(optarg); break;
+        case OPT_OTHER: o.otherRate = atof(optarg); break;
+        case OPT_SCOPE: o.scopeRate = atof(optarg); break;
+        case OPT_CRLF: o.crlf = 1; break;
+        case OPT_CHUNK: o.chunk = atoi(optarg); break;
+        case 'i': iterations = atol(optarg); break;
+        case OPT_MAX_NS: maxNs = atof(optarg); break;
+        case OPT_RADIO_US: radioUs = atof(optarg); break;
+        case OPT_INTERVAL_MS: intervalMs = atof(optarg); break;
+        case OPT_SEED: o.seed = strtoull(optarg, NULL, 10); break;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    if (optind + 1 != argc || o.seconds < 0.0 || o.chunk < 1 || iterations < 0 || radioUs < 0.0 ||
+        intervalMs < 0.0) {
+        usage(stderr);
+        return 2;
+    }
+    const char *cmd = argv[optind];
+    if (!strcmp(cmd, "store")) {
+        if (o.seconds == 0.0) o.seconds = 3.0;
+        if (tuneRate > 0.0) o.tuneRate = tuneRate;
+        return bench_store(&o, iterations ? iterations : 1000000);
+    }
+    if (o.seconds == 0.0) o.seconds = 10.0;
+    if (!strcmp(cmd, "sched")) {
+        o.tuneRate = tuneRate > 0.0 ? tuneRate : 500.0;
+        return bench_sched(&o, (uint64_t)(radioUs * 1e3), (uint64_t)(intervalMs * 1e6));
+    }
+    if (tuneRate > 0.0) o.tuneRate = tuneRate;
+    if (!strcmp(cmd, "framer")) return bench_framer(&o, iterations ? (int)iterations : 5);
+    if (!strcmp(cmd, "codec")) return bench_codec(&o, iterations ? (int)iterations : 5, maxNs);
+    if (!strcmp(cmd, "fuzz")) return fuzz_codec(iterations ? iterations : 1000000, o.seed);
+    usage(stderr);
+    return 2;
+}
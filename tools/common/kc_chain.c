@@ -0,0 +1,147 @@
+/*  kc_chain.c
+ *
+ *  See kc_chain.h. Stage delays were measured on the wrapper configuration
+ *  (fsize 1920, ovrlp 4): EMNR's overlap-add adds fsize - incr = 1440 samples,
+ *  RNNoise one 480-sample frame, ANR none.
+ */
+
+#include "kc_chain.h"
+#include "rnnoise.h"
+#if KC_HAVE_WDSP
+#include "WDSPWrapper.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+typedef struct kc_stage {
+    kc_nr_kind kind;
+    void      *impl;
+} kc_stage;
+
+struct kc_chain {
+    int      count;
+    kc_stage stage[KC_CHAIN_MAX];
+    float    scaled[KC_CHAIN_FRAME];    /* RNNoise works in int16-like units */
+};
+
+static const char *const kNames[] = { "emnr", "anr", "rnnoise", "none" };
+
+const char *kc_nr_name(kc_nr_kind kind) {
+    return (unsigned)kind < sizeof(kNames) / sizeof(kNames[0]) ? kNames[kind] : "?";
+}
+
+int kc_nr_available(kc_nr_kind kind) {
+#if KC_HAVE_WDSP
+    (void)kind;
+    return 1;
+#else
+    return kind != KC_NR_EMNR && kind != KC_NR_ANR;
+#endif
+}
+
+int kc_chain_parse(const char *spec, kc_nr_kind *kinds, int max) {
+    int n = 0;
+    const char *p = spec;
+    while (*p) {
+        const char *e = strchr(p, ',');
+        size_t len = e ? (size_t)(e - p) : strlen(p);
+        int found = -1;
+        for (int k = 0; k < (int)(sizeof(kNames) / sizeof(kNames[0])); k++) {
+            if (strlen(kNames[k]) == len && strncasecmp(p, kNames[k], len) == 0) found = k;
+        }
+        if (found < 0 || n >= max || !kc_nr_available((kc_nr_kind)found)) return -1;
+        kinds[n++] = (kc_nr_kind)found;
+        if (!e) break;
+        p = e + 1;
+    }
+    return n;
+}
+
+kc_chain *kc_chain_create(const kc_nr_kind *kinds, int count) {
+    if (count < 0 || count > KC_CHAIN_MAX) return NULL;
+    kc_chain *c = (kc_chain *)calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    for (int i = 0; i < count; i++) {
+        kc_stage *s = &c->stage[i];
+        s->kind = kinds[i];
+        switch (s->kind) {
+#if KC_HAVE_WDSP
+        case KC_NR_EMNR:    s->impl = wdsp_emnr_create(KC_CHAIN_RATE); break;
+        case KC_NR_ANR:     s->impl = wdsp_anr_create(KC_CHAIN_RATE);  break;
+#endif
+        case KC_NR_RNNOISE: s->impl = rnnoise_create(NULL);           break;
+        case KC_NR_NONE:    s->impl = c;                               break;
+        default:            s->impl = NULL;                            break;
+        }
+        c->count = i + 1;
+        if (!s->impl) {
+            kc_chain_destroy(c);
+            return NULL;
+        }
+    }
+    return c;
+}
+
+void kc_chain_destroy(kc_chain *c) {
+    if (!c) return;
+    for (int i = 0; i < c->count; i++) {
+        kc_stage *s = &c->stage[i];
+        if (!s->impl) continue;
+        switch (s->kind) {
+#if KC_HAVE_WDSP
+        case KC_NR_EMNR:    wdsp_emnr_destroy((WDSP_EMNR *)s->impl); break;
+        case KC_NR_ANR:     wdsp_anr_destroy((WDSP_ANR *)s->impl);   break;
+#endif
+        case KC_NR_RNNOISE: rnnoise_destroy((DenoiseState *)s->impl); break;
+        default: break;
+        }
+    }
+    free(c);
+}
+
+static void rnnoise_run(kc_chain *c, DenoiseState *st, float *x, int n) {
+    for (int off = 0; off + KC_CHAIN_FRAME <= n; off += KC_CHAIN_FRAME) {
+        float *f = x + off;
+        for (int i = 0; i < KC_CHAIN_FRAME; i++) c->scaled[i] = f[i] * 32768.0f;
+        rnnoise_process_frame(st, c->scaled, c->scaled);
+        for (int i = 0; i < KC_CHAIN_FRAME; i++) f[i] = c->scaled[i] * (1.0f / 32768.0f);
+    }
+}
+
+void kc_chain_process(kc_chain *c, float *x, int n) {
+    for (int i = 0; i < c->count; i++) {
+        kc_stage *s = &c->stage[i];
+        switch (s->kind) {
+#if KC_HAVE_WDSP
+        case KC_NR_EMNR:    wdsp_emnr_process((WDSP_EMNR *)s->impl, x, n); break;
+        case KC_NR_ANR:     wdsp_anr_process((WDSP_ANR *)s->impl, x, n);   break;
+#endif
+        case KC_NR_RNNOISE: rnnoise_run(c, (DenoiseState *)s->impl, x, n); break;
+        default: break;
+        }
+    }
+}
+
+void kc_chain_set_emnr_quality(kc_chain *c, int gainMethod, int aeRun, int post2Run) {
+#if KC_HAVE_WDSP
+    for (int i = 0; i < c->count; i++)
+        if (c->stage[i].kind == KC_NR_EMNR)
+            wdsp_emnr_set_quality((WDSP_EMNR *)c->stage[i].impl, gainMethod, aeRun, post2Run);
+#else
+    (void)c; (void)gainMethod; (void)aeRun; (void)post2Run;
+#endif
+}
+
+int kc_chain_delay(const kc_chain *c) {
+    int d = 0;
+    for (int i = 0; i < c->count; i++) {
+        switch (c->stage[i].kind) {
+        case KC_NR_EMNR:    d += 1440;           break;
+        case KC_NR_RNNOISE: d += KC_CHAIN_FRAME; break;
+        default: break;
+        }
+    }
+    return d;
+}
@@ -0,0 +1,49 @@
+/*  kc_chain.h
+ *
+ *  A chain of the app's noise-reduction engines (WDSP EMNR, WDSP ANR, RNNoise)
+ *  for offline tools. Runs at 48 kHz mono float in [-1, 1], 480-sample frames,
+ *  the same configuration the app uses on LAN RX audio.
+ *
+ *  EMNR and ANR need FFTW and are only present when built with KC_HAVE_WDSP.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KC_CHAIN_RATE   48000
+#define KC_CHAIN_FRAME  480
+#define KC_CHAIN_MAX    8
+
+typedef enum {
+    KC_NR_EMNR,
+    KC_NR_ANR,
+    KC_NR_RNNOISE,
+    KC_NR_NONE      /* pass-through; handy as a baseline */
+} kc_nr_kind;
+
+typedef struct kc_chain kc_chain;
+
+/* Parse "emnr,rnnoise" etc. Returns the number of stages, or -1 (bad name / too many).
+ * A stage that isn't compiled in is an error too; see kc_nr_available(). */
+int         kc_chain_parse(const char *spec, kc_nr_kind *kinds, int max);
+int         kc_nr_available(kc_nr_kind kind);
+const char *kc_nr_name(kc_nr_kind kind);
+
+kc_chain   *kc_chain_create(const kc_nr_kind *kinds, int count);
+void        kc_chain_destroy(kc_chain *c);
+
+/* In-place; n must be a multiple of KC_CHAIN_FRAME. */
+void        kc_chain_process(kc_chain *c, float *x, int n);
+
+/* Quality / CPU trade-off for every EMNR stage, as wdsp_emnr_set_quality. No-op without EMNR. */
+void        kc_chain_set_emnr_quality(kc_chain *c, int gainMethod, int aeRun, int post2Run);
+
+/* Total algorithmic delay in samples at 48 kHz: output sample i corresponds to input i - delay. */
+int         kc_chain_delay(const kc_chain *c);
+
+#ifdef __cplusplus
+}
+#endif
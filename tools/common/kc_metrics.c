@@ -0,0 +1,111 @@
+/*  kc_metrics.c
+ *
+ *  See kc_metrics.h. The LSD transform uses RNNoise's kiss_fft, which every
+ *  tool links already, so the metrics don't depend on FFTW.
+ */
+
+#include "kc_metrics.h"
+#include "kiss_fft.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define KC_ACTIVE_DB  40.0
+#define KC_FLOOR_DB   60.0
+
+/* Marks frames (length len, hop) whose reference energy is within KC_ACTIVE_DB of the loudest. */
+static int active_frames(const float *ref, size_t n, size_t len, size_t hop, unsigned char **out) {
+    if (n < len) return 0;
+    size_t frames = (n - len) / hop + 1;
+    double *e = (double *)malloc(sizeof(double) * frames);
+    unsigned char *a = (unsigned char *)calloc(frames, 1);
+    if (!e || !a) { free(e); free(a); return 0; }
+    double peak = 0.0;
+    for (size_t f = 0; f < frames; f++) {
+        double s = 0.0;
+        for (size_t i = 0; i < len; i++) s += (double)ref[f * hop + i] * ref[f * hop + i];
+        e[f] = s;
+        if (s > peak) peak = s;
+    }
+    double gate = peak * pow(10.0, -KC_ACTIVE_DB / 10.0);
+    for (size_t f = 0; f < frames; f++) a[f] = peak > 0.0 && e[f] >= gate;
+    free(e);
+    *out = a;
+    return (int)frames;
+}
+
+double kc_segsnr(const float *ref, const float *test, size_t n, int rate) {
+    size_t len = (size_t)rate / 50;
+    unsigned char *active = NULL;
+    int frames = active_frames(ref, n, len, len, &active);
+    double sum = 0.0;
+    int used = 0;
+    for (int f = 0; f < frames; f++) {
+        if (!active[f]) continue;
+        double sig = 0.0, err = 0.0;
+        for (size_t i = f * len; i < (f + 1) * len; i++) {
+            double d = (double)ref[i] - test[i];
+            sig += (double)ref[i] * ref[i];
+            err += d * d;
+        }
+        double snr = err > 0.0 ? 10.0 * log10(sig / err) : 35.0;
+        sum += fmin(35.0, fmax(-10.0, snr));
+        used++;
+    }
+    free(active);
+    return used ? sum / used : 0.0;
+}
+
+double kc_lsd(const float *ref, const float *test, size_t n, int rate, double maxHz) {
+    size_t len = (size_t)rate / 50, hop = len / 2;
+    kiss_fft_state *cfg = rnn_fft_alloc_twiddles((int)len, NULL, NULL, NULL, 0);
+    kiss_fft_cpx *xi = (kiss_fft_cpx *)malloc(sizeof(kiss_fft_cpx) * len);
+    kiss_fft_cpx *xr = (kiss_fft_cpx *)malloc(sizeof(kiss_fft_cpx) * len);
+    kiss_fft_cpx *xt = (kiss_fft_cpx *)malloc(sizeof(kiss_fft_cpx) * len);
+    float *win = (float *)malloc(sizeof(float) * len);
+    unsigned char *active = NULL;
+    double result = -1.0;
+    if (!cfg || !xi || !xr || !xt || !win) goto done;
+
+    for (size_t i = 0; i < len; i++) win[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / len));
+    size_t bins = (size_t)(maxHz * len / rate) + 1;
+    if (bins > len / 2 + 1) bins = len / 2 + 1;
+
+    int frames = active_frames(ref, n, len, hop, &active);
+    double sum = 0.0;
+    int used = 0;
+    for (int f = 0; f < frames; f++) {
+        if (!active[f]) continue;
+        const float *r = ref + f * hop, *t = test + f * hop;
+        for (size_t i = 0; i < len; i++) { xi[i].r = r[i] * win[i]; xi[i].i = 0.0f; }
+        rnn_fft_c(cfg, xi, xr);
+        for (size_t i = 0; i < len; i++) { xi[i].r = t[i] * win[i]; xi[i].i = 0.0f; }
+        rnn_fft_c(cfg, xi, xt);
+
+        double peak = 0.0;
+        for (size_t k = 0; k < bins; k++) {
+            double p = (double)xr[k].r * xr[k].r + (double)xr[k].i * xr[k].i;
+            if (p > peak) peak = p;
+        }
+        double floor = peak * pow(10.0, -KC_FLOOR_DB / 10.0) + 1e-30;
+        double acc = 0.0;
+        for (size_t k = 0; k < bins; k++) {
+            double pr = (double)xr[k].r * xr[k].r + (double)xr[k].i * xr[k].i;
+            double pt = (double)xt[k].r * xt[k].r + (double)xt[k].i * xt[k].i;
+            double d = 10.0 * log10(fmax(pr, floor) / fmax(pt, floor));
+            acc += d * d;
+        }
+        sum += sqrt(acc / bins);
+        used++;
+    }
+    result = used ? sum / used : 0.0;
+
+done:
+    free(active);
+    free(win);
+    free(xt);
+    free(xr);
+    free(xi);
+    if (cfg) rnn_fft_free(cfg, 0);
+    return result;
+}
@@ -0,0 +1,28 @@
+/*  kc_metrics.h
+ *
+ *  Objective quality metrics for comparing processed audio with a clean
+ *  reference. Both buffers must already be time-aligned and the same length.
+ *  Only "active" frames count — those whose reference energy is within 40 dB
+ *  of the loudest reference frame — so silence and key-up gaps don't dominate.
+ */
+
+#pragma once
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Segmental SNR in dB: mean over active 20 ms frames of 10·log10(Σref² / Σ(ref − test)²),
+ * each frame clamped to [−10, 35] dB. Higher is better. */
+double kc_segsnr(const float *ref, const float *test, size_t n, int rate);
+
+/* Log-spectral distance in dB: mean over active 20 ms Hann frames (50 % overlap) of the RMS
+ * difference between reference and test power spectra in dB, over bins up to maxHz.
+ * Bin powers are floored 60 dB below the frame's loudest reference bin. Lower is better.
+ * Returns a negative value if the frame length can't be transformed. */
+double kc_lsd(const float *ref, const float *test, size_t n, int rate, double maxHz);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,289 @@
+/*  kc_replay.c
+ *
+ *  See kc_replay.h.
+ */
+
+#include "kc_replay.h"
+#include "kc_audio_stats.h"
+#include "kc_pcm.h"
+#include "kc_plc.h"
+#include "kc_signal.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FRAME_NS      20000000ull
+#define HOLD_BACK_NS  (FRAME_NS + FRAME_NS / 4)
+
+/* ---- Scheduler ---- */
+
+/* Min-heap of records waiting for their delivery time; ties go in capture order. */
+typedef struct held {
+    uint64_t        at, order;
+    kc_capture_item item;
+} held;
+
+typedef struct heap {
+    held  *v;
+    size_t n, cap;
+} heap;
+
+static int held_before(const held *a, const held *b) {
+    return a->at < b->at || (a->at == b->at && a->order < b->order);
+}
+
+static int heap_push(heap *h, const held *x) {
+    if (h->n == h->cap) {
+        size_t cap = h->cap ? 2 * h->cap : 64;
+        held *v = realloc(h->v, cap * sizeof *v);
+        if (!v) return -1;
+        h->v = v;
+        h->cap = cap;
+    }
+    size_t i = h->n++;
+    while (i > 0 && held_before(x, &h->v[(i - 1) / 2])) {
+        h->v[i] = h->v[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->v[i] = *x;
+    return 0;
+}
+
+static held heap_pop(heap *h) {
+    held top = h->v[0], last = h->v[--h->n];
+    size_t i = 0;
+    for (;;) {
+        size_t c = 2 * i + 1;
+        if (c >= h->n) break;
+        if (c + 1 < h->n && held_before(&h->v[c + 1], &h->v[c])) c++;
+        if (!held_before(&h->v[c], &last)) break;
+        h->v[i] = h->v[c];
+        i = c;
+    }
+    if (h->n > 0) h->v[i] = last;
+    return top;
+}
+
+static uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void wait_until(uint64_t t) {
+    for (uint64_t now = mono_ns(); now < t; now = mono_ns()) {
+        uint64_t d = t - now;
+        struct timespec ts = { .tv_sec = (time_t)(d / 1000000000ull), .tv_nsec = (long)(d % 1000000000ull) };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static void deliver(const kc_replay_opts *o, uint64_t wallStart, held *x, kc_replay_fn fn, void *ctx,
+                    kc_replay_counts *c) {
+    if (o->speed > 0.0) wait_until(wallStart + (uint64_t)((double)x->at / o->speed));
+    x->item.timeNs = x->at;
+    fn(ctx, &x->item);
+    c->delivered++;
+    c->endNs = x->at;
+}
+
+int kc_replay_run(kc_capture_reader *r, const kc_replay_opts *o, kc_replay_fn fn, void *ctx,
+                  kc_replay_counts *counts) {
+    kc_replay_counts c = { 0 };
+    kc_rng rng;
+    kc_rng_seed(&rng, o->seed);
+    heap h = { 0 };
+    uint64_t order = 0, wallStart = mono_ns();
+    int rc;
+    kc_capture_item item;
+
+    kc_capture_reader_rewind(r);
+    while ((rc = kc_capture_reader_next(r, &item)) == 1) {
+        if (o->kinds && !(o->kinds & (1u << item.kind))) continue;
+        held x = { .at = item.timeNs, .order = order++, .item = item };
+        if (item.kind == KC_CAPTURE_RTP_RX) {
+            double loss = kc_rng_uniform(&rng) * 100.0;
+            double reorder = kc_rng_uniform(&rng) * 100.0;
+            double jitter = kc_rng_uniform(&rng) * o->jitterMs * 1e6;
+            if (loss < o->lossPct) {
+                c.lost++;
+                continue;
+            }
+            x.at += (uint64_t)jitter;
+            if (reorder < o->reorderPct) {
+                x.at += HOLD_BACK_NS;
+                c.reordered++;
+            }
+        }
+        if (heap_push(&h, &x) != 0) {
+            rc = -1;
+            errno = ENOMEM;
+            break;
+        }
+        /* Nothing read later can be due before this record's capture time. */
+        while (h.n > 0 && h.v[0].at <= item.timeNs) {
+            held d = heap_pop(&h);
+            deliver(o, wallStart, &d, fn, ctx, &c);
+        }
+    }
+    while (h.n > 0) {
+        held d = heap_pop(&h);
+        deliver(o, wallStart, &d, fn, ctx, &c);
+    }
+    free(h.v);
+    if (counts) *counts = c;
+    return rc < 0 ? -1 : 0;
+}
+
+/* ---- LAN RX pipeline ---- */
+
+#define PAYLOAD_BYTES 640
+#define FRAME_16K     320
+#define FRAME_48K     960
+#define TIMER_NS      5000000ull
+
+struct kc_rxsim {
+    kc_jitter      *jitter;
+    kc_plc         *plc;
+    uint8_t         frame[PAYLOAD_BYTES];
+    float           pcm[FRAME_16K];
+    float           pending;
+    int             hasPending;
+    uint64_t        nextTickNs;
+    int             started;
+    float          *out;
+    size_t          outCount, outCap;
+    kc_rxsim_counts counts;
+};
+
+kc_rxsim *kc_rxsim_create(void) {
+    kc_rxsim *s = calloc(1, sizeof *s);
+    if (!s) return NULL;
+    s->jitter = kc_jitter_create(PAYLOAD_BYTES, FRAME_NS, 2, 15);
+    s->plc = kc_plc_create(16000, FRAME_16K);
+    if (!s->jitter || !s->plc) {
+        kc_rxsim_destroy(s);
+        return NULL;
+    }
+    return s;
+}
+
+void kc_rxsim_destroy(kc_rxsim *s) {
+    if (!s) return;
+    kc_jitter_destroy(s->jitter);
+    kc_plc_destroy(s->plc);
+    free(s->out);
+    free(s);
+}
+
+/* upsampleAndEmit: linear x3, holding the last sample for the next frame. */
+static void upsample_and_emit(kc_rxsim *s, uint64_t start) {
+    if (s->outCap - s->outCount < FRAME_48K) {
+        size_t cap = s->outCap ? 2 * s->outCap : 48000;
+        float *out = realloc(s->out, cap * sizeof *out);
+        if (!out) return;
+        s->out = out;
+        s->outCap = cap;
+    }
+    float *o = s->out + s->outCount;
+    size_t produced = 0;
+    for (int i = 0; i < FRAME_16K; i++) {
+        float x = s->pcm[i];
+        if (s->hasPending) {
+            float a = s->pending, d = x - a;
+            o[produced] = a;
+            o[produced + 1] = a + d / 3.0f;
+            o[produced + 2] = a + 2.0f * d / 3.0f;
+            produced += 3;
+        }
+        s->pending = x;
+        s->hasPending = 1;
+    }
+    kc_stats_end(KC_STATS_RX_UPSAMPLE, start);
+    s->outCount += produced;
+}
+
+static void play_out(kc_rxsim *s, uint64_t now) {
+    for (;;) {
+        kc_jitter_get_result r = kc_jitter_get(s->jitter, now, s->frame);
+        if (r == KC_JITTER_FRAME) {
+            uint64_t start = kc_stats_begin();
+            kc_pcm_s16le_to_f32(s->frame, s->pcm, FRAME_16K, 1.0f / 32768.0f);
+            kc_plc_good(s->plc, s->pcm);
+            upsample_and_emit(s, start);
+            s->counts.frames++;
+        } else if (r == KC_JITTER_LOST || r == KC_JITTER_UNDERRUN) {
+            if (r == KC_JITTER_LOST) kc_stats_count(KC_STATS_LOST_PACKETS, 1);
+            kc_stats_count(KC_STATS_PLC_INSERTS, 1);
+            uint64_t start = kc_stats_begin();
+            kc_plc_conceal(s->plc, s->pcm);
+            upsample_and_emit(s, start);
+            s->counts.concealed++;
+        } else {
+            return;
+        }
+    }
+}
+
+void kc_rxsim_advance(kc_rxsim *s, uint64_t nowNs) {
+    if (!s->started) {
+        s->nextTickNs = nowNs;
+        s->started = 1;
+    }
+    for (; s->nextTickNs <= nowNs; s->nextTickNs += TIMER_NS) play_out(s, s->nextTickNs);
+}
+
+/* RTPHeader.parse plus the padding handling in handlePacket. Payload offset, or -1. */
+static long rtp_payload(const uint8_t *p, size_t n, size_t *payloadLen) {
+    if (n < 12 || p[0] >> 6 != 2) return -1;
+    size_t h = 12 + 4 * (size_t)(p[0] & 0x0f);
+    if (n < h) return -1;
+    if (p[0] & 0x10) {
+        if (n < h + 4) return -1;
+        h += 4 + 4 * (size_t)(p[h + 2] << 8 | p[h + 3]);
+        if (n < h) return -1;
+    }
+    size_t end = n;
+    if ((p[0] & 0x20) && end > h) {
+        size_t pad = p[end - 1];
+        if (pad > 0 && end - pad >= h) end -= pad;
+    }
+    *payloadLen = end - h;
+    return (long)h;
+}
+
+void kc_rxsim_packet(kc_rxsim *s, const uint8_t *pkt, size_t length, uint64_t arrivalNs) {
+    kc_rxsim_advance(s, arrivalNs);
+    uint64_t drainStart = kc_stats_begin();
+    s->counts.datagrams++;
+    size_t payloadLen = 0;
+    long at = rtp_payload(pkt, length, &payloadLen);
+    if (at < 0 || payloadLen < PAYLOAD_BYTES) {
+        s->counts.rejected++;
+    } else {
+        kc_stats_count(KC_STATS_PACKETS, 1);
+        uint16_t seq = (uint16_t)(pkt[2] << 8 | pkt[3]);
+        switch (kc_jitter_put(s->jitter, seq, arrivalNs, pkt + at)) {
+        case KC_JITTER_LATE: kc_stats_count(KC_STATS_LATE_PACKETS, 1); break;
+        case KC_JITTER_REORDERED: kc_stats_count(KC_STATS_REORDERED, 1); break;
+        default: break;
+        }
+    }
+    play_out(s, arrivalNs);
+    kc_stats_end(KC_STATS_RX_DRAIN, drainStart);
+}
+
+const float *kc_rxsim_output(const kc_rxsim *s, size_t *count) {
+    *count = s->outCount;
+    return s->out;
+}
+
+void kc_rxsim_read_counts(const kc_rxsim *s, kc_rxsim_counts *out) {
+    *out = s->counts;
+}
+
+void kc_rxsim_read_jitter(const kc_rxsim *s, kc_jitter_stats *out) {
+    kc_jitter_read_stats(s->jitter, out);
+}
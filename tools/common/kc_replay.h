@@ -0,0 +1,89 @@
+/*  kc_replay.h
+ *
+ *  Replays a traffic capture (Native/kc_capture) for the tools: a scheduler
+ *  that delivers its records in time order, optionally perturbed, and a copy
+ *  of the app's LAN RX pipeline to deliver RTP packets into.
+ *
+ *  Perturbations apply to received RTP only (CAT and TX records keep their
+ *  times) and are drawn from a seeded kc_rng, three draws per packet whether
+ *  or not each perturbation is on, so a run depends only on the capture and
+ *  the options:
+ *
+ *    - jitter: extra delay, uniform in [0, jitterMs);
+ *    - reorder: held back 1.25 frames, so it arrives after its successor;
+ *    - loss: never delivered.
+ *
+ *  The RX pipeline is KenwoodLanAudioReceiver without the socket: RTP header
+ *  and padding parsing, kc_jitter (640-byte frames, depth 2..15), playout
+ *  after each packet and on a 5 ms timer, kc_pcm decode, kc_plc concealment
+ *  and the 16 -> 48 kHz linear upsampler with its held sample. It runs on
+ *  the delivery times, not the wall clock, so its output is deterministic
+ *  at any replay speed. Stage times and counters go to kc_audio_stats as in
+ *  the app.
+ */
+
+#pragma once
+#include "kc_capture.h"
+#include "kc_jitter.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---- Scheduler ---- */
+
+typedef struct kc_replay_opts {
+    double   speed;             /* 1 = real time, 4 = four times faster, 0 = no waiting */
+    double   jitterMs;
+    double   lossPct;
+    double   reorderPct;
+    uint64_t seed;
+    unsigned kinds;             /* bit (1 << kind) for each kind to deliver; 0 = all */
+} kc_replay_opts;
+
+typedef struct kc_replay_counts {
+    uint64_t delivered;
+    uint64_t lost, reordered;   /* RTP RX packets dropped / held back */
+    uint64_t endNs;             /* delivery time of the last record */
+} kc_replay_counts;
+
+/* Called for each record in delivery order; item->timeNs is the (perturbed) delivery time. */
+typedef void (*kc_replay_fn)(void *ctx, const kc_capture_item *item);
+
+/* Replays r from its start. Returns 0, or -1 if the capture is corrupt (what came before the
+ * bad record has been delivered). */
+int kc_replay_run(kc_capture_reader *r, const kc_replay_opts *o, kc_replay_fn fn, void *ctx,
+                  kc_replay_counts *counts);
+
+/* ---- LAN RX pipeline ---- */
+
+#define KC_RXSIM_RATE 48000
+
+typedef struct kc_rxsim kc_rxsim;
+
+typedef struct kc_rxsim_counts {
+    uint64_t datagrams;
+    uint64_t rejected;          /* not RTP v2, or a payload under 640 bytes */
+    uint64_t frames;            /* 20 ms frames played from packets */
+    uint64_t concealed;         /* frames played by kc_plc */
+} kc_rxsim_counts;
+
+kc_rxsim *kc_rxsim_create(void);
+void      kc_rxsim_destroy(kc_rxsim *s);
+
+/* One datagram as drain() handles it, arriving at arrivalNs (which also advances the clock). */
+void kc_rxsim_packet(kc_rxsim *s, const uint8_t *pkt, size_t length, uint64_t arrivalNs);
+/* Runs the 5 ms playout timer up to nowNs. */
+void kc_rxsim_advance(kc_rxsim *s, uint64_t nowNs);
+
+/* The 48 kHz mono output so far (valid until the next call that adds to it). */
+const float *kc_rxsim_output(const kc_rxsim *s, size_t *count);
+void kc_rxsim_read_counts(const kc_rxsim *s, kc_rxsim_counts *out);
+void kc_rxsim_read_jitter(const kc_rxsim *s, kc_jitter_stats *out);
+
+#ifdef __cplusplus
+}
+#endif
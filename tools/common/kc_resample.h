@@ -0,0 +1,33 @@
+/*  kc_resample.h
+ *
+ *  Stateless windowed-sinc sample-rate conversion for the command-line tools.
+ *  Output sample j sits at input time j * rateIn / rateOut; input outside
+ *  [0, nin) reads as zero, so callers that care about edges pass extra context.
+ *  A resampler is read-only after creation and can be shared between threads.
+ */
+
+#pragma once
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct kc_resampler kc_resampler;
+
+/* Returns NULL if the rates are invalid or the rate ratio needs too many filter phases. */
+kc_resampler *kc_resampler_create(int rateIn, int rateOut);
+void          kc_resampler_destroy(kc_resampler *r);
+
+/* Output length for nin input samples: floor(nin * rateOut / rateIn). */
+size_t kc_resample_length(const kc_resampler *r, size_t nin);
+
+/* Input samples of context the kernel reaches on each side. */
+int    kc_resample_reach(const kc_resampler *r);
+
+/* Writes kc_resample_length(r, nin) samples to out. Equal rates copy. */
+void   kc_resample(const kc_resampler *r, const float *in, size_t nin, float *out);
+
+#ifdef __cplusplus
+}
+#endif
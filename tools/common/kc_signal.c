@@ -0,0 +1,192 @@
+/*  kc_signal.c
+ *
+ *  See kc_signal.h.
+ */
+
+#include "kc_signal.h"
+
+#include <math.h>
+#include <string.h>
+
+void kc_rng_seed(kc_rng *r, uint64_t seed) {
+    r->s = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+uint64_t kc_rng_next(kc_rng *r) {
+    uint64_t x = r->s;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    r->s = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+double kc_rng_uniform(kc_rng *r) {
+    return (double)(kc_rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double kc_rng_gauss(kc_rng *r) {
+    /* Box–Muller; the second value is dropped to keep the stream position simple. */
+    double u1 = kc_rng_uniform(r), u2 = kc_rng_uniform(r);
+    if (u1 < 1e-300) u1 = 1e-300;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+void kc_sig_noise(float *x, size_t n, double rms, uint64_t seed) {
+    kc_rng r;
+    kc_rng_seed(&r, seed);
+    for (size_t i = 0; i < n; i++) x[i] += (float)(rms * kc_rng_gauss(&r));
+}
+
+double kc_sig_rms(const float *x, size_t n) {
+    double acc = 0.0;
+    for (size_t i = 0; i < n; i++) acc += (double)x[i] * x[i];
+    return n ? sqrt(acc / n) : 0.0;
+}
+
+/* ---- CW ---- */
+
+/* '.' dit, '-' dah; index 0–25 letters, 26–35 digits. */
+static const char *const kMorse[36] = {
+    ".-", "-...", "-.-.", "-..", ".", "..-.", "--.", "....", "..", ".---", "-.-", ".-..", "--",
+    "-.", "---", ".--.", "--.-", ".-.", "...", "-", "..-", "...-", ".--", "-..-", "-.--", "--..",
+    "-----", ".----", "..---", "...--", "....-", ".....", "-....", "--...", "---..", "----."
+};
+
+static const char *morse_for(char c) {
+    if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+    if (c >= 'A' && c <= 'Z') return kMorse[c - 'A'];
+    if (c >= '0' && c <= '9') return kMorse[26 + c - '0'];
+    return NULL;
+}
+
+/* Key-down intervals in dit units for one pass of `text`; returns the pass length in dits. */
+static int cw_keying(const char *text, int *on, int *len, int max, int *count) {
+    int t = 0, k = 0;
+    for (const char *p = text; *p; p++) {
+        if (*p == ' ') { t += 4; continue; }      /* 3 already added after the letter → 7 */
+        const char *code = morse_for(*p);
+        if (!code) continue;
+        for (const char *c = code; *c; c++) {
+            int d = *c == '-' ? 3 : 1;
+            if (k < max) { on[k] = t; len[k] = d; k++; }
+            t += d + 1;
+        }
+        t += 2;                                   /* letter gap: 1 + 2 = 3 */
+    }
+    *count = k;
+    return t + 4;                                 /* word gap before the text repeats */
+}
+
+void kc_sig_cw(float *x, size_t n, int rate, double hz, double wpm, const char *text, double amp) {
+    enum { MAX_ELEMENTS = 512 };
+    int on[MAX_ELEMENTS], len[MAX_ELEMENTS], count = 0;
+    int pass = cw_keying(text, on, len, MAX_ELEMENTS, &count);
+    if (count == 0 || wpm <= 0.0) return;
+
+    const double dit = 1.2 / wpm * rate;          /* samples per dit (PARIS timing) */
+    const double edge = 0.005 * rate;
+    const double w = 2.0 * M_PI * hz / rate;
+    const size_t passSamples = (size_t)(pass * dit);
+    for (size_t base = 0; base < n; base += passSamples) {
+        for (int k = 0; k < count; k++) {
+            size_t s0 = base + (size_t)(on[k] * dit);
+            size_t s1 = base + (size_t)((on[k] + len[k]) * dit);
+            for (size_t i = s0; i < s1 && i < n; i++) {
+                double a = 1.0, t0 = (double)(i - s0), t1 = (double)(s1 - i);
+                if (t0 < edge) a = 0.5 - 0.5 * cos(M_PI * t0 / edge);
+                else if (t1 < edge) a = 0.5 - 0.5 * cos(M_PI * t1 / edge);
+                x[i] += (float)(amp * a * sin(w * (double)i));
+            }
+        }
+    }
+}
+
+/* ---- Voice ---- */
+
+static const double kVowels[5][3] = {
+    { 730, 1090, 2440 }, { 270, 2290, 3010 }, { 300, 870, 2240 }, { 530, 1840, 2480 }, { 570, 840, 2410 }
+};
+static const double kFormantBw[3] = { 80, 100, 150 };
+
+#define VOICE_MAX_HARMONICS 48
+
+void kc_sig_voice(float *x, size_t n, int rate, uint64_t seed, double amp) {
+    kc_rng r;
+    kc_rng_seed(&r, seed);
+    const double top = fmin(4000.0, 0.5 * rate - 200.0);
+    const double ramp = 0.03 * rate;
+    double phase = 0.0;
+    size_t i = 0;
+    while (i < n) {
+        if (kc_rng_uniform(&r) < 0.2) {                       /* pause */
+            i += (size_t)((0.1 + 0.3 * kc_rng_uniform(&r)) * rate);
+            continue;
+        }
+        size_t dur = (size_t)((0.15 + 0.2 * kc_rng_uniform(&r)) * rate);
+        const double *f = kVowels[kc_rng_next(&r) % 5];
+        double f0a = 90.0 + 130.0 * kc_rng_uniform(&r);
+        double f0b = 90.0 + 130.0 * kc_rng_uniform(&r);
+        double f0m = 0.5 * (f0a + f0b);
+
+        /* Harmonic weights at the syllable's mean pitch: formant resonances × 1/k tilt. */
+        double a[VOICE_MAX_HARMONICS], sum = 0.0;
+        int harmonics = 0;
+        for (int k = 1; k <= VOICE_MAX_HARMONICS && k * f0m < top; k++) {
+            double fk = k * f0m, g = 0.0;
+            for (int j = 0; j < 3; j++) {
+                double d = (fk - f[j]) / kFormantBw[j];
+                g += 1.0 / (1.0 + d * d);
+            }
+            a[k - 1] = g / k;
+            sum += a[k - 1];
+            harmonics = k;
+        }
+        double scale = sum > 0.0 ? amp / sum : 0.0;
+
+        for (size_t t = 0; t < dur && i < n; t++, i++) {
+            double f0 = f0a + (f0b - f0a) * (double)t / (double)dur;
+            phase += 2.0 * M_PI * f0 / rate;
+            if (phase > 2.0 * M_PI) phase -= 2.0 * M_PI;
+            double env = 1.0;
+            if (t < ramp) env = 0.5 - 0.5 * cos(M_PI * t / ramp);
+            else if (dur - t < ramp) env = 0.5 - 0.5 * cos(M_PI * (dur - t) / ramp);
+            double v = 0.0;
+            for (int k = 0; k < harmonics; k++) v += a[k] * sin((k + 1) * phase);
+            x[i] += (float)(scale * env * v);
+        }
+    }
+}
+
+/* ---- 8-FSK (FT8 timing) ---- */
+
+#define FSK8_SYMBOLS 79
+#define FSK8_BAUD    6.25
+#define FSK8_SLOT    15.0
+#define FSK8_START   0.5
+
+void kc_sig_fsk8(float *x, size_t n, int rate, double baseHz, uint64_t seed, double amp) {
+    const size_t slot = (size_t)(FSK8_SLOT * rate);
+    const size_t symLen = (size_t)(rate / FSK8_BAUD);
+    const size_t ramp = (size_t)(0.01 * rate);
+    const size_t txLen = FSK8_SYMBOLS * symLen;
+    for (size_t s0 = 0, slotIndex = 0; s0 < n; s0 += slot, slotIndex++) {
+        kc_rng r;
+        kc_rng_seed(&r, seed + slotIndex);
+        double phase = 0.0;
+        size_t start = s0 + (size_t)(FSK8_START * rate);
+        for (int sym = 0; sym < FSK8_SYMBOLS; sym++) {
+            double w = 2.0 * M_PI * (baseHz + FSK8_BAUD * (double)(kc_rng_next(&r) % 8)) / rate;
+            for (size_t t = 0; t < symLen; t++) {
+                size_t pos = (size_t)sym * symLen + t, i = start + pos;
+                phase += w;
+                if (i >= n) continue;
+                double env = 1.0;
+                if (pos < ramp) env = 0.5 - 0.5 * cos(M_PI * pos / ramp);
+                else if (txLen - pos < ramp) env = 0.5 - 0.5 * cos(M_PI * (txLen - pos) / ramp);
+                x[i] += (float)(amp * env * sin(phase));
+            }
+            phase = fmod(phase, 2.0 * M_PI);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/*  kc_signal.h
+ *
+ *  Deterministic synthetic test signals for the command-line tools: seeded
+ *  white noise, keyed CW, a crude voiced-speech model and 8-FSK with FT8
+ *  timing. Every generator adds into x (so signals and noise can be mixed in
+ *  place) and depends only on its arguments — same seed, same samples, on any
+ *  machine.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* xorshift64* — tiny, fast, reproducible. Seed 0 is remapped to a fixed nonzero value. */
+typedef struct kc_rng { uint64_t s; } kc_rng;
+
+void     kc_rng_seed(kc_rng *r, uint64_t seed);
+uint64_t kc_rng_next(kc_rng *r);
+double   kc_rng_uniform(kc_rng *r);     /* [0, 1) */
+double   kc_rng_gauss(kc_rng *r);       /* N(0, 1) */
+
+/* Gaussian white noise with the given RMS. */
+void kc_sig_noise(float *x, size_t n, double rms, uint64_t seed);
+
+/* Morse `text` (A–Z, 0–9, space; anything else is skipped) at `wpm`, repeated to fill n samples,
+ * 5 ms raised-cosine key edges, peak amplitude `amp`. */
+void kc_sig_cw(float *x, size_t n, int rate, double hz, double wpm, const char *text, double amp);
+
+/* Voiced speech stand-in: a glottal harmonic series with gliding pitch (90–220 Hz) shaped by
+ * vowel formants that change every syllable, with syllable envelopes and pauses. Peak about amp. */
+void kc_sig_voice(float *x, size_t n, int rate, uint64_t seed, double amp);
+
+/* 8-FSK at FT8's timing (6.25 Hz spacing, 0.16 s symbols, 79 symbols per 15 s slot starting
+ * 0.5 s in), continuous phase, random symbols from `seed`. Not a decodable FT8 message. */
+void kc_sig_fsk8(float *x, size_t n, int rate, double baseHz, uint64_t seed, double amp);
+
+/* RMS of x. */
+double kc_sig_rms(const float *x, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,240 @@
+/*  kc_wav.c
+ *
+ *  See kc_wav.h. Input is mmap'd once and read concurrently by worker threads;
+ *  output goes through pwrite so chunks can be written in any order.
+ */
+
+#include "kc_wav.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WAV_HEADER_SIZE 44
+#define WAVE_FORMAT_PCM        1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+static uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static void wr16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void wr32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static int parse_wav(kc_audio_file *f, char *err, size_t errSize) {
+    const uint8_t *p = f->map, *end = f->map + f->mapSize;
+    if (f->mapSize < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0) {
+        snprintf(err, errSize, "not a RIFF/WAVE file (use --raw-rate for headerless PCM)");
+        return -1;
+    }
+    int haveFmt = 0, bits = 0, tag = 0;
+    p += 12;
+    while (p + 8 <= end) {
+        uint32_t size = rd32(p + 4);
+        const uint8_t *body = p + 8;
+        if (memcmp(p, "fmt ", 4) == 0 && size >= 16 && body + 16 <= end) {
+            tag            = rd16(body);
+            f->channels    = rd16(body + 2);
+            f->sampleRate  = (int)rd32(body + 4);
+            bits           = rd16(body + 14);
+            if (tag == WAVE_FORMAT_EXTENSIBLE && size >= 26 && body + 26 <= end)
+                tag = rd16(body + 24);
+            haveFmt = 1;
+        } else if (memcmp(p, "data", 4) == 0) {
+            if (!haveFmt) break;
+            /* Recorders that never finalize the header leave 0 or 0xFFFFFFFF here. */
+            size_t avail = (size_t)(end - body);
+            size_t bytes = (size == 0 || size > avail) ? avail : size;
+            if (tag == WAVE_FORMAT_PCM && bits == 16)             f->format = KC_PCM_S16;
+            else if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 32) f->format = KC_PCM_F32;
+            else {
+                snprintf(err, errSize, "unsupported WAV encoding (format %d, %d bits)", tag, bits);
+                return -1;
+            }
+            if (f->channels < 1 || f->sampleRate < 1000) {
+                snprintf(err, errSize, "bad WAV header (%d channels, %d Hz)", f->channels, f->sampleRate);
+                return -1;
+            }
+            f->data = body;
+            f->frames = bytes / ((size_t)f->channels * (bits / 8));
+            return 0;
+        }
+        p = body + size + (size & 1);
+    }
+    snprintf(err, errSize, "no fmt/data chunk");
+    return -1;
+}
+
+int kc_audio_open(kc_audio_file *f, const char *path, int rawRate, char *err, size_t errSize) {
+    memset(f, 0, sizeof(*f));
+    f->fd = open(path, O_RDONLY);
+    if (f->fd < 0) {
+        snprintf(err, errSize, "%s", strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(f->fd, &st) != 0 || st.st_size == 0) {
+        snprintf(err, errSize, "empty or unreadable file");
+        close(f->fd);
+        return -1;
+    }
+    f->mapSize = (size_t)st.st_size;
+    void *m = mmap(NULL, f->mapSize, PROT_READ, MAP_PRIVATE, f->fd, 0);
+    if (m == MAP_FAILED) {
+        snprintf(err, errSize, "mmap: %s", strerror(errno));
+        close(f->fd);
+        return -1;
+    }
+    f->map = (const uint8_t *)m;
+    /* Worker threads walk the file front to back. */
+    madvise(m, f->mapSize, MADV_SEQUENTIAL);
+
+    if (rawRate > 0) {
+        f->isRaw = 1;
+        f->sampleRate = rawRate;
+        f->channels = 1;
+        f->format = KC_PCM_S16;
+        f->data = f->map;
+        f->frames = f->mapSize / 2;
+        return 0;
+    }
+    if (parse_wav(f, err, errSize) != 0) {
+        kc_audio_close(f);
+        return -1;
+    }
+    return 0;
+}
+
+void kc_audio_close(kc_audio_file *f) {
+    if (f->map) munmap((void *)f->map, f->mapSize);
+    if (f->fd >= 0) close(f->fd);
+    f->map = NULL;
+    f->fd = -1;
+}
+
+void kc_audio_read_mono(const kc_audio_file *f, size_t start, size_t count, float *out) {
+    size_t avail = start < f->frames ? f->frames - start : 0;
+    size_t n = count < avail ? count : avail;
+    const int ch = f->channels;
+    const float scale = 1.0f / (float)ch;
+
+    if (f->format == KC_PCM_S16) {
+        const uint8_t *p = f->data + start * (size_t)ch * 2;
+        for (size_t i = 0; i < n; i++) {
+            float acc = 0.0f;
+            for (int c = 0; c < ch; c++, p += 2)
+                acc += (float)(int16_t)rd16(p);
+            out[i] = acc * scale * (1.0f / 32768.0f);
+        }
+    } else {
+        const uint8_t *p = f->data + start * (size_t)ch * 4;
+        for (size_t i = 0; i < n; i++) {
+            float acc = 0.0f;
+            for (int c = 0; c < ch; c++, p += 4) {
+                float v;
+                memcpy(&v, p, 4);
+                acc += v;
+            }
+            out[i] = acc * scale;
+        }
+    }
+    for (size_t i = n; i < count; i++) out[i] = 0.0f;
+}
+
+static void wav_header(uint8_t *h, int sampleRate, kc_pcm_format format, size_t frames) {
+    int bytesPerSample = format == KC_PCM_S16 ? 2 : 4;
+    uint32_t dataBytes = (uint32_t)(frames * bytesPerSample);
+    memcpy(h, "RIFF", 4);
+    wr32(h + 4, 36 + dataBytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    wr32(h + 16, 16);
+    wr16(h + 20, format == KC_PCM_S16 ? WAVE_FORMAT_PCM : WAVE_FORMAT_IEEE_FLOAT);
+    wr16(h + 22, 1);
+    wr32(h + 24, (uint32_t)sampleRate);
+    wr32(h + 28, (uint32_t)(sampleRate * bytesPerSample));
+    wr16(h + 32, (uint16_t)bytesPerSample);
+    wr16(h + 34, (uint16_t)(bytesPerSample * 8));
+    memcpy(h + 36, "data", 4);
+    wr32(h + 40, dataBytes);
+}
+
+int kc_audio_create_mono(const char *path, int raw, int sampleRate, kc_pcm_format format,
+                         size_t frames, size_t *dataOffset, char *err, size_t errSize) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        snprintf(err, errSize, "%s", strerror(errno));
+        return -1;
+    }
+    size_t off = 0;
+    if (!raw) {
+        uint8_t h[WAV_HEADER_SIZE];
+        wav_header(h, sampleRate, format, frames);
+        if (pwrite(fd, h, sizeof(h), 0) != (ssize_t)sizeof(h)) {
+            snprintf(err, errSize, "write: %s", strerror(errno));
+            close(fd);
+            return -1;
+        }
+        off = WAV_HEADER_SIZE;
+    }
+    size_t bytes = off + frames * (format == KC_PCM_S16 ? 2 : 4);
+    if (ftruncate(fd, (off_t)bytes) != 0) {
+        snprintf(err, errSize, "ftruncate: %s", strerror(errno));
+        close(fd);
+        return -1;
+    }
+    *dataOffset = off;
+    return fd;
+}
+
+int kc_audio_write_mono(int fd, size_t dataOffset, kc_pcm_format format,
+                        size_t startFrame, const float *x, size_t count) {
+    uint8_t stage[1 << 16];
+    const size_t bps = format == KC_PCM_S16 ? 2 : 4;
+    const size_t perPass = sizeof(stage) / bps;
+    size_t done = 0;
+
+    while (done < count) {
+        size_t n = count - done < perPass ? count - done : perPass;
+        if (format == KC_PCM_S16) {
+            for (size_t i = 0; i < n; i++) {
+                float v = x[done + i] * 32768.0f;
+                int s = (int)(v < 0 ? v - 0.5f : v + 0.5f);
+                if (s > 32767) s = 32767;
+                if (s < -32768) s = -32768;
+                wr16(stage + 2 * i, (uint16_t)(int16_t)s);
+            }
+        } else {
+            memcpy(stage, x + done, n * 4);
+        }
+        off_t at = (off_t)(dataOffset + (startFrame + done) * bps);
+        size_t bytes = n * bps, put = 0;
+        while (put < bytes) {
+            ssize_t w = pwrite(fd, stage + put, bytes - put, at + (off_t)put);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            put += (size_t)w;
+        }
+        done += n;
+    }
+    return 0;
+}
+
+int kc_wav_write_file(const char *path, int sampleRate, kc_pcm_format format,
+                      const float *x, size_t count) {
+    char err[128];
+    size_t off;
+    int fd = kc_audio_create_mono(path, 0, sampleRate, format, count, &off, err, sizeof(err));
+    if (fd < 0) return -1;
+    int rc = kc_audio_write_mono(fd, off, format, 0, x, count);
+    close(fd);
+    return rc;
+}
@@ -0,0 +1,60 @@
+/*  kc_wav.h
+ *
+ *  Memory-mapped WAV / raw PCM input and positioned (pwrite) mono output
+ *  for the command-line tools.
+ *
+ *  Input: RIFF WAVE with 16-bit PCM or 32-bit IEEE float samples (any channel
+ *  count, WAVE_FORMAT_EXTENSIBLE accepted), or headerless s16le mono.
+ *  Reads mix all channels down to mono float in [-1, 1].
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    KC_PCM_S16 = 1,
+    KC_PCM_F32 = 3
+} kc_pcm_format;
+
+typedef struct kc_audio_file {
+    int            fd;
+    const uint8_t *map;         /* whole file, read-only */
+    size_t         mapSize;
+    const uint8_t *data;        /* first sample frame */
+    size_t         frames;      /* sample frames in the data chunk */
+    int            sampleRate;
+    int            channels;
+    kc_pcm_format  format;
+    int            isRaw;       /* 1: headerless s16le mono */
+} kc_audio_file;
+
+/* Open and map `path`. rawRate > 0 treats the file as headerless s16le mono at that rate.
+ * Returns 0, or -1 with a message in err (errSize bytes). */
+int  kc_audio_open(kc_audio_file *f, const char *path, int rawRate, char *err, size_t errSize);
+void kc_audio_close(kc_audio_file *f);
+
+/* Mono float samples [start, start+count); frames past the end read as zero. */
+void kc_audio_read_mono(const kc_audio_file *f, size_t start, size_t count, float *out);
+
+/* Create `path` sized for `frames` mono frames, writing a WAV header unless raw.
+ * Returns the fd (data starts at *dataOffset), or -1 with a message in err. */
+int  kc_audio_create_mono(const char *path, int raw, int sampleRate, kc_pcm_format format,
+                          size_t frames, size_t *dataOffset, char *err, size_t errSize);
+
+/* Convert and pwrite `count` mono samples at frame `startFrame` (through a fixed staging
+ * buffer, so any count is fine). Returns 0, or -1 on a write error. */
+int  kc_audio_write_mono(int fd, size_t dataOffset, kc_pcm_format format,
+                         size_t startFrame, const float *x, size_t count);
+
+/* Write a whole mono float buffer as a WAV file (convenience for tools that build audio in memory). */
+int  kc_wav_write_file(const char *path, int sampleRate, kc_pcm_format format,
+                       const float *x, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
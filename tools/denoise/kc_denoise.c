@@ -0,0 +1,318 @@
+/*  kc_denoise.c
+ *
+ *  Offline batch denoiser: runs recorded WAV / raw PCM through the app's NR
+ *  engines (WDSP EMNR, WDSP ANR, RNNoise, in any order) outside the app.
+ *
+ *  Work is split into jobs of one chunk each (default 30 s). A pool of worker
+ *  threads takes jobs from a shared counter, so several files and several
+ *  pieces of one long file run at once. Each chunk is preceded by a warm-up
+ *  stretch of the audio before it (default 4 s) that is processed and thrown
+ *  away, so every chunk starts with a converged noise estimate and RNN state
+ *  and the seams don't show. Input is memory-mapped; each chunk's output is
+ *  written with pwrite at its final offset.
+ *
+ *  Usage: kc-denoise [options] FILE...   (kc-denoise --help)
+ */
+
+#include "kc_chain.h"
+#include "kc_resample.h"
+#include "kc_wav.h"
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct dn_file {
+    const char    *inPath;
+    char          *outPath;
+    kc_audio_file  in;
+    int            outFd;
+    size_t         outOffset;
+    kc_resampler  *up;          /* file rate -> 48 kHz */
+    kc_resampler  *down;        /* 48 kHz -> file rate */
+    int            chunks;
+    atomic_int     chunksLeft;
+    atomic_int     failed;
+} dn_file;
+
+typedef struct dn_job {
+    dn_file *file;
+    size_t   start, end;        /* output frames, file rate */
+} dn_job;
+
+typedef struct dn_opts {
+    kc_nr_kind chain[KC_CHAIN_MAX];
+    int        chainCount;
+    const char *outDir;
+    const char *suffix;
+    int        jobs;
+    double     chunkSeconds;
+    double     warmupSeconds;
+    int        rawRate;
+    int        quiet;
+} dn_opts;
+
+typedef struct dn_ctx {
+    const dn_opts *opts;
+    dn_job        *jobs;
+    int            jobCount;
+    atomic_int     next;
+    pthread_mutex_t printLock;
+} dn_ctx;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-denoise [options] FILE...\n"
+        "  -c, --chain LIST     NR stages in order: emnr, anr, rnnoise, none (default: emnr)\n"
+        "  -o, --out-dir DIR    write outputs to DIR (default: next to each input)\n"
+        "  -s, --suffix SUF     output name suffix before the extension (default: .nr)\n"
+        "  -j, --jobs N         worker threads (default: online CPUs)\n"
+        "      --chunk SEC      split files into SEC-second chunks (default: 30)\n"
+        "      --warmup SEC     audio processed and discarded before each chunk (default: 4)\n"
+        "      --raw-rate HZ    inputs are headerless s16le mono at HZ\n"
+        "  -q, --quiet          only print the summary\n"
+        "Outputs are mono at the input's sample rate and encoding; audio is converted to\n"
+        "48 kHz for processing, as in the app.\n");
+}
+
+static char *output_path(const dn_opts *o, const char *in) {
+    const char *base = strrchr(in, '/');
+    base = base ? base + 1 : in;
+    const char *dot = strrchr(base, '.');
+    size_t stem = dot ? (size_t)(dot - base) : strlen(base);
+    const char *ext = o->rawRate > 0 ? (dot ? dot : ".raw") : ".wav";
+    size_t dirLen = o->outDir ? strlen(o->outDir) + 1 : (size_t)(base - in);
+    size_t len = dirLen + stem + strlen(o->suffix) + strlen(ext) + 1;
+    char *out = (char *)malloc(len);
+    if (!out) return NULL;
+    if (o->outDir) snprintf(out, len, "%s/%.*s%s%s", o->outDir, (int)stem, base, o->suffix, ext);
+    else           snprintf(out, len, "%.*s%.*s%s%s", (int)(base - in), in, (int)stem, base, o->suffix, ext);
+    return out;
+}
+
+/* One chunk: [start - warmup, end + delay + margin) at the file rate → 48 kHz → chain →
+ * drop the chain delay → back to the file rate → write [start, end). */
+static int run_job(const dn_opts *o, const dn_job *job) {
+    dn_file *f = job->file;
+    const int rate = f->in.sampleRate;
+    const size_t warm = (size_t)(o->warmupSeconds * rate);
+    const size_t pre = job->start < warm ? job->start : warm;
+    const size_t seg0 = job->start - pre;
+
+    kc_chain *chain = kc_chain_create(o->chain, o->chainCount);
+    if (!chain) return -1;
+    const int delay48 = kc_chain_delay(chain);
+    const size_t margin = (size_t)kc_resample_reach(f->up) + (size_t)kc_resample_reach(f->down) + 16;
+    const size_t delaySrc = (size_t)(((long long)delay48 * rate + KC_CHAIN_RATE - 1) / KC_CHAIN_RATE);
+    const size_t segLen = pre + (job->end - job->start) + delaySrc + margin;
+
+    size_t n48 = kc_resample_length(f->up, segLen);
+    size_t n48Padded = (n48 + KC_CHAIN_FRAME - 1) / KC_CHAIN_FRAME * KC_CHAIN_FRAME;
+    float *src = (float *)malloc(segLen * sizeof(float));
+    float *x48 = (float *)calloc(n48Padded, sizeof(float));
+    size_t nBack = kc_resample_length(f->down, n48 - (size_t)delay48);
+    float *back = (float *)malloc((nBack ? nBack : 1) * sizeof(float));
+    int rc = -1;
+    if (!src || !x48 || !back) goto done;
+
+    kc_audio_read_mono(&f->in, seg0, segLen, src);
+    kc_resample(f->up, src, segLen, x48);
+    kc_chain_process(chain, x48, (int)n48Padded);
+    kc_resample(f->down, x48 + delay48, n48 - (size_t)delay48, back);
+
+    size_t want = job->end - job->start;
+    if (pre + want > nBack) goto done;      /* margin too small: shouldn't happen */
+    rc = kc_audio_write_mono(f->outFd, f->outOffset, f->in.format, job->start, back + pre, want);
+
+done:
+    free(back);
+    free(x48);
+    free(src);
+    kc_chain_destroy(chain);
+    return rc;
+}
+
+static void *worker(void *arg) {
+    dn_ctx *ctx = (dn_ctx *)arg;
+    for (;;) {
+        int i = atomic_fetch_add(&ctx->next, 1);
+        if (i >= ctx->jobCount) break;
+        dn_job *job = &ctx->jobs[i];
+        dn_file *f = job->file;
+        if (run_job(ctx->opts, job) != 0) atomic_store(&f->failed, 1);
+        if (atomic_fetch_sub(&f->chunksLeft, 1) == 1 && !ctx->opts->quiet) {
+            pthread_mutex_lock(&ctx->printLock);
+            double secs = (double)f->in.frames / f->in.sampleRate;
+            if (atomic_load(&f->failed))
+                fprintf(stderr, "kc-denoise: %s: processing failed\n", f->inPath);
+            else
+                printf("%s -> %s (%.1f s, %d Hz, %d chunk%s)\n", f->inPath, f->outPath, secs,
+                       f->in.sampleRate, f->chunks, f->chunks == 1 ? "" : "s");
+            pthread_mutex_unlock(&ctx->printLock);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    dn_opts o = {
+        .outDir = NULL, .suffix = ".nr", .jobs = 0,
+        .chunkSeconds = 30.0, .warmupSeconds = 4.0, .rawRate = 0, .quiet = 0
+    };
+    const char *chainSpec = "emnr";
+    enum { OPT_CHUNK = 256, OPT_WARMUP, OPT_RAW };
+    static const struct option longOpts[] = {
+        { "chain",    required_argument, NULL, 'c' },
+        { "out-dir",  required_argument, NULL, 'o' },
+        { "suffix",   required_argument, NULL, 's' },
+        { "jobs",     required_argument, NULL, 'j' },
+        { "chunk",    required_argument, NULL, OPT_CHUNK },
+        { "warmup",   required_argument, NULL, OPT_WARMUP },
+        { "raw-rate", required_argument, NULL, OPT_RAW },
+        { "quiet",    no_argument,       NULL, 'q' },
+        { "help",     no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int ch;
+    while ((ch = getopt_long(argc, argv, "c:o:s:j:qh", longOpts, NULL)) != -1) {
+        switch (ch) {
+        case 'c': chainSpec = optarg; break;
+        case 'o': o.outDir = optarg; break;
+        case 's': o.suffix = optarg; break;
+        case 'j': o.jobs = atoi(optarg); break;
+        case 'q': o.quiet = 1; break;
+        case OPT_CHUNK:  o.chunkSeconds = atof(optarg); break;
+        case OPT_WARMUP: o.warmupSeconds = atof(optarg); break;
+        case OPT_RAW:    o.rawRate = atoi(optarg); break;
+        case 'h': usage(stdout); return 0;
+        default:  usage(stderr); return 2;
+        }
+    }
+    if (optind >= argc) { usage(stderr); return 2; }
+    o.chainCount = kc_chain_parse(chainSpec, o.chain, KC_CHAIN_MAX);
+    if (o.chainCount < 0) {
+        fprintf(stderr, "kc-denoise: bad --chain '%s' (stages: emnr, anr, rnnoise, none%s)\n", chainSpec,
+                kc_nr_available(KC_NR_EMNR) ? "" : "; emnr/anr need a build with FFTW");
+        return 2;
+    }
+    if (o.chunkSeconds < 1.0 || o.warmupSeconds < 0.0) {
+        fprintf(stderr, "kc-denoise: --chunk must be >= 1 s and --warmup >= 0\n");
+        return 2;
+    }
+    if (o.jobs <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        o.jobs = n > 0 ? (int)n : 1;
+    }
+
+    int fileCount = argc - optind, opened = 0, status = 0;
+    dn_file *files = (dn_file *)calloc((size_t)fileCount, sizeof(dn_file));
+    if (!files) return 1;
+
+    int jobCount = 0;
+    for (int i = 0; i < fileCount; i++) {
+        dn_file *f = &files[opened];
+        char err[256];
+        f->inPath = argv[optind + i];
+        if (kc_audio_open(&f->in, f->inPath, o.rawRate, err, sizeof(err)) != 0) {
+            fprintf(stderr, "kc-denoise: %s: %s\n", f->inPath, err);
+            status = 1;
+            continue;
+        }
+        f->up = kc_resampler_create(f->in.sampleRate, KC_CHAIN_RATE);
+        f->down = kc_resampler_create(KC_CHAIN_RATE, f->in.sampleRate);
+        f->outPath = output_path(&o, f->inPath);
+        if (!f->up || !f->down || !f->outPath) {
+            fprintf(stderr, "kc-denoise: %s: unsupported sample rate %d\n", f->inPath, f->in.sampleRate);
+            goto skip;
+        }
+        f->outFd = kc_audio_create_mono(f->outPath, f->in.isRaw, f->in.sampleRate, f->in.format,
+                                        f->in.frames, &f->outOffset, err, sizeof(err));
+        if (f->outFd < 0) {
+            fprintf(stderr, "kc-denoise: %s: %s\n", f->outPath, err);
+            goto skip;
+        }
+        size_t chunk = (size_t)(o.chunkSeconds * f->in.sampleRate);
+        f->chunks = f->in.frames == 0 ? 0 : (int)((f->in.frames + chunk - 1) / chunk);
+        atomic_init(&f->chunksLeft, f->chunks);
+        atomic_init(&f->failed, 0);
+        jobCount += f->chunks;
+        opened++;
+        continue;
+    skip:
+        kc_resampler_destroy(f->up);
+        kc_resampler_destroy(f->down);
+        free(f->outPath);
+        kc_audio_close(&f->in);
+        memset(f, 0, sizeof(*f));
+        status = 1;
+    }
+
+    dn_job *jobs = (dn_job *)calloc(jobCount ? (size_t)jobCount : 1, sizeof(dn_job));
+    if (!jobs) return 1;
+    int j = 0;
+    double audioSeconds = 0.0;
+    for (int i = 0; i < opened; i++) {
+        dn_file *f = &files[i];
+        size_t chunk = (size_t)(o.chunkSeconds * f->in.sampleRate);
+        for (size_t s = 0; s < f->in.frames; s += chunk) {
+            jobs[j].file = f;
+            jobs[j].start = s;
+            jobs[j].end = s + chunk < f->in.frames ? s + chunk : f->in.frames;
+            j++;
+        }
+        audioSeconds += (double)f->in.frames / f->in.sampleRate;
+    }
+
+    dn_ctx ctx = { .opts = &o, .jobs = jobs, .jobCount = jobCount };
+    atomic_init(&ctx.next, 0);
+    pthread_mutex_init(&ctx.printLock, NULL);
+
+    int threads = o.jobs < jobCount ? o.jobs : (jobCount > 0 ? jobCount : 1);
+    pthread_t *tids = (pthread_t *)calloc((size_t)threads, sizeof(pthread_t));
+    double t0 = now_seconds();
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&tids[t], NULL, worker, &ctx) != 0) break;
+        started++;
+    }
+    if (started == 0) worker(&ctx);
+    for (int t = 0; t < started; t++) pthread_join(tids[t], NULL);
+    double wall = now_seconds() - t0;
+
+    for (int i = 0; i < opened; i++) {
+        dn_file *f = &files[i];
+        if (atomic_load(&f->failed)) status = 1;
+        close(f->outFd);
+        kc_audio_close(&f->in);
+        kc_resampler_destroy(f->up);
+        kc_resampler_destroy(f->down);
+        free(f->outPath);
+    }
+
+    char chainDesc[128] = "";
+    for (int i = 0; i < o.chainCount; i++) {
+        strncat(chainDesc, kc_nr_name(o.chain[i]), sizeof(chainDesc) - strlen(chainDesc) - 2);
+        if (i + 1 < o.chainCount) strcat(chainDesc, ",");
+    }
+    printf("chain %s: %d file%s, %.1f s of audio in %.2f s with %d thread%s = %.1fx real time\n",
+           chainDesc, opened, opened == 1 ? "" : "s", audioSeconds, wall, started ? started : 1,
+           started == 1 ? "" : "s", wall > 0 ? audioSeconds / wall : 0.0);
+
+    free(tids);
+    free(jobs);
+    free(files);
+    pthread_mutex_destroy(&ctx.printLock);
+    return status;
+}
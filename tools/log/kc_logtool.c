@@ -0,0 +1,369 @@
+/*  kc_logtool.c
+ *
+ *  The app's diagnostic log (kc_log) from the command line.
+ *
+ *  decode: prints binary logs as the text log would have them, oldest file
+ *  first when given path.2 path.1 path. --level drops records below a
+ *  level; --stats prints the records per format instead.
+ *
+ *  bench: --clients threads each log --records records, mostly CAT frames
+ *  like TS890Connection's "RX: ..." lines with some free text, either flat
+ *  out or at --rate a second each. Three ways:
+ *
+ *    old      a C rendering of AppFileLogger before kc_log: per line, a
+ *             local-time timestamp formatted from scratch, then on one
+ *             serial queue (a mutex here) a stat for the rotation check
+ *             and an open, seek, write and close.
+ *    text     kc_log writing the text file.
+ *    binary   kc_log writing binary records.
+ *
+ *  Reported: the time a log call takes in the thread that makes it
+ *  (sampled), the time until everything is in the file, the bytes and
+ *  write calls it took, and records dropped. The files are read back
+ *  afterwards; a count that does not add up exits 1.
+ *
+ *  Usage: kc-log decode|bench [options]   (kc-log --help)
+ */
+
+#include "kc_log.h"
+#include "kc_signal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* ---- decode ---- */
+
+static int parse_level(const char *s, kc_log_level *out) {
+    if (!strcmp(s, "debug")) *out = KC_LOG_DEBUG;
+    else if (!strcmp(s, "info")) *out = KC_LOG_INFO;
+    else if (!strcmp(s, "error")) *out = KC_LOG_ERROR;
+    else return -1;
+    return 0;
+}
+
+static int decode(char **paths, int count, kc_log_level minLevel, int stats) {
+    int status = 0;
+    for (int f = 0; f < count; f++) {
+        char err[512];
+        kc_log_reader *r = kc_log_reader_open(paths[f], err, sizeof err);
+        if (!r) {
+            fprintf(stderr, "kc-log: %s\n", err);
+            status = 1;
+            continue;
+        }
+        uint64_t perFormat[256] = { 0 }, records = 0;
+        const char *templ[256] = { 0 };
+        kc_log_item it;
+        char line[KC_LOG_MAX_TEXT + 512];
+        int rc;
+        while ((rc = kc_log_reader_next(r, &it)) == 1) {
+            records++;
+            perFormat[it.format]++;
+            templ[it.format] = it.templ;
+            if (stats || it.level < minLevel) continue;
+            fwrite(line, 1, kc_log_render(&it, line, sizeof line), stdout);
+        }
+        if (rc < 0) {
+            fprintf(stderr, "kc-log: %s: cut off or corrupt after %llu records\n", paths[f],
+                    (unsigned long long)records);
+            status = 1;
+        }
+        if (stats) {
+            printf("%s: pid %u, %llu records\n", paths[f], kc_log_reader_pid(r), (unsigned long long)records);
+            for (int i = 0; i < 256; i++)
+                if (perFormat[i]) printf("  %10llu  %s\n", (unsigned long long)perFormat[i], templ[i]);
+        }
+        kc_log_reader_close(r);
+    }
+    return status;
+}
+
+/* ---- bench ---- */
+
+typedef enum { WAY_OLD, WAY_TEXT, WAY_BINARY } bench_way;
+
+typedef struct bench_opts {
+    int         clients;
+    long        records;                /* per client */
+    double      rate;                   /* per client per second; 0: flat out */
+    size_t      ringBytes;
+    const char *dir;
+    uint64_t    seed;
+} bench_opts;
+
+typedef struct bench_client {
+    const bench_opts *o;
+    bench_way   way;
+    const char *path;
+    int         index;
+    uint64_t   *samples;                /* every 16th call */
+    size_t      sampled;
+} bench_client;
+
+static const char *const g_frames[] = {
+    "FA00014074000", "FA00014074010", "FA00014074020", "SM0012", "SM0015", "FB00014076000",
+    "OM02", "RG255", "PC100", "MD2", "BY00", "FR0", "FT0", "SQ000", "AG090",
+};
+#define FRAME_COUNT (sizeof g_frames / sizeof g_frames[0])
+
+/* What the old AppFileLogger did per line. The mutex stands in for its serial queue. */
+static pthread_mutex_t g_oldLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void old_log(const char *path, const char *message) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    struct tm tm;
+    localtime_r(&ts.tv_sec, &tm);
+    char stamp[32], line[KC_LOG_MAX_TEXT + 64];
+    strftime(stamp, sizeof stamp, "%Y-%m-%d %H:%M:%S", &tm);
+    int n = snprintf(line, sizeof line, "[%s.%03ld] %s\n", stamp, ts.tv_nsec / 1000000, message);
+
+    pthread_mutex_lock(&g_oldLock);
+    struct stat st;
+    stat(path, &st);                    /* rotateIfNeeded */
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+    if (fd >= 0) {
+        lseek(fd, 0, SEEK_END);
+        if (write(fd, line, (size_t)n) < 0) perror("kc-log: write");
+        close(fd);
+    }
+    pthread_mutex_unlock(&g_oldLock);
+}
+
+static void *client_main(void *arg) {
+    bench_client *c = arg;
+    kc_rng rng;
+    kc_rng_seed(&rng, c->o->seed + (uint64_t)c->index * 7919);
+    uint64_t interval = c->o->rate > 0.0 ? (uint64_t)(1e9 / c->o->rate) : 0, next = now_ns();
+    char text[128];
+    for (long i = 0; i < c->o->records; i++) {
+        if (interval) {
+            next += interval;
+            uint64_t t;
+            while ((t = now_ns()) < next) {
+                struct timespec d = { 0, (long)(next - t) };
+                nanosleep(&d, NULL);
+            }
+        }
+        uint64_t r = kc_rng_next(&rng);
+        int isText = r % 5 == 0;
+        const char *frame = g_frames[(r >> 8) % FRAME_COUNT];
+        if (isText)
+            snprintf(text, sizeof text, "LAN audio: %llu packets, %llu late, jitter buffer %u ms",
+                     (unsigned long long)i, (unsigned long long)(r >> 40), (unsigned)(r >> 20) % 200);
+        int sample = (i & 15) == 0;
+        uint64_t start = sample ? now_ns() : 0;
+        if (c->way == WAY_OLD) {
+            char line[160];
+            if (!isText) snprintf(line, sizeof line, "RX: %s;", frame);
+            old_log(c->path, isText ? text : line);
+        } else if (isText) {
+            kc_log_text(KC_LOG_INFO, text, strlen(text));
+        } else {
+            kc_log_write(KC_LOG_INFO, KC_LOG_FMT_CAT_RX, NULL, 0, frame, strlen(frame));
+        }
+        if (sample) c->samples[c->sampled++] = now_ns() - start;
+    }
+    return NULL;
+}
+
+/* Lines other than kc_log's own "dropped" notes. */
+static long count_lines(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    long n = 0;
+    char line[KC_LOG_MAX_TEXT + 512];
+    while (fgets(line, sizeof line, f)) n += strstr(line, "log records dropped") == NULL;
+    fclose(f);
+    return n;
+}
+
+static long count_records(const char *path) {
+    char err[512];
+    kc_log_reader *r = kc_log_reader_open(path, err, sizeof err);
+    if (!r) {
+        fprintf(stderr, "kc-log: %s\n", err);
+        return -1;
+    }
+    kc_log_item it;
+    long n = 0;
+    int rc;
+    while ((rc = kc_log_reader_next(r, &it)) == 1) n += it.format != KC_LOG_FMT_DROPPED;
+    kc_log_reader_close(r);
+    return rc < 0 ? -1 : n;
+}
+
+static int bench_way_run(const bench_opts *o, bench_way way) {
+    static const char *const names[] = { "old (open/write/close per line)", "kc_log, text file", "kc_log, binary file" };
+    char path[1024];
+    snprintf(path, sizeof path, "%s/kc-log-bench-%d.%s", o->dir, (int)getpid(), way == WAY_BINARY ? "kclog" : "log");
+    unlink(path);
+
+    if (way != WAY_OLD) {
+        kc_log_config cfg = { .path = path, .binary = way == WAY_BINARY, .maxBytes = (size_t)1 << 40,
+                              .ringBytes = o->ringBytes };
+        if (kc_log_open(&cfg) != 0) {
+            fprintf(stderr, "kc-log: %s: %s\n", path, strerror(errno));
+            return 1;
+        }
+    }
+    kc_log_stats before;
+    kc_log_read_stats(&before);
+
+    bench_client *clients = calloc((size_t)o->clients, sizeof *clients);
+    pthread_t *threads = calloc((size_t)o->clients, sizeof *threads);
+    uint64_t start = now_ns();
+    for (int i = 0; i < o->clients; i++) {
+        clients[i] = (bench_client){ .o = o, .way = way, .path = path, .index = i,
+                                     .samples = malloc(((size_t)o->records / 16 + 1) * sizeof(uint64_t)) };
+        pthread_create(&threads[i], NULL, client_main, &clients[i]);
+    }
+    for (int i = 0; i < o->clients; i++) pthread_join(threads[i], NULL);
+    uint64_t logged = now_ns();
+    if (way != WAY_OLD) kc_log_close();
+    uint64_t done = now_ns();
+
+    size_t total = 0;
+    for (int i = 0; i < o->clients; i++) total += clients[i].sampled;
+    uint64_t *all = malloc((total + 1) * sizeof *all);
+    size_t k = 0;
+    double sum = 0.0;
+    for (int i = 0; i < o->clients; i++) {
+        for (size_t j = 0; j < clients[i].sampled; j++) {
+            all[k++] = clients[i].samples[j];
+            sum += (double)clients[i].samples[j];
+        }
+        free(clients[i].samples);
+    }
+    qsort(all, total, sizeof *all, cmp_u64);
+
+    long records = (long)o->clients * o->records;
+    kc_log_stats st;
+    kc_log_read_stats(&st);
+    uint64_t dropped = st.dropped - before.dropped;
+    struct stat fs;
+    long long bytes = stat(path, &fs) == 0 ? (long long)fs.st_size : -1;
+
+    printf("%s, %d clients x %ld records\n", names[way], o->clients, o->records);
+    printf("  call       mean %8.0f ns   p50 %8llu ns   p99 %8llu ns   max %8llu ns\n",
+           total ? sum / (double)total : 0.0, (unsigned long long)(total ? all[total / 2] : 0),
+           (unsigned long long)(total ? all[total * 99 / 100] : 0), (unsigned long long)(total ? all[total - 1] : 0));
+    printf("  logged     %8.1f ms  (%.0f records/s)   in the file after %.1f ms\n",
+           (double)(logged - start) / 1e6, (double)records * 1e9 / (double)(logged - start),
+           (double)(done - start) / 1e6);
+    if (way == WAY_OLD)
+        printf("  file       %lld bytes, %ld writes\n", bytes, records);
+    else
+        printf("  file       %lld bytes, %llu writes, %llu dropped\n", bytes,
+               (unsigned long long)(st.writes - before.writes), (unsigned long long)dropped);
+
+    long found = way == WAY_BINARY ? count_records(path) : count_lines(path);
+    long expected = records - (long)dropped;
+    int status = 0;
+    if (found != expected) {
+        printf("  check      FAILED: %ld records in the file, expected %ld\n", found, expected);
+        status = 1;
+    }
+    unlink(path);
+    free(all);
+    free(clients);
+    free(threads);
+    return status;
+}
+
+static int bench(const bench_opts *o, const char *only) {
+    int status = 0;
+    if (!only || !strcmp(only, "old")) status |= bench_way_run(o, WAY_OLD);
+    if (!only || !strcmp(only, "text")) status |= bench_way_run(o, WAY_TEXT);
+    if (!only || !strcmp(only, "binary")) status |= bench_way_run(o, WAY_BINARY);
+    return status;
+}
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-log decode [options] FILE...   print binary logs as text\n"
+        "       kc-log bench [options]            log calls through kc_log and the old way\n"
+        "      --level L        decode: only records at L and above: debug (default), info or error\n"
+        "      --stats          decode: records per format instead of the records\n"
+        "  -c, --clients N      bench: logging threads (default 4)\n"
+        "  -n, --records N      bench: records per thread (default 100000)\n"
+        "      --rate R         bench: records per second per thread (default: flat out)\n"
+        "      --ring-kb N      bench: kc_log's ring (default 1024)\n"
+        "      --dir D          bench: where to write the logs (default /tmp)\n"
+        "      --only W         bench: old, text or binary\n"
+        "      --seed N         random seed (default 1)\n"
+        "  -h, --help\n");
+}
+
+int main(int argc, char **argv) {
+    bench_opts o = { .clients = 4, .records = 100000, .ringBytes = (size_t)1 << 20, .dir = "/tmp", .seed = 1 };
+    kc_log_level level = KC_LOG_DEBUG;
+    int stats = 0;
+    const char *only = NULL;
+    enum { OPT_LEVEL = 256, OPT_STATS, OPT_RATE, OPT_RING_KB, OPT_DIR, OPT_ONLY, OPT_SEED };
+    static const struct option longOpts[] = {
+        { "level", required_argument, NULL, OPT_LEVEL },
+        { "stats", no_argument, NULL, OPT_STATS },
+        { "clients", required_argument, NULL, 'c' },
+        { "records", required_argument, NULL, 'n' },
+        { "rate", required_argument, NULL, OPT_RATE },
+        { "ring-kb", required_argument, NULL, OPT_RING_KB },
+        { "dir", required_argument, NULL, OPT_DIR },
+        { "only", required_argument, NULL, OPT_ONLY },
+        { "seed", required_argument, NULL, OPT_SEED },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "c:n:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case OPT_LEVEL:
+            if (parse_level(optarg, &level) != 0) {
+                usage(stderr);
+                return 2;
+            }
+            break;
+        case OPT_STATS: stats = 1; break;
+        case 'c': o.clients = atoi(optarg); break;
+        case 'n': o.records = atol(optarg); break;
+        case OPT_RATE: o.rate = atof(optarg); break;
+        case OPT_RING_KB: o.ringBytes = (size_t)atol(optarg) << 10; break;
+        case OPT_DIR: o.dir = optarg; break;
+        case OPT_ONLY: only = optarg; break;
+        case OPT_SEED: o.seed = strtoull(optarg, NULL, 10); break;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    if (optind >= argc) {
+        usage(stderr);
+        return 2;
+    }
+    const char *cmd = argv[optind];
+    if (!strcmp(cmd, "decode") && optind + 1 < argc)
+        return decode(argv + optind + 1, argc - optind - 1, level, stats);
+    if (!strcmp(cmd, "bench") && optind + 1 == argc && o.clients > 0 && o.records > 0 && o.rate >= 0.0 &&
+        (!only || !strcmp(only, "old") || !strcmp(only, "text") || !strcmp(only, "binary")))
+        return bench(&o, only);
+    usage(stderr);
+    return 2;
+}
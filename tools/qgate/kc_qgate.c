@@ -0,0 +1,555 @@
+/*  kc_qgate.c
+ *
+ *  Quality-versus-speed gate for NR variants. Clean speech, CW and FT8 are
+ *  mixed with band noise at fixed SNRs; every variant (a chain of engines plus
+ *  optional EMNR quality settings) processes every mix, and the delay-aligned
+ *  output is scored against the clean signal: segmental SNR, log-spectral
+ *  distance, FT8 decodes (when jt9 is available) and CPU time. Each variant
+ *  is then checked cell by cell against a reference variant, and the run
+ *  exits 1 if any variant loses more than the configured margins.
+ *
+ *  A variant's reference is --reference if given, otherwise the variant with
+ *  the same chain and default EMNR settings ("emnr-nopf=emnr:ae=0,post2=0" is
+ *  gated against "emnr=emnr"). Variants without one are only reported.
+ *
+ *  Clean signals default to the kc_signal generators; pass real recordings
+ *  with --clean (a 15 s FT8 slot at any rate is needed for decode counts,
+ *  since the synthetic 8-FSK carries no valid message). Noise defaults to
+ *  white noise band-limited to 6 kHz; pass a band-noise recording with --noise.
+ *
+ *  Usage: kc-qgate [options]   (kc-qgate --help)
+ */
+
+#include "kc_chain.h"
+#include "kc_metrics.h"
+#include "kc_resample.h"
+#include "kc_signal.h"
+#include "kc_wav.h"
+
+#include <errno.h>
+#include <ftw.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define QG_RATE       KC_CHAIN_RATE
+#define QG_FRAME      KC_CHAIN_FRAME
+#define QG_MAX_VARIANTS 16
+#define QG_MAX_SNRS   8
+#define QG_JT9_RATE   12000
+#define QG_LSD_MAX_HZ 4000.0
+
+enum { QG_SPEECH, QG_CW, QG_FT8, QG_SIGNALS };
+static const char *const kSignalNames[QG_SIGNALS] = { "speech", "cw", "ft8" };
+
+typedef struct qg_variant {
+    char       name[48];
+    kc_nr_kind chain[KC_CHAIN_MAX];
+    int        chainCount;
+    int        gainMethod, aeRun, post2Run;     /* -1: leave at the wrapper default */
+    double     cpuNs;                           /* accumulated over all cells */
+    double     audioSamples;
+} qg_variant;
+
+typedef struct qg_score {
+    double segsnr, lsd;
+    int    decodes;                             /* -1: not measured */
+} qg_score;
+
+typedef struct qg_opts {
+    qg_variant  variants[QG_MAX_VARIANTS];
+    int         variantCount;
+    const char *reference;
+    double      snr[QG_MAX_SNRS];
+    int         snrCount;
+    int         useSignal[QG_SIGNALS];
+    const char *cleanPath[QG_SIGNALS];
+    const char *noisePath;
+    int         rawRate;
+    double      seconds, warmup;
+    const char *jt9;
+    const char *keepDir;
+    double      maxSegsnrDrop, maxLsdRise;
+    int         maxDecodeLoss;
+    unsigned long long seed;
+} qg_opts;
+
+/* ---- Variants ---- */
+
+/* NAME=CHAIN[:gain=G,ae=A,post2=P], e.g. "emnr-fast=emnr:gain=0,ae=0". */
+static int parse_variant(const char *spec, qg_variant *v) {
+    memset(v, 0, sizeof(*v));
+    v->gainMethod = v->aeRun = v->post2Run = -1;
+    const char *eq = strchr(spec, '=');
+    if (!eq || eq == spec || (size_t)(eq - spec) >= sizeof(v->name)) return -1;
+    memcpy(v->name, spec, (size_t)(eq - spec));
+
+    char chain[128];
+    const char *colon = strchr(eq + 1, ':');
+    size_t len = colon ? (size_t)(colon - eq - 1) : strlen(eq + 1);
+    if (len == 0 || len >= sizeof(chain)) return -1;
+    memcpy(chain, eq + 1, len);
+    chain[len] = 0;
+    v->chainCount = kc_chain_parse(chain, v->chain, KC_CHAIN_MAX);
+    if (v->chainCount <= 0) return -1;
+
+    for (const char *p = colon ? colon + 1 : NULL; p && *p;) {
+        int value;
+        if (sscanf(p, "gain=%d", &value) == 1) v->gainMethod = value;
+        else if (sscanf(p, "ae=%d", &value) == 1) v->aeRun = value;
+        else if (sscanf(p, "post2=%d", &value) == 1) v->post2Run = value;
+        else return -1;
+        p = strchr(p, ',');
+        if (p) p++;
+    }
+    return 0;
+}
+
+static void default_variants(qg_opts *o) {
+    static const char *const kDefaults[] = {
+        "none=none", "emnr=emnr", "emnr-nopf=emnr:ae=0,post2=0",
+        "anr=anr", "rnnoise=rnnoise", "emnr+rnnoise=emnr,rnnoise"
+    };
+    for (size_t i = 0; i < sizeof(kDefaults) / sizeof(kDefaults[0]); i++) {
+        if (parse_variant(kDefaults[i], &o->variants[o->variantCount]) == 0) o->variantCount++;
+    }
+}
+
+/* r is v's chain at default EMNR quality (and v isn't). */
+static int is_plain_version(const qg_variant *r, const qg_variant *v) {
+    if (r->gainMethod >= 0 || r->aeRun >= 0 || r->post2Run >= 0) return 0;
+    if (v->gainMethod < 0 && v->aeRun < 0 && v->post2Run < 0) return 0;
+    if (r->chainCount != v->chainCount) return 0;
+    return memcmp(r->chain, v->chain, sizeof(kc_nr_kind) * v->chainCount) == 0;
+}
+
+static kc_chain *variant_chain(const qg_variant *v) {
+    kc_chain *c = kc_chain_create(v->chain, v->chainCount);
+    if (c && (v->gainMethod >= 0 || v->aeRun >= 0 || v->post2Run >= 0)) {
+        kc_chain_set_emnr_quality(c, v->gainMethod >= 0 ? v->gainMethod : 2,
+                                  v->aeRun >= 0 ? v->aeRun : 1, v->post2Run >= 0 ? v->post2Run : 0);
+    }
+    return c;
+}
+
+/* ---- Audio ---- */
+
+/* Whole file as 48 kHz mono; NULL on error. */
+static float *load_48k(const char *path, int rawRate, size_t *n) {
+    char err[256];
+    kc_audio_file f;
+    if (kc_audio_open(&f, path, rawRate, err, sizeof(err)) != 0) {
+        fprintf(stderr, "kc-qgate: %s\n", err);
+        return NULL;
+    }
+    kc_resampler *rs = kc_resampler_create(f.sampleRate, QG_RATE);
+    float *mono = (float *)malloc(sizeof(float) * (f.frames ? f.frames : 1));
+    float *out = NULL;
+    if (rs && mono) {
+        kc_audio_read_mono(&f, 0, f.frames, mono);
+        *n = kc_resample_length(rs, f.frames);
+        out = (float *)malloc(sizeof(float) * (*n ? *n : 1));
+        if (out) kc_resample(rs, mono, f.frames, out);
+    } else {
+        fprintf(stderr, "kc-qgate: %s: can't resample %d Hz\n", path, f.sampleRate);
+    }
+    free(mono);
+    kc_resampler_destroy(rs);
+    kc_audio_close(&f);
+    return out;
+}
+
+static float *make_clean(const qg_opts *o, int sig, size_t n) {
+    float *x = (float *)calloc(n, sizeof(float));
+    if (!x) return NULL;
+    if (o->cleanPath[sig]) {
+        size_t len = 0;
+        float *rec = load_48k(o->cleanPath[sig], o->rawRate, &len);
+        if (!rec) { free(x); return NULL; }
+        memcpy(x, rec, sizeof(float) * (len < n ? len : n));
+        free(rec);
+        return x;
+    }
+    switch (sig) {
+    case QG_SPEECH: kc_sig_voice(x, n, QG_RATE, o->seed, 0.3); break;
+    case QG_CW:     kc_sig_cw(x, n, QG_RATE, 700.0, 22.0, "CQ TEST DE K1ABC K1ABC K", 0.3); break;
+    case QG_FT8:    kc_sig_fsk8(x, n, QG_RATE, 1500.0, o->seed, 0.3); break;
+    }
+    return x;
+}
+
+/* n samples of noise: the recording looped, or seeded white noise generated at 12 kHz and
+ * resampled (so it is band-limited like receiver audio). */
+static float *make_noise(const qg_opts *o, size_t n) {
+    float *x = (float *)calloc(n, sizeof(float));
+    if (!x) return NULL;
+    if (o->noisePath) {
+        size_t len = 0;
+        float *rec = load_48k(o->noisePath, o->rawRate, &len);
+        if (!rec || len == 0) { free(rec); free(x); return NULL; }
+        for (size_t i = 0; i < n; i++) x[i] = rec[i % len];
+        free(rec);
+        return x;
+    }
+    kc_resampler *rs = kc_resampler_create(QG_JT9_RATE, QG_RATE);
+    size_t lo = n / (QG_RATE / QG_JT9_RATE) + 1;
+    float *w = (float *)calloc(lo, sizeof(float));
+    if (!rs || !w) { free(w); free(x); kc_resampler_destroy(rs); return NULL; }
+    kc_sig_noise(w, lo, 1.0, o->seed + 100);
+    float *up = (float *)calloc(kc_resample_length(rs, lo), sizeof(float));
+    if (up) {
+        kc_resample(rs, w, lo, up);
+        memcpy(x, up, sizeof(float) * n);
+        free(up);
+    } else {
+        free(x);
+        x = NULL;
+    }
+    free(w);
+    kc_resampler_destroy(rs);
+    return x;
+}
+
+/* ---- jt9 ---- */
+
+static const char *find_in_path(const char *name) {
+    static char found[1024];
+    const char *path = getenv("PATH");
+    for (const char *p = path; p && *p;) {
+        const char *e = strchr(p, ':');
+        size_t len = e ? (size_t)(e - p) : strlen(p);
+        snprintf(found, sizeof(found), "%.*s/%s", (int)len, p, name);
+        if (access(found, X_OK) == 0) return found;
+        if (!e) break;
+        p = e + 1;
+    }
+    return NULL;
+}
+
+static int remove_entry(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    (void)st; (void)flag; (void)ftw;
+    return remove(path);
+}
+
+/* Decodes jt9 finds in x (48 kHz, one slot), or -1 if it couldn't run. */
+static int count_decodes(const char *jt9, const float *x, size_t n) {
+    char dir[] = "/tmp/kc-qgate-XXXXXX";
+    if (!mkdtemp(dir)) return -1;
+    int decodes = -1;
+    kc_resampler *rs = kc_resampler_create(QG_RATE, QG_JT9_RATE);
+    float *lo = rs ? (float *)malloc(sizeof(float) * (kc_resample_length(rs, n) + 1)) : NULL;
+    char wav[64], cmd[2048];
+    snprintf(wav, sizeof(wav), "%s/slot.wav", dir);
+    if (lo) {
+        size_t m = kc_resample_length(rs, n);
+        kc_resample(rs, x, n, lo);
+        for (size_t i = 0; i < m; i++) lo[i] = fmaxf(-1.0f, fminf(1.0f, lo[i]));
+        if (kc_wav_write_file(wav, QG_JT9_RATE, KC_PCM_S16, lo, m) == 0) {
+            snprintf(cmd, sizeof(cmd), "'%s' -8 -a %s -t %s %s 2>/dev/null", jt9, dir, dir, wav);
+            FILE *p = popen(cmd, "r");
+            if (p) {
+                char line[512];
+                decodes = 0;
+                while (fgets(line, sizeof(line), p))
+                    if (strstr(line, " ~ ")) decodes++;
+                if (pclose(p) != 0) decodes = -1;
+            }
+        }
+    }
+    free(lo);
+    kc_resampler_destroy(rs);
+    nftw(dir, remove_entry, 8, FTW_DEPTH | FTW_PHYS);
+    return decodes;
+}
+
+/* ---- Scoring ---- */
+
+static double thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void score(const qg_opts *o, const char *jt9, int sig, const float *clean, const float *test,
+                  size_t n, qg_score *s) {
+    s->segsnr = kc_segsnr(clean, test, n, QG_RATE);
+    s->lsd = kc_lsd(clean, test, n, QG_RATE, QG_LSD_MAX_HZ);
+    s->decodes = sig == QG_FT8 && jt9 && o->cleanPath[QG_FT8] ? count_decodes(jt9, test, n) : -1;
+}
+
+static void keep(const qg_opts *o, const char *what, int sig, double snr, const float *x, size_t n) {
+    if (!o->keepDir) return;
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s_%+.0fdB_%s.wav", o->keepDir, kSignalNames[sig], snr, what);
+    if (kc_wav_write_file(path, QG_RATE, KC_PCM_F32, x, n) != 0)
+        fprintf(stderr, "kc-qgate: can't write %s\n", path);
+}
+
+static void print_row(const char *sig, double snr, const char *who, const qg_score *s, double nsPerFrame) {
+    char dec[16], cpu[32];
+    if (s->decodes >= 0) snprintf(dec, sizeof(dec), "%d", s->decodes);
+    else snprintf(dec, sizeof(dec), "-");
+    if (nsPerFrame >= 0.0) snprintf(cpu, sizeof(cpu), "%.0f", nsPerFrame);
+    else snprintf(cpu, sizeof(cpu), "-");
+    printf("%-7s %+5.0f  %-18s %8.2f %8.2f %7s %11s\n", sig, snr, who, s->segsnr, s->lsd, dec, cpu);
+}
+
+/* ---- main ---- */
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-qgate [options]\n"
+        "  -v, --variant NAME=CHAIN[:gain=G,ae=A,post2=P]\n"
+        "                        a variant to test (repeatable). CHAIN as kc-denoise -c; gain/ae/post2\n"
+        "                        set EMNR quality (wdsp_emnr_set_quality). Default: a built-in set\n"
+        "  -r, --reference NAME  gate every other variant against NAME (default: each variant against\n"
+        "                        the same chain at default EMNR quality, if there is one)\n"
+        "      --snr LIST        mix SNRs in dB (default: -5,0,5,10)\n"
+        "      --signals LIST    speech, cw, ft8 (default: all)\n"
+        "      --clean KIND=FILE clean recording for speech, cw or ft8 (default: synthetic)\n"
+        "      --noise FILE      band-noise recording, looped (default: white noise, 6 kHz wide)\n"
+        "      --raw-rate HZ     treat --clean/--noise files as headerless s16le mono at HZ\n"
+        "      --seconds S       scored length per mix (default: 15)\n"
+        "      --warmup S        noise-only lead-in, not scored (default: 3)\n"
+        "      --jt9 PATH        WSJT-X jt9 for FT8 decode counts (default: jt9 on PATH)\n"
+        "      --keep DIR        write clean, mixed and processed audio to DIR\n"
+        "      --max-segsnr-drop DB   fail if segSNR falls more than DB below the reference (0.5)\n"
+        "      --max-lsd-rise DB      fail if LSD rises more than DB above the reference (0.5)\n"
+        "      --max-decode-loss N    fail if a variant decodes N+1 fewer FT8 messages (0)\n"
+        "      --seed N          seed for synthetic signals and noise (default: 1)\n"
+        "  -h, --help\n");
+}
+
+static int parse_snrs(const char *s, qg_opts *o) {
+    o->snrCount = 0;
+    for (const char *p = s; *p;) {
+        char *end;
+        double v = strtod(p, &end);
+        if (end == p || o->snrCount == QG_MAX_SNRS) return -1;
+        o->snr[o->snrCount++] = v;
+        if (*end != ',') return *end ? -1 : 0;
+        p = end + 1;
+    }
+    return 0;
+}
+
+static int signal_index(const char *name, size_t len) {
+    for (int i = 0; i < QG_SIGNALS; i++)
+        if (strlen(kSignalNames[i]) == len && strncmp(name, kSignalNames[i], len) == 0) return i;
+    return -1;
+}
+
+int main(int argc, char **argv) {
+    qg_opts o;
+    memset(&o, 0, sizeof(o));
+    o.seconds = 15.0;
+    o.warmup = 3.0;
+    o.maxSegsnrDrop = 0.5;
+    o.maxLsdRise = 0.5;
+    o.seed = 1;
+    parse_snrs("-5,0,5,10", &o);
+    for (int i = 0; i < QG_SIGNALS; i++) o.useSignal[i] = 1;
+
+    enum { OPT_SNR = 256, OPT_SIGNALS, OPT_CLEAN, OPT_NOISE, OPT_RAW_RATE, OPT_SECONDS, OPT_WARMUP,
+           OPT_JT9, OPT_KEEP, OPT_SEGSNR_DROP, OPT_LSD_RISE, OPT_DECODE_LOSS, OPT_SEED };
+    static const struct option longOpts[] = {
+        { "variant", required_argument, NULL, 'v' },
+        { "reference", required_argument, NULL, 'r' },
+        { "snr", required_argument, NULL, OPT_SNR },
+        { "signals", required_argument, NULL, OPT_SIGNALS },
+        { "clean", required_argument, NULL, OPT_CLEAN },
+        { "noise", required_argument, NULL, OPT_NOISE },
+        { "raw-rate", required_argument, NULL, OPT_RAW_RATE },
+        { "seconds", required_argument, NULL, OPT_SECONDS },
+        { "warmup", required_argument, NULL, OPT_WARMUP },
+        { "jt9", required_argument, NULL, OPT_JT9 },
+        { "keep", required_argument, NULL, OPT_KEEP },
+        { "max-segsnr-drop", required_argument, NULL, OPT_SEGSNR_DROP },
+        { "max-lsd-rise", required_argument, NULL, OPT_LSD_RISE },
+        { "max-decode-loss", required_argument, NULL, OPT_DECODE_LOSS },
+        { "seed", required_argument, NULL, OPT_SEED },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "v:r:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'v':
+            if (o.variantCount == QG_MAX_VARIANTS || parse_variant(optarg, &o.variants[o.variantCount]) != 0) {
+                fprintf(stderr, "kc-qgate: bad or unavailable variant '%s'\n", optarg);
+                return 2;
+            }
+            o.variantCount++;
+            break;
+        case 'r': o.reference = optarg; break;
+        case OPT_SNR:
+            if (parse_snrs(optarg, &o) != 0 || o.snrCount == 0) { fprintf(stderr, "kc-qgate: bad --snr\n"); return 2; }
+            break;
+        case OPT_SIGNALS:
+            memset(o.useSignal, 0, sizeof(o.useSignal));
+            for (const char *p = optarg; *p;) {
+                const char *e = strchr(p, ',');
+                size_t len = e ? (size_t)(e - p) : strlen(p);
+                int k = signal_index(p, len);
+                if (k < 0) { fprintf(stderr, "kc-qgate: unknown signal '%.*s'\n", (int)len, p); return 2; }
+                o.useSignal[k] = 1;
+                if (!e) break;
+                p = e + 1;
+            }
+            break;
+        case OPT_CLEAN: {
+            const char *eq = strchr(optarg, '=');
+            int k = eq ? signal_index(optarg, (size_t)(eq - optarg)) : -1;
+            if (k < 0) { fprintf(stderr, "kc-qgate: --clean wants speech=, cw= or ft8=FILE\n"); return 2; }
+            o.cleanPath[k] = eq + 1;
+            break;
+        }
+        case OPT_NOISE: o.noisePath = optarg; break;
+        case OPT_RAW_RATE: o.rawRate = atoi(optarg); break;
+        case OPT_SECONDS: o.seconds = atof(optarg); break;
+        case OPT_WARMUP: o.warmup = atof(optarg); break;
+        case OPT_JT9: o.jt9 = optarg; break;
+        case OPT_KEEP: o.keepDir = optarg; break;
+        case OPT_SEGSNR_DROP: o.maxSegsnrDrop = atof(optarg); break;
+        case OPT_LSD_RISE: o.maxLsdRise = atof(optarg); break;
+        case OPT_DECODE_LOSS: o.maxDecodeLoss = atoi(optarg); break;
+        case OPT_SEED: o.seed = strtoull(optarg, NULL, 10); break;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    if (o.seconds <= 0.0 || o.warmup < 0.0) { usage(stderr); return 2; }
+    if (o.variantCount == 0) default_variants(&o);
+
+    int refFor[QG_MAX_VARIANTS];
+    for (int v = 0; v < o.variantCount; v++) {
+        refFor[v] = -1;
+        for (int r = 0; r < o.variantCount && refFor[v] < 0; r++) {
+            if (r == v) continue;
+            if (o.reference ? strcmp(o.variants[r].name, o.reference) == 0 : is_plain_version(&o.variants[r], &o.variants[v]))
+                refFor[v] = r;
+        }
+    }
+    if (o.reference) {
+        int found = 0;
+        for (int v = 0; v < o.variantCount; v++) found |= strcmp(o.variants[v].name, o.reference) == 0;
+        if (!found) { fprintf(stderr, "kc-qgate: no variant named %s\n", o.reference); return 2; }
+    }
+    const char *jt9 = o.jt9 ? o.jt9 : find_in_path("jt9");
+    if (o.useSignal[QG_FT8] && !(jt9 && o.cleanPath[QG_FT8]))
+        fprintf(stderr, "kc-qgate: FT8 decode counts need --clean ft8=FILE and jt9; not measured\n");
+    if (o.keepDir) mkdir(o.keepDir, 0777);
+
+    const size_t lead = (size_t)(o.warmup * QG_RATE) / QG_FRAME * QG_FRAME;
+    const size_t scored = (size_t)(o.seconds * QG_RATE);
+    int maxDelay = 0;
+    for (int v = 0; v < o.variantCount; v++) {
+        kc_chain *ch = variant_chain(&o.variants[v]);
+        if (ch && kc_chain_delay(ch) > maxDelay) maxDelay = kc_chain_delay(ch);
+        kc_chain_destroy(ch);
+    }
+    /* Mix = lead-in noise, then clean + noise, then enough extra noise to flush the longest delay. */
+    const size_t total = (lead + scored + maxDelay + QG_FRAME - 1) / QG_FRAME * QG_FRAME;
+
+    float *noise = make_noise(&o, total);
+    float *mix = (float *)malloc(sizeof(float) * total);
+    float *work = (float *)malloc(sizeof(float) * total);
+    qg_score *scores = (qg_score *)calloc((size_t)QG_SIGNALS * QG_MAX_SNRS * o.variantCount, sizeof(qg_score));
+    if (!noise || !mix || !work || !scores) { fprintf(stderr, "kc-qgate: out of memory\n"); return 1; }
+#define SCORE(sig, k, v) scores[((sig) * QG_MAX_SNRS + (k)) * o.variantCount + (v)]
+
+    double noisePower = 0.0;
+    for (size_t i = 0; i < total; i++) noisePower += (double)noise[i] * noise[i];
+    noisePower /= total;
+
+    printf("%-7s %5s  %-18s %8s %8s %7s %11s\n", "signal", "SNR", "variant", "segSNR", "LSD", "decodes", "ns/frame");
+    for (int sig = 0; sig < QG_SIGNALS; sig++) {
+        if (!o.useSignal[sig]) continue;
+        float *clean = make_clean(&o, sig, scored);
+        if (!clean) return 1;
+        double cleanPower = kc_sig_rms(clean, scored);
+        cleanPower *= cleanPower;
+        if (cleanPower <= 0.0) { fprintf(stderr, "kc-qgate: %s reference is silent\n", kSignalNames[sig]); return 1; }
+        keep(&o, "clean", sig, 0.0, clean, scored);
+
+        for (int k = 0; k < o.snrCount; k++) {
+            double g = sqrt(cleanPower / (noisePower * pow(10.0, o.snr[k] / 10.0)));
+            for (size_t i = 0; i < total; i++) mix[i] = (float)(g * noise[i]);
+            for (size_t i = 0; i < scored; i++) mix[lead + i] += clean[i];
+
+            qg_score in;
+            score(&o, jt9, sig, clean, mix + lead, scored, &in);
+            print_row(kSignalNames[sig], o.snr[k], "(unprocessed)", &in, -1.0);
+            keep(&o, "mix", sig, o.snr[k], mix + lead, scored);
+
+            for (int v = 0; v < o.variantCount; v++) {
+                qg_variant *var = &o.variants[v];
+                kc_chain *ch = variant_chain(var);
+                if (!ch) { fprintf(stderr, "kc-qgate: can't create %s\n", var->name); return 1; }
+                memcpy(work, mix, sizeof(float) * total);
+                double t0 = thread_cpu_ns();
+                kc_chain_process(ch, work, (int)total);
+                double t1 = thread_cpu_ns();
+                var->cpuNs += t1 - t0;
+                var->audioSamples += total;
+                const float *out = work + lead + kc_chain_delay(ch);
+                kc_chain_destroy(ch);
+
+                qg_score *s = &SCORE(sig, k, v);
+                score(&o, jt9, sig, clean, out, scored, s);
+                print_row(kSignalNames[sig], o.snr[k], var->name, s, (t1 - t0) * QG_FRAME / total);
+                keep(&o, var->name, sig, o.snr[k], out, scored);
+            }
+            fflush(stdout);
+        }
+        free(clean);
+    }
+
+    printf("\nCPU (all mixes)      ns/frame       rtf\n");
+    for (int v = 0; v < o.variantCount; v++) {
+        const qg_variant *var = &o.variants[v];
+        double nsPerFrame = var->audioSamples > 0 ? var->cpuNs * QG_FRAME / var->audioSamples : 0.0;
+        printf("  %-18s %10.0f %9.5f\n", var->name, nsPerFrame, nsPerFrame / (1e9 * QG_FRAME / QG_RATE));
+    }
+
+    int failures = 0;
+    printf("\nGate: segSNR drop <= %.2f dB, LSD rise <= %.2f dB, decode loss <= %d\n",
+           o.maxSegsnrDrop, o.maxLsdRise, o.maxDecodeLoss);
+    for (int v = 0; v < o.variantCount; v++) {
+        int ref = refFor[v];
+        if (ref < 0) continue;
+        int bad = 0;
+        for (int sig = 0; sig < QG_SIGNALS; sig++) {
+            if (!o.useSignal[sig]) continue;
+            for (int k = 0; k < o.snrCount; k++) {
+                const qg_score *r = &SCORE(sig, k, ref), *s = &SCORE(sig, k, v);
+                char why[128] = "";
+                if (r->segsnr - s->segsnr > o.maxSegsnrDrop)
+                    snprintf(why, sizeof(why), "segSNR %.2f < %.2f", s->segsnr, r->segsnr);
+                else if (s->lsd - r->lsd > o.maxLsdRise)
+                    snprintf(why, sizeof(why), "LSD %.2f > %.2f", s->lsd, r->lsd);
+                else if (r->decodes >= 0 && s->decodes >= 0 && r->decodes - s->decodes > o.maxDecodeLoss)
+                    snprintf(why, sizeof(why), "decodes %d < %d", s->decodes, r->decodes);
+                if (why[0]) {
+                    printf("  FAIL %-18s vs %s, %s at %+.0f dB: %s\n", o.variants[v].name, o.variants[ref].name,
+                           kSignalNames[sig], o.snr[k], why);
+                    bad = 1;
+                }
+            }
+        }
+        if (!bad) printf("  pass %-18s vs %s\n", o.variants[v].name, o.variants[ref].name);
+        failures += bad;
+    }
+#undef SCORE
+
+    free(scores);
+    free(work);
+    free(mix);
+    free(noise);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,507 @@
+/*  kc_replay.c
+ *
+ *  Works with traffic captures (Native/kc_capture: RTP audio and CAT bytes
+ *  with timestamps, recorded by the app with KC_CAPTURE=path), so a field
+ *  problem can be looked at, replayed and regression-tested on a machine
+ *  with no radio.
+ *
+ *    info FILE              what is in a capture: records per kind, RTP
+ *                           sequence gaps and arrival spacing, CAT rates
+ *    run FILE               replays the received RTP into a copy of the
+ *                           app's LAN RX pipeline (kc_replay) and reports
+ *                           what it did: jitter buffer and concealment
+ *                           counts, stage timings, a hash of the 48 kHz
+ *                           output (and the output itself with -o)
+ *    send FILE HOST[:PORT]  replays the received RTP over UDP to a running
+ *                           app, paced like the original
+ *    cat FILE               prints the CAT traffic with timestamps
+ *    synth FILE             writes a synthetic capture (a tone stream with
+ *                           arrival jitter, CAT polls and an AI burst)
+ *
+ *  run and send take the same perturbations (--jitter, --loss, --reorder,
+ *  --seed) and --speed. The pipeline runs on replay time, so run's output
+ *  and hash depend only on the capture, the options and the build; with
+ *  --expect HASH it exits 1 on a mismatch, to gate changes to the receive
+ *  path.
+ *
+ *  Usage: kc-replay COMMAND [options] FILE...   (kc-replay --help)
+ */
+
+#include "kc_audio_stats.h"
+#include "kc_capture.h"
+#include "kc_replay.h"
+#include "kc_signal.h"
+#include "kc_wav.h"
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FRAME_NS 20000000ull
+
+typedef struct replay_args {
+    kc_replay_opts opts;
+    const char    *outPath;
+    const char    *expect;
+    double         seconds;             /* synth */
+} replay_args;
+
+static kc_capture_reader *open_capture(const char *path) {
+    char err[256];
+    kc_capture_reader *r = kc_capture_reader_open(path, err, sizeof err);
+    if (!r) fprintf(stderr, "kc-replay: %s\n", err);
+    return r;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile_ms(const uint64_t *v, size_t n, double q) {
+    if (n == 0) return 0.0;
+    size_t i = (size_t)(q * (double)(n - 1) + 0.5);
+    return v[i] / 1e6;
+}
+
+/* ---- info ---- */
+
+static int run_info(const char *path) {
+    kc_capture_reader *r = open_capture(path);
+    if (!r) return 1;
+
+    uint64_t records[5] = { 0 }, bytes[5] = { 0 }, endNs = 0;
+    uint64_t *gaps = NULL;
+    size_t nGaps = 0, capGaps = 0;
+    uint64_t missing = 0, outOfOrder = 0, duplicates = 0, rtpPackets = 0;
+    uint16_t nextSeq = 0;
+    uint64_t lastArrival = 0;
+    double jitterNs = 0.0;              /* RFC 3550 estimate, on sequence x 20 ms */
+    int64_t lastTransit = 0;
+    uint64_t catFrames[2] = { 0 }, catPeak[2] = { 0 }, catSecond[2] = { 0 }, catBin[2] = { 0 };
+    kc_capture_item it;
+    int rc;
+
+    while ((rc = kc_capture_reader_next(r, &it)) == 1) {
+        records[it.kind]++;
+        bytes[it.kind] += it.length;
+        endNs = it.timeNs;
+        if (it.kind == KC_CAPTURE_RTP_RX && it.length >= 12) {
+            uint16_t seq = (uint16_t)(it.data[2] << 8 | it.data[3]);
+            if (rtpPackets > 0) {
+                int16_t d = (int16_t)(seq - nextSeq);
+                if (d > 0) missing += (uint64_t)d;
+                else if (d == -1) duplicates++;
+                else if (d < 0) outOfOrder++;
+                if (capGaps == nGaps) {
+                    capGaps = capGaps ? 2 * capGaps : 1024;
+                    uint64_t *g = realloc(gaps, capGaps * sizeof *g);
+                    if (!g) { free(gaps); kc_capture_reader_close(r); return 1; }
+                    gaps = g;
+                }
+                gaps[nGaps++] = it.timeNs - lastArrival;
+            }
+            if (rtpPackets == 0 || (int16_t)(seq - nextSeq) >= 0) nextSeq = (uint16_t)(seq + 1);
+            int64_t transit = (int64_t)it.timeNs - (int64_t)((uint64_t)seq * FRAME_NS);
+            if (rtpPackets > 0) {
+                double d = fabs((double)(transit - lastTransit));
+                if (d < 1e9) jitterNs += (d - jitterNs) / 16.0;
+            }
+            lastTransit = transit;
+            lastArrival = it.timeNs;
+            rtpPackets++;
+        } else if (it.kind == KC_CAPTURE_CAT_RX || it.kind == KC_CAPTURE_CAT_TX) {
+            int dir = it.kind == KC_CAPTURE_CAT_TX;
+            uint64_t second = it.timeNs / 1000000000ull;
+            if (second != catSecond[dir]) {
+                catSecond[dir] = second;
+                catBin[dir] = 0;
+            }
+            for (uint32_t i = 0; i < it.length; i++)
+                if (it.data[i] == ';') {
+                    catFrames[dir]++;
+                    if (++catBin[dir] > catPeak[dir]) catPeak[dir] = catBin[dir];
+                }
+        }
+    }
+
+    time_t wall = (time_t)(kc_capture_reader_wall_start_us(r) / 1000000ull);
+    char when[64];
+    strftime(when, sizeof when, "%Y-%m-%d %H:%M:%S UTC", gmtime(&wall));
+    printf("%s: %.3f s, started %s\n", path, endNs / 1e9, when);
+    printf("%-8s %10s %12s\n", "kind", "records", "bytes");
+    for (int k = KC_CAPTURE_RTP_RX; k <= KC_CAPTURE_CAT_TX; k++)
+        printf("%-8s %10llu %12llu\n", kc_capture_kind_name((kc_capture_kind)k),
+               (unsigned long long)records[k], (unsigned long long)bytes[k]);
+    if (rtpPackets > 0) {
+        qsort(gaps, nGaps, sizeof *gaps, cmp_u64);
+        printf("rtp_rx: %llu missing, %llu out of order, %llu duplicates\n",
+               (unsigned long long)missing, (unsigned long long)outOfOrder, (unsigned long long)duplicates);
+        printf("rtp_rx arrival spacing ms: p50 %.2f  p99 %.2f  max %.2f; jitter %.2f ms\n",
+               percentile_ms(gaps, nGaps, 0.5), percentile_ms(gaps, nGaps, 0.99),
+               percentile_ms(gaps, nGaps, 1.0), jitterNs / 1e6);
+    }
+    for (int dir = 0; dir < 2; dir++)
+        if (catFrames[dir] > 0)
+            printf("%s: %llu frames, peak %llu in one second\n", dir ? "cat_tx" : "cat_rx",
+                   (unsigned long long)catFrames[dir], (unsigned long long)catPeak[dir]);
+    if (rc < 0) fprintf(stderr, "kc-replay: %s: corrupt record after %.3f s\n", path, endNs / 1e9);
+    free(gaps);
+    kc_capture_reader_close(r);
+    return rc < 0 ? 1 : 0;
+}
+
+/* ---- run ---- */
+
+typedef struct run_ctx {
+    kc_rxsim *sim;
+    uint64_t  cat;
+} run_ctx;
+
+static void run_item(void *ctx, const kc_capture_item *it) {
+    run_ctx *c = ctx;
+    if (it->kind == KC_CAPTURE_RTP_RX) kc_rxsim_packet(c->sim, it->data, it->length, it->timeNs);
+    else if (it->kind == KC_CAPTURE_CAT_RX || it->kind == KC_CAPTURE_CAT_TX) c->cat++;
+}
+
+static uint64_t fnv1a(const float *x, size_t n) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    const uint8_t *p = (const uint8_t *)x;
+    for (size_t i = 0; i < n * sizeof *x; i++) h = (h ^ p[i]) * 0x100000001b3ull;
+    return h;
+}
+
+static void print_stages(void) {
+    kc_stats_snapshot *snap = malloc(sizeof *snap);
+    kc_stats_summary sum;
+    if (!snap || kc_stats_take(kc_stats_current(), snap) != 0) {
+        free(snap);
+        return;
+    }
+    kc_stats_summarize(snap, NULL, &sum);
+    printf("%-12s %10s %10s %10s %10s\n", "stage", "count", "mean us", "p99 us", "max us");
+    for (int i = 0; i < KC_STATS_STAGE_COUNT; i++) {
+        const kc_stats_stage_summary *st = &sum.stage[i];
+        if (st->count == 0) continue;
+        printf("%-12s %10llu %10.2f %10.2f %10.2f\n", kc_stats_stage_name((kc_stats_stage)i),
+               (unsigned long long)st->count, st->meanNs / 1e3, st->p99Ns / 1e3, st->maxNs / 1e3);
+    }
+    free(snap);
+}
+
+static int run_run(const char *path, const replay_args *a) {
+    kc_capture_reader *r = open_capture(path);
+    if (!r) return 1;
+    run_ctx c = { .sim = kc_rxsim_create() };
+    if (!c.sim) {
+        kc_capture_reader_close(r);
+        return 1;
+    }
+    kc_replay_counts counts;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int rc = kc_replay_run(r, &a->opts, run_item, &c, &counts);
+    /* Let the playout timer run out what is still queued, and no further (that would conceal). */
+    kc_jitter_stats js;
+    uint64_t endNs = counts.endNs;
+    for (kc_rxsim_read_jitter(c.sim, &js); js.depth > 0; kc_rxsim_read_jitter(c.sim, &js)) {
+        endNs += FRAME_NS / 4;
+        kc_rxsim_advance(c.sim, endNs);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double wall = (double)(t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    kc_rxsim_counts rx;
+    size_t n;
+    const float *out = kc_rxsim_output(c.sim, &n);
+    kc_rxsim_read_counts(c.sim, &rx);
+    kc_rxsim_read_jitter(c.sim, &js);
+    uint64_t hash = fnv1a(out, n);
+
+    printf("%llu records replayed (%llu rtp lost, %llu held back, %llu cat) in %.3f s, %.3f s of capture\n",
+           (unsigned long long)counts.delivered, (unsigned long long)counts.lost,
+           (unsigned long long)counts.reordered, (unsigned long long)c.cat, wall, counts.endNs / 1e9);
+    printf("rx: %llu datagrams, %llu rejected, %llu frames played, %llu concealed\n",
+           (unsigned long long)rx.datagrams, (unsigned long long)rx.rejected,
+           (unsigned long long)rx.frames, (unsigned long long)rx.concealed);
+    printf("jitter buffer: depth %d, target %d, jitter %.2f ms; %llu received, %llu reordered, %llu late, "
+           "%llu duplicates, %llu lost, %llu underruns, %llu dropped, %llu restarts\n",
+           js.depth, js.target, js.jitterMs, (unsigned long long)js.received,
+           (unsigned long long)js.reordered, (unsigned long long)js.late, (unsigned long long)js.duplicates,
+           (unsigned long long)js.lost, (unsigned long long)js.underruns, (unsigned long long)js.dropped,
+           (unsigned long long)js.restarts);
+    printf("output: %zu samples at %d Hz, hash %016llx\n", n, KC_RXSIM_RATE, (unsigned long long)hash);
+    print_stages();
+
+    int status = rc < 0 ? 1 : 0;
+    if (rc < 0) fprintf(stderr, "kc-replay: %s: corrupt record after %.3f s\n", path, counts.endNs / 1e9);
+    if (a->outPath && kc_wav_write_file(a->outPath, KC_RXSIM_RATE, KC_PCM_F32, out, n) != 0) {
+        fprintf(stderr, "kc-replay: could not write %s\n", a->outPath);
+        status = 1;
+    }
+    if (a->expect && strtoull(a->expect, NULL, 16) != hash) {
+        printf("FAIL: expected hash %s\n", a->expect);
+        status = 1;
+    }
+    kc_rxsim_destroy(c.sim);
+    kc_capture_reader_close(r);
+    return status;
+}
+
+/* ---- send ---- */
+
+typedef struct send_ctx {
+    int                fd;
+    struct sockaddr_in to;
+    uint64_t           sent;
+} send_ctx;
+
+static void send_item(void *ctx, const kc_capture_item *it) {
+    send_ctx *c = ctx;
+    if (sendto(c->fd, it->data, it->length, 0, (struct sockaddr *)&c->to, sizeof c->to) == (ssize_t)it->length)
+        c->sent++;
+}
+
+static int run_send(const char *path, const char *target, const replay_args *a) {
+    char host[64];
+    const char *colon = strrchr(target, ':');
+    size_t hostLen = colon ? (size_t)(colon - target) : strlen(target);
+    if (hostLen >= sizeof host) hostLen = sizeof host - 1;
+    memcpy(host, target, hostLen);
+    host[hostLen] = 0;
+    send_ctx c = { .to = { .sin_family = AF_INET, .sin_port = htons(colon ? (uint16_t)atoi(colon + 1) : 60001) } };
+    if (inet_pton(AF_INET, host, &c.to.sin_addr) != 1) {
+        fprintf(stderr, "kc-replay: %s: not an IPv4 address\n", host);
+        return 2;
+    }
+    kc_capture_reader *r = open_capture(path);
+    if (!r) return 1;
+    c.fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (c.fd < 0) {
+        perror("kc-replay: socket");
+        kc_capture_reader_close(r);
+        return 1;
+    }
+    kc_replay_opts o = a->opts;
+    o.kinds = 1u << KC_CAPTURE_RTP_RX;
+    kc_replay_counts counts;
+    int rc = kc_replay_run(r, &o, send_item, &c, &counts);
+    printf("%llu packets sent (%llu dropped, %llu held back) over %.3f s of capture\n",
+           (unsigned long long)c.sent, (unsigned long long)counts.lost, (unsigned long long)counts.reordered,
+           counts.endNs / 1e9);
+    close(c.fd);
+    kc_capture_reader_close(r);
+    return rc < 0 ? 1 : 0;
+}
+
+/* ---- cat ---- */
+
+static void cat_item(void *ctx, const kc_capture_item *it) {
+    (void)ctx;
+    printf("%10.3f %s ", it->timeNs / 1e9, it->kind == KC_CAPTURE_CAT_TX ? ">" : "<");
+    for (uint32_t i = 0; i < it->length; i++) {
+        uint8_t b = it->data[i];
+        if (b >= 0x20 && b < 0x7f && b != '\\') putchar(b);
+        else printf("\\x%02x", b);
+    }
+    putchar('\n');
+}
+
+static int run_cat(const char *path) {
+    kc_capture_reader *r = open_capture(path);
+    if (!r) return 1;
+    kc_replay_opts o = { .kinds = 1u << KC_CAPTURE_CAT_RX | 1u << KC_CAPTURE_CAT_TX };
+    int rc = kc_replay_run(r, &o, cat_item, NULL, NULL);
+    kc_capture_reader_close(r);
+    return rc < 0 ? 1 : 0;
+}
+
+/* ---- synth ---- */
+
+typedef struct synth_event {
+    uint64_t        at;
+    kc_capture_kind kind;
+    size_t          length;
+    uint8_t         data[12 + 640];
+} synth_event;
+
+typedef struct synth_list {
+    synth_event *v;
+    size_t       n, cap;
+} synth_list;
+
+static synth_event *synth_add(synth_list *l, uint64_t at, kc_capture_kind kind, const void *data, size_t length) {
+    if (l->n == l->cap) {
+        size_t cap = l->cap ? 2 * l->cap : 1024;
+        synth_event *v = realloc(l->v, cap * sizeof *v);
+        if (!v) return NULL;
+        l->v = v;
+        l->cap = cap;
+    }
+    synth_event *e = &l->v[l->n++];
+    e->at = at;
+    e->kind = kind;
+    e->length = length < sizeof e->data ? length : sizeof e->data;
+    if (data) memcpy(e->data, data, e->length);
+    return e;
+}
+
+static int cmp_event(const void *a, const void *b) {
+    const synth_event *x = a, *y = b;
+    return x->at < y->at ? -1 : x->at > y->at;
+}
+
+static void put_be16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+
+/* 20 ms RTP packets of a 1 kHz tone arriving late by |N(0, jitter)| (in order), the app's 250 ms
+ * CAT polls with their answers 4 ms later, and at 1 s an auto-information burst split mid-frame
+ * across two reads. */
+static int run_synth(const char *path, const replay_args *a) {
+    synth_list l = { 0 };
+    kc_rng rng;
+    kc_rng_seed(&rng, a->opts.seed);
+    int packets = (int)(a->seconds * 1e9 / FRAME_NS);
+    double jitterNs = a->opts.jitterMs * 1e6;
+    uint64_t lastAt = 0;
+    int ok = 1;
+
+    for (uint64_t poll = 0; ok && poll < (uint64_t)packets * FRAME_NS; poll += 250000000ull) {
+        ok = synth_add(&l, poll + 1000, KC_CAPTURE_CAT_TX, "FA;SM0;", 7) &&
+             synth_add(&l, poll + 4000000, KC_CAPTURE_CAT_RX, "FA00014074000;SM00007;", 22);
+    }
+    char burst[512] = "";
+    for (int k = 0; k < 24; k++) {
+        char f[32];
+        snprintf(f, sizeof f, "FA%011d;", 14074000 + 10 * k);
+        strcat(burst, f);
+    }
+    size_t len = strlen(burst), half = len / 2 + 3;
+    ok = ok && synth_add(&l, 1002000000ull, KC_CAPTURE_CAT_RX, burst, half) &&
+         synth_add(&l, 1002100000ull, KC_CAPTURE_CAT_RX, burst + half, len - half);
+
+    for (int i = 0; ok && i < packets; i++) {
+        uint64_t at = (uint64_t)i * FRAME_NS + 500000 + (uint64_t)fabs(kc_rng_gauss(&rng) * jitterNs);
+        if (at < lastAt) at = lastAt;
+        lastAt = at;
+        synth_event *e = synth_add(&l, at, KC_CAPTURE_RTP_RX, NULL, 12 + 640);
+        if (!e) break;
+        memset(e->data, 0, 12);
+        e->data[0] = 0x80;              /* V=2 */
+        e->data[1] = 0x60;              /* PT=96 */
+        put_be16(e->data + 2, (uint16_t)i);
+        memcpy(e->data + 8, "890", 4);
+        for (int s = 0; s < 320; s++) {
+            double t = ((double)i * 320 + s) / 16000.0;
+            int16_t v = (int16_t)lrint(0.3 * 32767.0 * sin(2.0 * M_PI * 1000.0 * t));
+            e->data[12 + 2 * s] = (uint8_t)v;
+            e->data[13 + 2 * s] = (uint8_t)((uint16_t)v >> 8);
+        }
+    }
+    if (!ok || l.n < (size_t)packets) {
+        fprintf(stderr, "kc-replay: synth: out of memory\n");
+        free(l.v);
+        return 1;
+    }
+    qsort(l.v, l.n, sizeof *l.v, cmp_event);
+
+    if (kc_capture_start(path) != 0) {
+        perror("kc-replay: synth");
+        free(l.v);
+        return 1;
+    }
+    uint64_t t0 = kc_capture_start_ns();
+    for (size_t i = 0; i < l.n; i++) kc_capture_record(l.v[i].kind, t0 + l.v[i].at, l.v[i].data, l.v[i].length);
+    free(l.v);
+    kc_capture_stats st;
+    kc_capture_read_stats(&st);
+    kc_capture_stop();
+    if (st.dropped || st.writeError) {
+        fprintf(stderr, "kc-replay: synth: %llu records dropped, write error %d\n",
+                (unsigned long long)st.dropped, st.writeError);
+        return 1;
+    }
+    printf("%s: %llu records, %llu bytes\n", path, (unsigned long long)st.records, (unsigned long long)st.bytes);
+    return 0;
+}
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-replay info FILE\n"
+        "       kc-replay run [options] FILE\n"
+        "       kc-replay send [options] FILE HOST[:PORT]   (port 60001 unless given)\n"
+        "       kc-replay cat FILE\n"
+        "       kc-replay synth [options] FILE\n"
+        "replay (run, send):\n"
+        "      --speed X        1 = real time, 0 = no waiting (default: run 0, send 1)\n"
+        "      --jitter MS      random extra delay per RTP packet, 0..MS (default 0)\n"
+        "      --loss PCT       RTP packets dropped (default 0)\n"
+        "      --reorder PCT    RTP packets held back behind their successor (default 0)\n"
+        "      --seed N         random seed (default 1)\n"
+        "run:\n"
+        "  -o, --output FILE    write the 48 kHz output as a float WAV\n"
+        "      --expect HASH    exit 1 unless the output hash is HASH\n"
+        "synth:\n"
+        "  -t, --seconds S      duration (default 10)\n"
+        "      --jitter MS      arrival jitter, standard deviation (default 3)\n"
+        "      --seed N         random seed (default 1)\n"
+        "  -h, --help\n");
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || !strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
+        usage(argc < 2 ? stderr : stdout);
+        return argc < 2 ? 2 : 0;
+    }
+    const char *cmd = argv[1];
+    int isSend = !strcmp(cmd, "send"), isSynth = !strcmp(cmd, "synth");
+    replay_args a = { .opts = { .speed = isSend ? 1.0 : 0.0, .jitterMs = isSynth ? 3.0 : 0.0, .seed = 1 },
+                      .seconds = 10.0 };
+    enum { OPT_SPEED = 256, OPT_JITTER, OPT_LOSS, OPT_REORDER, OPT_SEED, OPT_EXPECT };
+    static const struct option longOpts[] = {
+        { "speed", required_argument, NULL, OPT_SPEED },
+        { "jitter", required_argument, NULL, OPT_JITTER },
+        { "loss", required_argument, NULL, OPT_LOSS },
+        { "reorder", required_argument, NULL, OPT_REORDER },
+        { "seed", required_argument, NULL, OPT_SEED },
+        { "output", required_argument, NULL, 'o' },
+        { "expect", required_argument, NULL, OPT_EXPECT },
+        { "seconds", required_argument, NULL, 't' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    optind = 2;
+    while ((c = getopt_long(argc, argv, "o:t:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case OPT_SPEED: a.opts.speed = atof(optarg); break;
+        case OPT_JITTER: a.opts.jitterMs = atof(optarg); break;
+        case OPT_LOSS: a.opts.lossPct = atof(optarg); break;
+        case OPT_REORDER: a.opts.reorderPct = atof(optarg); break;
+        case OPT_SEED: a.opts.seed = strtoull(optarg, NULL, 10); break;
+        case 'o': a.outPath = optarg; break;
+        case OPT_EXPECT: a.expect = optarg; break;
+        case 't': a.seconds = atof(optarg); break;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    int files = argc - optind;
+    if (a.opts.speed < 0.0 || a.opts.jitterMs < 0.0 || a.seconds <= 0.0) {
+        usage(stderr);
+        return 2;
+    }
+    if (!strcmp(cmd, "info") && files == 1) return run_info(argv[optind]);
+    if (!strcmp(cmd, "run") && files == 1) return run_run(argv[optind], &a);
+    if (isSend && files == 2) return run_send(argv[optind], argv[optind + 1], &a);
+    if (!strcmp(cmd, "cat") && files == 1) return run_cat(argv[optind]);
+    if (isSynth && files == 1) return run_synth(argv[optind], &a);
+    usage(stderr);
+    return 2;
+}
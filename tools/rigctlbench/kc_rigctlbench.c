@@ -0,0 +1,593 @@
+/*  kc_rigctlbench.c
+ *
+ *  Load-tests the rigctld-compatible server (kc_rigctl) with many clients
+ *  on loopback, against a stub radio, and compares it with the way
+ *  rigctld serves them: every request a CAT round trip to the radio, one
+ *  at a time.
+ *
+ *  The stub radio is kc-sim's CAT state (kc_sim_cat) behind a simulated
+ *  link: each write costs --rtt-us plus --radio-us per command it holds,
+ *  and its answers and AI reports come back into a kc_rig_store. The two
+ *  servers:
+ *
+ *    cache   kc_rigctl, as the app runs it. Reads are answered from the
+ *            store; sets go through kc_cat_sched (window 24, 20 ms write
+ *            interval, as TS890Connection) to the stub.
+ *    direct  a thread per client, each request turned into the CAT
+ *            commands Hamlib's Kenwood backend sends (get_mode is OM and
+ *            DA, get_split_vfo FR and FT...), each waiting for its answer
+ *            on the one connection.
+ *
+ *  Every client is a thread with its own connection, sending the extended
+ *  protocol ("+f") in a closed loop: reads of frequency, mode, PTT and
+ *  split in turn, and --set-pct percent frequency sets. Reported per
+ *  server: requests per second, read and set latency percentiles, and how
+ *  many commands the radio had to handle. Exits 1 if the cache server
+ *  answered any request with an error, or if the store and the stub radio
+ *  disagree on the frequency once the sets have drained.
+ *
+ *  Usage: kc-rigctlbench [options]   (kc-rigctlbench --help)
+ */
+
+#include "kc_cat_codec.h"
+#include "kc_cat_sched.h"
+#include "kc_rig_state.h"
+#include "kc_rigctl.h"
+#include "kc_sim_cat.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct bench_opts {
+    int      clients;
+    double   seconds;
+    double   setPct;
+    double   rate;                      /* requests per second per client; 0: closed loop */
+    uint64_t radioNs, rttNs;
+    int      cache, direct;
+} bench_opts;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_ns(uint64_t d) {
+    struct timespec ts = { (time_t)(d / 1000000000ull), (long)(d % 1000000000ull) };
+    nanosleep(&ts, NULL);
+}
+
+/* ---- Stub radio ---- */
+
+typedef struct radio {
+    pthread_mutex_t lock;               /* the connection queue: cat, sched */
+    pthread_cond_t  wake;
+    kc_sim_cat      cat;
+    kc_cat_sched   *sched;
+    kc_rig_store   *store;
+    uint64_t        radioNs, rttNs;
+    int             stop;
+    uint64_t        commands;           /* handled by the radio */
+    uint64_t        busyNs;
+    pthread_t       thread;
+} radio;
+
+/* Runs `frames` (';'-terminated commands) on the radio; its answers and reports go to `out`. */
+static size_t radio_handle(radio *r, const char *frames, size_t n, char *out, size_t cap) {
+    size_t len = 0, start = 0;
+    kc_sim_cat_out o;
+    for (size_t i = 0; i < n; i++) {
+        if (frames[i] != ';') continue;
+        kc_sim_cat_handle(&r->cat, frames + start, i - start, now_ns(), &o);
+        r->commands++;
+        if (len + o.replyLen + o.pushLen <= cap) {
+            memcpy(out + len, o.reply, o.replyLen);
+            len += o.replyLen;
+            memcpy(out + len, o.push, o.pushLen);
+            len += o.pushLen;
+        }
+        start = i + 1;
+    }
+    return len;
+}
+
+/* The connection side of the cache server: TS890Connection's writes and flushFrames. */
+static void *radio_main(void *arg) {
+    radio *r = arg;
+    char batch[4096], answers[16384];
+    pthread_mutex_lock(&r->lock);
+    while (!r->stop) {
+        uint64_t wait;
+        size_t n = kc_cat_sched_next_write(r->sched, now_ns(), batch, sizeof batch, &wait);
+        if (n == 0) {
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            uint64_t d = wait ? wait : 10000000ull;
+            ts.tv_nsec += (long)(d % 1000000000ull);
+            ts.tv_sec += (time_t)(d / 1000000000ull) + ts.tv_nsec / 1000000000l;
+            ts.tv_nsec %= 1000000000l;
+            pthread_cond_timedwait(&r->wake, &r->lock, &ts);
+            continue;
+        }
+        pthread_mutex_unlock(&r->lock);
+
+        uint64_t before = r->commands;
+        size_t a = radio_handle(r, batch, n, answers, sizeof answers);
+        uint64_t busy = (r->commands - before) * r->radioNs;
+        r->busyNs += busy;
+        sleep_ns(r->rttNs + busy);
+
+        pthread_mutex_lock(&r->lock);
+        size_t start = 0;
+        for (size_t i = 0; i < a; i++) {
+            if (answers[i] != ';') continue;
+            kc_cat_msg m;
+            if (kc_cat_decode(answers + start, i - start, &m)) kc_rig_store_apply(r->store, &m);
+            kc_cat_sched_on_frame(r->sched, answers + start, i - start, now_ns());
+            start = i + 1;
+        }
+    }
+    pthread_mutex_unlock(&r->lock);
+    return NULL;
+}
+
+static void radio_submit(void *ctx, const char *command, size_t length) {
+    radio *r = ctx;
+    pthread_mutex_lock(&r->lock);
+    kc_cat_sched_submit(r->sched, command, length, now_ns());
+    pthread_cond_signal(&r->wake);
+    pthread_mutex_unlock(&r->lock);
+}
+
+static int radio_pending(radio *r) {
+    pthread_mutex_lock(&r->lock);
+    int n = kc_cat_sched_pending(r->sched);
+    pthread_mutex_unlock(&r->lock);
+    return n;
+}
+
+static void radio_drain(radio *r) {
+    for (uint64_t until = now_ns() + 5000000000ull; radio_pending(r) && now_ns() < until;) sleep_ns(1000000);
+}
+
+/* ---- Clients ---- */
+
+typedef struct latencies {
+    uint64_t *ns;
+    size_t    n, cap;
+} latencies;
+
+static void record(latencies *l, uint64_t ns) {
+    if (l->n == l->cap) {
+        size_t cap = l->cap ? 2 * l->cap : 4096;
+        uint64_t *p = realloc(l->ns, cap * sizeof *p);
+        if (!p) return;
+        l->ns = p;
+        l->cap = cap;
+    }
+    l->ns[l->n++] = ns;
+}
+
+typedef struct client {
+    const bench_opts *o;
+    int               port, id;
+    uint64_t          deadlineNs;
+    latencies         reads, sets;
+    uint64_t          errors, failed;
+    pthread_t         thread;
+} client;
+
+static int connect_to(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a = { .sin_family = AF_INET, .sin_port = htons((uint16_t)port) };
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int one = 1;
+    if (fd < 0) return -1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    if (connect(fd, (struct sockaddr *)&a, sizeof a) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Reads up to the "RPRT n" line. Returns n, or 1 if the connection failed. */
+static int read_reply(int fd, char *buf, size_t cap, size_t *have) {
+    for (;;) {
+        char *p = buf;
+        buf[*have] = 0;
+        while ((p = strstr(p, "RPRT ")) != NULL) {
+            char *nl = strchr(p, '\n');
+            if (!nl) break;
+            if (p == buf || p[-1] == '\n') {
+                int rc = atoi(p + 5);
+                size_t used = (size_t)(nl + 1 - buf);
+                memmove(buf, nl + 1, *have - used);
+                *have -= used;
+                return rc;
+            }
+            p = nl;
+        }
+        if (*have + 1 >= cap) return 1;
+        ssize_t n = recv(fd, buf + *have, cap - 1 - *have, 0);
+        if (n <= 0) return 1;
+        *have += (size_t)n;
+    }
+}
+
+static void *client_main(void *arg) {
+    client *c = arg;
+    static const char *reads[] = { "+f\n", "+m\n", "+t\n", "+s\n" };
+    char buf[4096], line[64];
+    size_t have = 0;
+    int fd = connect_to(c->port);
+    if (fd < 0) {
+        c->failed = 1;
+        return NULL;
+    }
+    uint64_t rng = 0x9e3779b97f4a7c15ull * (uint64_t)(c->id + 1), next = now_ns();
+    for (int k = 0; now_ns() < c->deadlineNs; k++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        const char *req = reads[k % 4];
+        int set = (double)(rng % 10000) < c->o->setPct * 100.0;
+        if (set) {
+            snprintf(line, sizeof line, "+F %lld\n", 14000000ll + (long long)(rng % 350000));
+            req = line;
+        }
+        uint64_t t0 = now_ns();
+        if (send(fd, req, strlen(req), 0) < 0) {
+            c->failed = 1;
+            break;
+        }
+        int rc = read_reply(fd, buf, sizeof buf, &have);
+        if (rc > 0) {
+            c->failed = 1;
+            break;
+        }
+        if (rc < 0) c->errors++;
+        record(set ? &c->sets : &c->reads, now_ns() - t0);
+        if (c->o->rate > 0.0) {
+            next += (uint64_t)(1e9 / c->o->rate);
+            uint64_t now = now_ns();
+            if (next > now) sleep_ns(next - now);
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+/* ---- The direct server: one CAT round trip per command, one at a time ---- */
+
+typedef struct direct_server {
+    radio           *r;
+    int              listenFd, port;
+    pthread_mutex_t  link;              /* the one CAT connection */
+    pthread_t        thread;
+    pthread_t        workers[KC_RIGCTL_MAX_CLIENTS];
+    int              fds[KC_RIGCTL_MAX_CLIENTS];
+    int              count;
+} direct_server;
+
+typedef struct direct_conn {
+    direct_server *d;
+    int            fd;
+} direct_conn;
+
+/* Sends one command and waits for its answer, as Hamlib's backend does. */
+static void direct_cat(direct_server *d, const char *command) {
+    char answers[1024];
+    pthread_mutex_lock(&d->link);
+    radio_handle(d->r, command, strlen(command), answers, sizeof answers);
+    d->r->busyNs += d->r->radioNs;
+    sleep_ns(d->r->rttNs + d->r->radioNs);
+    pthread_mutex_unlock(&d->link);
+}
+
+static void direct_request(direct_server *d, char *line, char *out, size_t cap) {
+    kc_sim_cat *cat = &d->r->cat;
+    static const char *modes[] = { "", "LSB", "USB", "CW", "FM", "AM", "RTTY", "CWR", "", "" };
+    char set[32];
+    int ext = line[0] == '+';
+    char *cmd = line + ext;
+    if (cmd[0] == 'f') {
+        direct_cat(d, "FA;");
+        snprintf(out, cap, "get_freq:\nFrequency: %lld\nRPRT 0\n", cat->fa);
+    } else if (cmd[0] == 'm') {
+        direct_cat(d, "OM0;");
+        direct_cat(d, "DA;");
+        snprintf(out, cap, "get_mode:\nMode: %s\nPassband: 0\nRPRT 0\n", modes[cat->mode % 10]);
+    } else if (cmd[0] == 't') {
+        direct_cat(d, "TX;");               /* the backend's PTT read; the stub doesn't know it */
+        snprintf(out, cap, "get_ptt:\nPTT: %d\nRPRT 0\n", cat->tx);
+    } else if (cmd[0] == 's') {
+        direct_cat(d, "FR;");
+        direct_cat(d, "FT;");
+        snprintf(out, cap, "get_split_vfo:\nSplit: %d\nTX VFO: %s\nRPRT 0\n", cat->fr != cat->ft,
+                 cat->ft ? "VFOB" : "VFOA");
+    } else if (cmd[0] == 'F') {
+        snprintf(set, sizeof set, "FA%011lld;", atoll(cmd + 2));
+        direct_cat(d, set);
+        direct_cat(d, "FA;");
+        snprintf(out, cap, "set_freq: %s\nRPRT 0\n", cmd + 2);
+    } else {
+        snprintf(out, cap, "RPRT -4\n");
+    }
+}
+
+static void *direct_conn_main(void *arg) {
+    direct_conn *dc = arg;
+    char in[512], out[256];
+    size_t have = 0;
+    for (;;) {
+        ssize_t n = recv(dc->fd, in + have, sizeof in - 1 - have, 0);
+        if (n <= 0) break;
+        have += (size_t)n;
+        char *nl;
+        while ((nl = memchr(in, '\n', have)) != NULL) {
+            *nl = 0;
+            direct_request(dc->d, in, out, sizeof out);
+            send(dc->fd, out, strlen(out), 0);
+            size_t used = (size_t)(nl + 1 - in);
+            memmove(in, nl + 1, have - used);
+            have -= used;
+        }
+        if (have == sizeof in - 1) break;
+    }
+    free(dc);
+    return NULL;
+}
+
+static void *direct_main(void *arg) {
+    direct_server *d = arg;
+    for (;;) {
+        int fd = accept(d->listenFd, NULL, NULL);
+        if (fd < 0) break;
+        direct_conn *dc = malloc(sizeof *dc);
+        if (!dc || d->count == KC_RIGCTL_MAX_CLIENTS) {
+            free(dc);
+            close(fd);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        *dc = (direct_conn){ d, fd };
+        d->fds[d->count] = fd;
+        pthread_create(&d->workers[d->count++], NULL, direct_conn_main, dc);
+    }
+    return NULL;
+}
+
+static int direct_start(direct_server *d, radio *r) {
+    struct sockaddr_in a = { .sin_family = AF_INET };
+    socklen_t len = sizeof a;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    memset(d, 0, sizeof *d);
+    d->r = r;
+    pthread_mutex_init(&d->link, NULL);
+    d->listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (d->listenFd < 0 || bind(d->listenFd, (struct sockaddr *)&a, sizeof a) < 0 || listen(d->listenFd, 256) < 0 ||
+        getsockname(d->listenFd, (struct sockaddr *)&a, &len) < 0)
+        return -1;
+    d->port = ntohs(a.sin_port);
+    return pthread_create(&d->thread, NULL, direct_main, d) == 0 ? 0 : -1;
+}
+
+static void direct_stop(direct_server *d) {
+    shutdown(d->listenFd, SHUT_RDWR);
+    close(d->listenFd);
+    pthread_join(d->thread, NULL);
+    for (int i = 0; i < d->count; i++) {
+        shutdown(d->fds[i], SHUT_RDWR);
+        pthread_join(d->workers[i], NULL);
+        close(d->fds[i]);
+    }
+}
+
+/* ---- Runs ---- */
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void print_latency(const char *name, latencies *l) {
+    if (l->n == 0) {
+        printf("  %-8s none\n", name);
+        return;
+    }
+    qsort(l->ns, l->n, sizeof *l->ns, cmp_u64);
+    printf("  %-8s %9zu   p50 %8.1f us   p99 %8.1f us   max %8.1f us\n", name, l->n, l->ns[l->n / 2] / 1e3,
+           l->ns[l->n * 99 / 100] / 1e3, l->ns[l->n - 1] / 1e3);
+}
+
+/* Runs the clients against `port`; returns the requests answered with an error, or -1 if a client failed. */
+static long run_clients(const bench_opts *o, int port, radio *r, const char *title) {
+    client *cs = calloc((size_t)o->clients, sizeof *cs);
+    if (!cs) return -1;
+    uint64_t start = now_ns(), busy0 = r->busyNs, commands0 = r->commands;
+    for (int i = 0; i < o->clients; i++) {
+        cs[i] = (client){ .o = o, .port = port, .id = i, .deadlineNs = start + (uint64_t)(o->seconds * 1e9) };
+        pthread_create(&cs[i].thread, NULL, client_main, &cs[i]);
+    }
+    latencies reads = { 0 }, sets = { 0 };
+    uint64_t errors = 0;
+    int failed = 0;
+    for (int i = 0; i < o->clients; i++) {
+        pthread_join(cs[i].thread, NULL);
+        for (size_t k = 0; k < cs[i].reads.n; k++) record(&reads, cs[i].reads.ns[k]);
+        for (size_t k = 0; k < cs[i].sets.n; k++) record(&sets, cs[i].sets.ns[k]);
+        errors += cs[i].errors;
+        failed += (int)cs[i].failed;
+        free(cs[i].reads.ns);
+        free(cs[i].sets.ns);
+    }
+    double secs = (double)(now_ns() - start) / 1e9;
+    printf("%s, %d clients, %.1f s\n", title, o->clients, secs);
+    printf("  requests %9zu   %.0f/s, %llu errors, %d clients failed\n", reads.n + sets.n,
+           (double)(reads.n + sets.n) / secs, (unsigned long long)errors, failed);
+    print_latency("reads", &reads);
+    print_latency("sets", &sets);
+    printf("  radio    %9llu commands (%.0f/s), busy %.0f%%\n", (unsigned long long)(r->commands - commands0),
+           (double)(r->commands - commands0) / secs, 100.0 * (double)(r->busyNs - busy0) / 1e9 / secs);
+    free(reads.ns);
+    free(sets.ns);
+    free(cs);
+    return failed ? -1 : (long)errors;
+}
+
+static int radio_init(radio *r, const bench_opts *o) {
+    memset(r, 0, sizeof *r);
+    kc_sim_cat_init(&r->cat);
+    r->radioNs = o->radioNs;
+    r->rttNs = o->rttNs;
+    kc_cat_sched_config config = { .window = 24, .minIntervalNs = 20000000ull, .timeoutNs = 1000000000ull };
+    r->sched = kc_cat_sched_create(&config);
+    r->store = kc_rig_store_create();
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->wake, NULL);
+    return r->sched && r->store ? 0 : -1;
+}
+
+static void radio_free(radio *r) {
+    kc_cat_sched_destroy(r->sched);
+    kc_rig_store_destroy(r->store);
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->wake);
+}
+
+static int bench_cache(const bench_opts *o) {
+    radio r;
+    if (radio_init(&r, o) < 0 || pthread_create(&r.thread, NULL, radio_main, &r) != 0) {
+        fprintf(stderr, "kc-rigctlbench: can't start the stub radio\n");
+        return 1;
+    }
+    /* What RadioState's resync reads at connect. */
+    static const char *resync[] = { "FA;", "FB;", "OM0;", "DA;", "FR;", "FT;", "PC;", "AG;", "RG;", "SQ;", "MV;" };
+    for (size_t i = 0; i < sizeof resync / sizeof resync[0]; i++) radio_submit(&r, resync[i], strlen(resync[i]));
+    radio_drain(&r);
+    kc_rig_store_set(r.store, KC_RIG_PTT, 0, 1);
+
+    kc_rigctl_config config = { .maxClients = KC_RIGCTL_MAX_CLIENTS, .store = r.store, .submit = radio_submit,
+                                .ctx = &r };
+    kc_rigctl *s = kc_rigctl_create(&config);
+    if (!s) {
+        perror("kc-rigctlbench: kc_rigctl_create");
+        return 1;
+    }
+    kc_rigctl_set_online(s, 1);
+    long errors = run_clients(o, kc_rigctl_port(s), &r, "cache (kc_rigctl)");
+    radio_drain(&r);
+
+    kc_rigctl_stats st;
+    kc_rigctl_read_stats(s, &st);
+    kc_cat_sched_stats ss;
+    pthread_mutex_lock(&r.lock);
+    kc_cat_sched_read_stats(r.sched, &ss);
+    pthread_mutex_unlock(&r.lock);
+    printf("  server   %llu accepted, %llu reads from the store, %llu sets, %llu CAT commands submitted\n",
+           (unsigned long long)st.accepted, (unsigned long long)st.reads, (unsigned long long)st.sets,
+           (unsigned long long)st.submitted);
+    printf("  sched    %llu coalesced, %llu written in %llu writes\n", (unsigned long long)ss.coalesced,
+           (unsigned long long)ss.written, (unsigned long long)ss.writes);
+
+    /* After the last set has been answered, the store holds what the radio has. */
+    kc_rig_values v = { 0 };
+    uint64_t cursor = 0;
+    kc_rig_store_poll(r.store, &cursor, &v);
+    int agree = (v.valid >> KC_RIG_VFO_A & 1) && v.v[KC_RIG_VFO_A] == r.cat.fa;
+    printf("  state    store %lld Hz, radio %lld Hz: %s\n", (long long)v.v[KC_RIG_VFO_A], r.cat.fa,
+           agree ? "agree" : "DIFFER");
+
+    kc_rigctl_destroy(s);
+    pthread_mutex_lock(&r.lock);
+    r.stop = 1;
+    pthread_cond_signal(&r.wake);
+    pthread_mutex_unlock(&r.lock);
+    pthread_join(r.thread, NULL);
+    radio_free(&r);
+    return errors != 0 || !agree;
+}
+
+static int bench_direct(const bench_opts *o) {
+    radio r;
+    direct_server d;
+    if (radio_init(&r, o) < 0 || direct_start(&d, &r) < 0) {
+        fprintf(stderr, "kc-rigctlbench: can't start the direct server\n");
+        return 1;
+    }
+    long errors = run_clients(o, d.port, &r, "direct (a CAT round trip per command)");
+    direct_stop(&d);
+    radio_free(&r);
+    return errors < 0;
+}
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-rigctlbench [options]\n"
+        "  -c, --clients N      connections, one thread each (default 32, at most %d)\n"
+        "  -t, --seconds S      how long the clients run (default 3)\n"
+        "      --set-pct P      percent of requests that set the frequency (default 5)\n"
+        "      --rate R         requests per second per client (default: as fast as answered)\n"
+        "      --radio-us N     the radio's time per command (default 2500)\n"
+        "      --rtt-us N       the link's round trip (default 1000)\n"
+        "      --only cache|direct\n"
+        "  -h, --help\n", KC_RIGCTL_MAX_CLIENTS);
+}
+
+int main(int argc, char **argv) {
+    bench_opts o = { .clients = 32, .seconds = 3.0, .setPct = 5.0, .radioNs = 2500000ull, .rttNs = 1000000ull,
+                     .cache = 1, .direct = 1 };
+    enum { OPT_SET_PCT = 256, OPT_RATE, OPT_RADIO_US, OPT_RTT_US, OPT_ONLY };
+    static const struct option longOpts[] = {
+        { "clients", required_argument, NULL, 'c' },
+        { "seconds", required_argument, NULL, 't' },
+        { "set-pct", required_argument, NULL, OPT_SET_PCT },
+        { "rate", required_argument, NULL, OPT_RATE },
+        { "radio-us", required_argument, NULL, OPT_RADIO_US },
+        { "rtt-us", required_argument, NULL, OPT_RTT_US },
+        { "only", required_argument, NULL, OPT_ONLY },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "c:t:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'c': o.clients = atoi(optarg); break;
+        case 't': o.seconds = atof(optarg); break;
+        case OPT_SET_PCT: o.setPct = atof(optarg); break;
+        case OPT_RATE: o.rate = atof(optarg); break;
+        case OPT_RADIO_US: o.radioNs = (uint64_t)(atof(optarg) * 1e3); break;
+        case OPT_RTT_US: o.rttNs = (uint64_t)(atof(optarg) * 1e3); break;
+        case OPT_ONLY:
+            o.cache = !strcmp(optarg, "cache");
+            o.direct = !strcmp(optarg, "direct");
+            break;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    if (optind != argc || o.clients < 1 || o.clients > KC_RIGCTL_MAX_CLIENTS || o.seconds <= 0.0 ||
+        o.setPct < 0.0 || o.setPct > 100.0 || (!o.cache && !o.direct)) {
+        usage(stderr);
+        return 2;
+    }
+    int rc = 0;
+    if (o.cache) rc |= bench_cache(&o);
+    if (o.direct) rc |= bench_direct(&o);
+    return rc;
+}
@@ -0,0 +1,914 @@
+/*  kc_sim.c
+ *
+ *  A headless TS-890 stand-in, or many of them, for testing and load-testing
+ *  the client side without a radio.
+ *
+ *  Each simulated radio listens for CAT on TCP (60000) and streams audio on
+ *  UDP (60001), as the real one does:
+ *
+ *    - KNS login: ##CN is answered ##CN1 (##CN0 once --clients sessions are
+ *      logged in), then ##ID with the configured account and password gets
+ *      ##ID1, anything else ##ID0. Frames before login are ignored. With
+ *      --no-login every connection starts logged in.
+ *    - CAT: the stateful subset in kc_sim_cat, AI per session, changes
+ *      reported to every AI session. A session silent for --idle seconds
+ *      is closed, like the radio's 10 s timeout.
+ *    - ##VP1 / ##VP2 start a 20 ms RTP stream (PT 96, 640 bytes of 16 kHz
+ *      PCM16) to the session's address on UDP 60001; ##VP0 stops it. Any
+ *      datagram from that address (the app's probe, mic audio) moves the
+ *      stream to the port it came from, so clients that can't bind 60001
+ *      work too. Received mic packets are counted, with sequence gaps.
+ *
+ *  The audio is a 30 s loop of one synthetic signal (kc_signal) plus noise,
+ *  each radio starting at a different point. Packets can be delayed,
+ *  dropped or held back behind their successor, from a per-radio seeded
+ *  generator, as in kc-udpbench --send.
+ *
+ *  Radio i listens on the first address + i (any 127.x.y.z works on Linux),
+ *  or with --port-step K on the same address, ports + K * i. Radios are
+ *  split across --threads worker threads; each runs one poll loop and a
+ *  timer heap, with packet sends timed to well under a millisecond. Every
+ *  --report seconds a line sums up sessions, packet rates and send
+ *  lateness.
+ *
+ *  Usage: kc-sim [options]   (kc-sim --help)
+ */
+
+#include "kc_pcm.h"
+#include "kc_signal.h"
+#include "kc_sim_cat.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RATE          16000
+#define SAMPLES       320                 /* 20 ms */
+#define PAYLOAD_BYTES (2 * SAMPLES)
+#define PACKET_BYTES  (12 + PAYLOAD_BYTES)
+#define FRAME_NS      20000000ull
+#define HOLD_BACK_NS  (FRAME_NS + FRAME_NS / 4)
+#define LOOP_FRAMES   1500                /* 30 s */
+#define MAX_SESSIONS  8                   /* connections per radio, logged in or not */
+#define IN_MAX        4096                /* a frame longer than this closes the session */
+#define OUT_MAX       (256 * 1024)        /* a session this far behind is closed */
+#define HOUSEKEEP_NS  10000000ull
+#define SPIN_NS       2000000ull          /* closer than this, sleep instead of polling */
+
+typedef enum { SIG_VOICE, SIG_TONE, SIG_CW, SIG_FSK8, SIG_SILENCE } sig_kind;
+
+typedef struct sim_opts {
+    int         radios, threads, sessions;
+    const char *addr;
+    int         port, portStep, clientPort;
+    const char *user, *password;
+    int         noLogin;
+    double      idleSec;
+    double      tuneRate;                 /* VFO A steps per second per radio */
+    sig_kind    signal;
+    double      hz, levelDb, noiseDb;
+    double      jitterMs, lossPct, reorderPct;
+    uint64_t    seed;
+    double      seconds, reportSec;
+} sim_opts;
+
+static sim_opts g_opts;
+static uint8_t *g_loop;                   /* LOOP_FRAMES payloads, PCM16 LE */
+static atomic_int g_stop;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t t) {
+    uint64_t now = now_ns();
+    if (t <= now) return;
+    uint64_t d = t - now;
+    struct timespec ts = { (time_t)(d / 1000000000ull), (long)(d % 1000000000ull) };
+    nanosleep(&ts, NULL);
+}
+
+static int set_nonblocking(int fd) {
+    int fl = fcntl(fd, F_GETFL, 0);
+    return fl < 0 ? -1 : fcntl(fd, F_SETFL, fl | O_NONBLOCK);
+}
+
+/* ---- State ---- */
+
+typedef struct session {
+    int            fd;
+    struct in_addr peer;
+    int            cnSeen, loggedIn, ai, closing;
+    uint64_t       lastRxNs;
+    char           in[IN_MAX];
+    size_t         inLen;
+    char          *out;
+    size_t         outLen, outCap;
+} session;
+
+typedef struct radio {
+    int                index;
+    int                tcpFd, udpFd;
+    struct sockaddr_in where;             /* TCP address; UDP is port + 1 */
+    kc_sim_cat         cat;
+    session           *sessions[MAX_SESSIONS];
+    int                nSessions, loggedIn;
+    session           *voip;              /* the session the stream goes to */
+    struct sockaddr_in dest;
+    uint32_t           gen;               /* bumped on each start/stop; stale timer events are skipped */
+    uint16_t           seq;
+    kc_rng             rng;
+    uint32_t           loopStart;
+    uint64_t           nextTuneNs;
+    int                tuneDir;
+    int                micSeen;
+    uint16_t           micNextSeq;
+} radio;
+
+typedef enum { EV_FRAME, EV_SEND } ev_kind;
+
+typedef struct event {
+    uint64_t at;
+    radio   *r;
+    uint32_t gen;
+    uint16_t seq;
+    uint8_t  kind;
+} event;
+
+typedef struct sim_counters {
+    atomic_int       sessions, loggedIn, streams;
+    _Atomic uint64_t rtpSent, rtpLost, rtpHeld, sendErrors;
+    _Atomic uint64_t late2ms, maxLateNs;
+    _Atomic uint64_t catIn, catOut, aiPush, unknown;
+    _Atomic uint64_t micPackets, micGaps;
+    _Atomic uint64_t loginFailures, refused, idleClosed, slowClosed;
+} sim_counters;
+
+typedef enum { FD_LISTEN, FD_UDP, FD_SESSION } fd_kind;
+
+typedef struct fd_owner {
+    fd_kind  kind;
+    radio   *r;
+    session *s;
+} fd_owner;
+
+typedef struct worker {
+    pthread_t     thread;
+    radio        *radios;
+    int           nRadios;
+    struct pollfd *pfd;
+    fd_owner     *owner;
+    size_t        nPfd, capPfd;
+    int           dirty;
+    event        *heap;
+    size_t        nHeap, capHeap;
+    sim_counters  c;
+} worker;
+
+static void count(_Atomic uint64_t *c, uint64_t n) {
+    atomic_fetch_add_explicit(c, n, memory_order_relaxed);
+}
+
+/* ---- Timer heap ---- */
+
+static void heap_push(worker *w, event e) {
+    if (w->nHeap == w->capHeap) {
+        size_t cap = w->capHeap ? 2 * w->capHeap : 256;
+        event *h = realloc(w->heap, cap * sizeof *h);
+        if (!h) return;
+        w->heap = h;
+        w->capHeap = cap;
+    }
+    size_t i = w->nHeap++;
+    while (i > 0 && e.at < w->heap[(i - 1) / 2].at) {
+        w->heap[i] = w->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    w->heap[i] = e;
+}
+
+static event heap_pop(worker *w) {
+    event top = w->heap[0], last = w->heap[--w->nHeap];
+    size_t i = 0;
+    for (;;) {
+        size_t c = 2 * i + 1;
+        if (c >= w->nHeap) break;
+        if (c + 1 < w->nHeap && w->heap[c + 1].at < w->heap[c].at) c++;
+        if (w->heap[c].at >= last.at) break;
+        w->heap[i] = w->heap[c];
+        i = c;
+    }
+    if (w->nHeap > 0) w->heap[i] = last;
+    return top;
+}
+
+/* ---- Sessions ---- */
+
+static void out_append(worker *w, session *s, const char *p, size_t n) {
+    if (s->closing || n == 0) return;
+    if (s->outLen + n > OUT_MAX) {
+        count(&w->c.slowClosed, 1);
+        s->closing = 1;
+        return;
+    }
+    if (s->outLen + n > s->outCap) {
+        size_t cap = s->outCap ? s->outCap : 4096;
+        while (cap < s->outLen + n) cap *= 2;
+        char *o = realloc(s->out, cap);
+        if (!o) {
+            s->closing = 1;
+            return;
+        }
+        s->out = o;
+        s->outCap = cap;
+    }
+    memcpy(s->out + s->outLen, p, n);
+    s->outLen += n;
+}
+
+static void out_str(worker *w, session *s, const char *str) {
+    out_append(w, s, str, strlen(str));
+    count(&w->c.catOut, 1);
+}
+
+/* Sends what it can now; the rest waits for POLLOUT. */
+static void flush(worker *w, session *s) {
+    while (s->outLen > 0) {
+        ssize_t n = send(s->fd, s->out, s->outLen, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) s->closing = 1;
+            break;
+        }
+        memmove(s->out, s->out + n, s->outLen - (size_t)n);
+        s->outLen -= (size_t)n;
+    }
+    (void)w;
+}
+
+static void push_ai(worker *w, radio *r, const char *p, size_t n) {
+    if (n == 0) return;
+    for (int i = 0; i < r->nSessions; i++) {
+        session *s = r->sessions[i];
+        if (s->loggedIn && s->ai) {
+            out_append(w, s, p, n);
+            count(&w->c.aiPush, 1);
+        }
+    }
+}
+
+static void start_stream(worker *w, radio *r, session *s, uint64_t now) {
+    if (r->voip && r->voip != s) atomic_fetch_sub(&w->c.streams, 1);
+    if (r->voip != s) {
+        atomic_fetch_add(&w->c.streams, 1);
+        if (!r->voip || r->voip->peer.s_addr != s->peer.s_addr)
+            r->dest = (struct sockaddr_in){ .sin_family = AF_INET, .sin_addr = s->peer,
+                                            .sin_port = htons((uint16_t)g_opts.clientPort) };
+    } else {
+        return;                           /* already streaming to it */
+    }
+    r->voip = s;
+    r->gen++;
+    heap_push(w, (event){ .at = now, .r = r, .gen = r->gen, .seq = r->seq, .kind = EV_FRAME });
+}
+
+static void stop_stream(worker *w, radio *r) {
+    if (!r->voip) return;
+    r->voip = NULL;
+    r->gen++;
+    atomic_fetch_sub(&w->c.streams, 1);
+}
+
+/* ##ID P1 P2P2 P3P3 account password (lengths in bytes). */
+static int login_ok(const char *f, size_t len) {
+    if (len < 9 || (f[4] != '0' && f[4] != '1')) return 0;
+    int al = (f[5] - '0') * 10 + (f[6] - '0'), pl = (f[7] - '0') * 10 + (f[8] - '0');
+    if (al < 1 || pl < 1 || (size_t)(9 + al + pl) != len) return 0;
+    return (size_t)al == strlen(g_opts.user) && !memcmp(f + 9, g_opts.user, (size_t)al) &&
+           (size_t)pl == strlen(g_opts.password) && !memcmp(f + 9 + al, g_opts.password, (size_t)pl);
+}
+
+static void handle_frame(worker *w, radio *r, session *s, const char *f, size_t len, uint64_t now) {
+    /* As the app does: strip whitespace and control bytes around the frame. */
+    while (len > 0 && (unsigned char)*f <= ' ') { f++; len--; }
+    while (len > 0 && (unsigned char)f[len - 1] <= ' ') len--;
+    if (len == 0) return;
+    count(&w->c.catIn, 1);
+
+    if (len == 4 && !memcmp(f, "##CN", 4)) {
+        if (!s->loggedIn && r->loggedIn >= g_opts.sessions) {
+            out_str(w, s, "##CN0;");
+            count(&w->c.refused, 1);
+            s->closing = 2;               /* after the answer goes out */
+            return;
+        }
+        s->cnSeen = 1;
+        out_str(w, s, "##CN1;");
+        return;
+    }
+    if (len >= 4 && !memcmp(f, "##ID", 4)) {
+        if (s->loggedIn) return;
+        if (s->cnSeen && login_ok(f, len) && r->loggedIn < g_opts.sessions) {
+            s->loggedIn = 1;
+            r->loggedIn++;
+            atomic_fetch_add(&w->c.loggedIn, 1);
+            out_str(w, s, "##ID1;");
+        } else {
+            count(&w->c.loginFailures, 1);
+            out_str(w, s, "##ID0;");
+        }
+        return;
+    }
+    if (!s->loggedIn) return;
+
+    if (len >= 2 && f[0] == 'A' && f[1] == 'I') {
+        if (len == 2) {
+            char a[8];
+            snprintf(a, sizeof a, "AI%d;", s->ai);
+            out_str(w, s, a);
+        } else if (len == 3 && f[2] >= '0' && f[2] <= '4') {
+            s->ai = f[2] - '0';
+        } else {
+            out_str(w, s, "?;");
+        }
+        return;
+    }
+    if (len >= 4 && !memcmp(f, "##VP", 4)) {
+        if (len == 4) {
+            out_str(w, s, r->voip == s ? "##VP1;" : "##VP0;");
+        } else if (len == 5 && f[4] >= '0' && f[4] <= '2') {
+            if (f[4] == '0') {
+                if (r->voip == s) stop_stream(w, r);
+            } else {
+                start_stream(w, r, s, now);
+            }
+        } else {
+            out_str(w, s, "?;");
+        }
+        return;
+    }
+
+    kc_sim_cat_out o;
+    kc_sim_cat_handle(&r->cat, f, len, now, &o);
+    if (o.replyLen) {
+        out_append(w, s, o.reply, o.replyLen);
+        count(&w->c.catOut, 1);
+        if (o.replyLen == 2 && o.reply[0] == '?') count(&w->c.unknown, 1);
+    }
+    push_ai(w, r, o.push, o.pushLen);
+}
+
+static void read_session(worker *w, radio *r, session *s, uint64_t now) {
+    for (;;) {
+        ssize_t n = recv(s->fd, s->in + s->inLen, IN_MAX - s->inLen, 0);
+        if (n == 0) {
+            s->closing = 1;
+            return;
+        }
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) s->closing = 1;
+            return;
+        }
+        s->lastRxNs = now;
+        size_t start = 0, end = s->inLen + (size_t)n;
+        for (size_t i = s->inLen; i < end && !s->closing; i++) {
+            if (s->in[i] != ';') continue;
+            handle_frame(w, r, s, s->in + start, i - start, now);
+            start = i + 1;
+        }
+        memmove(s->in, s->in + start, end - start);
+        s->inLen = end - start;
+        if (s->inLen == IN_MAX) s->closing = 1;
+        if (s->closing) return;
+    }
+}
+
+static void close_session(worker *w, radio *r, int i) {
+    session *s = r->sessions[i];
+    if (r->voip == s) stop_stream(w, r);
+    if (s->loggedIn) {
+        r->loggedIn--;
+        atomic_fetch_sub(&w->c.loggedIn, 1);
+    }
+    close(s->fd);
+    free(s->out);
+    free(s);
+    r->sessions[i] = r->sessions[--r->nSessions];
+    atomic_fetch_sub(&w->c.sessions, 1);
+    w->dirty = 1;
+}
+
+static void accept_sessions(worker *w, radio *r, uint64_t now) {
+    for (;;) {
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof from;
+        int fd = accept(r->tcpFd, (struct sockaddr *)&from, &fromLen);
+        if (fd < 0) return;
+        session *s = r->nSessions < MAX_SESSIONS ? calloc(1, sizeof *s) : NULL;
+        if (!s || set_nonblocking(fd) != 0) {
+            count(&w->c.refused, 1);
+            free(s);
+            close(fd);
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        s->fd = fd;
+        s->peer = from.sin_addr;
+        s->lastRxNs = now;
+        if (g_opts.noLogin && r->loggedIn < g_opts.sessions) {
+            s->loggedIn = 1;
+            r->loggedIn++;
+            atomic_fetch_add(&w->c.loggedIn, 1);
+        }
+        r->sessions[r->nSessions++] = s;
+        atomic_fetch_add(&w->c.sessions, 1);
+        w->dirty = 1;
+    }
+}
+
+/* Mic audio, the app's probe, or anything else from the streaming session's host. */
+static void read_udp(worker *w, radio *r) {
+    uint8_t buf[2048];
+    for (int k = 0; k < 64; k++) {
+        struct sockaddr_in from;
+        socklen_t fromLen = sizeof from;
+        ssize_t n = recvfrom(r->udpFd, buf, sizeof buf, 0, (struct sockaddr *)&from, &fromLen);
+        if (n < 0) return;
+        if (!r->voip || from.sin_addr.s_addr != r->voip->peer.s_addr) continue;
+        /* Our own stream, when the client is on this host and hasn't said where it listens. */
+        if (from.sin_addr.s_addr == r->where.sin_addr.s_addr &&
+            ntohs(from.sin_port) == ntohs(r->where.sin_port) + 1)
+            continue;
+        r->dest.sin_port = from.sin_port;
+        if (n != PACKET_BYTES || buf[0] >> 6 != 2) continue;
+        uint16_t seq = (uint16_t)(buf[2] << 8 | buf[3]);
+        if (r->micSeen && seq != r->micNextSeq) count(&w->c.micGaps, 1);
+        r->micSeen = 1;
+        r->micNextSeq = (uint16_t)(seq + 1);
+        count(&w->c.micPackets, 1);
+    }
+}
+
+/* ---- Audio stream ---- */
+
+static void on_frame(worker *w, const event *e) {
+    radio *r = e->r;
+    r->seq = (uint16_t)(e->seq + 1);
+    heap_push(w, (event){ .at = e->at + FRAME_NS, .r = r, .gen = e->gen, .seq = r->seq, .kind = EV_FRAME });
+
+    /* Three draws per packet whatever is switched on, as in kc_replay. */
+    double loss = kc_rng_uniform(&r->rng) * 100.0;
+    double reorder = kc_rng_uniform(&r->rng) * 100.0;
+    uint64_t at = e->at + (uint64_t)(kc_rng_uniform(&r->rng) * g_opts.jitterMs * 1e6);
+    if (loss < g_opts.lossPct) {
+        count(&w->c.rtpLost, 1);
+        return;
+    }
+    if (reorder < g_opts.reorderPct) {
+        at += HOLD_BACK_NS;
+        count(&w->c.rtpHeld, 1);
+    }
+    heap_push(w, (event){ .at = at, .r = r, .gen = e->gen, .seq = e->seq, .kind = EV_SEND });
+}
+
+static void on_send(worker *w, const event *e, uint64_t now) {
+    radio *r = e->r;
+    uint8_t pkt[PACKET_BYTES];
+    pkt[0] = 0x80;                        /* V=2 */
+    pkt[1] = 0x60;                        /* PT=96 */
+    pkt[2] = (uint8_t)(e->seq >> 8);
+    pkt[3] = (uint8_t)e->seq;
+    memset(pkt + 4, 0, 4);                /* the radio's timestamps aren't used */
+    memcpy(pkt + 8, "890", 4);
+    memcpy(pkt + 12, g_loop + (size_t)((r->loopStart + e->seq) % LOOP_FRAMES) * PAYLOAD_BYTES, PAYLOAD_BYTES);
+    if (sendto(r->udpFd, pkt, sizeof pkt, 0, (struct sockaddr *)&r->dest, sizeof r->dest) == (ssize_t)sizeof pkt)
+        count(&w->c.rtpSent, 1);
+    else
+        count(&w->c.sendErrors, 1);
+
+    uint64_t late = now > e->at ? now - e->at : 0;
+    if (late > 2000000) count(&w->c.late2ms, 1);
+    if (late > atomic_load_explicit(&w->c.maxLateNs, memory_order_relaxed))
+        atomic_store_explicit(&w->c.maxLateNs, late, memory_order_relaxed);
+}
+
+/* ---- Worker ---- */
+
+static void housekeep(worker *w, uint64_t now) {
+    kc_sim_cat_out o;
+    for (int i = 0; i < w->nRadios; i++) {
+        radio *r = &w->radios[i];
+        if (kc_sim_cat_tick(&r->cat, now, &o)) push_ai(w, r, o.push, o.pushLen);
+        /* Someone turning the VFO A knob: 10 Hz steps, reversing every 10 kHz. */
+        if (g_opts.tuneRate > 0.0) {
+            uint64_t step = (uint64_t)(1e9 / g_opts.tuneRate);
+            for (; r->nextTuneNs <= now; r->nextTuneNs += step) {
+                if (r->loggedIn == 0) continue;
+                if ((r->cat.fa / 10) % 1000 == 0) r->tuneDir = -r->tuneDir;
+                char f[24];
+                snprintf(f, sizeof f, "FA%011lld", r->cat.fa + 10 * r->tuneDir);
+                kc_sim_cat_handle(&r->cat, f, strlen(f), now, &o);
+                push_ai(w, r, o.push, o.pushLen);
+            }
+        }
+        for (int k = r->nSessions - 1; k >= 0; k--) {
+            session *s = r->sessions[k];
+            if (g_opts.idleSec > 0.0 && now - s->lastRxNs > (uint64_t)(g_opts.idleSec * 1e9)) {
+                count(&w->c.idleClosed, 1);
+                s->closing = 1;
+            }
+            if (s->outLen) flush(w, s);
+            if (s->closing == 1 || (s->closing == 2 && s->outLen == 0)) close_session(w, r, k);
+        }
+    }
+}
+
+static void rebuild_fds(worker *w) {
+    size_t need = 0;
+    for (int i = 0; i < w->nRadios; i++) need += 2 + (size_t)w->radios[i].nSessions;
+    if (need > w->capPfd) {
+        struct pollfd *p = realloc(w->pfd, need * sizeof *p);
+        fd_owner *o = p ? realloc(w->owner, need * sizeof *o) : NULL;
+        if (p) w->pfd = p;
+        if (o) w->owner = o;
+        if (!p || !o) return;
+        w->capPfd = need;
+    }
+    size_t n = 0;
+    for (int i = 0; i < w->nRadios; i++) {
+        radio *r = &w->radios[i];
+        w->pfd[n] = (struct pollfd){ .fd = r->tcpFd, .events = POLLIN };
+        w->owner[n++] = (fd_owner){ FD_LISTEN, r, NULL };
+        w->pfd[n] = (struct pollfd){ .fd = r->udpFd, .events = POLLIN };
+        w->owner[n++] = (fd_owner){ FD_UDP, r, NULL };
+        for (int k = 0; k < r->nSessions; k++) {
+            w->pfd[n] = (struct pollfd){ .fd = r->sessions[k]->fd, .events = POLLIN };
+            w->owner[n++] = (fd_owner){ FD_SESSION, r, r->sessions[k] };
+        }
+    }
+    w->nPfd = n;
+    w->dirty = 0;
+}
+
+static void *worker_main(void *arg) {
+    worker *w = arg;
+    uint64_t nextHousekeep = now_ns();
+    w->dirty = 1;
+    while (!atomic_load_explicit(&g_stop, memory_order_relaxed)) {
+        uint64_t now = now_ns();
+        while (w->nHeap > 0 && w->heap[0].at <= now) {
+            event e = heap_pop(w);
+            if (e.r->gen != e.gen || !e.r->voip) continue;
+            if (e.kind == EV_FRAME) on_frame(w, &e);
+            else on_send(w, &e, now);
+        }
+        if (now >= nextHousekeep) {
+            housekeep(w, now);
+            nextHousekeep = now + HOUSEKEEP_NS;
+        }
+        if (w->dirty) rebuild_fds(w);
+        for (size_t i = 0; i < w->nPfd; i++)
+            if (w->owner[i].kind == FD_SESSION)
+                w->pfd[i].events = (short)(POLLIN | (w->owner[i].s->outLen ? POLLOUT : 0));
+
+        uint64_t next = nextHousekeep;
+        if (w->nHeap > 0 && w->heap[0].at < next) next = w->heap[0].at;
+        now = now_ns();
+        int timeout = next > now + SPIN_NS ? (int)((next - now - SPIN_NS / 2) / 1000000ull) : 0;
+        int ready = poll(w->pfd, (nfds_t)w->nPfd, timeout);
+        if (ready > 0) {
+            now = now_ns();
+            for (size_t i = 0; i < w->nPfd && ready > 0; i++) {
+                if (!w->pfd[i].revents) continue;
+                ready--;
+                fd_owner *o = &w->owner[i];
+                if (o->kind == FD_LISTEN) accept_sessions(w, o->r, now);
+                else if (o->kind == FD_UDP) read_udp(w, o->r);
+                else {
+                    if (w->pfd[i].revents & (POLLIN | POLLHUP | POLLERR)) read_session(w, o->r, o->s, now);
+                    if (o->s->outLen) flush(w, o->s);
+                    if (o->s->closing) nextHousekeep = now;   /* close it on this pass */
+                }
+            }
+        } else if (ready == 0) {
+            /* Poll only has millisecond resolution; sleep out the rest. */
+            if (w->nHeap > 0 && w->heap[0].at < nextHousekeep) sleep_until(w->heap[0].at);
+        }
+    }
+    return NULL;
+}
+
+/* ---- Setup ---- */
+
+static int open_radio(radio *r, int index) {
+    struct in_addr base;
+    if (inet_pton(AF_INET, g_opts.addr, &base) != 1) {
+        fprintf(stderr, "kc-sim: %s: not an IPv4 address\n", g_opts.addr);
+        return -1;
+    }
+    r->index = index;
+    r->where.sin_family = AF_INET;
+    if (g_opts.portStep > 0) {
+        r->where.sin_addr = base;
+        r->where.sin_port = htons((uint16_t)(g_opts.port + g_opts.portStep * index));
+    } else {
+        r->where.sin_addr.s_addr = htonl(ntohl(base.s_addr) + (uint32_t)index);
+        r->where.sin_port = htons((uint16_t)g_opts.port);
+    }
+    struct sockaddr_in u = r->where;
+    u.sin_port = htons((uint16_t)(ntohs(r->where.sin_port) + 1));
+
+    int one = 1;
+    r->tcpFd = socket(AF_INET, SOCK_STREAM, 0);
+    r->udpFd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (r->tcpFd < 0 || r->udpFd < 0) {
+        perror("kc-sim: socket");
+        return -1;
+    }
+    setsockopt(r->tcpFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    char a[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &r->where.sin_addr, a, sizeof a);
+    if (bind(r->tcpFd, (struct sockaddr *)&r->where, sizeof r->where) != 0 || listen(r->tcpFd, 8) != 0) {
+        fprintf(stderr, "kc-sim: radio %d: TCP %s:%d: %s\n", index, a, ntohs(r->where.sin_port), strerror(errno));
+        return -1;
+    }
+    if (bind(r->udpFd, (struct sockaddr *)&u, sizeof u) != 0) {
+        fprintf(stderr, "kc-sim: radio %d: UDP %s:%d: %s\n", index, a, ntohs(u.sin_port), strerror(errno));
+        return -1;
+    }
+    if (set_nonblocking(r->tcpFd) != 0 || set_nonblocking(r->udpFd) != 0) return -1;
+
+    kc_sim_cat_init(&r->cat);
+    kc_rng_seed(&r->rng, g_opts.seed + (uint64_t)index);
+    r->seq = (uint16_t)kc_rng_next(&r->rng);
+    r->loopStart = (uint32_t)(((uint64_t)index * 7919u) % LOOP_FRAMES);
+    r->tuneDir = 1;
+    r->nextTuneNs = now_ns();
+    return 0;
+}
+
+static int make_loop(void) {
+    size_t n = (size_t)LOOP_FRAMES * SAMPLES;
+    float *x = calloc(n, sizeof *x);
+    g_loop = malloc(n * 2);
+    if (!x || !g_loop) {
+        free(x);
+        return -1;
+    }
+    double amp = pow(10.0, g_opts.levelDb / 20.0);
+    switch (g_opts.signal) {
+    case SIG_VOICE: kc_sig_voice(x, n, RATE, g_opts.seed, amp); break;
+    case SIG_CW: kc_sig_cw(x, n, RATE, g_opts.hz, 20.0, "CQ CQ DE KC0SIM KC0SIM K", amp); break;
+    case SIG_FSK8: kc_sig_fsk8(x, n, RATE, g_opts.hz, g_opts.seed, amp); break;
+    case SIG_TONE:
+        for (size_t i = 0; i < n; i++) x[i] = (float)(amp * sin(2.0 * M_PI * g_opts.hz * (double)i / RATE));
+        break;
+    case SIG_SILENCE: break;
+    }
+    if (g_opts.noiseDb > -150.0) kc_sig_noise(x, n, pow(10.0, g_opts.noiseDb / 20.0), g_opts.seed + 1);
+    kc_pcm_f32_to_s16le(x, g_loop, n, 32767.0f, NULL);
+    free(x);
+    return 0;
+}
+
+static void on_signal(int sig) {
+    (void)sig;
+    atomic_store(&g_stop, 1);
+}
+
+/* ---- Report ---- */
+
+typedef struct totals {
+    int      sessions, loggedIn, streams;
+    uint64_t rtpSent, rtpLost, rtpHeld, sendErrors, late2ms, maxLateNs;
+    uint64_t catIn, catOut, aiPush, unknown, micPackets, micGaps;
+    uint64_t loginFailures, refused, idleClosed, slowClosed;
+} totals;
+
+static void sum(const worker *ws, int n, totals *t) {
+    memset(t, 0, sizeof *t);
+    for (int i = 0; i < n; i++) {
+        const sim_counters *c = &ws[i].c;
+        t->sessions += atomic_load(&c->sessions);
+        t->loggedIn += atomic_load(&c->loggedIn);
+        t->streams += atomic_load(&c->streams);
+#define ADD(f) t->f += atomic_load_explicit(&c->f, memory_order_relaxed)
+        ADD(rtpSent); ADD(rtpLost); ADD(rtpHeld); ADD(sendErrors); ADD(late2ms);
+        ADD(catIn); ADD(catOut); ADD(aiPush); ADD(unknown); ADD(micPackets); ADD(micGaps);
+        ADD(loginFailures); ADD(refused); ADD(idleClosed); ADD(slowClosed);
+#undef ADD
+        uint64_t m = atomic_load_explicit(&c->maxLateNs, memory_order_relaxed);
+        if (m > t->maxLateNs) t->maxLateNs = m;
+    }
+}
+
+static void report(double t, const totals *cur, const totals *prev, double dt) {
+#define RATE_OF(f) ((double)(cur->f - prev->f) / dt)
+    printf("%7.1fs  sessions %d (%d logged in, %d streaming)  rtp %.0f/s (lost %.0f/s, late>2ms %llu, max late %.2f ms)"
+           "  cat in %.0f/s out %.0f/s ai %.0f/s  mic %.0f/s\n",
+           t, cur->sessions, cur->loggedIn, cur->streams, RATE_OF(rtpSent), RATE_OF(rtpLost),
+           (unsigned long long)(cur->late2ms - prev->late2ms), cur->maxLateNs / 1e6,
+           RATE_OF(catIn), RATE_OF(catOut), RATE_OF(aiPush), RATE_OF(micPackets));
+#undef RATE_OF
+    fflush(stdout);
+}
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-sim [options]\n"
+        "radios:\n"
+        "  -n, --radios N       simulated radios (default 1)\n"
+        "  -j, --threads N      worker threads (default 1)\n"
+        "      --addr A         first radio's address; radio i uses A + i (default 127.0.0.1)\n"
+        "      --port P         CAT port; audio is P + 1 (default 60000)\n"
+        "      --port-step K    radio i on A, ports P + K*i (for systems with only 127.0.0.1)\n"
+        "      --client-port P  where streams go until the client sends from elsewhere (default 60001)\n"
+        "sessions:\n"
+        "      --user ID        KNS account (default admin)\n"
+        "      --password PW    KNS password (default admin)\n"
+        "      --no-login       sessions start logged in\n"
+        "      --clients N      logged-in sessions per radio (default 1, at most %d)\n"
+        "      --idle S         close sessions silent this long, 0 = never (default 10)\n"
+        "      --tune RATE      VFO A steps per second per radio, pushed to AI sessions (default 0)\n"
+        "audio:\n"
+        "      --signal KIND    voice, tone, cw, fsk8 or silence (default voice)\n"
+        "      --hz F           tone, CW or FSK8 base frequency (default 1000, 700, 1500)\n"
+        "      --level DB       signal peak, dBFS (default -12)\n"
+        "      --noise DB       noise RMS, dBFS; -200 for none (default -50)\n"
+        "      --jitter MS      random extra delay per packet, 0..MS (default 0)\n"
+        "      --loss PCT       packets never sent (default 0)\n"
+        "      --reorder PCT    packets sent after their successor (default 0)\n"
+        "      --seed N         random seed (default 1)\n"
+        "run:\n"
+        "  -t, --seconds S      stop after S seconds, 0 = at Ctrl-C (default 0)\n"
+        "      --report S       status line interval (default 5)\n"
+        "  -h, --help\n", MAX_SESSIONS);
+}
+
+int main(int argc, char **argv) {
+    g_opts = (sim_opts){ .radios = 1, .threads = 1, .sessions = 1, .addr = "127.0.0.1", .port = 60000,
+                         .clientPort = 60001, .user = "admin", .password = "admin", .idleSec = 10.0,
+                         .signal = SIG_VOICE, .hz = 0.0, .levelDb = -12.0, .noiseDb = -50.0, .seed = 1,
+                         .reportSec = 5.0 };
+    enum { OPT_ADDR = 256, OPT_PORT, OPT_PORT_STEP, OPT_CLIENT_PORT, OPT_USER, OPT_PASSWORD, OPT_NO_LOGIN,
+           OPT_CLIENTS, OPT_IDLE, OPT_TUNE, OPT_SIGNAL, OPT_HZ, OPT_LEVEL, OPT_NOISE, OPT_JITTER, OPT_LOSS,
+           OPT_REORDER, OPT_SEED, OPT_REPORT };
+    static const struct option longOpts[] = {
+        { "radios", required_argument, NULL, 'n' },
+        { "threads", required_argument, NULL, 'j' },
+        { "addr", required_argument, NULL, OPT_ADDR },
+        { "port", required_argument, NULL, OPT_PORT },
+        { "port-step", required_argument, NULL, OPT_PORT_STEP },
+        { "client-port", required_argument, NULL, OPT_CLIENT_PORT },
+        { "user", required_argument, NULL, OPT_USER },
+        { "password", required_argument, NULL, OPT_PASSWORD },
+        { "no-login", no_argument, NULL, OPT_NO_LOGIN },
+        { "clients", required_argument, NULL, OPT_CLIENTS },
+        { "idle", required_argument, NULL, OPT_IDLE },
+        { "tune", required_argument, NULL, OPT_TUNE },
+        { "signal", required_argument, NULL, OPT_SIGNAL },
+        { "hz", required_argument, NULL, OPT_HZ },
+        { "level", required_argument, NULL, OPT_LEVEL },
+        { "noise", required_argument, NULL, OPT_NOISE },
+        { "jitter", required_argument, NULL, OPT_JITTER },
+        { "loss", required_argument, NULL, OPT_LOSS },
+        { "reorder", required_argument, NULL, OPT_REORDER },
+        { "seed", required_argument, NULL, OPT_SEED },
+        { "seconds", required_argument, NULL, 't' },
+        { "report", required_argument, NULL, OPT_REPORT },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    static const char *signals[] = { "voice", "tone", "cw", "fsk8", "silence" };
+    int c;
+    while ((c = getopt_long(argc, argv, "n:j:t:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'n': g_opts.radios = atoi(optarg); break;
+        case 'j': g_opts.threads = atoi(optarg); break;
+        case OPT_ADDR: g_opts.addr = optarg; break;
+        case OPT_PORT: g_opts.port = atoi(optarg); break;
+        case OPT_PORT_STEP: g_opts.portStep = atoi(optarg); break;
+        case OPT_CLIENT_PORT: g_opts.clientPort = atoi(optarg); break;
+        case OPT_USER: g_opts.user = optarg; break;
+        case OPT_PASSWORD: g_opts.password = optarg; break;
+        case OPT_NO_LOGIN: g_opts.noLogin = 1; break;
+        case OPT_CLIENTS: g_opts.sessions = atoi(optarg); break;
+        case OPT_IDLE: g_opts.idleSec = atof(optarg); break;
+        case OPT_TUNE: g_opts.tuneRate = atof(optarg); break;
+        case OPT_SIGNAL: {
+            int k = -1;
+            for (int i = 0; i < 5; i++)
+                if (!strcmp(optarg, signals[i])) k = i;
+            if (k < 0) {
+                usage(stderr);
+                return 2;
+            }
+            g_opts.signal = (sig_kind)k;
+            break;
+        }
+        case OPT_HZ: g_opts.hz = atof(optarg); break;
+        case OPT_LEVEL: g_opts.levelDb = atof(optarg); break;
+        case OPT_NOISE: g_opts.noiseDb = atof(optarg); break;
+        case OPT_JITTER: g_opts.jitterMs = atof(optarg); break;
+        case OPT_LOSS: g_opts.lossPct = atof(optarg); break;
+        case OPT_REORDER: g_opts.reorderPct = atof(optarg); break;
+        case OPT_SEED: g_opts.seed = strtoull(optarg, NULL, 10); break;
+        case 't': g_opts.seconds = atof(optarg); break;
+        case OPT_REPORT: g_opts.reportSec = atof(optarg); break;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    if (optind != argc || g_opts.radios < 1 || g_opts.threads < 1 || g_opts.sessions < 1 ||
+        g_opts.sessions > MAX_SESSIONS || g_opts.reportSec <= 0.0 || g_opts.port < 1 ||
+        g_opts.port + g_opts.portStep * (g_opts.radios - 1) + 1 > 65535) {
+        usage(stderr);
+        return 2;
+    }
+    if (g_opts.hz <= 0.0)
+        g_opts.hz = g_opts.signal == SIG_CW ? 700.0 : g_opts.signal == SIG_FSK8 ? 1500.0 : 1000.0;
+    if (g_opts.threads > g_opts.radios) g_opts.threads = g_opts.radios;
+    if (g_opts.tuneRate > 1000.0) g_opts.tuneRate = 1000.0;
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    if (make_loop() != 0) {
+        fprintf(stderr, "kc-sim: out of memory\n");
+        return 1;
+    }
+    radio *radios = calloc((size_t)g_opts.radios, sizeof *radios);
+    worker *ws = calloc((size_t)g_opts.threads, sizeof *ws);
+    if (!radios || !ws) {
+        fprintf(stderr, "kc-sim: out of memory\n");
+        return 1;
+    }
+    for (int i = 0; i < g_opts.radios; i++)
+        if (open_radio(&radios[i], i) != 0) return 1;
+
+    char a[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &radios[g_opts.radios - 1].where.sin_addr, a, sizeof a);
+    printf("%d radio%s, %s:%d", g_opts.radios, g_opts.radios == 1 ? "" : "s", g_opts.addr, g_opts.port);
+    if (g_opts.radios > 1) printf(" .. %s:%d", a, ntohs(radios[g_opts.radios - 1].where.sin_port));
+    printf(", %d thread%s, %s %.0f dBFS, noise %.0f dBFS\n", g_opts.threads, g_opts.threads == 1 ? "" : "s",
+           signals[g_opts.signal], g_opts.levelDb, g_opts.noiseDb);
+    fflush(stdout);
+
+    for (int t = 0, first = 0; t < g_opts.threads; t++) {
+        int count = g_opts.radios / g_opts.threads + (t < g_opts.radios % g_opts.threads);
+        ws[t].radios = radios + first;
+        ws[t].nRadios = count;
+        first += count;
+        if (pthread_create(&ws[t].thread, NULL, worker_main, &ws[t]) != 0) {
+            fprintf(stderr, "kc-sim: can't start worker %d\n", t);
+            return 1;
+        }
+    }
+
+    uint64_t start = now_ns(), lastReport = start;
+    totals prev = { 0 }, cur;
+    while (!atomic_load(&g_stop)) {
+        uint64_t next = lastReport + (uint64_t)(g_opts.reportSec * 1e9);
+        uint64_t end = g_opts.seconds > 0.0 ? start + (uint64_t)(g_opts.seconds * 1e9) : UINT64_MAX;
+        uint64_t wake = next < end ? next : end;
+        while (!atomic_load(&g_stop) && now_ns() < wake) sleep_until(now_ns() + 100000000ull < wake ? now_ns() + 100000000ull : wake);
+        uint64_t now = now_ns();
+        if (now >= end) atomic_store(&g_stop, 1);
+        sum(ws, g_opts.threads, &cur);
+        report((now - start) / 1e9, &cur, &prev, (now - lastReport) / 1e9);
+        prev = cur;
+        lastReport = now;
+    }
+    for (int t = 0; t < g_opts.threads; t++) pthread_join(ws[t].thread, NULL);
+
+    sum(ws, g_opts.threads, &cur);
+    printf("total: %llu rtp sent (%llu lost, %llu held back, %llu send errors, %llu late>2ms, max late %.2f ms), "
+           "%llu cat frames in, %llu out, %llu ai, %llu unknown, %llu mic packets (%llu gaps); "
+           "sessions: %llu login failures, %llu refused, %llu idle, %llu too slow\n",
+           (unsigned long long)cur.rtpSent, (unsigned long long)cur.rtpLost, (unsigned long long)cur.rtpHeld,
+           (unsigned long long)cur.sendErrors, (unsigned long long)cur.late2ms, cur.maxLateNs / 1e6,
+           (unsigned long long)cur.catIn, (unsigned long long)cur.catOut, (unsigned long long)cur.aiPush,
+           (unsigned long long)cur.unknown, (unsigned long long)cur.micPackets, (unsigned long long)cur.micGaps,
+           (unsigned long long)cur.loginFailures, (unsigned long long)cur.refused,
+           (unsigned long long)cur.idleClosed, (unsigned long long)cur.slowClosed);
+    return 0;
+}
@@ -0,0 +1,385 @@
+/*  kc_sim_cat.c
+ *
+ *  See kc_sim_cat.h.
+ */
+
+#include "kc_sim_cat.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TUNE_NS 1500000000ull           /* the ATU takes 1.5 s */
+
+static void append(char *buf, size_t *len, const char *fmt, va_list ap) {
+    int n = vsnprintf(buf + *len, KC_SIM_OUT_MAX - *len, fmt, ap);
+    if (n > 0) *len += (size_t)n < KC_SIM_OUT_MAX - *len ? (size_t)n : KC_SIM_OUT_MAX - 1 - *len;
+}
+
+static void reply(kc_sim_cat_out *o, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    append(o->reply, &o->replyLen, fmt, ap);
+    va_end(ap);
+}
+
+static void push(kc_sim_cat_out *o, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    append(o->push, &o->pushLen, fmt, ap);
+    va_end(ap);
+}
+
+/* Exactly n decimal digits at p. */
+static int digits(const char *p, size_t n, long long *out) {
+    long long v = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (p[i] < '0' || p[i] > '9') return 0;
+        v = 10 * v + (p[i] - '0');
+    }
+    *out = v;
+    return 1;
+}
+
+/* A set command with exactly n digits after the name and value in [lo, hi]. */
+static int set_value(const char *f, size_t len, size_t nameLen, size_t n, long long lo, long long hi, long long *v) {
+    return len == nameLen + n && digits(f + nameLen, n, v) && *v >= lo && *v <= hi;
+}
+
+static int hexdigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void memory_name(kc_sim_memory *m, const char *name, size_t len) {
+    if (len > 10) len = 10;
+    memcpy(m->name, name, len);
+    while (len > 0 && m->name[len - 1] == ' ') len--;
+    m->name[len] = 0;
+}
+
+void kc_sim_cat_init(kc_sim_cat *s) {
+    memset(s, 0, sizeof *s);
+    s->fa = 14074000;
+    s->fb = 7074000;
+    s->mode = 2;                        /* USB */
+    s->lowCut = 3;
+    s->highCut = 10;
+    s->power = 100;
+    s->afGain = 100;
+    s->rfGain = 255;
+    s->voipIn = 50;
+    s->voipOut = 50;
+    s->meter = 20;
+    static const struct { int ch; long long hz; int mode; const char *name; } preset[] = {
+        { 0, 3573000, 2, "FT8 80m" },
+        { 1, 7074000, 2, "FT8 40m" },
+        { 2, 14074000, 2, "FT8 20m" },
+        { 3, 14025000, 3, "CW 20m" },
+        { 10, 145500000, 4, "2m FM" },
+    };
+    for (size_t i = 0; i < sizeof preset / sizeof preset[0]; i++) {
+        kc_sim_memory *m = &s->mem[preset[i].ch];
+        m->hz = preset[i].hz;
+        m->mode = preset[i].mode;
+        memory_name(m, preset[i].name, strlen(preset[i].name));
+    }
+    for (int m = 30; m <= 32; m++) s->menuSigned[m] = 1;
+    for (int m = 60; m <= 62; m++) s->menuSigned[m] = 1;
+}
+
+static void recall_channel(kc_sim_cat *s, kc_sim_cat_out *o) {
+    const kc_sim_memory *m = &s->mem[s->channel];
+    if (!s->memoryMode || m->hz == 0) return;
+    s->fa = m->hz;
+    s->mode = m->mode ? m->mode : s->mode;
+    push(o, "FA%011lld;OM0%X;", s->fa, s->mode);
+}
+
+/* FA, FB: 11-digit Hz. */
+static int cmd_vfo(long long *hz, char name, const char *f, size_t len, kc_sim_cat_out *o) {
+    long long v;
+    if (len == 2) {
+        reply(o, "F%c%011lld;", name, *hz);
+        return 1;
+    }
+    if (!set_value(f, len, 2, 11, 0, 99999999999ll, &v)) return 0;
+    if (v != *hz) {
+        *hz = v;
+        push(o, "F%c%011lld;", name, v);
+    }
+    return 1;
+}
+
+/* Two-letter commands with one fixed-width unsigned value. */
+static int cmd_int(int *field, const char *f, size_t len, size_t n, long long lo, long long hi, kc_sim_cat_out *o) {
+    long long v;
+    if (len == 2) {
+        reply(o, "%.2s%0*d;", f, (int)n, *field);
+        return 1;
+    }
+    if (!set_value(f, len, 2, n, lo, hi, &v)) return 0;
+    if (v != *field) {
+        *field = (int)v;
+        push(o, "%.2s%0*d;", f, (int)n, *field);
+    }
+    return 1;
+}
+
+static void rit_report(const kc_sim_cat *s, kc_sim_cat_out *o) {
+    push(o, "RF%d%04d;", s->ritHz < 0, s->ritHz < 0 ? -s->ritHz : s->ritHz);
+}
+
+static int handle(kc_sim_cat *s, const char *f, size_t len, uint64_t nowNs, kc_sim_cat_out *o) {
+    long long v;
+    if (len < 2) return 0;
+
+    if (len >= 5 && !memcmp(f, "##KN3", 5)) {
+        if (len < 6 || (f[5] != '0' && f[5] != '1')) return 0;
+        int *level = f[5] == '0' ? &s->voipIn : &s->voipOut;
+        if (len == 6) {
+            reply(o, "##KN3%c%03d;", f[5], *level);
+            return 1;
+        }
+        if (!set_value(f, len, 6, 3, 0, 100, &v)) return 0;
+        *level = (int)v;
+        return 1;
+    }
+
+    char a = f[0], b = f[1];
+#define IS(x, y) (a == (x) && b == (y))
+    if (IS('F', 'A')) return cmd_vfo(&s->fa, 'A', f, len, o);
+    if (IS('F', 'B')) return cmd_vfo(&s->fb, 'B', f, len, o);
+    if (IS('M', 'D')) return cmd_int(&s->md, f, len, 1, 0, 9, o);
+    if (IS('D', 'A')) return cmd_int(&s->da, f, len, 1, 0, 1, o);
+    if (IS('F', 'R')) return cmd_int(&s->fr, f, len, 1, 0, 1, o);
+    if (IS('F', 'T')) return cmd_int(&s->ft, f, len, 1, 0, 1, o);
+    if (IS('N', 'R')) return cmd_int(&s->nr, f, len, 1, 0, 2, o);
+    if (IS('N', 'T')) return cmd_int(&s->nt, f, len, 1, 0, 1, o);
+    if (IS('R', 'T')) return cmd_int(&s->rt, f, len, 1, 0, 1, o);
+    if (IS('X', 'T')) return cmd_int(&s->xt, f, len, 1, 0, 1, o);
+    if (IS('A', 'G')) return cmd_int(&s->afGain, f, len, 3, 0, 255, o);
+    if (IS('R', 'G')) return cmd_int(&s->rfGain, f, len, 3, 0, 255, o);
+    if (IS('S', 'Q')) return cmd_int(&s->squelch, f, len, 3, 0, 255, o);
+    if (IS('P', 'C')) return cmd_int(&s->power, f, len, 3, 5, 100, o);
+
+    if (IS('O', 'M')) {
+        if (len < 3 || (f[2] != '0' && f[2] != '1')) return 0;
+        if (len == 3) {
+            reply(o, "OM%c%X;", f[2], s->mode);
+            return 1;
+        }
+        int m = len == 4 ? hexdigit(f[3]) : -1;
+        if (m < 1) return 0;
+        if (m != s->mode) {
+            s->mode = m;
+            push(o, "OM0%X;", m);
+        }
+        return 1;
+    }
+    if (IS('S', 'M')) {
+        if (len != 2 && !(len == 3 && f[2] == '0')) return 0;
+        reply(o, "SM%04d;", s->tx ? 0 : s->meter);
+        return 1;
+    }
+    if (IS('R', 'C')) {
+        if (len != 2) return 0;
+        if (s->ritHz != 0) {
+            s->ritHz = 0;
+            rit_report(s, o);
+        }
+        return 1;
+    }
+    if (IS('R', 'U') || IS('R', 'D')) {
+        int sign = b == 'U' ? 1 : -1;
+        if (len == 2) v = 10;
+        else if (!set_value(f, len, 2, 5, 0, 9999, &v)) return 0;
+        int hz = len == 2 ? s->ritHz + sign * (int)v : sign * (int)v;
+        if (hz > 9999) hz = 9999;
+        if (hz < -9999) hz = -9999;
+        if (hz != s->ritHz) {
+            s->ritHz = hz;
+            rit_report(s, o);
+        }
+        return 1;
+    }
+    if (IS('R', 'F')) {
+        if (len != 2) return 0;
+        reply(o, "RF%d%04d;", s->ritHz < 0, s->ritHz < 0 ? -s->ritHz : s->ritHz);
+        return 1;
+    }
+    if (IS('I', 'S')) {
+        if (len == 2) {
+            reply(o, "IS%c%04d;", s->shiftHz < 0 ? '-' : '+', s->shiftHz < 0 ? -s->shiftHz : s->shiftHz);
+            return 1;
+        }
+        if (len != 7 || (f[2] != '+' && f[2] != '-' && f[2] != ' ') || !digits(f + 3, 4, &v)) return 0;
+        s->shiftHz = f[2] == '-' ? -(int)v : (int)v;
+        push(o, "IS%c%04d;", s->shiftHz < 0 ? '-' : '+', (int)v);
+        return 1;
+    }
+    if (IS('S', 'L') || IS('S', 'H')) {
+        size_t n = b == 'L' ? 2 : 3;
+        int *id = b == 'L' ? &s->lowCut : &s->highCut;
+        if (len < 3 || f[2] != '0') return 0;
+        if (len == 3) {
+            reply(o, "S%c0%0*d;", b, (int)n, *id);
+            return 1;
+        }
+        if (!set_value(f, len, 3, n, 0, b == 'L' ? 99 : 999, &v)) return 0;
+        *id = (int)v;
+        push(o, "S%c0%0*d;", b, (int)n, *id);
+        return 1;
+    }
+    if (IS('A', 'C')) {
+        if (len == 2) {
+            reply(o, "AC%d%d%d;", s->atuRx, s->atuTx, s->tuning);
+            return 1;
+        }
+        if (len != 5 || (f[3] != '0' && f[3] != '1') || (f[4] != '0' && f[4] != '1')) return 0;
+        s->atuTx = f[3] - '0';
+        if (f[4] == '1') {
+            s->atuTx = 1;
+            s->tuning = 1;
+            s->tuneEndNs = nowNs + TUNE_NS;
+        } else {
+            s->tuning = 0;
+        }
+        push(o, "AC%d%d%d;", s->atuRx, s->atuTx, s->tuning);
+        return 1;
+    }
+    if (IS('S', 'P')) {
+        if (len == 2) {
+            reply(o, "SP%d;", s->split);
+            return 1;
+        }
+        if (len == 3 && (f[2] == '1' || f[2] == '2')) {
+            s->split = f[2] == '1';
+            push(o, "SP%d;", s->split);
+            return 1;
+        }
+        if (len == 5 && f[2] == '0' && (f[3] == '0' || f[3] == '1') && f[4] >= '1' && f[4] <= '9') {
+            s->fb = s->fa + (f[3] == '0' ? 1 : -1) * (f[4] - '0') * 1000ll;
+            s->split = 0;
+            push(o, "FB%011lld;SP0;", s->fb);
+            return 1;
+        }
+        return 0;
+    }
+    if (IS('M', 'V')) {
+        if (len == 2) {
+            reply(o, "MV%d;", s->memoryMode);
+            return 1;
+        }
+        if (len != 3 || (f[2] != '0' && f[2] != '1')) return 0;
+        if (s->memoryMode != f[2] - '0') {
+            s->memoryMode = f[2] - '0';
+            push(o, "MV%d;", s->memoryMode);
+            recall_channel(s, o);
+        }
+        return 1;
+    }
+    if (IS('M', 'N')) {
+        if (len == 2) {
+            reply(o, "MN%03d;", s->channel);
+            return 1;
+        }
+        if (!set_value(f, len, 2, 3, 0, KC_SIM_MEMORIES - 1, &v)) return 0;
+        s->channel = (int)v;
+        push(o, "MN%03d;", s->channel);
+        recall_channel(s, o);
+        return 1;
+    }
+    if (IS('M', 'A')) {
+        if (len < 3) return 0;
+        if (f[2] == '0') {
+            if (!set_value(f, len, 3, 3, 0, KC_SIM_MEMORIES - 1, &v)) return 0;
+            const kc_sim_memory *m = &s->mem[v];
+            reply(o, "MA0%03lld%011lld%X%d%-10s;", v, m->hz, m->mode, m->narrow, m->name);
+            return 1;
+        }
+        if (f[2] == '1') {
+            int mode = len == 16 ? hexdigit(f[14]) : -1;
+            if (len != 16 || !digits(f + 3, 11, &v) || mode < 0 || (f[15] != '0' && f[15] != '1')) return 0;
+            kc_sim_memory *m = &s->mem[s->channel];
+            m->hz = v;
+            m->mode = mode;
+            m->narrow = f[15] - '0';
+            return 1;
+        }
+        if (f[2] == '2') {
+            if (len < 7 || !digits(f + 3, 3, &v) || v >= KC_SIM_MEMORIES || f[6] != ' ') return 0;
+            memory_name(&s->mem[v], f + 7, len - 7);
+            return 1;
+        }
+        return 0;
+    }
+    if (IS('E', 'X')) {
+        if (len < 5 || !digits(f + 2, 3, &v) || v >= KC_SIM_MENUS) return 0;
+        int menu = (int)v;
+        if (len == 5) {
+            int x = s->menu[menu];
+            if (s->menuSigned[menu]) reply(o, "EX%03d%c%02d;", menu, x < 0 ? '-' : '+', x < 0 ? -x : x);
+            else reply(o, "EX%03d%03d;", menu, x);
+            return 1;
+        }
+        const char *p = f + 5;
+        size_t n = len - 5;
+        int sign = 0;
+        if (*p == '+' || *p == '-') {
+            sign = *p == '-' ? -1 : 1;
+            p++;
+            n--;
+        }
+        if (n == 0 || n > 4 || !digits(p, n, &v)) return 0;
+        s->menu[menu] = sign < 0 ? -(int)v : (int)v;
+        if (sign) s->menuSigned[menu] = 1;
+        return 1;
+    }
+    if (IS('T', 'X')) {
+        if (len > 3 || (len == 3 && (f[2] < '0' || f[2] > '2'))) return 0;
+        if (!s->tx) {
+            s->tx = 1;
+            push(o, "TX%c;", len == 3 ? f[2] : '0');
+        }
+        return 1;
+    }
+    if (IS('R', 'X')) {
+        if (len != 2) return 0;
+        if (s->tx) {
+            s->tx = 0;
+            push(o, "RX;");
+        }
+        return 1;
+    }
+    if (IS('I', 'D')) {
+        if (len != 2) return 0;
+        reply(o, "ID024;");
+        return 1;
+    }
+    if (IS('P', 'S')) {
+        if (len != 2) return 0;
+        reply(o, "PS1;");
+        return 1;
+    }
+#undef IS
+    return 0;
+}
+
+void kc_sim_cat_handle(kc_sim_cat *s, const char *frame, size_t len, uint64_t nowNs, kc_sim_cat_out *out) {
+    out->replyLen = out->pushLen = 0;
+    out->reply[0] = out->push[0] = 0;
+    if (!handle(s, frame, len, nowNs, out)) {
+        out->replyLen = out->pushLen = 0;
+        reply(out, "?;");
+    }
+}
+
+int kc_sim_cat_tick(kc_sim_cat *s, uint64_t nowNs, kc_sim_cat_out *out) {
+    out->replyLen = out->pushLen = 0;
+    if (!s->tuning || nowNs < s->tuneEndNs) return 0;
+    s->tuning = 0;
+    push(out, "AC%d%d%d;", s->atuRx, s->atuTx, s->tuning);
+    return 1;
+}
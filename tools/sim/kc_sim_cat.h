@@ -0,0 +1,70 @@
+/*  kc_sim_cat.h
+ *
+ *  The CAT side of the simulated TS-890 (kc-sim): one radio's state and the
+ *  commands the app sends, answered in the formats RadioState.handleFrame
+ *  parses (docs/ts890_command_map.md, KenwoodCAT.swift).
+ *
+ *  As on the radio, a read gets an answer and a set gets none; a set that
+ *  changes something is reported to every session with AI on (the sender
+ *  included), which is how the app sees its own changes. Anything unknown
+ *  or malformed is answered "?;".
+ *
+ *  Session commands (##CN, ##ID, ##VP, AI) belong to the connection, not
+ *  the radio, and are handled by kc-sim itself.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KC_SIM_MEMORIES 120
+#define KC_SIM_MENUS    1000
+#define KC_SIM_OUT_MAX  512
+
+typedef struct kc_sim_memory {
+    long long hz;                       /* 0 = empty */
+    int       mode, narrow;
+    char      name[11];
+} kc_sim_memory;
+
+typedef struct kc_sim_cat {
+    long long fa, fb;
+    int mode, md, da;                   /* OM mode (1..9), MD, DA */
+    int fr, ft, nr, nt, rt, xt;
+    int ritHz, shiftHz, lowCut, highCut;
+    int power, afGain, rfGain, squelch;
+    int atuRx, atuTx, tuning;
+    uint64_t tuneEndNs;
+    int split, memoryMode, channel;
+    int tx;
+    int voipIn, voipOut;
+    int meter;                          /* SM reading, 0..70 */
+    kc_sim_memory mem[KC_SIM_MEMORIES];
+    int  menu[KC_SIM_MENUS];
+    char menuSigned[KC_SIM_MENUS];      /* answered as +nn / -nn */
+} kc_sim_cat;
+
+/* What one frame produced: an answer for the sender, and a report for AI sessions. */
+typedef struct kc_sim_cat_out {
+    char   reply[KC_SIM_OUT_MAX];
+    size_t replyLen;
+    char   push[KC_SIM_OUT_MAX];
+    size_t pushLen;
+} kc_sim_cat_out;
+
+/* A radio on 14.074 MHz USB with a few memory channels filled in. */
+void kc_sim_cat_init(kc_sim_cat *s);
+
+/* Handles one frame, without its ';'. `out` is cleared first. */
+void kc_sim_cat_handle(kc_sim_cat *s, const char *frame, size_t len, uint64_t nowNs, kc_sim_cat_out *out);
+
+/* Time-driven changes (the tuner finishing). Returns 1 if something was pushed. */
+int  kc_sim_cat_tick(kc_sim_cat *s, uint64_t nowNs, kc_sim_cat_out *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,114 @@
+/*  kc_stats.c
+ *
+ *  Prints the LAN RX audio timing histograms and counters of a running app
+ *  (or of anything else that called kc_stats_open) by attaching read-only to
+ *  its stats file. The app logs the file's path at startup.
+ *
+ *  Usage: kc-stats [options] FILE   (kc-stats --help)
+ */
+
+#include "kc_audio_stats.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void print_table(FILE *to, const kc_stats_summary *s) {
+    fprintf(to, "%-12s %10s %9s %10s %10s %10s %10s\n",
+            "stage", "count", "per s", "mean us", "p50 us", "p99 us", "max us");
+    for (int i = 0; i < KC_STATS_STAGE_COUNT; i++) {
+        const kc_stats_stage_summary *st = &s->stage[i];
+        fprintf(to, "%-12s %10llu %9.1f %10.1f %10.1f %10.1f %10.1f\n",
+                kc_stats_stage_name((kc_stats_stage)i), (unsigned long long)st->count, st->perSecond,
+                st->meanNs / 1e3, st->p50Ns / 1e3, st->p99Ns / 1e3, st->maxNs / 1e3);
+    }
+    for (int i = 0; i < KC_STATS_COUNTER_COUNT; i++) {
+        fprintf(to, "%s%s %llu", i ? ", " : "", kc_stats_counter_name((kc_stats_counter)i),
+                (unsigned long long)s->counter[i]);
+        if (s->seconds > 0.0) fprintf(to, " (%.1f/s)", s->counterPerSecond[i]);
+    }
+    fprintf(to, "\n");
+}
+
+static void print_json(FILE *to, const kc_stats_summary *s) {
+    fprintf(to, "{\"seconds\": %.3f, \"stages\": {", s->seconds);
+    for (int i = 0; i < KC_STATS_STAGE_COUNT; i++) {
+        const kc_stats_stage_summary *st = &s->stage[i];
+        fprintf(to, "%s\"%s\": {\"count\": %llu, \"per_second\": %.2f, \"mean_ns\": %.0f, "
+                    "\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"max_ns\": %.0f}",
+                i ? ", " : "", kc_stats_stage_name((kc_stats_stage)i), (unsigned long long)st->count,
+                st->perSecond, st->meanNs, st->p50Ns, st->p99Ns, st->maxNs);
+    }
+    fprintf(to, "}, \"counters\": {");
+    for (int i = 0; i < KC_STATS_COUNTER_COUNT; i++) {
+        fprintf(to, "%s\"%s\": {\"count\": %llu, \"per_second\": %.2f}", i ? ", " : "",
+                kc_stats_counter_name((kc_stats_counter)i), (unsigned long long)s->counter[i],
+                s->counterPerSecond[i]);
+    }
+    fprintf(to, "}}\n");
+}
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-stats [options] FILE\n"
+        "  -w, --watch SEC   print the last SEC seconds every SEC seconds (default: once, since start)\n"
+        "  -n, --count N     with --watch, stop after N reports\n"
+        "  -j, --json        one JSON object per report\n"
+        "  -h, --help\n");
+}
+
+int main(int argc, char **argv) {
+    double watch = 0.0;
+    int count = 0, json = 0;
+    static const struct option longOpts[] = {
+        { "watch", required_argument, NULL, 'w' },
+        { "count", required_argument, NULL, 'n' },
+        { "json", no_argument, NULL, 'j' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "w:n:jh", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'w': watch = atof(optarg); break;
+        case 'n': count = atoi(optarg); break;
+        case 'j': json = 1; break;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    if (optind + 1 != argc || watch < 0.0) { usage(stderr); return 2; }
+
+    kc_stats *s = kc_stats_attach(argv[optind]);
+    if (!s) {
+        fprintf(stderr, "kc-stats: %s: not a stats file from this version\n", argv[optind]);
+        return 1;
+    }
+    kc_stats_snapshot *cur = (kc_stats_snapshot *)malloc(sizeof(*cur));
+    kc_stats_snapshot *prev = (kc_stats_snapshot *)malloc(sizeof(*prev));
+    kc_stats_summary sum;
+    if (!cur || !prev || kc_stats_take(s, prev) != 0) return 1;
+
+    if (watch <= 0.0) {
+        kc_stats_summarize(prev, NULL, &sum);
+        if (json) print_json(stdout, &sum);
+        else print_table(stdout, &sum);
+    } else {
+        struct timespec ts = { (time_t)watch, (long)((watch - (time_t)watch) * 1e9) };
+        for (int i = 0; count <= 0 || i < count; i++) {
+            nanosleep(&ts, NULL);
+            if (kc_stats_take(s, cur) != 0) break;
+            kc_stats_summarize(cur, prev, &sum);
+            if (json) print_json(stdout, &sum);
+            else { print_table(stdout, &sum); printf("\n"); }
+            fflush(stdout);
+            kc_stats_snapshot *t = prev; prev = cur; cur = t;
+        }
+    }
+    free(cur);
+    free(prev);
+    kc_stats_detach(s);
+    return 0;
+}
@@ -0,0 +1,545 @@
+/*  kc_udpbench.c
+ *
+ *  Benchmarks the LAN RX socket read path and stands in for the radio's
+ *  audio stream.
+ *
+ *  Default mode: a sender thread pushes RTP-shaped packets (12-byte header +
+ *  640 bytes, like the TS-890's) over loopback, in bursts, and the main
+ *  thread reads them twice over: once with a plain recvfrom loop (the old
+ *  receiver) and once with kc_udp_rx. Each packet carries its send time, so
+ *  both are measured from the same reference: receive CPU per packet,
+ *  syscalls per packet, batch size, send-to-read latency, how far the kernel
+ *  arrival stamp is from the send time, and drops.
+ *
+ *  --send HOST:PORT: sends a 16 kHz PCM16 tone as a 20 ms RTP stream to a
+ *  running app (listening on 60001), optionally with jitter, loss and
+ *  reordering, for exercising the jitter buffer without a radio.
+ *
+ *  --tx: checks the mic TX sender's cadence. kc_tx sends to a loopback
+ *  socket read with kc_udp_rx, fed by a thread that pushes frames in 40 ms
+ *  bursts as a capture device might. The kernel arrival stamps give the
+ *  packet spacing; exits 1 if a sequence number or frame is missing or out
+ *  of order, or if the p99 spacing error exceeds --max-error.
+ *
+ *  Usage: kc-udpbench [options]   (kc-udpbench --help)
+ */
+
+#include "kc_tx.h"
+#include "kc_udp_rx.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PACKET_BYTES  652               /* 12-byte RTP header + 320 PCM16 samples */
+#define SAMPLES       320
+#define FRAME_NS      20000000ull
+#define SLAB_PACKETS  32                /* as in KenwoodLanAudioReceiver */
+
+/* The clock kc_udp_rx stamps arrivals on. */
+static uint64_t now_ns(void) {
+#ifdef __APPLE__
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void sleep_until(uint64_t t) {
+    uint64_t now = now_ns();
+    if (t <= now) return;
+    uint64_t d = t - now;
+    struct timespec ts = { (time_t)(d / 1000000000ull), (long)(d % 1000000000ull) };
+    nanosleep(&ts, NULL);
+}
+
+static void put_be16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)(v >> 8); p[1] = (uint8_t)v; }
+static void put_be32(uint8_t *p, uint32_t v) { put_be16(p, (uint16_t)(v >> 16)); put_be16(p + 2, (uint16_t)v); }
+
+static void rtp_header(uint8_t *p, uint16_t seq) {
+    p[0] = 0x80;                        /* V=2 */
+    p[1] = 0x60;                        /* PT=96 */
+    put_be16(p + 2, seq);
+    put_be32(p + 4, 0);                 /* the radio's timestamps aren't used */
+    put_be32(p + 8, 0x38393000);        /* "890\0" */
+}
+
+/* ---- Benchmark ---- */
+
+typedef struct bench_opts {
+    int    packets;
+    int    rate;                        /* packets per second; 0 = as fast as possible */
+    int    burst;
+    int    rcvbuf;
+} bench_opts;
+
+typedef struct sender_ctx {
+    const bench_opts  *opts;
+    struct sockaddr_in to;
+    atomic_int         done;
+    int                sent;
+} sender_ctx;
+
+static void *sender_main(void *arg) {
+    sender_ctx *s = arg;
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    uint8_t pkt[PACKET_BYTES];
+    memset(pkt, 0, sizeof pkt);
+    uint64_t start = now_ns();
+    uint64_t burstNs = s->opts->rate > 0 ? (uint64_t)s->opts->burst * 1000000000ull / (uint64_t)s->opts->rate : 0;
+    for (int i = 0; fd >= 0 && i < s->opts->packets; i += s->opts->burst) {
+        if (burstNs) sleep_until(start + (uint64_t)(i / s->opts->burst) * burstNs);
+        for (int j = i; j < i + s->opts->burst && j < s->opts->packets; j++) {
+            rtp_header(pkt, (uint16_t)j);
+            uint64_t t = now_ns();
+            memcpy(pkt + 12, &t, sizeof t);
+            if (sendto(fd, pkt, sizeof pkt, 0, (struct sockaddr *)&s->to, sizeof s->to) == (ssize_t)sizeof pkt)
+                s->sent++;
+        }
+    }
+    if (fd >= 0) close(fd);
+    atomic_store(&s->done, 1);
+    return NULL;
+}
+
+typedef struct bench_result {
+    int      received;
+    uint64_t syscalls, readNs, kernelDrops, truncated;
+    int      maxBatch;
+    uint64_t *readLatency;              /* send -> returned to the reader */
+    uint64_t *stampLatency;             /* send -> kernel arrival stamp */
+    int      stamps;
+} bench_result;
+
+static int cmp_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static double percentile_us(uint64_t *v, int n, double p) {
+    if (n <= 0) return NAN;
+    int i = (int)(p * (n - 1) + 0.5);
+    return v[i] / 1e3;
+}
+
+static void record(bench_result *r, const uint8_t *data, int len, uint64_t readAt, uint64_t arrival, int haveArrival) {
+    if (len != PACKET_BYTES) return;
+    uint64_t sentAt;
+    memcpy(&sentAt, data + 12, sizeof sentAt);
+    r->readLatency[r->received] = readAt > sentAt ? readAt - sentAt : 0;
+    if (haveArrival) r->stampLatency[r->stamps++] = arrival > sentAt ? arrival - sentAt : 0;
+    r->received++;
+}
+
+static int bench_one(const bench_opts *o, int batched, bench_result *r) {
+    memset(r, 0, sizeof *r);
+    r->readLatency = calloc((size_t)o->packets, sizeof(uint64_t));
+    r->stampLatency = calloc((size_t)o->packets, sizeof(uint64_t));
+    if (!r->readLatency || !r->stampLatency) return -1;
+
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) return -1;
+    if (o->rcvbuf > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &o->rcvbuf, sizeof o->rcvbuf);
+    struct sockaddr_in sin = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t len = sizeof sin;
+    if (bind(fd, (struct sockaddr *)&sin, sizeof sin) != 0 || getsockname(fd, (struct sockaddr *)&sin, &len) != 0) {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    kc_udp_rx *rx = batched ? kc_udp_rx_create(fd, SLAB_PACKETS, 2048) : NULL;
+    if (batched && !rx) {
+        close(fd);
+        return -1;
+    }
+
+    sender_ctx s = { .opts = o, .to = sin };
+    pthread_t th;
+    pthread_create(&th, NULL, sender_main, &s);
+
+    uint8_t buf[2048];
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    for (;;) {
+        int ready = poll(&pfd, 1, 50);
+        if (ready == 0) {
+            if (atomic_load(&s.done)) break;
+            continue;
+        }
+        if (ready < 0 && errno != EINTR) break;
+
+        /* Drain as KenwoodLanAudioReceiver does on each read event. */
+        uint64_t t0 = now_ns();
+        if (batched) {
+            const kc_udp_packet *p;
+            for (;;) {
+                int n = kc_udp_rx_receive(rx, &p);
+#if defined(__linux__)
+                r->syscalls++;          /* one recvmmsg */
+#else
+                r->syscalls += n > 0 ? (uint64_t)n + (n < SLAB_PACKETS) : 1;   /* recvmsg each, then EAGAIN */
+#endif
+                if (n <= 0) break;
+                uint64_t at = now_ns();
+                for (int i = 0; i < n; i++) record(r, p[i].data, p[i].length, at, p[i].arrivalNs, 1);
+                if (n < SLAB_PACKETS) break;
+            }
+        } else {
+            for (;;) {
+                struct sockaddr_in from;
+                socklen_t fromLen = sizeof from;
+                ssize_t n = recvfrom(fd, buf, sizeof buf, 0, (struct sockaddr *)&from, &fromLen);
+                r->syscalls++;
+                if (n <= 0) break;
+                if (r->maxBatch < 1) r->maxBatch = 1;
+                record(r, buf, (int)n, now_ns(), 0, 0);
+            }
+        }
+        r->readNs += now_ns() - t0;
+    }
+    pthread_join(th, NULL);
+
+    if (rx) {
+        kc_udp_rx_stats st;
+        kc_udp_rx_read_stats(rx, &st);
+        r->kernelDrops = st.kernelDrops;
+        r->truncated = st.truncated;
+        r->maxBatch = st.maxBatch;
+        if (!st.kernelTimestamps) r->stamps = 0;
+        kc_udp_rx_destroy(rx);
+    }
+    close(fd);
+    return s.sent;
+}
+
+static void print_result(const char *name, int sent, bench_result *r) {
+    qsort(r->readLatency, (size_t)r->received, sizeof(uint64_t), cmp_u64);
+    qsort(r->stampLatency, (size_t)r->stamps, sizeof(uint64_t), cmp_u64);
+    int dropped = sent - r->received;
+    printf("%-10s %8d %8d %9.0f %8.3f %6d %9.1f %9.1f ",
+           name, sent, r->received,
+           r->received ? (double)r->readNs / r->received : NAN,
+           r->received ? (double)r->syscalls / r->received : NAN,
+           r->maxBatch,
+           percentile_us(r->readLatency, r->received, 0.5),
+           percentile_us(r->readLatency, r->received, 0.99));
+    if (r->stamps) printf("%9.1f %9.1f", percentile_us(r->stampLatency, r->stamps, 0.5),
+                          percentile_us(r->stampLatency, r->stamps, 0.99));
+    else printf("%9s %9s", "-", "-");
+    printf(" %7d", dropped);
+    if (r->kernelDrops || r->truncated)
+        printf("  (kernel %llu, truncated %llu)", (unsigned long long)r->kernelDrops, (unsigned long long)r->truncated);
+    printf("\n");
+    free(r->readLatency);
+    free(r->stampLatency);
+}
+
+static int run_bench(const bench_opts *o) {
+    printf("%d packets of %d bytes, %s, bursts of %d, SO_RCVBUF %s\n", o->packets, PACKET_BYTES,
+           o->rate > 0 ? "paced" : "unpaced", o->burst, o->rcvbuf > 0 ? "set" : "default");
+    if (o->rate > 0) printf("rate %d packets/s\n", o->rate);
+    printf("%-10s %8s %8s %9s %8s %6s %9s %9s %9s %9s %7s\n", "reader", "sent", "recvd", "ns/pkt",
+           "sys/pkt", "batch", "read p50", "read p99", "stamp p50", "stamp p99", "dropped");
+    printf("%-10s %8s %8s %9s %8s %6s %9s %9s %9s %9s %7s\n", "", "", "", "", "", "max", "us", "us", "us", "us", "");
+    static const char *const names[2] = { "recvfrom", "kc_udp_rx" };
+    for (int batched = 0; batched < 2; batched++) {
+        bench_result r;
+        int sent = bench_one(o, batched, &r);
+        if (sent < 0) {
+            fprintf(stderr, "kc-udpbench: %s: %s\n", names[batched], strerror(errno));
+            return 1;
+        }
+        print_result(names[batched], sent, &r);
+    }
+    return 0;
+}
+
+/* ---- Stand-in radio stream ---- */
+
+typedef struct stream_opts {
+    double seconds;
+    double toneHz;
+    double jitterMs;                    /* extra send delay, uniform in [0, jitterMs] */
+    double lossPct;
+    double reorderPct;                  /* held back one frame, so it goes after its successor */
+    unsigned seed;
+} stream_opts;
+
+typedef struct pending {
+    uint64_t at;
+    uint16_t seq;
+} pending;
+
+static void tone_payload(uint8_t *p, uint16_t seq, const stream_opts *o) {
+    for (int i = 0; i < SAMPLES; i++) {
+        double t = ((double)seq * SAMPLES + i) / 16000.0;
+        int16_t v = (int16_t)lrint(0.3 * 32767.0 * sin(2.0 * M_PI * o->toneHz * t));
+        p[2 * i] = (uint8_t)v;
+        p[2 * i + 1] = (uint8_t)((uint16_t)v >> 8);
+    }
+}
+
+static double uniform(void) {
+    return rand() / ((double)RAND_MAX + 1.0);
+}
+
+static int run_stream(const char *target, const stream_opts *o) {
+    char host[64];
+    const char *colon = strrchr(target, ':');
+    size_t hostLen = colon ? (size_t)(colon - target) : strlen(target);
+    if (hostLen >= sizeof host) hostLen = sizeof host - 1;
+    memcpy(host, target, hostLen);
+    host[hostLen] = 0;
+    struct sockaddr_in to = { .sin_family = AF_INET, .sin_port = htons(colon ? (uint16_t)atoi(colon + 1) : 60001) };
+    if (inet_pton(AF_INET, host, &to.sin_addr) != 1) {
+        fprintf(stderr, "kc-udpbench: %s: not an IPv4 address\n", host);
+        return 2;
+    }
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) { perror("kc-udpbench: socket"); return 1; }
+    srand(o->seed);
+
+    enum { MAX_PENDING = 256 };
+    pending queue[MAX_PENDING];
+    int queued = 0;
+    uint8_t pkt[PACKET_BYTES];
+    int total = (int)(o->seconds * 1e9 / FRAME_NS);
+    int made = 0, sent = 0, lost = 0, reordered = 0;
+    uint64_t start = now_ns();
+
+    while (made < total || queued > 0) {
+        uint64_t now = now_ns();
+        /* Packets the radio has produced by now. */
+        while (made < total && start + (uint64_t)made * FRAME_NS <= now) {
+            uint64_t at = start + (uint64_t)made * FRAME_NS + (uint64_t)(uniform() * o->jitterMs * 1e6);
+            if (uniform() * 100.0 < o->reorderPct) {
+                at += FRAME_NS + FRAME_NS / 4;
+                reordered++;
+            }
+            if (uniform() * 100.0 < o->lossPct) lost++;
+            else if (queued < MAX_PENDING) queue[queued++] = (pending){ at, (uint16_t)made };
+            made++;
+        }
+        /* Send what's due, in due order. */
+        for (;;) {
+            int due = -1;
+            for (int i = 0; i < queued; i++)
+                if (queue[i].at <= now && (due < 0 || queue[i].at < queue[due].at)) due = i;
+            if (due < 0) break;
+            rtp_header(pkt, queue[due].seq);
+            tone_payload(pkt + 12, queue[due].seq, o);
+            if (sendto(fd, pkt, sizeof pkt, 0, (struct sockaddr *)&to, sizeof to) == (ssize_t)sizeof pkt) sent++;
+            queue[due] = queue[--queued];
+        }
+        uint64_t next = made < total ? start + (uint64_t)made * FRAME_NS : UINT64_MAX;
+        for (int i = 0; i < queued; i++)
+            if (queue[i].at < next) next = queue[i].at;
+        if (next != UINT64_MAX) sleep_until(next);
+    }
+    close(fd);
+    printf("%d packets: %d sent, %d dropped, %d held back\n", total, sent, lost, reordered);
+    return 0;
+}
+
+/* ---- Mic TX cadence ---- */
+
+typedef struct tx_feed {
+    kc_tx     *tx;
+    int        frames;
+    atomic_int pushed, full;
+} tx_feed;
+
+/* Two frames every 40 ms; each frame's samples are its index, so the reader can check order. */
+static void *tx_feed_main(void *arg) {
+    tx_feed *f = arg;
+    int16_t frame[KC_TX_FRAME_SAMPLES];
+    uint64_t start = now_ns();
+    for (int i = 0; i < f->frames; i += 2) {
+        sleep_until(start + (uint64_t)(i + 2) * FRAME_NS);
+        for (int j = i; j < i + 2 && j < f->frames; j++) {
+            for (int k = 0; k < KC_TX_FRAME_SAMPLES; k++) frame[k] = (int16_t)j;
+            if (kc_tx_push(f->tx, frame) == 0) atomic_fetch_add(&f->pushed, 1);
+            else atomic_fetch_add(&f->full, 1);
+        }
+    }
+    return NULL;
+}
+
+static int run_tx(double seconds, double maxErrorMs) {
+    int rfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    int sfd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in sin = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t len = sizeof sin;
+    if (rfd < 0 || sfd < 0 || bind(rfd, (struct sockaddr *)&sin, sizeof sin) != 0 ||
+        getsockname(rfd, (struct sockaddr *)&sin, &len) != 0) {
+        perror("kc-udpbench: socket");
+        return 1;
+    }
+    fcntl(rfd, F_SETFL, fcntl(rfd, F_GETFL) | O_NONBLOCK);
+    kc_udp_rx *rx = kc_udp_rx_create(rfd, SLAB_PACKETS, 2048);
+    int frames = (int)(seconds * 1e9 / FRAME_NS);
+    kc_tx *tx = kc_tx_create(sfd, (struct sockaddr *)&sin, sizeof sin, 0xfff0, 6);
+    uint64_t *gaps = calloc((size_t)frames + 1, sizeof(uint64_t));
+    if (!rx || !tx || !gaps) {
+        fprintf(stderr, "kc-udpbench: setup failed\n");
+        return 1;
+    }
+
+    tx_feed feed = { .tx = tx, .frames = frames };
+    pthread_t th;
+    kc_tx_set_keyed(tx, 1);
+    kc_tx_start(tx);
+    pthread_create(&th, NULL, tx_feed_main, &feed);
+
+    /* The sender sends silence until the first push and after the last, so stop once the last
+     * frame has arrived (or nothing has for a second). */
+    int received = 0, seqErrors = 0, orderErrors = 0, nGaps = 0, haveLast = 0, lastFrame = -1;
+    uint16_t lastSeq = 0;
+    uint64_t lastAt = 0, quietSince = now_ns();
+    struct pollfd pfd = { .fd = rfd, .events = POLLIN };
+    while (lastFrame < frames - 1 && now_ns() - quietSince < 1000000000ull) {
+        if (poll(&pfd, 1, 50) <= 0) continue;
+        const kc_udp_packet *p;
+        int n = kc_udp_rx_receive(rx, &p);
+        for (int i = 0; i < n; i++) {
+            if (p[i].length != KC_TX_PACKET_BYTES) continue;
+            quietSince = now_ns();
+            uint16_t seq = (uint16_t)(p[i].data[2] << 8 | p[i].data[3]);
+            if (haveLast) {
+                if (seq != (uint16_t)(lastSeq + 1)) seqErrors++;
+                if (nGaps < frames) gaps[nGaps++] = p[i].arrivalNs - lastAt;
+            }
+            haveLast = 1;
+            lastSeq = seq;
+            lastAt = p[i].arrivalNs;
+            received++;
+            /* Silence is all zeros; frame 0 is too, and counts as in order either way. */
+            int16_t v = (int16_t)(p[i].data[12] | p[i].data[13] << 8);
+            if (v > 0 || (v == 0 && lastFrame < 0)) {
+                if (v != lastFrame + 1 && v != lastFrame) orderErrors++;
+                lastFrame = v;
+            }
+        }
+    }
+    pthread_join(th, NULL);
+    kc_tx_stats st;
+    kc_tx_read_stats(tx, &st);
+    kc_tx_destroy(tx);
+    kc_udp_rx_stats rs;
+    kc_udp_rx_read_stats(rx, &rs);
+    kc_udp_rx_destroy(rx);
+    close(rfd);
+    close(sfd);
+
+    /* Spacing error: |gap - 20 ms|. */
+    for (int i = 0; i < nGaps; i++)
+        gaps[i] = gaps[i] > FRAME_NS ? gaps[i] - FRAME_NS : FRAME_NS - gaps[i];
+    qsort(gaps, (size_t)nGaps, sizeof(uint64_t), cmp_u64);
+    double p99 = percentile_us(gaps, nGaps, 0.99);
+    printf("%d frames pushed (%d refused, ring full), %d packets received%s\n",
+           atomic_load(&feed.pushed), atomic_load(&feed.full), received,
+           rs.kernelTimestamps ? "" : " (no kernel timestamps: read times used)");
+    printf("spacing error us: p50 %.1f  p99 %.1f  max %.1f\n",
+           percentile_us(gaps, nGaps, 0.5), p99, percentile_us(gaps, nGaps, 1.0));
+    printf("sender: %llu sent, %llu silence, %llu late, %llu rescheduled, %llu dropped, %llu errors, "
+           "max late %.1f us\n",
+           (unsigned long long)st.sent, (unsigned long long)st.silence, (unsigned long long)st.late,
+           (unsigned long long)st.rescheduled, (unsigned long long)st.dropped,
+           (unsigned long long)st.sendErrors, st.maxLateNs / 1e3);
+    printf("sequence errors %d, frame order errors %d, last frame %d of %d\n",
+           seqErrors, orderErrors, lastFrame, frames - 1);
+    free(gaps);
+    int ok = seqErrors == 0 && orderErrors == 0 && lastFrame == frames - 1 && p99 <= maxErrorMs * 1e3;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+static void usage(FILE *to) {
+    fprintf(to,
+        "usage: kc-udpbench [options]                 compare recvfrom and kc_udp_rx over loopback\n"
+        "       kc-udpbench --send HOST[:PORT] [options]   send a stand-in radio audio stream\n"
+        "       kc-udpbench --tx [options]            check the mic TX sender's 20 ms cadence\n"
+        "benchmark:\n"
+        "  -n, --packets N      packets per reader (default 20000)\n"
+        "  -r, --rate PPS       send rate, 0 = unpaced (default 5000)\n"
+        "  -b, --burst N        packets sent back-to-back per tick (default 8)\n"
+        "      --rcvbuf BYTES   receive buffer size (default: system default)\n"
+        "stream (--send, port 60001 unless given):\n"
+        "  -t, --seconds S      duration (default 30)\n"
+        "      --tone HZ        tone frequency (default 1000)\n"
+        "      --jitter MS      random extra delay per packet, 0..MS (default 0)\n"
+        "      --loss PCT       packets never sent (default 0)\n"
+        "      --reorder PCT    packets sent after their successor (default 0)\n"
+        "      --seed N         random seed (default 1)\n"
+        "mic TX check (--tx):\n"
+        "  -t, --seconds S      duration (default 30)\n"
+        "      --max-error MS   fail if the p99 spacing error is above MS (default 2)\n"
+        "  -h, --help\n");
+}
+
+int main(int argc, char **argv) {
+    bench_opts b = { .packets = 20000, .rate = 5000, .burst = 8, .rcvbuf = 0 };
+    stream_opts s = { .seconds = 30.0, .toneHz = 1000.0, .seed = 1 };
+    const char *target = NULL;
+    int txCheck = 0;
+    double maxErrorMs = 2.0;
+    enum { OPT_RCVBUF = 256, OPT_TONE, OPT_JITTER, OPT_LOSS, OPT_REORDER, OPT_SEED, OPT_TX, OPT_MAX_ERROR };
+    static const struct option longOpts[] = {
+        { "packets", required_argument, NULL, 'n' },
+        { "rate", required_argument, NULL, 'r' },
+        { "burst", required_argument, NULL, 'b' },
+        { "rcvbuf", required_argument, NULL, OPT_RCVBUF },
+        { "send", required_argument, NULL, 's' },
+        { "seconds", required_argument, NULL, 't' },
+        { "tone", required_argument, NULL, OPT_TONE },
+        { "jitter", required_argument, NULL, OPT_JITTER },
+        { "loss", required_argument, NULL, OPT_LOSS },
+        { "reorder", required_argument, NULL, OPT_REORDER },
+        { "seed", required_argument, NULL, OPT_SEED },
+        { "tx", no_argument, NULL, OPT_TX },
+        { "max-error", required_argument, NULL, OPT_MAX_ERROR },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "n:r:b:s:t:h", longOpts, NULL)) != -1) {
+        switch (c) {
+        case 'n': b.packets = atoi(optarg); break;
+        case 'r': b.rate = atoi(optarg); break;
+        case 'b': b.burst = atoi(optarg); break;
+        case OPT_RCVBUF: b.rcvbuf = atoi(optarg); break;
+        case 's': target = optarg; break;
+        case 't': s.seconds = atof(optarg); break;
+        case OPT_TONE: s.toneHz = atof(optarg); break;
+        case OPT_JITTER: s.jitterMs = atof(optarg); break;
+        case OPT_LOSS: s.lossPct = atof(optarg); break;
+        case OPT_REORDER: s.reorderPct = atof(optarg); break;
+        case OPT_SEED: s.seed = (unsigned)strtoul(optarg, NULL, 10); break;
+        case OPT_TX: txCheck = 1; break;
+        case OPT_MAX_ERROR: maxErrorMs = atof(optarg); break;
+        case 'h': usage(stdout); return 0;
+        default: usage(stderr); return 2;
+        }
+    }
+    if (optind != argc || b.packets < 1 || b.rate < 0 || b.burst < 1 || s.seconds <= 0.0) {
+        usage(stderr);
+        return 2;
+    }
+    if (txCheck) return run_tx(s.seconds, maxErrorMs);
+    return target ? run_stream(target, &s) : run_bench(&b);
+}